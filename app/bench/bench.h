@@ -0,0 +1,75 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2025 Axis Communications AB
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef __BENCH_H__
+#define __BENCH_H__
+
+#include <glib.h>
+
+/* the malloc(), calloc() and realloc() calls made by the process so far, see
+ * bench_alloc.c */
+extern guint64 bench_allocs;
+
+/**
+ * bench_parse_func_t:
+ * @response: a VAPIX response
+ * @len: the length of @response
+ * @err: return location for a #GError
+ *
+ * Parses @response the way its plugin does and frees the result.
+ *
+ * Returns: TRUE if successful, FALSE otherwise.
+ */
+typedef gboolean (*bench_parse_func_t)(const gchar *response,
+                                       gsize len,
+                                       GError **err);
+
+/* a thermometry.cgi 'getAreaStatus' response, see thermal_vapix.c */
+gboolean
+bench_parse_thermal_status(const gchar *response, gsize len, GError **err);
+
+/* an io/portmanagement.cgi 'getPorts' response, see ioports_vapix.c */
+gboolean
+bench_parse_ioports(const gchar *response, gsize len, GError **err);
+
+/* the 'id' key of the configuration change AxEvent of I/O port 3 */
+#define BENCH_IOPORTS_CFG_EVENT_ID                                             \
+  "/com/axis/Configuration/Legacy/IOControl/IOPort/3"
+
+/* the 'configuration_changes' key of an I/O port configuration change
+ * AxEvent, with the 'id' BENCH_IOPORTS_CFG_EVENT_ID, split and unquoted the
+ * way iop_cfg_ev_cb() does, see iop_parse_cfg_change() */
+gboolean
+bench_parse_ioports_cfg_event(const gchar *response, gsize len, GError **err);
+
+/* a virtual input activate.cgi response, see vinput_vapix.c */
+gboolean
+bench_parse_vinput_state(const gchar *response, gsize len, GError **err);
+
+/* a virtual input getschemaversions.cgi response, see vinput_vapix.c */
+gboolean
+bench_parse_vinput_schema(const gchar *response, gsize len, GError **err);
+
+#endif /* __BENCH_H__ */
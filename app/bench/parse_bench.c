@@ -0,0 +1,233 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2025 Axis Communications AB
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <glib.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "bench.h"
+#include "error.h"
+
+/* how long each case runs at least */
+#define BENCH_MIN_TIME (200 * G_TIME_SPAN_MILLISECOND)
+/* the largest number of areas and ports, the sweep doubles from 1 */
+#define BENCH_MAX_ITEMS 256
+
+#define VINPUT_STATE_RESPONSE                                                  \
+  "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"                               \
+  "<VirtualInputResponse SchemaVersion=\"1.0\">\n"                             \
+  "  <Success>\n"                                                              \
+  "    <ActivateSuccess>\n"                                                    \
+  "      <StateChanged>true</StateChanged>\n"                                  \
+  "    </ActivateSuccess>\n"                                                   \
+  "  </Success>\n"                                                             \
+  "</VirtualInputResponse>\n"
+
+#define VINPUT_SCHEMA_RESPONSE                                                 \
+  "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"                               \
+  "<VirtualInputResponse SchemaVersion=\"1.0\">\n"                             \
+  "  <Success>\n"                                                              \
+  "    <SchemaVersion>\n"                                                      \
+  "      <MajorVersion>1</MajorVersion>\n"                                     \
+  "      <MinorVersion>0</MinorVersion>\n"                                     \
+  "    </SchemaVersion>\n"                                                     \
+  "  </Success>\n"                                                             \
+  "</VirtualInputResponse>\n"
+
+/* the 'configuration_changes' key of a name change of an I/O port, quoted by
+ * the device */
+#define IOPORTS_CFG_EVENT "\"Name=Door \\\"Lobby\\\" contact\""
+
+/* a 'getAreaStatus' response of a camera with 'nr_areas' areas */
+static gchar *
+thermal_status_payload(guint nr_areas)
+{
+  GString *payload = g_string_new(NULL);
+
+  g_string_append(payload,
+                  "{\"apiVersion\":\"1.2\",\"method\":\"getAreaStatus\","
+                  "\"data\":{\"arealist\":[");
+  for (guint i = 0; i < nr_areas; i++) {
+    g_string_append_printf(payload,
+                           "%s{\"id\":%u,\"avg\":%u.25,\"min\":%u.5,"
+                           "\"max\":%u.75,\"triggered\":%s,"
+                           "\"detectionType\":\"above\","
+                           "\"measurement\":\"max\"}",
+                           i > 0 ? "," : "",
+                           i + 1,
+                           20 + i % 10,
+                           15 + i % 5,
+                           30 + i % 20,
+                           i % 7 == 0 ? "true" : "false");
+  }
+  g_string_append(payload, "]}}");
+
+  return g_string_free(payload, FALSE);
+}
+
+/* a 'getPorts' response of a device with 'nr_ports' ports */
+static gchar *
+ports_payload(guint nr_ports)
+{
+  GString *payload = g_string_new(NULL);
+
+  g_string_append_printf(payload,
+                         "{\"apiVersion\":\"1.1\",\"method\":\"getPorts\","
+                         "\"data\":{\"numberOfPorts\":%u,\"items\":[",
+                         nr_ports);
+  for (guint i = 0; i < nr_ports; i++) {
+    g_string_append_printf(payload,
+                           "%s{\"port\":\"%u\",\"configurable\":true,"
+                           "\"readonly\":%s,\"usage\":\"Door\","
+                           "\"name\":\"Port %u\",\"direction\":\"%s\","
+                           "\"state\":\"%s\",\"normalState\":\"open\"}",
+                           i > 0 ? "," : "",
+                           i,
+                           i % 4 == 3 ? "true" : "false",
+                           i + 1,
+                           i % 2 ? "output" : "input",
+                           i % 3 ? "closed" : "open");
+  }
+  g_string_append(payload, "]}}");
+
+  return g_string_free(payload, FALSE);
+}
+
+/* runs 'func' on 'payload' for at least BENCH_MIN_TIME and prints the mean
+ * time and number of allocations of a call */
+static gboolean
+run_case(const gchar *name,
+         guint nr_items,
+         bench_parse_func_t func,
+         const gchar *payload,
+         GError **err)
+{
+  gsize len = strlen(payload);
+  guint64 iterations = 0;
+  guint64 batch = 1;
+  guint64 allocs;
+  gint64 start;
+  gint64 elapsed;
+
+  g_assert(err == NULL || *err == NULL);
+
+  /* the first call registers the timing metric of the parser */
+  if (!func(payload, len, err)) {
+    g_prefix_error(err, "%s/%u: ", name, nr_items);
+    return FALSE;
+  }
+
+  allocs = bench_allocs;
+  start = g_get_monotonic_time();
+  do {
+    for (guint64 i = 0; i < batch; i++) {
+      if (!func(payload, len, err)) {
+        g_prefix_error(err, "%s/%u: ", name, nr_items);
+        return FALSE;
+      }
+    }
+    iterations += batch;
+    batch *= 2;
+    elapsed = g_get_monotonic_time() - start;
+  } while (elapsed < BENCH_MIN_TIME);
+  allocs = bench_allocs - allocs;
+
+  g_print("%-16s %5u %8zu %12.0f %10.1f\n",
+          name,
+          nr_items,
+          len,
+          (gdouble) elapsed * 1000 / (gdouble) iterations,
+          (gdouble) allocs / (gdouble) iterations);
+
+  return TRUE;
+}
+
+int
+main(void)
+{
+  GError *lerr = NULL;
+  gchar *payload;
+  gboolean ok;
+
+  g_print("%-16s %5s %8s %12s %10s\n",
+          "parser",
+          "items",
+          "bytes",
+          "ns/op",
+          "allocs/op");
+
+  for (guint n = 1; n <= BENCH_MAX_ITEMS; n *= 2) {
+    payload = thermal_status_payload(n);
+    ok = run_case("thermal.status",
+                  n,
+                  bench_parse_thermal_status,
+                  payload,
+                  &lerr);
+    g_free(payload);
+    if (!ok) {
+      goto err_out;
+    }
+  }
+
+  for (guint n = 1; n <= BENCH_MAX_ITEMS; n *= 2) {
+    payload = ports_payload(n);
+    ok = run_case("ioports.ports", n, bench_parse_ioports, payload, &lerr);
+    g_free(payload);
+    if (!ok) {
+      goto err_out;
+    }
+  }
+
+  /* a configuration change event is about a single port */
+  if (!run_case("ioports.cfg_event",
+                1,
+                bench_parse_ioports_cfg_event,
+                IOPORTS_CFG_EVENT,
+                &lerr)) {
+    goto err_out;
+  }
+
+  /* a virtual input response is about a single port */
+  if (!run_case("vinput.state",
+                1,
+                bench_parse_vinput_state,
+                VINPUT_STATE_RESPONSE,
+                &lerr) ||
+      !run_case("vinput.schema",
+                1,
+                bench_parse_vinput_schema,
+                VINPUT_SCHEMA_RESPONSE,
+                &lerr)) {
+    goto err_out;
+  }
+
+  return EXIT_SUCCESS;
+
+err_out:
+  g_printerr("%s\n", GERROR_MSG(lerr));
+  g_clear_error(&lerr);
+
+  return EXIT_FAILURE;
+}
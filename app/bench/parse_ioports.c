@@ -0,0 +1,64 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2025 Axis Communications AB
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/* the parser is static, the module is built into the benchmark */
+#include "ioports_vapix.c"
+
+#include "bench.h"
+
+gboolean
+bench_parse_ioports(const gchar *response, gsize len, GError **err)
+{
+  GHashTable *ports = NULL;
+
+  if (!parse_ports_cb(response, len, &ports, err)) {
+    return FALSE;
+  }
+  g_hash_table_destroy(ports);
+
+  return TRUE;
+}
+
+gboolean
+bench_parse_ioports_cfg_event(const gchar *response,
+                              G_GNUC_UNUSED gsize len,
+                              GError **err)
+{
+  gint64 port_nr;
+  gchar *param;
+  gchar *value;
+
+  if (!iop_parse_cfg_change(response,
+                            BENCH_IOPORTS_CFG_EVENT_ID,
+                            &port_nr,
+                            &param,
+                            &value,
+                            err)) {
+    return FALSE;
+  }
+  g_free(param);
+
+  return TRUE;
+}
@@ -0,0 +1,55 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2025 Axis Communications AB
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/* the parsers are static, the module is built into the benchmark */
+#include "vinput_vapix.c"
+
+#include "bench.h"
+
+gboolean
+bench_parse_vinput_state(const gchar *response,
+                         G_GNUC_UNUSED gsize len,
+                         GError **err)
+{
+  gboolean state_changed;
+
+  return vin_port_state_parse("activate.cgi", response, &state_changed, err);
+}
+
+gboolean
+bench_parse_vinput_schema(const gchar *response,
+                          G_GNUC_UNUSED gsize len,
+                          GError **err)
+{
+  gchar *schema_version;
+
+  schema_version = vin_schema_version_parse(response, err);
+  if (schema_version == NULL) {
+    return FALSE;
+  }
+  g_free(schema_version);
+
+  return TRUE;
+}
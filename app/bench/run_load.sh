@@ -0,0 +1,63 @@
+#!/bin/bash
+#
+#
+# MIT License
+#
+# Copyright (c) 2025 Axis Communications AB
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice (including the next
+# paragraph) shall be included in all copies or substantial portions of the
+# Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+# AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+# SOFTWARE.
+
+# Runs the host build of the server (load/opcpluginserver) with its VAPIX
+# requests served by tools/vapix_mock.py, drives it with ua_load_bench, whose
+# options are the arguments of the script, and stops both. The server
+# parameters are set with AXPARAM_<name> variables, e.g. AXPARAM_Port=4841, the
+# mock with VAPIX_MOCK_ARGS, e.g. VAPIX_MOCK_ARGS="--latency-ms 20 --areas 16".
+# VAPIX_MOCK_PORT is to match the one the server was built with. The method
+# calls of ua_load_bench (--call-interval) are served by the method workers
+# with e.g. AXPARAM_MethodWorkers=4.
+
+set -eu
+
+cd "$(dirname "$0")"
+
+port=${AXPARAM_Port:-4840}
+# the plugins add most of their nodes once their first VAPIX requests are done
+settle=${LOAD_SETTLE:-3}
+
+python3 ../../tools/vapix_mock.py --port "${VAPIX_MOCK_PORT:-8080}" \
+        ${VAPIX_MOCK_ARGS:-} &
+mock=$!
+./load/opcpluginserver &
+server=$!
+trap 'kill $server $mock 2>/dev/null; wait' EXIT
+
+for _ in $(seq 100); do
+    if ! kill -0 $server 2>/dev/null; then
+        echo "the server exited, see the system log" >&2
+        exit 1
+    fi
+    if (exec 3<>/dev/tcp/127.0.0.1/"$port") 2>/dev/null; then
+        break
+    fi
+    sleep 0.1
+done
+sleep "$settle"
+
+./ua_load_bench --url "opc.tcp://127.0.0.1:$port" --pid $server "$@"
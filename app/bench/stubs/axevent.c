@@ -0,0 +1,338 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2025 Axis Communications AB
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <axsdk/axevent.h>
+#include <stdarg.h>
+
+#include "error.h"
+
+DEFINE_GQUARK("axevent-stub")
+
+typedef struct kv_entry {
+  gchar *key;
+  gchar *name_space;
+  AXEventValueType type;
+  /* FALSE for the wildcards of a subscription */
+  gboolean has_value;
+  gint integer;
+  gboolean boolean;
+  gdouble number;
+  gchar *string;
+} kv_entry_t;
+
+struct _AXEventKeyValueSet {
+  GPtrArray *entries;
+};
+
+struct _AXEventHandler {
+  guint next_subscription;
+  /* subscription -> AXEventKeyValueSet, kept for nothing but their lifetime */
+  GHashTable *subscriptions;
+};
+
+struct _AXEvent {
+  AXEventKeyValueSet *key_value_set;
+  GDateTime *time_stamp;
+};
+
+static void
+free_entry(gpointer data)
+{
+  kv_entry_t *entry = data;
+
+  g_free(entry->key);
+  g_free(entry->name_space);
+  g_free(entry->string);
+  g_free(entry);
+}
+
+static const kv_entry_t *
+lookup(const AXEventKeyValueSet *key_value_set,
+       const gchar *key,
+       const gchar *name_space,
+       AXEventValueType type,
+       GError **err)
+{
+  g_return_val_if_fail(key_value_set != NULL, NULL);
+  g_return_val_if_fail(key != NULL, NULL);
+
+  for (guint i = 0; i < key_value_set->entries->len; i++) {
+    const kv_entry_t *entry = g_ptr_array_index(key_value_set->entries, i);
+
+    if (g_strcmp0(entry->key, key) != 0 ||
+        g_strcmp0(entry->name_space, name_space) != 0) {
+      continue;
+    }
+
+    if (entry->type != type || !entry->has_value) {
+      SET_ERROR(err, -1, "Key %s has no value of type %d", key, type);
+      return NULL;
+    }
+
+    return entry;
+  }
+
+  SET_ERROR(err, -1, "No key %s", key);
+
+  return NULL;
+}
+
+AXEventHandler *
+ax_event_handler_new(void)
+{
+  AXEventHandler *event_handler = g_new0(AXEventHandler, 1);
+
+  event_handler->next_subscription = 1;
+  event_handler->subscriptions =
+          g_hash_table_new_full(NULL,
+                                NULL,
+                                NULL,
+                                (GDestroyNotify) ax_event_key_value_set_free);
+
+  return event_handler;
+}
+
+void
+ax_event_handler_free(AXEventHandler *event_handler)
+{
+  if (event_handler == NULL) {
+    return;
+  }
+
+  g_hash_table_destroy(event_handler->subscriptions);
+  g_free(event_handler);
+}
+
+gboolean
+ax_event_handler_subscribe(AXEventHandler *event_handler,
+                           const AXEventKeyValueSet *key_value_set,
+                           guint *subscription,
+                           G_GNUC_UNUSED AXSubscriptionCallback callback,
+                           G_GNUC_UNUSED gpointer user_data,
+                           GError **error)
+{
+  AXEventKeyValueSet *copy;
+
+  g_return_val_if_fail(event_handler != NULL, FALSE);
+  g_return_val_if_fail(key_value_set != NULL, FALSE);
+  g_return_val_if_fail(subscription != NULL, FALSE);
+  g_return_val_if_fail(error == NULL || *error == NULL, FALSE);
+
+  /* the caller frees its set once subscribed */
+  copy = ax_event_key_value_set_new();
+  for (guint i = 0; i < key_value_set->entries->len; i++) {
+    const kv_entry_t *entry = g_ptr_array_index(key_value_set->entries, i);
+    kv_entry_t *dup = g_memdup2(entry, sizeof(*entry));
+
+    dup->key = g_strdup(entry->key);
+    dup->name_space = g_strdup(entry->name_space);
+    dup->string = g_strdup(entry->string);
+    g_ptr_array_add(copy->entries, dup);
+  }
+
+  *subscription = event_handler->next_subscription++;
+  g_hash_table_insert(event_handler->subscriptions,
+                      GUINT_TO_POINTER(*subscription),
+                      copy);
+
+  return TRUE;
+}
+
+gboolean
+ax_event_handler_unsubscribe_and_notify(AXEventHandler *event_handler,
+                                        guint subscription,
+                                        GDestroyNotify callback,
+                                        gpointer user_data,
+                                        GError **error)
+{
+  g_return_val_if_fail(event_handler != NULL, FALSE);
+  g_return_val_if_fail(error == NULL || *error == NULL, FALSE);
+
+  if (!g_hash_table_remove(event_handler->subscriptions,
+                           GUINT_TO_POINTER(subscription))) {
+    SET_ERROR(error, -1, "No subscription %u", subscription);
+    return FALSE;
+  }
+
+  if (callback != NULL) {
+    callback(user_data);
+  }
+
+  return TRUE;
+}
+
+AXEventKeyValueSet *
+ax_event_key_value_set_new(void)
+{
+  AXEventKeyValueSet *key_value_set = g_new0(AXEventKeyValueSet, 1);
+
+  key_value_set->entries = g_ptr_array_new_with_free_func(free_entry);
+
+  return key_value_set;
+}
+
+void
+ax_event_key_value_set_free(AXEventKeyValueSet *key_value_set)
+{
+  if (key_value_set == NULL) {
+    return;
+  }
+
+  g_ptr_array_unref(key_value_set->entries);
+  g_free(key_value_set);
+}
+
+gboolean
+ax_event_key_value_set_add_key_values(AXEventKeyValueSet *key_value_set,
+                                      GError **error,
+                                      ...)
+{
+  const gchar *key;
+  va_list args;
+
+  g_return_val_if_fail(key_value_set != NULL, FALSE);
+  g_return_val_if_fail(error == NULL || *error == NULL, FALSE);
+
+  va_start(args, error);
+  while ((key = va_arg(args, const gchar *)) != NULL) {
+    kv_entry_t *entry = g_new0(kv_entry_t, 1);
+    const gchar *name_space = va_arg(args, const gchar *);
+    gconstpointer value = va_arg(args, gconstpointer);
+
+    entry->key = g_strdup(key);
+    entry->name_space = g_strdup(name_space);
+    entry->type = va_arg(args, AXEventValueType);
+    entry->has_value = (value != NULL);
+    if (value != NULL) {
+      switch (entry->type) {
+      case AX_VALUE_TYPE_INT:
+        entry->integer = *(const gint *) value;
+        break;
+      case AX_VALUE_TYPE_BOOL:
+        entry->boolean = *(const gboolean *) value;
+        break;
+      case AX_VALUE_TYPE_DOUBLE:
+        entry->number = *(const gdouble *) value;
+        break;
+      case AX_VALUE_TYPE_STRING:
+      case AX_VALUE_TYPE_ELEMENT:
+        entry->string = g_strdup(value);
+        break;
+      }
+    }
+    g_ptr_array_add(key_value_set->entries, entry);
+  }
+  va_end(args);
+
+  return TRUE;
+}
+
+gboolean
+ax_event_key_value_set_get_integer(const AXEventKeyValueSet *key_value_set,
+                                   const gchar *key,
+                                   const gchar *name_space,
+                                   gint *value,
+                                   GError **error)
+{
+  const kv_entry_t *entry;
+
+  g_return_val_if_fail(value != NULL, FALSE);
+
+  entry = lookup(key_value_set, key, name_space, AX_VALUE_TYPE_INT, error);
+  if (entry == NULL) {
+    return FALSE;
+  }
+  *value = entry->integer;
+
+  return TRUE;
+}
+
+gboolean
+ax_event_key_value_set_get_boolean(const AXEventKeyValueSet *key_value_set,
+                                   const gchar *key,
+                                   const gchar *name_space,
+                                   gboolean *value,
+                                   GError **error)
+{
+  const kv_entry_t *entry;
+
+  g_return_val_if_fail(value != NULL, FALSE);
+
+  entry = lookup(key_value_set, key, name_space, AX_VALUE_TYPE_BOOL, error);
+  if (entry == NULL) {
+    return FALSE;
+  }
+  *value = entry->boolean;
+
+  return TRUE;
+}
+
+gboolean
+ax_event_key_value_set_get_string(const AXEventKeyValueSet *key_value_set,
+                                  const gchar *key,
+                                  const gchar *name_space,
+                                  gchar **value,
+                                  GError **error)
+{
+  const kv_entry_t *entry;
+
+  g_return_val_if_fail(value != NULL, FALSE);
+
+  entry = lookup(key_value_set, key, name_space, AX_VALUE_TYPE_STRING, error);
+  if (entry == NULL) {
+    return FALSE;
+  }
+  *value = g_strdup(entry->string);
+
+  return TRUE;
+}
+
+const AXEventKeyValueSet *
+ax_event_get_key_value_set(const AXEvent *event)
+{
+  g_return_val_if_fail(event != NULL, NULL);
+
+  return event->key_value_set;
+}
+
+GDateTime *
+ax_event_get_time_stamp2(AXEvent *event)
+{
+  g_return_val_if_fail(event != NULL, NULL);
+
+  return event->time_stamp;
+}
+
+void
+ax_event_free(AXEvent *event)
+{
+  if (event == NULL) {
+    return;
+  }
+
+  ax_event_key_value_set_free(event->key_value_set);
+  g_clear_pointer(&event->time_stamp, g_date_time_unref);
+  g_free(event);
+}
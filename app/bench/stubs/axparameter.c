@@ -0,0 +1,177 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2025 Axis Communications AB
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <axsdk/axparameter.h>
+#include <jansson.h>
+
+#include "error.h"
+
+/* app/manifest.json, the defaults of the parameters are read from */
+#ifndef BENCH_MANIFEST
+#error "BENCH_MANIFEST is to be set to the path of app/manifest.json"
+#endif
+
+#define ENV_PREFIX "AXPARAM_"
+
+DEFINE_GQUARK("axparameter-stub")
+
+struct _AXParameter {
+  /* name -> value */
+  GHashTable *values;
+};
+
+/* reads the names and defaults of acapPackageConf.configuration.paramConfig
+ * of the manifest into 'values' */
+static gboolean
+load_defaults(GHashTable *values, GError **err)
+{
+  gboolean ret = FALSE;
+  json_error_t json_error;
+  json_t *manifest;
+  json_t *params;
+  json_t *param;
+  gsize index;
+
+  g_assert(values != NULL);
+  g_assert(err == NULL || *err == NULL);
+
+  manifest = json_load_file(BENCH_MANIFEST, 0, &json_error);
+  if (manifest == NULL) {
+    SET_ERROR(err, -1, "%s: %s", BENCH_MANIFEST, json_error.text);
+    return FALSE;
+  }
+
+  /* clang-format off */
+  if (json_unpack_ex(manifest, &json_error, 0, "{s:{s:{s:o}}}",
+                     "acapPackageConf",
+                     "configuration",
+                     "paramConfig", &params) != 0) {
+    SET_ERROR(err, -1, "%s: %s", BENCH_MANIFEST, json_error.text);
+    goto out;
+  }
+  /* clang-format on */
+
+  json_array_foreach(params, index, param)
+  {
+    const gchar *name;
+    const gchar *value;
+
+    if (json_unpack_ex(param,
+                       &json_error,
+                       0,
+                       "{s:s, s:s}",
+                       "name",
+                       &name,
+                       "default",
+                       &value) != 0) {
+      SET_ERROR(err, -1, "%s: %s", BENCH_MANIFEST, json_error.text);
+      goto out;
+    }
+    g_hash_table_replace(values, g_strdup(name), g_strdup(value));
+  }
+
+  ret = TRUE;
+
+out:
+  json_decref(manifest);
+
+  return ret;
+}
+
+AXParameter *
+ax_parameter_new(G_GNUC_UNUSED const gchar *app_name, GError **error)
+{
+  AXParameter *handle;
+
+  g_return_val_if_fail(error == NULL || *error == NULL, NULL);
+
+  handle = g_new0(AXParameter, 1);
+  handle->values =
+          g_hash_table_new_full(g_str_hash, g_str_equal, g_free, g_free);
+
+  if (!load_defaults(handle->values, error)) {
+    ax_parameter_free(handle);
+    return NULL;
+  }
+
+  return handle;
+}
+
+void
+ax_parameter_free(AXParameter *handle)
+{
+  if (handle == NULL) {
+    return;
+  }
+
+  g_hash_table_destroy(handle->values);
+  g_free(handle);
+}
+
+gboolean
+ax_parameter_get(AXParameter *handle,
+                 const gchar *name,
+                 gchar **value,
+                 GError **error)
+{
+  const gchar *found;
+  gchar *env_name;
+
+  g_return_val_if_fail(handle != NULL, FALSE);
+  g_return_val_if_fail(name != NULL, FALSE);
+  g_return_val_if_fail(value != NULL, FALSE);
+  g_return_val_if_fail(error == NULL || *error == NULL, FALSE);
+
+  env_name = g_strconcat(ENV_PREFIX, name, NULL);
+  found = g_getenv(env_name);
+  g_free(env_name);
+
+  if (found == NULL) {
+    found = g_hash_table_lookup(handle->values, name);
+  }
+
+  if (found == NULL) {
+    SET_ERROR(error, -1, "No parameter %s", name);
+    return FALSE;
+  }
+
+  *value = g_strdup(found);
+
+  return TRUE;
+}
+
+gboolean
+ax_parameter_register_callback(AXParameter *handle,
+                               const gchar *name,
+                               G_GNUC_UNUSED AXParameterCallback callback,
+                               G_GNUC_UNUSED gpointer user_data,
+                               GError **error)
+{
+  g_return_val_if_fail(handle != NULL, FALSE);
+  g_return_val_if_fail(name != NULL, FALSE);
+  g_return_val_if_fail(error == NULL || *error == NULL, FALSE);
+
+  return TRUE;
+}
@@ -0,0 +1,115 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2025 Axis Communications AB
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef __STUB_AXEVENT_H__
+#define __STUB_AXEVENT_H__
+
+#include <glib.h>
+
+/* the part of the axevent API of the ACAP SDK used by the plugins, for the
+ * host build of the application. The subscriptions succeed but no event is
+ * ever delivered. */
+
+typedef struct _AXEvent AXEvent;
+typedef struct _AXEventHandler AXEventHandler;
+typedef struct _AXEventKeyValueSet AXEventKeyValueSet;
+
+typedef enum {
+  AX_VALUE_TYPE_INT,
+  AX_VALUE_TYPE_BOOL,
+  AX_VALUE_TYPE_DOUBLE,
+  AX_VALUE_TYPE_STRING,
+  AX_VALUE_TYPE_ELEMENT
+} AXEventValueType;
+
+typedef void (*AXSubscriptionCallback)(guint subscription,
+                                       AXEvent *event,
+                                       gpointer user_data);
+
+AXEventHandler *
+ax_event_handler_new(void);
+
+void
+ax_event_handler_free(AXEventHandler *event_handler);
+
+gboolean
+ax_event_handler_subscribe(AXEventHandler *event_handler,
+                           const AXEventKeyValueSet *key_value_set,
+                           guint *subscription,
+                           AXSubscriptionCallback callback,
+                           gpointer user_data,
+                           GError **error);
+
+gboolean
+ax_event_handler_unsubscribe_and_notify(AXEventHandler *event_handler,
+                                        guint subscription,
+                                        GDestroyNotify callback,
+                                        gpointer user_data,
+                                        GError **error);
+
+AXEventKeyValueSet *
+ax_event_key_value_set_new(void);
+
+void
+ax_event_key_value_set_free(AXEventKeyValueSet *key_value_set);
+
+/* the variable arguments are NULL terminated quadruples of key, namespace,
+ * value and AXEventValueType */
+gboolean
+ax_event_key_value_set_add_key_values(AXEventKeyValueSet *key_value_set,
+                                      GError **error,
+                                      ...);
+
+gboolean
+ax_event_key_value_set_get_integer(const AXEventKeyValueSet *key_value_set,
+                                   const gchar *key,
+                                   const gchar *name_space,
+                                   gint *value,
+                                   GError **error);
+
+gboolean
+ax_event_key_value_set_get_boolean(const AXEventKeyValueSet *key_value_set,
+                                   const gchar *key,
+                                   const gchar *name_space,
+                                   gboolean *value,
+                                   GError **error);
+
+gboolean
+ax_event_key_value_set_get_string(const AXEventKeyValueSet *key_value_set,
+                                  const gchar *key,
+                                  const gchar *name_space,
+                                  gchar **value,
+                                  GError **error);
+
+const AXEventKeyValueSet *
+ax_event_get_key_value_set(const AXEvent *event);
+
+GDateTime *
+ax_event_get_time_stamp2(AXEvent *event);
+
+void
+ax_event_free(AXEvent *event);
+
+#endif /* __STUB_AXEVENT_H__ */
@@ -0,0 +1,61 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2025 Axis Communications AB
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef __STUB_AXPARAMETER_H__
+#define __STUB_AXPARAMETER_H__
+
+#include <glib.h>
+
+/* the part of the axparameter API of the ACAP SDK used by the application,
+ * for its host build. The values are the defaults of app/manifest.json, an
+ * AXPARAM_<name> environment variable overrides the one of <name>. */
+
+typedef struct _AXParameter AXParameter;
+
+typedef void (*AXParameterCallback)(const gchar *name,
+                                    const gchar *value,
+                                    gpointer user_data);
+
+AXParameter *
+ax_parameter_new(const gchar *app_name, GError **error);
+
+void
+ax_parameter_free(AXParameter *handle);
+
+gboolean
+ax_parameter_get(AXParameter *handle,
+                 const gchar *name,
+                 gchar **value,
+                 GError **error);
+
+/* the callback is never called, the parameters don't change */
+gboolean
+ax_parameter_register_callback(AXParameter *handle,
+                               const gchar *name,
+                               AXParameterCallback callback,
+                               gpointer user_data,
+                               GError **error);
+
+#endif /* __STUB_AXPARAMETER_H__ */
@@ -0,0 +1,936 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2025 Axis Communications AB
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/* Drives the server with concurrent sessions, each with a subscription of
+ * monitored items, a stream of reads and optionally a stream of calls of the
+ * vinput methods, and prints the read and call latency percentiles, the
+ * notification rate and the resident memory and CPU time of the server
+ * process. */
+
+#include <glib.h>
+#include <open62541/client.h>
+#include <open62541/client_config_default.h>
+#include <open62541/client_highlevel.h>
+#include <open62541/client_subscriptions.h>
+#include <open62541/plugin/log_stdout.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "error.h"
+
+/* bounds the walk of the address space */
+#define MAX_NODES 65536
+
+/* the Virtual Input ports the vinput methods accept are 1..VINPUT_MAX_PORTS */
+#define VINPUT_MAX_PORTS 64
+
+DEFINE_GQUARK("ua-load-bench")
+
+typedef enum {
+  PHASE_SETUP,
+  PHASE_RUN,
+  PHASE_STOP,
+} phase_t;
+
+/* the methods of the vinput plugin, found by their browse name */
+typedef enum {
+  METHOD_ACTIVATE,
+  METHOD_DEACTIVATE,
+  METHOD_SET_MULTIPLE,
+  NR_METHODS,
+} method_t;
+
+typedef struct session {
+  GThread *thread;
+  guint index;
+  /* the durations of the reads and the calls of the run, in microseconds */
+  GArray *latencies;
+  GArray *call_latencies;
+  gint64 connect_time;
+  guint items_created;
+  guint64 read_errors;
+  guint64 bad_values;
+  guint64 call_errors;
+  guint64 bad_results;
+  guint64 notifications;
+  GError *error;
+} session_t;
+
+typedef struct proc_sample {
+  guint64 rss_kb;
+  guint64 hwm_kb;
+  guint64 cpu_ticks;
+} proc_sample_t;
+
+static gchar *opt_url = "opc.tcp://127.0.0.1:4840";
+static gint opt_sessions = 10;
+static gint opt_items = 100;
+static gint opt_duration = 30;
+static gint opt_read_interval = 100;
+static gint opt_read_size = 1;
+static gdouble opt_publishing_interval = 1000;
+static gdouble opt_sampling_interval = 1000;
+static gint opt_call_interval;
+static gint opt_call_ports = 1;
+static gint opt_pid;
+
+/* clang-format off */
+static GOptionEntry entries[] = {
+  {"url", 'u', 0, G_OPTION_ARG_STRING, &opt_url,
+   "Endpoint of the server, default opc.tcp://127.0.0.1:4840", "URL"},
+  {"sessions", 's', 0, G_OPTION_ARG_INT, &opt_sessions,
+   "Concurrent sessions, default 10", "N"},
+  {"items", 'm', 0, G_OPTION_ARG_INT, &opt_items,
+   "Monitored items per session, default 100", "N"},
+  {"duration", 'd', 0, G_OPTION_ARG_INT, &opt_duration,
+   "Seconds of the run, default 30", "S"},
+  {"read-interval", 'i', 0, G_OPTION_ARG_INT, &opt_read_interval,
+   "Milliseconds between the reads of a session, 0 for back to back, "
+   "default 100", "MS"},
+  {"read-size", 'r', 0, G_OPTION_ARG_INT, &opt_read_size,
+   "Variables per read, default 1", "N"},
+  {"publishing-interval", 0, 0, G_OPTION_ARG_DOUBLE, &opt_publishing_interval,
+   "Milliseconds, default 1000", "MS"},
+  {"sampling-interval", 0, 0, G_OPTION_ARG_DOUBLE, &opt_sampling_interval,
+   "Milliseconds, default 1000", "MS"},
+  {"call-interval", 'c', 0, G_OPTION_ARG_INT, &opt_call_interval,
+   "Milliseconds between the vinput method calls of a session, 0 for none, "
+   "default 0", "MS"},
+  {"call-ports", 0, 0, G_OPTION_ARG_INT, &opt_call_ports,
+   "Virtual Inputs per call, 1 alternates Activate and Deactivate, more "
+   "call SetMultiple, default 1", "N"},
+  {"pid", 'p', 0, G_OPTION_ARG_INT, &opt_pid,
+   "Process of the server, for its memory and CPU time", "PID"},
+  {NULL, 0, 0, 0, NULL, NULL, NULL}
+};
+/* clang-format on */
+
+/* the variables of the plugins, the monitored items and reads cycle over */
+static UA_NodeId *nodes;
+static guint nr_nodes;
+
+/* the browse names of the vinput methods, and the method nodes and their
+ * object once found */
+static const gchar *method_names[NR_METHODS] = {
+  [METHOD_ACTIVATE] = "Activate Method",
+  [METHOD_DEACTIVATE] = "Deactivate Method",
+  [METHOD_SET_MULTIPLE] = "SetMultiple Method",
+};
+static UA_NodeId methods[NR_METHODS];
+static UA_NodeId method_objects[NR_METHODS];
+
+static gint phase = PHASE_SETUP;
+static gint sessions_ready;
+
+static UA_Client *
+new_client(void)
+{
+  UA_ClientConfig config;
+
+  memset(&config, 0, sizeof(config));
+  config.logging = UA_Log_Stdout_new(UA_LOGLEVEL_WARNING);
+  if (UA_ClientConfig_setDefault(&config) != UA_STATUSCODE_GOOD) {
+    return NULL;
+  }
+
+  return UA_Client_newWithConfig(&config);
+}
+
+static gchar *
+node_key(const UA_NodeId *id)
+{
+  UA_String str = UA_STRING_NULL;
+  gchar *key;
+
+  UA_NodeId_print(id, &str);
+  key = g_strndup((const gchar *) str.data, str.length);
+  UA_String_clear(&str);
+
+  return key;
+}
+
+/* records the method 'target' of 'parent' if it is one of the vinput
+ * methods */
+static void
+collect_method(const UA_NodeId *parent,
+               const UA_NodeId *target,
+               const UA_QualifiedName *bname)
+{
+  for (guint i = 0; i < NR_METHODS; i++) {
+    UA_String name = UA_STRING((gchar *) method_names[i]);
+
+    if (UA_String_equal(&bname->name, &name) && UA_NodeId_isNull(&methods[i])) {
+      UA_NodeId_copy(target, &methods[i]);
+      UA_NodeId_copy(parent, &method_objects[i]);
+    }
+  }
+}
+
+/* adds the targets of 'refs' of 'parent' to 'found' (variables) and
+ * 'pending' (objects to walk), skipping namespace 0 and the nodes already
+ * seen. The vinput methods are recorded by collect_method(). */
+static void
+collect_refs(const UA_NodeId *parent,
+             const UA_ReferenceDescription *refs,
+             gsize nr_refs,
+             GHashTable *seen,
+             GQueue *pending,
+             GArray *found)
+{
+  for (gsize i = 0; i < nr_refs; i++) {
+    const UA_NodeId *target = &refs[i].nodeId.nodeId;
+    UA_NodeId copy;
+
+    if (target->namespaceIndex == 0 ||
+        !g_hash_table_add(seen, node_key(target))) {
+      continue;
+    }
+
+    if (refs[i].nodeClass == UA_NODECLASS_METHOD) {
+      collect_method(parent, target, &refs[i].browseName);
+      continue;
+    }
+
+    UA_NodeId_copy(target, &copy);
+    if (refs[i].nodeClass == UA_NODECLASS_VARIABLE) {
+      g_array_append_val(found, copy);
+    } else {
+      g_queue_push_tail(pending, g_memdup2(&copy, sizeof(copy)));
+    }
+  }
+}
+
+/* walks the hierarchical references from the Objects folder and returns the
+ * variables outside namespace 0, along the way it finds the vinput methods */
+static gboolean
+find_variables(UA_Client *client, GError **err)
+{
+  gboolean ret = FALSE;
+  GHashTable *seen;
+  GQueue pending = G_QUEUE_INIT;
+  GArray *found;
+  UA_NodeId *node;
+
+  g_assert(err == NULL || *err == NULL);
+
+  seen = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, NULL);
+  found = g_array_new(FALSE, FALSE, sizeof(UA_NodeId));
+
+  node = UA_NodeId_new();
+  *node = UA_NODEID_NUMERIC(0, UA_NS0ID_OBJECTSFOLDER);
+  g_queue_push_tail(&pending, node);
+
+  while ((node = g_queue_pop_head(&pending)) != NULL &&
+         found->len < MAX_NODES) {
+    UA_BrowseDescription desc;
+    UA_BrowseRequest request;
+    UA_BrowseResponse response;
+    UA_ByteString cp = UA_BYTESTRING_NULL;
+
+    UA_BrowseDescription_init(&desc);
+    desc.nodeId = *node;
+    desc.browseDirection = UA_BROWSEDIRECTION_FORWARD;
+    desc.referenceTypeId =
+            UA_NODEID_NUMERIC(0, UA_NS0ID_HIERARCHICALREFERENCES);
+    desc.includeSubtypes = true;
+    desc.nodeClassMask =
+            UA_NODECLASS_OBJECT | UA_NODECLASS_VARIABLE | UA_NODECLASS_METHOD;
+    desc.resultMask =
+            UA_BROWSERESULTMASK_NODECLASS | UA_BROWSERESULTMASK_BROWSENAME;
+
+    UA_BrowseRequest_init(&request);
+    request.nodesToBrowse = &desc;
+    request.nodesToBrowseSize = 1;
+
+    response = UA_Client_Service_browse(client, request);
+    if (response.responseHeader.serviceResult != UA_STATUSCODE_GOOD ||
+        response.resultsSize != 1) {
+      SET_ERROR(err,
+                -1,
+                "Browse failed: %s",
+                UA_StatusCode_name(response.responseHeader.serviceResult));
+      UA_BrowseResponse_clear(&response);
+      UA_NodeId_delete(node);
+      goto out;
+    }
+    collect_refs(node,
+                 response.results[0].references,
+                 response.results[0].referencesSize,
+                 seen,
+                 &pending,
+                 found);
+    UA_ByteString_copy(&response.results[0].continuationPoint, &cp);
+    UA_BrowseResponse_clear(&response);
+
+    while (cp.length > 0) {
+      UA_BrowseNextRequest next;
+      UA_BrowseNextResponse next_response;
+
+      UA_BrowseNextRequest_init(&next);
+      next.continuationPoints = &cp;
+      next.continuationPointsSize = 1;
+
+      next_response = UA_Client_Service_browseNext(client, next);
+      UA_ByteString_clear(&cp);
+      if (next_response.responseHeader.serviceResult == UA_STATUSCODE_GOOD &&
+          next_response.resultsSize == 1) {
+        collect_refs(node,
+                     next_response.results[0].references,
+                     next_response.results[0].referencesSize,
+                     seen,
+                     &pending,
+                     found);
+        UA_ByteString_copy(&next_response.results[0].continuationPoint, &cp);
+      }
+      UA_BrowseNextResponse_clear(&next_response);
+    }
+
+    UA_NodeId_delete(node);
+  }
+  /* the walk stopped at MAX_NODES */
+  if (node != NULL) {
+    UA_NodeId_delete(node);
+  }
+
+  if (found->len == 0) {
+    SET_ERROR(err, -1, "No variables outside namespace 0, no plugin loaded?");
+    goto out;
+  }
+
+  nr_nodes = found->len;
+  nodes = (UA_NodeId *) g_array_free(found, FALSE);
+  found = NULL;
+  ret = TRUE;
+
+out:
+  if (found != NULL) {
+    for (guint i = 0; i < found->len; i++) {
+      UA_NodeId_clear(&g_array_index(found, UA_NodeId, i));
+    }
+    g_array_free(found, TRUE);
+  }
+  g_queue_clear_full(&pending, (GDestroyNotify) UA_NodeId_delete);
+  g_hash_table_destroy(seen);
+
+  return ret;
+}
+
+static void
+data_change_cb(G_GNUC_UNUSED UA_Client *client,
+               G_GNUC_UNUSED UA_UInt32 sub_id,
+               G_GNUC_UNUSED void *sub_context,
+               G_GNUC_UNUSED UA_UInt32 mon_id,
+               void *mon_context,
+               G_GNUC_UNUSED UA_DataValue *value)
+{
+  session_t *session = mon_context;
+
+  if (g_atomic_int_get(&phase) == PHASE_RUN) {
+    session->notifications++;
+  }
+}
+
+/* creates a subscription of opt_items monitored items, the ones of session
+ * 'i' start at the variable i * opt_items */
+static gboolean
+subscribe(UA_Client *client, session_t *session, GError **err)
+{
+  UA_CreateSubscriptionRequest sub_request;
+  UA_CreateSubscriptionResponse sub_response;
+  UA_CreateMonitoredItemsRequest request;
+  UA_CreateMonitoredItemsResponse response;
+  UA_MonitoredItemCreateRequest *items;
+  UA_Client_DataChangeNotificationCallback *callbacks;
+  UA_Client_DeleteMonitoredItemCallback *delete_callbacks;
+  void **contexts;
+  gboolean ret = FALSE;
+
+  g_assert(err == NULL || *err == NULL);
+
+  sub_request = UA_CreateSubscriptionRequest_default();
+  sub_request.requestedPublishingInterval = opt_publishing_interval;
+  sub_response = UA_Client_Subscriptions_create(client,
+                                                sub_request,
+                                                session,
+                                                NULL,
+                                                NULL);
+  if (sub_response.responseHeader.serviceResult != UA_STATUSCODE_GOOD) {
+    SET_ERROR(err,
+              -1,
+              "CreateSubscription failed: %s",
+              UA_StatusCode_name(sub_response.responseHeader.serviceResult));
+    return FALSE;
+  }
+
+  if (opt_items == 0) {
+    return TRUE;
+  }
+
+  items = g_new0(UA_MonitoredItemCreateRequest, opt_items);
+  callbacks = g_new0(UA_Client_DataChangeNotificationCallback, opt_items);
+  delete_callbacks = g_new0(UA_Client_DeleteMonitoredItemCallback, opt_items);
+  contexts = g_new0(void *, opt_items);
+  for (gint i = 0; i < opt_items; i++) {
+    guint node = (session->index * opt_items + i) % nr_nodes;
+
+    items[i] = UA_MonitoredItemCreateRequest_default(nodes[node]);
+    items[i].requestedParameters.samplingInterval = opt_sampling_interval;
+    callbacks[i] = data_change_cb;
+    contexts[i] = session;
+  }
+
+  UA_CreateMonitoredItemsRequest_init(&request);
+  request.subscriptionId = sub_response.subscriptionId;
+  request.timestampsToReturn = UA_TIMESTAMPSTORETURN_SOURCE;
+  request.itemsToCreate = items;
+  request.itemsToCreateSize = opt_items;
+
+  response = UA_Client_MonitoredItems_createDataChanges(client,
+                                                        request,
+                                                        contexts,
+                                                        callbacks,
+                                                        delete_callbacks);
+  if (response.responseHeader.serviceResult != UA_STATUSCODE_GOOD) {
+    SET_ERROR(err,
+              -1,
+              "CreateMonitoredItems failed: %s",
+              UA_StatusCode_name(response.responseHeader.serviceResult));
+    goto out;
+  }
+
+  for (gsize i = 0; i < response.resultsSize; i++) {
+    if (response.results[i].statusCode == UA_STATUSCODE_GOOD) {
+      session->items_created++;
+    }
+  }
+  ret = TRUE;
+
+out:
+  UA_CreateMonitoredItemsResponse_clear(&response);
+  g_free(items);
+  g_free(callbacks);
+  g_free(delete_callbacks);
+  g_free(contexts);
+
+  return ret;
+}
+
+/* serves the publish responses of 'client' until 'deadline' (monotonic
+ * microseconds) or the end of the run */
+static void
+iterate_until(UA_Client *client, gint64 deadline)
+{
+  gint64 now = g_get_monotonic_time();
+
+  do {
+    gint64 timeout = MAX(deadline - now, 0) / G_TIME_SPAN_MILLISECOND;
+
+    UA_Client_run_iterate(client, (UA_UInt32) timeout);
+    now = g_get_monotonic_time();
+  } while (now < deadline && g_atomic_int_get(&phase) != PHASE_STOP);
+}
+
+/* reads the next opt_read_size variables of the session */
+static void
+read_once(UA_Client *client,
+          session_t *session,
+          UA_ReadRequest *request,
+          guint *next_node)
+{
+  UA_ReadResponse response;
+  gint64 start;
+  gint64 latency;
+
+  for (gint i = 0; i < opt_read_size; i++) {
+    request->nodesToRead[i].nodeId = nodes[(*next_node)++ % nr_nodes];
+    request->nodesToRead[i].attributeId = UA_ATTRIBUTEID_VALUE;
+  }
+
+  start = g_get_monotonic_time();
+  response = UA_Client_Service_read(client, *request);
+  latency = g_get_monotonic_time() - start;
+
+  if (response.responseHeader.serviceResult != UA_STATUSCODE_GOOD) {
+    session->read_errors++;
+  } else {
+    g_array_append_val(session->latencies, latency);
+    for (gsize i = 0; i < response.resultsSize; i++) {
+      if (response.results[i].hasStatus &&
+          response.results[i].status != UA_STATUSCODE_GOOD) {
+        session->bad_values++;
+      }
+    }
+  }
+  UA_ReadResponse_clear(&response);
+}
+
+/* the 'n'th call of the session: with one port per call, alternately
+ * activates and deactivates a Virtual Input, otherwise sets opt_call_ports
+ * of them, all active or all inactive, with SetMultiple. The ports of the
+ * sessions follow each other. */
+static void
+call_once(UA_Client *client, session_t *session, guint64 n)
+{
+  UA_UInt32 ports[VINPUT_MAX_PORTS];
+  UA_Boolean states[VINPUT_MAX_PORTS];
+  UA_Int32 durations[VINPUT_MAX_PORTS];
+  UA_Variant input[3];
+  size_t nr_input;
+  size_t nr_output = 0;
+  UA_Variant *output = NULL;
+  UA_Boolean active = (n % 2 == 0);
+  UA_Int32 duration = -1;
+  method_t method;
+  UA_StatusCode status;
+  gint64 start;
+  gint64 latency;
+
+  for (gint i = 0; i < opt_call_ports; i++) {
+    ports[i] = (session->index * opt_call_ports + i) % VINPUT_MAX_PORTS + 1;
+    states[i] = active;
+    durations[i] = duration;
+  }
+
+  if (opt_call_ports == 1) {
+    method = active ? METHOD_ACTIVATE : METHOD_DEACTIVATE;
+    UA_Variant_setScalar(&input[0], &ports[0], &UA_TYPES[UA_TYPES_UINT32]);
+    UA_Variant_setScalar(&input[1], &duration, &UA_TYPES[UA_TYPES_INT32]);
+    nr_input = active ? 2 : 1;
+  } else {
+    method = METHOD_SET_MULTIPLE;
+    UA_Variant_setArray(&input[0],
+                        ports,
+                        opt_call_ports,
+                        &UA_TYPES[UA_TYPES_UINT32]);
+    UA_Variant_setArray(&input[1],
+                        states,
+                        opt_call_ports,
+                        &UA_TYPES[UA_TYPES_BOOLEAN]);
+    UA_Variant_setArray(&input[2],
+                        durations,
+                        opt_call_ports,
+                        &UA_TYPES[UA_TYPES_INT32]);
+    nr_input = 3;
+  }
+
+  start = g_get_monotonic_time();
+  status = UA_Client_call(client,
+                          method_objects[method],
+                          methods[method],
+                          nr_input,
+                          input,
+                          &nr_output,
+                          &output);
+  latency = g_get_monotonic_time() - start;
+
+  if (status != UA_STATUSCODE_GOOD) {
+    session->call_errors++;
+  } else {
+    g_array_append_val(session->call_latencies, latency);
+    /* the status code of each port of SetMultiple */
+    if (method == METHOD_SET_MULTIPLE && nr_output == 2 &&
+        UA_Variant_hasArrayType(&output[1], &UA_TYPES[UA_TYPES_STATUSCODE])) {
+      const UA_StatusCode *results = output[1].data;
+
+      for (gsize i = 0; i < output[1].arrayLength; i++) {
+        if (results[i] != UA_STATUSCODE_GOOD) {
+          session->bad_results++;
+        }
+      }
+    }
+  }
+  UA_Array_delete(output, nr_output, &UA_TYPES[UA_TYPES_VARIANT]);
+}
+
+static gpointer
+session_thread(gpointer data)
+{
+  session_t *session = data;
+  UA_Client *client;
+  UA_ReadValueId *ids;
+  UA_ReadRequest request;
+  UA_StatusCode status;
+  guint next_node = session->index;
+  guint64 nr_calls = 0;
+  gint64 start;
+  gint64 next_read;
+  gint64 next_call;
+
+  ids = g_new0(UA_ReadValueId, opt_read_size);
+  UA_ReadRequest_init(&request);
+  request.nodesToRead = ids;
+  request.nodesToReadSize = opt_read_size;
+
+  client = new_client();
+  if (client == NULL) {
+    SET_ERROR(&session->error, -1, "new_client() failed");
+    goto ready;
+  }
+
+  start = g_get_monotonic_time();
+  status = UA_Client_connect(client, opt_url);
+  session->connect_time = g_get_monotonic_time() - start;
+  if (status != UA_STATUSCODE_GOOD) {
+    SET_ERROR(&session->error,
+              -1,
+              "UA_Client_connect() failed: %s",
+              UA_StatusCode_name(status));
+    goto ready;
+  }
+
+  subscribe(client, session, &session->error);
+
+ready:
+  g_atomic_int_inc(&sessions_ready);
+  if (session->error != NULL) {
+    goto out;
+  }
+
+  while (g_atomic_int_get(&phase) == PHASE_SETUP) {
+    UA_Client_run_iterate(client, 10);
+  }
+
+  next_read = next_call = g_get_monotonic_time();
+  while (g_atomic_int_get(&phase) == PHASE_RUN) {
+    gint64 now = g_get_monotonic_time();
+
+    if (now >= next_read) {
+      read_once(client, session, &request, &next_node);
+      next_read = now + opt_read_interval * G_TIME_SPAN_MILLISECOND;
+    }
+    if (opt_call_interval > 0 && now >= next_call) {
+      call_once(client, session, nr_calls++);
+      next_call = now + opt_call_interval * G_TIME_SPAN_MILLISECOND;
+    }
+
+    iterate_until(client,
+                  opt_call_interval > 0 ? MIN(next_read, next_call) :
+                                          next_read);
+  }
+
+out:
+  if (client != NULL) {
+    UA_Client_disconnect(client);
+    UA_Client_delete(client);
+  }
+  g_free(ids);
+
+  return NULL;
+}
+
+static void
+sample_proc(proc_sample_t *sample)
+{
+  gchar *path;
+  gchar *contents = NULL;
+  gchar **fields;
+
+  memset(sample, 0, sizeof(*sample));
+  if (opt_pid <= 0) {
+    return;
+  }
+
+  path = g_strdup_printf("/proc/%d/status", opt_pid);
+  if (g_file_get_contents(path, &contents, NULL, NULL)) {
+    gchar *line;
+
+    line = strstr(contents, "VmRSS:");
+    if (line != NULL) {
+      sample->rss_kb = g_ascii_strtoull(line + strlen("VmRSS:"), NULL, 10);
+    }
+    line = strstr(contents, "VmHWM:");
+    if (line != NULL) {
+      sample->hwm_kb = g_ascii_strtoull(line + strlen("VmHWM:"), NULL, 10);
+    }
+  }
+  g_free(contents);
+  g_free(path);
+
+  /* utime and stime, the 14th and 15th fields, follow the command name which
+   * is in parentheses and may contain spaces */
+  path = g_strdup_printf("/proc/%d/stat", opt_pid);
+  contents = NULL;
+  if (g_file_get_contents(path, &contents, NULL, NULL) &&
+      strrchr(contents, ')') != NULL) {
+    fields = g_strsplit(strrchr(contents, ')') + 2, " ", 0);
+    if (g_strv_length(fields) > 12) {
+      sample->cpu_ticks = g_ascii_strtoull(fields[11], NULL, 10) +
+                          g_ascii_strtoull(fields[12], NULL, 10);
+    }
+    g_strfreev(fields);
+  }
+  g_free(contents);
+  g_free(path);
+}
+
+static gint
+cmp_gint64(gconstpointer a, gconstpointer b)
+{
+  gint64 x = *(const gint64 *) a;
+  gint64 y = *(const gint64 *) b;
+
+  return (x > y) - (x < y);
+}
+
+/* the 'p' quantile of the sorted 'values', in milliseconds */
+static gdouble
+percentile(GArray *values, gdouble p)
+{
+  guint index = (guint) (p * values->len);
+
+  if (values->len == 0) {
+    return 0;
+  }
+  index = MIN(index, values->len - 1);
+
+  return (gdouble) g_array_index(values, gint64, index) / 1000;
+}
+
+static void
+report(session_t *sessions,
+       gint64 elapsed,
+       const proc_sample_t *before,
+       const proc_sample_t *after,
+       guint64 max_rss_kb)
+{
+  GArray *latencies = g_array_new(FALSE, FALSE, sizeof(gint64));
+  GArray *call_latencies = g_array_new(FALSE, FALSE, sizeof(gint64));
+  GArray *connects = g_array_new(FALSE, FALSE, sizeof(gint64));
+  guint64 read_errors = 0;
+  guint64 bad_values = 0;
+  guint64 call_errors = 0;
+  guint64 bad_results = 0;
+  guint64 notifications = 0;
+  guint64 items = 0;
+  gdouble seconds = (gdouble) elapsed / G_TIME_SPAN_SECOND;
+  glong ticks_per_second = sysconf(_SC_CLK_TCK);
+
+  for (gint i = 0; i < opt_sessions; i++) {
+    g_array_append_vals(latencies,
+                        sessions[i].latencies->data,
+                        sessions[i].latencies->len);
+    g_array_append_vals(call_latencies,
+                        sessions[i].call_latencies->data,
+                        sessions[i].call_latencies->len);
+    g_array_append_val(connects, sessions[i].connect_time);
+    read_errors += sessions[i].read_errors;
+    bad_values += sessions[i].bad_values;
+    call_errors += sessions[i].call_errors;
+    bad_results += sessions[i].bad_results;
+    notifications += sessions[i].notifications;
+    items += sessions[i].items_created;
+  }
+  g_array_sort(latencies, cmp_gint64);
+  g_array_sort(call_latencies, cmp_gint64);
+  g_array_sort(connects, cmp_gint64);
+
+  g_print("sessions          %d, %" G_GUINT64_FORMAT " monitored items on %u "
+          "variables, %.1f s\n",
+          opt_sessions,
+          items,
+          nr_nodes,
+          seconds);
+  g_print("connect ms        p50 %.2f  p99 %.2f  max %.2f\n",
+          percentile(connects, 0.5),
+          percentile(connects, 0.99),
+          percentile(connects, 1));
+  g_print("reads             %u (%.1f/s), %" G_GUINT64_FORMAT " failed, "
+          "%" G_GUINT64_FORMAT " bad values\n",
+          latencies->len,
+          latencies->len / seconds,
+          read_errors,
+          bad_values);
+  g_print("read latency ms   p50 %.2f  p90 %.2f  p99 %.2f  p99.9 %.2f  "
+          "max %.2f\n",
+          percentile(latencies, 0.5),
+          percentile(latencies, 0.9),
+          percentile(latencies, 0.99),
+          percentile(latencies, 0.999),
+          percentile(latencies, 1));
+  if (opt_call_interval > 0) {
+    g_print("calls             %u (%.1f/s) of %s, %" G_GUINT64_FORMAT
+            " failed, %" G_GUINT64_FORMAT " bad results\n",
+            call_latencies->len,
+            call_latencies->len / seconds,
+            opt_call_ports == 1 ? "Activate/Deactivate" : "SetMultiple",
+            call_errors,
+            bad_results);
+    g_print("call latency ms   p50 %.2f  p90 %.2f  p99 %.2f  p99.9 %.2f  "
+            "max %.2f\n",
+            percentile(call_latencies, 0.5),
+            percentile(call_latencies, 0.9),
+            percentile(call_latencies, 0.99),
+            percentile(call_latencies, 0.999),
+            percentile(call_latencies, 1));
+  }
+  g_print("notifications     %" G_GUINT64_FORMAT " (%.1f/s)\n",
+          notifications,
+          notifications / seconds);
+  if (opt_pid > 0) {
+    g_print("server RSS kB     %" G_GUINT64_FORMAT " idle, %" G_GUINT64_FORMAT
+            " max under load, %" G_GUINT64_FORMAT " peak (VmHWM)\n",
+            before->rss_kb,
+            max_rss_kb,
+            after->hwm_kb);
+    g_print("server CPU        %.1f %%\n",
+            (gdouble) (after->cpu_ticks - before->cpu_ticks) * 100 /
+                    (gdouble) ticks_per_second / seconds);
+  }
+
+  g_array_free(latencies, TRUE);
+  g_array_free(call_latencies, TRUE);
+  g_array_free(connects, TRUE);
+}
+
+int
+main(int argc, char **argv)
+{
+  GOptionContext *context;
+  GError *lerr = NULL;
+  UA_Client *client = NULL;
+  session_t *sessions = NULL;
+  proc_sample_t before;
+  proc_sample_t after;
+  proc_sample_t sample;
+  guint64 max_rss_kb;
+  gint64 start;
+  gint64 end;
+  gint failed = 0;
+  int ret = EXIT_FAILURE;
+
+  context = g_option_context_new("- OPC-UA server load benchmark");
+  g_option_context_add_main_entries(context, entries, NULL);
+  if (!g_option_context_parse(context, &argc, &argv, &lerr)) {
+    goto err_out;
+  }
+  if (opt_sessions < 1 || opt_items < 0 || opt_duration < 1 ||
+      opt_read_interval < 0 || opt_read_size < 1 || opt_call_interval < 0 ||
+      opt_call_ports < 1 || opt_call_ports > VINPUT_MAX_PORTS) {
+    SET_ERROR(&lerr, -1, "Invalid option value, see --help");
+    goto err_out;
+  }
+
+  /* the variables are looked up once, by a session of its own */
+  client = new_client();
+  if (client == NULL) {
+    SET_ERROR(&lerr, -1, "new_client() failed");
+    goto err_out;
+  }
+  if (UA_Client_connect(client, opt_url) != UA_STATUSCODE_GOOD) {
+    SET_ERROR(&lerr, -1, "Failed to connect to %s", opt_url);
+    goto err_out;
+  }
+  if (!find_variables(client, &lerr)) {
+    goto err_out;
+  }
+  if (opt_call_interval > 0) {
+    method_t needed[] = { METHOD_ACTIVATE, METHOD_DEACTIVATE };
+
+    if (opt_call_ports > 1) {
+      needed[0] = needed[1] = METHOD_SET_MULTIPLE;
+    }
+    for (guint i = 0; i < G_N_ELEMENTS(needed); i++) {
+      if (UA_NodeId_isNull(&methods[needed[i]])) {
+        SET_ERROR(&lerr,
+                  -1,
+                  "No '%s' node, is the vinput plugin loaded?",
+                  method_names[needed[i]]);
+        goto err_out;
+      }
+    }
+  }
+  UA_Client_disconnect(client);
+  g_clear_pointer(&client, UA_Client_delete);
+
+  sessions = g_new0(session_t, opt_sessions);
+  for (gint i = 0; i < opt_sessions; i++) {
+    sessions[i].index = i;
+    sessions[i].latencies = g_array_new(FALSE, FALSE, sizeof(gint64));
+    sessions[i].call_latencies = g_array_new(FALSE, FALSE, sizeof(gint64));
+    sessions[i].thread = g_thread_new("session", session_thread, &sessions[i]);
+  }
+
+  while (g_atomic_int_get(&sessions_ready) < opt_sessions) {
+    g_usleep(10 * G_TIME_SPAN_MILLISECOND);
+  }
+  for (gint i = 0; i < opt_sessions; i++) {
+    if (sessions[i].error != NULL) {
+      g_printerr("session %d: %s\n", i, sessions[i].error->message);
+      failed++;
+    }
+  }
+
+  sample_proc(&before);
+  max_rss_kb = before.rss_kb;
+  start = g_get_monotonic_time();
+  g_atomic_int_set(&phase, PHASE_RUN);
+
+  end = start + opt_duration * G_TIME_SPAN_SECOND;
+  while (g_get_monotonic_time() < end) {
+    g_usleep(100 * G_TIME_SPAN_MILLISECOND);
+    sample_proc(&sample);
+    max_rss_kb = MAX(max_rss_kb, sample.rss_kb);
+  }
+
+  g_atomic_int_set(&phase, PHASE_STOP);
+  end = g_get_monotonic_time();
+  sample_proc(&after);
+
+  for (gint i = 0; i < opt_sessions; i++) {
+    g_thread_join(sessions[i].thread);
+  }
+
+  report(sessions, end - start, &before, &after, max_rss_kb);
+  ret = failed == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+
+err_out:
+  if (lerr != NULL) {
+    g_printerr("%s\n", lerr->message);
+    g_clear_error(&lerr);
+  }
+  if (sessions != NULL) {
+    for (gint i = 0; i < opt_sessions; i++) {
+      g_array_free(sessions[i].latencies, TRUE);
+      g_array_free(sessions[i].call_latencies, TRUE);
+      g_clear_error(&sessions[i].error);
+    }
+    g_free(sessions);
+  }
+  for (guint i = 0; i < nr_nodes; i++) {
+    UA_NodeId_clear(&nodes[i]);
+  }
+  g_free(nodes);
+  for (guint i = 0; i < NR_METHODS; i++) {
+    UA_NodeId_clear(&methods[i]);
+    UA_NodeId_clear(&method_objects[i]);
+  }
+  if (client != NULL) {
+    UA_Client_delete(client);
+  }
+  g_option_context_free(context);
+
+  return ret;
+}
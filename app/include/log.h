@@ -26,51 +26,70 @@
 #ifndef __LOG_H__
 #define __LOG_H__
 
+#include <glib.h>
 #include <open62541/plugin/log_syslog.h>
+
+/* the lowest level logged by the macros below, set from the 'LogLevel'
+ * parameter. A message of a lower level is skipped without evaluating its
+ * arguments. */
+extern gint ua_log_level;
+
+#define LOG_ENABLED(level) ((gint) (level) >= g_atomic_int_get(&ua_log_level))
+
 /* clang-format off */
 #define LOG_D(logger, fmt, args...)                                            \
   {                                                                            \
-    UA_LOG_DEBUG(logger, UA_LOGCATEGORY_USERLAND, "%s:%d/%s: " fmt,            \
-                __FILE__,                                                      \
-                __LINE__,                                                      \
-                __FUNCTION__,                                                  \
-                ##args);                                                       \
+    if (LOG_ENABLED(UA_LOGLEVEL_DEBUG)) {                                      \
+      UA_LOG_DEBUG(logger, UA_LOGCATEGORY_USERLAND, "%s:%d/%s: " fmt,          \
+                  __FILE__,                                                    \
+                  __LINE__,                                                    \
+                  __FUNCTION__,                                                \
+                  ##args);                                                     \
+    }                                                                          \
   }
 
 #define LOG_I(logger, fmt, args...)                                            \
   {                                                                            \
-    UA_LOG_INFO(logger, UA_LOGCATEGORY_USERLAND, "%s:%d/%s: " fmt,             \
-                __FILE__,                                                      \
-                __LINE__,                                                      \
-                __FUNCTION__,                                                  \
-                ##args);                                                       \
+    if (LOG_ENABLED(UA_LOGLEVEL_INFO)) {                                       \
+      UA_LOG_INFO(logger, UA_LOGCATEGORY_USERLAND, "%s:%d/%s: " fmt,           \
+                  __FILE__,                                                    \
+                  __LINE__,                                                    \
+                  __FUNCTION__,                                                \
+                  ##args);                                                     \
+    }                                                                          \
   }
 
 #define LOG_W(logger, fmt, args...)                                            \
   {                                                                            \
-    UA_LOG_WARNING(logger, UA_LOGCATEGORY_USERLAND, "%s:%d/%s: " fmt,          \
-                __FILE__,                                                      \
-                __LINE__,                                                      \
-                __FUNCTION__,                                                  \
-                ##args);                                                       \
+    if (LOG_ENABLED(UA_LOGLEVEL_WARNING)) {                                    \
+      UA_LOG_WARNING(logger, UA_LOGCATEGORY_USERLAND, "%s:%d/%s: " fmt,        \
+                  __FILE__,                                                    \
+                  __LINE__,                                                    \
+                  __FUNCTION__,                                                \
+                  ##args);                                                     \
+    }                                                                          \
   }
 
 #define LOG_E(logger, fmt, args...)                                            \
   {                                                                            \
-    UA_LOG_ERROR(logger, UA_LOGCATEGORY_USERLAND, "%s:%d/%s: " fmt,            \
-                __FILE__,                                                      \
-                __LINE__,                                                      \
-                __FUNCTION__,                                                  \
-                ##args);                                                       \
+    if (LOG_ENABLED(UA_LOGLEVEL_ERROR)) {                                      \
+      UA_LOG_ERROR(logger, UA_LOGCATEGORY_USERLAND, "%s:%d/%s: " fmt,          \
+                  __FILE__,                                                    \
+                  __LINE__,                                                    \
+                  __FUNCTION__,                                                \
+                  ##args);                                                     \
+    }                                                                          \
   }
 
 #define LOG_C(logger, fmt, args...)                                            \
   {                                                                            \
-    UA_LOG_FATAL(logger, UA_LOGCATEGORY_USERLAND, "%s:%d/%s: " fmt,            \
-                __FILE__,                                                      \
-                __LINE__,                                                      \
-                __FUNCTION__,                                                  \
-                ##args);                                                       \
+    if (LOG_ENABLED(UA_LOGLEVEL_FATAL)) {                                      \
+      UA_LOG_FATAL(logger, UA_LOGCATEGORY_USERLAND, "%s:%d/%s: " fmt,          \
+                  __FILE__,                                                    \
+                  __LINE__,                                                    \
+                  __FUNCTION__,                                                \
+                  ##args);                                                     \
+    }                                                                          \
   }
 /* clang-format on */
 
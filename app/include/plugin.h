@@ -30,15 +30,79 @@
 #include "gmodule.h"
 #include <open62541/types.h>
 
+#include "ua_queue.h"
+#include "ua_sched.h"
+#include "vapix_utils.h"
+
+/* can be set at build time, e.g. for a host build of the application */
+#ifndef ACAP_MODULES_PATH
 #define ACAP_MODULES_PATH "/usr/local/packages/" APPNAME "/lib"
+#endif
+
+/* services provided by the server application, 'params' of the plugin
+ * constructor points to this structure */
+typedef struct ua_plugin_params {
+  /* VAPIX connection pool shared by all the plugins */
+  vapix_service_t *vapix;
+  /* mutations of the server requested from outside the OPC-UA server thread,
+   * e.g. from the GLib main loop, are to be pushed onto this queue */
+  ua_queue_t *queue;
+  /* shortest period, in milliseconds, at which a plugin may sample the device
+   * on behalf of the subscribed clients (user configurable parameter) */
+  guint min_sampling_interval;
+  /* I/O port state changes closer than this many milliseconds to the last
+   * emitted event are folded into a single event, 0 to disable (user
+   * configurable parameter) */
+  guint io_event_window;
+  /* maximum number of I/O port state events per second and port, 0 for no
+   * limit (user configurable parameter) */
+  guint io_event_max_rate;
+  /* number of threads serving the method calls, 0 when they are called from
+   * the OPC-UA server thread. Methods which may block should be made
+   * asynchronous with ua_utils_set_method_async() when this is not 0, their
+   * callbacks then run concurrently with each other and with the server
+   * thread (user configurable parameter) */
+  guint method_workers;
+  /* number of events kept per event type and served to HistoryReadEvents, see
+   * ua_utils_event_pool_keep_history(), 0 to keep none (user configurable
+   * parameter) */
+  guint event_history;
+} ua_plugin_params_t;
 
 /* plugin constructor: allocates resources and initializes the OPC-UA
- * information model associated with the plugin */
+ * information model associated with the plugin, 'params' is a
+ * #ua_plugin_params_t which stays valid until the plugin is destroyed */
 typedef gboolean (*ua_create_t)(UA_Server *server,
                                 UA_Logger *logger,
                                 gpointer *params,
                                 GError **err);
 
+/* optional plugin preparation: performs the blocking requests, e.g. over
+ * VAPIX, the constructor needs the result of. It is called from a worker
+ * thread, concurrently with the preparation of the other plugins, and must
+ * not access the server nor attach sources to the GLib main loop. The
+ * constructor is only called if it succeeded, 'params' is the same as the
+ * one of the constructor */
+typedef gboolean (*ua_prepare_t)(UA_Logger *logger,
+                                 gpointer *params,
+                                 GError **err);
+
+/* optional periodic work: called from the GLib main loop by the scheduler of
+ * the application once the plugin is created, on wakeups shared with the
+ * other plugins. The plugin polls the device from here, draws its VAPIX
+ * requests from the global budget with ua_sched_acquire() and reports their
+ * outcome with ua_sched_report(), see ua_sched.h. 'client' stays valid until
+ * the plugin is destroyed */
+typedef guint (*ua_tick_t)(ua_sched_client_t *client, gint64 now);
+
+/* optional removal of the information model: deletes the nodes added by the
+ * constructor, e.g. with ua_utils_do_rollback() on the rollback data kept for
+ * that purpose, so that the plugin can be destroyed and unloaded while the
+ * server keeps running. It is called with an exclusive access to the server
+ * (see ua_server_call_exclusive()). Without it the plugin is only unloaded
+ * when the application exits */
+typedef gboolean (*ua_remove_t)(UA_Server *server, GError **err);
+
 /* plugin destructor: releases all allocated resources */
 typedef void (*ua_destroy_t)(void);
 
@@ -50,6 +114,9 @@ typedef struct conf_plugin_func_set {
   ua_create_t ua_create;                   /* plugin constructor */
   ua_destroy_t ua_destroy;                 /* plugin destructor */
   ua_get_plugin_name_t ua_get_plugin_name; /* returns the plugin name */
+  ua_prepare_t ua_prepare;                 /* optional, before ua_create */
+  ua_tick_t ua_tick;                       /* optional, periodic work */
+  ua_remove_t ua_remove;                   /* optional, before ua_destroy */
 } conf_plugin_func_set_t;
 
 /* structure used for the housekeeping of an OPC-UA plugin */
@@ -60,6 +127,14 @@ typedef struct opc_plugin {
   gchar *filename;
   /* associated #GModule handle of the dynamically-loaded library */
   GModule *module;
+  /* the plugin in the scheduler, NULL unless it is created and ticked */
+  ua_sched_client_t *sched_client;
+  /* the constructor succeeded, the information model of the plugin is in the
+   * address space */
+  gboolean created;
+  /* what the plugin allocates through open62541 is accounted to this owner,
+   * see ua_memory_set_owner() */
+  guint mem_owner;
 } opc_plugin_t;
 
 /**
@@ -74,6 +149,19 @@ typedef struct opc_plugin {
 GSList *
 plugin_get_names(UA_Logger *logger);
 
+/**
+ * plugin_get_id:
+ * @plugin_name: the file name of a plugin, as returned by plugin_get_names(),
+ *   or its full path
+ *
+ * Returns the short name of the plugin, e.g. "thermal" for
+ * "libopcua_thermal.so", by which it is known to the users.
+ *
+ * Returns: a newly allocated string.
+ */
+gchar *
+plugin_get_id(const gchar *plugin_name);
+
 /**
  * plugin_load:
  * @plugin_name: the file name of the plugin
@@ -0,0 +1,108 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2025 Axis Communications AB
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef __UA_ARENA_H__
+#define __UA_ARENA_H__
+
+#include <glib.h>
+
+/* a bump allocator for the temporaries of a callback or a request, which are
+ * all released at once by ua_arena_reset(). Once its block has grown to the
+ * high-water mark of its owner, the arena doesn't allocate anymore. An arena
+ * must only be used by one thread at a time. */
+typedef struct ua_arena ua_arena_t;
+
+/**
+ * ua_arena_new:
+ * @size: the initial size of the block, in bytes
+ *
+ * Creates an arena, its block grows as needed.
+ *
+ * Returns: a new arena to be freed with ua_arena_free().
+ */
+ua_arena_t *
+ua_arena_new(gsize size);
+
+/**
+ * ua_arena_free:
+ * @arena: an arena obtained with ua_arena_new() or NULL
+ *
+ * Frees @arena and all the memory allocated from it.
+ */
+void
+ua_arena_free(ua_arena_t *arena);
+
+/**
+ * ua_arena_reset:
+ * @arena: an arena obtained with ua_arena_new()
+ *
+ * Releases all the memory allocated from @arena since the previous reset. If
+ * the block ran out of space meanwhile it is enlarged to fit all of it.
+ */
+void
+ua_arena_reset(ua_arena_t *arena);
+
+/**
+ * ua_arena_alloc:
+ * @arena: an arena obtained with ua_arena_new()
+ * @size: the number of bytes to allocate
+ *
+ * Allocates @size bytes suitably aligned for any type.
+ *
+ * Returns: (transfer none): the uninitialized memory, valid until the next
+ *    ua_arena_reset().
+ */
+gpointer
+ua_arena_alloc(ua_arena_t *arena, gsize size);
+
+/**
+ * ua_arena_strndup:
+ * @arena: an arena obtained with ua_arena_new()
+ * @str: (nullable): a string
+ * @n: the maximum number of bytes to copy from @str
+ *
+ * Like g_strndup() but the copy is allocated from @arena.
+ *
+ * Returns: (transfer none) (nullable): the NUL-terminated copy, NULL if @str
+ *    is NULL.
+ */
+gchar *
+ua_arena_strndup(ua_arena_t *arena, const gchar *str, gsize n);
+
+/**
+ * ua_arena_printf:
+ * @arena: an arena obtained with ua_arena_new()
+ * @format: a printf()-like format
+ * @...: the arguments of @format
+ *
+ * Like g_strdup_printf() but the string is allocated from @arena.
+ *
+ * Returns: (transfer none): the formatted string.
+ */
+gchar *
+ua_arena_printf(ua_arena_t *arena, const gchar *format, ...)
+        G_GNUC_PRINTF(2, 3);
+
+#endif /* __UA_ARENA_H__ */
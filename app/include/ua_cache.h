@@ -0,0 +1,67 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2025 Axis Communications AB
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef __UA_CACHE_H__
+#define __UA_CACHE_H__
+
+#include <glib.h>
+
+/* the data the plugins fetch over VAPIX at startup which only changes on a
+ * firmware upgrade, e.g. the basic device information, is kept in a small
+ * file per plugin in the local data directory of the application. A cache
+ * written by another firmware version, or by another format version of this
+ * file, is never loaded, so the entries are fetched again after an upgrade. */
+
+/**
+ * ua_cache_load:
+ * @name: the name of the cache, a plain file name
+ * @err: return location for a #GError
+ *
+ * Loads the entries stored with ua_cache_store(). It is safe to call this from
+ * any thread.
+ *
+ * Returns: a #GHashTable of the string entries, to be released with
+ *    g_hash_table_unref(), NULL if there is no cache for the running firmware
+ *    or it can't be read.
+ */
+GHashTable *
+ua_cache_load(const gchar *name, GError **err);
+
+/**
+ * ua_cache_store:
+ * @name: the name of the cache, a plain file name
+ * @entries: a #GHashTable of the string entries to store
+ * @err: return location for a #GError
+ *
+ * Replaces the cache @name with @entries, tagged with the running firmware
+ * version. The file is replaced atomically, a concurrent ua_cache_load() sees
+ * either the old or the new entries. It is safe to call this from any thread.
+ *
+ * Returns: TRUE on success, FALSE if @err is set.
+ */
+gboolean
+ua_cache_store(const gchar *name, GHashTable *entries, GError **err);
+
+#endif /* __UA_CACHE_H__ */
@@ -0,0 +1,94 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2025 Axis Communications AB
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef __UA_HISTORY_H__
+#define __UA_HISTORY_H__
+
+#include <glib.h>
+#include <open62541/server.h>
+
+#include "ua_utils.h"
+
+/* the latest events of one event type kept in a fixed ring, so that the
+ * clients can catch up on the events they missed with HistoryReadEvents. The
+ * ring is allocated once, recording an event doesn't allocate and overwrites
+ * the oldest one when the ring is full. Every history is served by the history
+ * database of the server installed by ua_history_setup(). */
+typedef struct ua_history ua_history_t;
+
+/**
+ * ua_history_new:
+ * @eventType: the type of the recorded events
+ * @capacity: the number of events kept
+ *
+ * Creates an empty history and makes it readable by the clients.
+ *
+ * Returns: a new history to be freed with ua_history_free(), NULL if
+ *    @eventType can't be copied.
+ */
+ua_history_t *
+ua_history_new(const UA_NodeId *eventType, guint capacity);
+
+/**
+ * ua_history_free:
+ * @history: a history obtained with ua_history_new() or NULL
+ *
+ * Stops serving @history to the clients and frees it.
+ */
+void
+ua_history_free(ua_history_t *history);
+
+/**
+ * ua_history_record:
+ * @history: a history obtained with ua_history_new()
+ * @origin: the node which emitted the event
+ * @eventId: (nullable): the EventId of the emitted event
+ * @fields: the fields of the event
+ *
+ * Records an event. The strings of @fields are truncated to the fixed size of
+ * the entries of the ring.
+ */
+void
+ua_history_record(ua_history_t *history,
+                  const UA_NodeId *origin,
+                  const UA_ByteString *eventId,
+                  const ua_event_fields_t *fields);
+
+/**
+ * ua_history_setup:
+ * @server: the OPC-UA server, not running yet
+ * @err: return location for a #GError
+ *
+ * Installs the history database of @server which serves the HistoryReadEvents
+ * requests from the histories. The events are read through their origin node
+ * or through the Server object, which returns the events of all histories.
+ * The where clause of the event filter is not evaluated.
+ *
+ * Returns: TRUE if the histories are readable, FALSE if @err is set.
+ */
+gboolean
+ua_history_setup(UA_Server *server, GError **err);
+
+#endif /* __UA_HISTORY_H__ */
@@ -0,0 +1,112 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2025 Axis Communications AB
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef __UA_MEMORY_H__
+#define __UA_MEMORY_H__
+
+#include <glib.h>
+
+/* the maximum number of owners, including the server */
+#define UA_MEMORY_MAX_OWNERS 32
+/* the owner of the blocks no plugin is accountable for */
+#define UA_MEMORY_SERVER 0
+
+/* accounting of the heap used by open62541, e.g. by the nodes of each plugin.
+ * The usable size of every block allocated through open62541 is added to the
+ * owner current in the allocating thread, and subtracted from the owner
+ * current in the freeing thread. The nodes of a plugin are added and removed
+ * with the plugin as the owner, a block allocated for one owner and freed by
+ * another moves between their gauges. The bytes in use are published as the
+ * "memory.<owner>" gauges and their sum as "memory.total". It needs open62541
+ * built with UA_ENABLE_MALLOC_SINGLETON. The allocations of GLib are not
+ * accounted. */
+
+/**
+ * ua_memory_setup:
+ * @err: return location for a #GError
+ *
+ * Starts the accounting. It must be called from the main thread before
+ * anything is allocated through open62541, it can't be stopped.
+ *
+ * Returns: TRUE on success, FALSE if @err is set.
+ */
+gboolean
+ua_memory_setup(GError **err);
+
+/**
+ * ua_memory_clear:
+ *
+ * Stops publishing the gauges, to be called before ua_metrics_clear(). The
+ * blocks are still accounted.
+ */
+void
+ua_memory_clear(void);
+
+/**
+ * ua_memory_attach_thread:
+ *
+ * Accounts the blocks allocated and freed by the calling thread. The allocator
+ * of open62541 is set per thread, every thread other than the main one must
+ * call this before calling into open62541, the blocks of a thread which
+ * doesn't are not accounted. It does nothing unless ua_memory_setup()
+ * succeeded.
+ */
+void
+ua_memory_attach_thread(void);
+
+/**
+ * ua_memory_get_owner_id:
+ * @name: the name of the owner, e.g. "opcua_thermal"
+ *
+ * Looks up the owner @name, registering it on first use. It is safe to call
+ * this from any thread.
+ *
+ * Returns: the id of the owner, %UA_MEMORY_SERVER if the accounting isn't
+ *    started or there are %UA_MEMORY_MAX_OWNERS already.
+ */
+guint
+ua_memory_get_owner_id(const gchar *name);
+
+/**
+ * ua_memory_get_owner:
+ *
+ * Returns: the owner of the blocks allocated by the calling thread,
+ *    %UA_MEMORY_SERVER unless set with ua_memory_set_owner().
+ */
+guint
+ua_memory_get_owner(void);
+
+/**
+ * ua_memory_set_owner:
+ * @owner: an id obtained with ua_memory_get_owner_id()
+ *
+ * Accounts the blocks the calling thread allocates from now on to @owner.
+ *
+ * Returns: the previous owner, to be restored when done.
+ */
+guint
+ua_memory_set_owner(guint owner);
+
+#endif /* __UA_MEMORY_H__ */
@@ -0,0 +1,293 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2025 Axis Communications AB
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef __UA_METRICS_H__
+#define __UA_METRICS_H__
+
+#include <glib.h>
+#include <open62541/server.h>
+
+#include "ua_trace.h"
+
+/* the maximum number of metrics in the registry */
+#define UA_METRICS_MAX 128
+/* the number of buckets of the timing histograms */
+#define UA_METRICS_NR_BUCKETS 8
+
+/* process wide metrics of the host and the plugins. The counters and timings
+ * are updated in a per-thread shard without any lock and are only summed up
+ * when they are read, so updating them is cheap enough for the hot paths. */
+typedef struct ua_metric ua_metric_t;
+
+/**
+ * ua_metric_type_t:
+ * @UA_METRIC_COUNTER: a number of events, see ua_metric_add()
+ * @UA_METRIC_TIMING: a number of durations, their sum, their maximum and their
+ *    histogram, see ua_metric_observe()
+ * @UA_METRIC_GAUGE: the last value set with ua_metric_set()
+ */
+typedef enum {
+  UA_METRIC_COUNTER,
+  UA_METRIC_TIMING,
+  UA_METRIC_GAUGE
+} ua_metric_type_t;
+
+/**
+ * ua_metric_value_t:
+ * @count: the number of events or durations
+ * @sum: the sum of the durations, in microseconds
+ * @max: the longest duration, in microseconds
+ * @value: the value of a gauge
+ * @buckets: the number of durations up to each of the bounds returned by
+ *    ua_metrics_get_bucket_bounds()
+ *
+ * A snapshot of a metric, see ua_metric_read().
+ */
+typedef struct {
+  guint64 count;
+  guint64 sum;
+  guint64 max;
+  gint64 value;
+  guint64 buckets[UA_METRICS_NR_BUCKETS];
+} ua_metric_value_t;
+
+/**
+ * ua_metrics_get:
+ * @type: the type of the metric
+ * @name: the name of the metric, e.g. "vapix.thermometry.cgi"
+ *
+ * Looks up the metric @name, registering it on first use. It is safe to call
+ * this from any thread, but it takes a lock so the result should be kept
+ * rather than looked up for every update.
+ *
+ * Returns: (nullable): the metric, valid until ua_metrics_clear(), or NULL if
+ *    @name is registered with another type or the registry is full. The
+ *    update functions ignore a NULL metric.
+ */
+ua_metric_t *
+ua_metrics_get(ua_metric_type_t type, const gchar *name);
+
+/**
+ * ua_metrics_get_cached:
+ * @cache: a location, NULL at first, keeping the metric between calls, e.g. a
+ *    static variable of a plugin which is unloaded before ua_metrics_clear()
+ * @type: the type of the metric
+ * @name: the name of the metric
+ *
+ * Like ua_metrics_get(), but only takes the lock of the registry on the first
+ * call, for the code having no context to keep the metric in. It is safe to
+ * call this from any thread.
+ *
+ * Returns: (nullable): the metric or NULL as for ua_metrics_get().
+ */
+ua_metric_t *
+ua_metrics_get_cached(ua_metric_t **cache,
+                      ua_metric_type_t type,
+                      const gchar *name);
+
+/**
+ * ua_metrics_get_size:
+ *
+ * Returns: the number of registered metrics.
+ */
+guint
+ua_metrics_get_size(void);
+
+/**
+ * ua_metrics_get_nth:
+ * @n: an index lower than ua_metrics_get_size()
+ *
+ * Returns: the metric registered in position @n, the positions don't change
+ *    until ua_metrics_clear().
+ */
+ua_metric_t *
+ua_metrics_get_nth(guint n);
+
+/**
+ * ua_metric_get_name:
+ * @metric: a metric
+ *
+ * Returns: the name of @metric.
+ */
+const gchar *
+ua_metric_get_name(const ua_metric_t *metric);
+
+/**
+ * ua_metric_get_type:
+ * @metric: a metric
+ *
+ * Returns: the type of @metric.
+ */
+ua_metric_type_t
+ua_metric_get_type(const ua_metric_t *metric);
+
+/**
+ * ua_metric_add:
+ * @metric: (nullable): a counter
+ * @n: the number of events
+ *
+ * Adds @n events to @metric.
+ */
+void
+ua_metric_add(ua_metric_t *metric, guint64 n);
+
+/**
+ * ua_metric_observe:
+ * @metric: (nullable): a timing
+ * @usec: a duration, in microseconds
+ *
+ * Records a duration in @metric.
+ */
+void
+ua_metric_observe(ua_metric_t *metric, guint64 usec);
+
+/**
+ * ua_metric_observe_since:
+ * @metric: (nullable): a timing
+ * @start: a time obtained with g_get_monotonic_time()
+ *
+ * Records the time elapsed since @start in @metric.
+ */
+void
+ua_metric_observe_since(ua_metric_t *metric, gint64 start);
+
+/**
+ * ua_metric_set:
+ * @metric: (nullable): a gauge
+ * @value: the current value
+ *
+ * Sets the value of @metric.
+ */
+void
+ua_metric_set(ua_metric_t *metric, gint value);
+
+/**
+ * ua_metric_adjust:
+ * @metric: (nullable): a gauge
+ * @delta: the change of the value
+ *
+ * Adds @delta to the value of @metric, for the gauges updated by several
+ * threads at once.
+ */
+void
+ua_metric_adjust(ua_metric_t *metric, gint delta);
+
+/**
+ * ua_metric_read:
+ * @metric: a metric
+ * @value: (out): return location for the snapshot
+ *
+ * Sums up the shards of @metric. The snapshot of each thread is consistent,
+ * but the threads may update @metric while it is read.
+ */
+void
+ua_metric_read(const ua_metric_t *metric, ua_metric_value_t *value);
+
+/**
+ * ua_metrics_get_bucket_bounds:
+ *
+ * Returns: the inclusive upper bounds of the histogram buckets, in
+ *    microseconds, the last one is G_MAXUINT64.
+ */
+const guint64 *
+ua_metrics_get_bucket_bounds(void);
+
+/**
+ * ua_metrics_clear:
+ *
+ * Unregisters and frees all the metrics. Must only be called once no other
+ * thread uses them, i.e. when the application exits.
+ */
+void
+ua_metrics_clear(void);
+
+/**
+ * UA_METRICS_TIMED_READ:
+ * @wrapper: the name of the defined function
+ * @func: a #UA_DataSource read callback
+ * @metric: an expression evaluating to the timing of @func
+ *
+ * Defines a read callback calling @func and recording its duration in
+ * @metric, as #UA_DataSource has no context of its own. The call is traced as
+ * the datasource_read stage, tagged with the name of @func, see ua_trace.h.
+ */
+#define UA_METRICS_TIMED_READ(wrapper, func, metric)                           \
+  static UA_StatusCode wrapper(UA_Server *server,                              \
+                               const UA_NodeId *sessionId,                     \
+                               void *sessionContext,                           \
+                               const UA_NodeId *nodeId,                        \
+                               void *nodeContext,                              \
+                               UA_Boolean sourceTimeStamp,                     \
+                               const UA_NumericRange *range,                   \
+                               UA_DataValue *value)                            \
+  {                                                                            \
+    gint64 start = g_get_monotonic_time();                                     \
+    UA_TRACE_ENTRY(datasource_read, #func);                                    \
+    UA_StatusCode ret = func(server,                                           \
+                             sessionId,                                        \
+                             sessionContext,                                   \
+                             nodeId,                                           \
+                             nodeContext,                                      \
+                             sourceTimeStamp,                                  \
+                             range,                                            \
+                             value);                                           \
+    ua_metric_observe_since(metric, start);                                    \
+    UA_TRACE_EXIT(datasource_read, #func, ret);                                \
+    return ret;                                                                \
+  }
+
+/**
+ * UA_METRICS_TIMED_WRITE:
+ * @wrapper: the name of the defined function
+ * @func: a #UA_DataSource write callback
+ * @metric: an expression evaluating to the timing of @func
+ *
+ * Like UA_METRICS_TIMED_READ() for a write callback, traced as the
+ * datasource_write stage.
+ */
+#define UA_METRICS_TIMED_WRITE(wrapper, func, metric)                          \
+  static UA_StatusCode wrapper(UA_Server *server,                              \
+                               const UA_NodeId *sessionId,                     \
+                               void *sessionContext,                           \
+                               const UA_NodeId *nodeId,                        \
+                               void *nodeContext,                              \
+                               const UA_NumericRange *range,                   \
+                               const UA_DataValue *value)                      \
+  {                                                                            \
+    gint64 start = g_get_monotonic_time();                                     \
+    UA_TRACE_ENTRY(datasource_write, #func);                                   \
+    UA_StatusCode ret = func(server,                                           \
+                             sessionId,                                        \
+                             sessionContext,                                   \
+                             nodeId,                                           \
+                             nodeContext,                                      \
+                             range,                                            \
+                             value);                                           \
+    ua_metric_observe_since(metric, start);                                    \
+    UA_TRACE_EXIT(datasource_write, #func, ret);                               \
+    return ret;                                                                \
+  }
+
+#endif /* __UA_METRICS_H__ */
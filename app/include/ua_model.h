@@ -0,0 +1,148 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2025 Axis Communications AB
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef __UA_MODEL_H__
+#define __UA_MODEL_H__
+
+#include <glib.h>
+#include <open62541/server.h>
+
+#include "ua_utils.h"
+
+/* static information models: the nodes of a namespace described by constant
+ * tables, generated at build time from a NodeSet2 XML file with
+ * tools/ua_model_gen.py, and added to the server in one pass. The tables need
+ * no allocation of their own and, since the rollback walks the table, the
+ * nodes of the model are not listed one by one in the rollback data. */
+
+/* the upper bound of the EnumStrings of a variable */
+#define UA_MODEL_MAX_ENUM_STRINGS 32
+
+/* a numeric node id of namespace 0 or of the namespace of the model, whose
+ * index is only known once the model is loaded */
+typedef struct ua_model_id {
+  UA_Boolean local;
+  UA_UInt32 id;
+} ua_model_id_t;
+
+#define UA_MODEL_NS0(i)   { UA_FALSE, (i) }
+#define UA_MODEL_LOCAL(i) { UA_TRUE, (i) }
+
+/* a node of the model, in the order of addition: a parent comes before its
+ * children and a data type before the variables of that type */
+typedef struct ua_model_node {
+  /* UA_NODECLASS_OBJECT, UA_NODECLASS_VARIABLE, UA_NODECLASS_OBJECTTYPE or
+   * UA_NODECLASS_DATATYPE */
+  UA_NodeClass node_class;
+  ua_model_id_t id;
+  ua_model_id_t parent;
+  /* the hierarchical reference from the parent to the node */
+  ua_model_id_t reference_type;
+  /* objects and variables only */
+  ua_model_id_t type_definition;
+  /* the browse name is in namespace 0, e.g. "EnumStrings" */
+  UA_Boolean browse_ns0;
+  const char *browse_name;
+  const char *display_name;
+  /* NULL for none */
+  const char *description;
+  /* types only */
+  UA_Boolean is_abstract;
+  /* objects only */
+  UA_Byte event_notifier;
+  /* variables only, a user_access_level of 0 keeps the open62541 default,
+   * an array_length of 0 sets no array dimensions */
+  ua_model_id_t data_type;
+  UA_Byte access_level;
+  UA_Byte user_access_level;
+  UA_Int32 value_rank;
+  UA_UInt32 array_length;
+  /* variables only, the LocalizedText array value of the variable, e.g. the
+   * EnumStrings of an enumeration */
+  const char *const *enum_strings;
+  UA_UInt32 nr_enum_strings;
+} ua_model_node_t;
+
+/* a non hierarchical reference, added once all the nodes are */
+typedef struct ua_model_reference {
+  ua_model_id_t source;
+  ua_model_id_t reference_type;
+  ua_model_id_t target;
+  UA_Boolean is_forward;
+} ua_model_reference_t;
+
+typedef struct ua_model {
+  const char *namespace_uri;
+  const ua_model_node_t *nodes;
+  guint nr_nodes;
+  const ua_model_reference_t *references;
+  guint nr_references;
+  /* the custom data types of the model, in 'type_array', or NULL. Their
+   * namespace index is set when the model is loaded */
+  UA_DataType *types;
+  guint nr_types;
+  UA_DataTypeArray *type_array;
+} ua_model_t;
+
+/**
+ * ua_model_load:
+ * @server: the OPC-UA server
+ * @model: a static information model
+ * @rbd: the rollback data of the plugin
+ * @err: return location for a #GError
+ *
+ * Registers the namespace of @model along with its custom data types and adds
+ * its nodes and references to @server. Then ua_utils_do_rollback() on @rbd
+ * deletes the nodes of @model, after the ones listed in @rbd, whether they
+ * all were added or not. Same calling context as ua_utils_do_rollback(), only
+ * one model per rollback data.
+ *
+ * Returns: TRUE if the whole model is added, FALSE if @err is set.
+ */
+gboolean
+ua_model_load(UA_Server *server,
+              const ua_model_t *model,
+              rollback_data_t *rbd,
+              GError **err);
+
+/**
+ * ua_model_remove:
+ * @server: the OPC-UA server
+ * @model: a static information model
+ * @ns: the namespace index @model was loaded into
+ * @err: return location for a #GError
+ *
+ * Deletes the nodes of @model from @server, in the reverse order of their
+ * addition. The nodes which are missing are skipped.
+ *
+ * Returns: TRUE on success, FALSE if @err is set.
+ */
+gboolean
+ua_model_remove(UA_Server *server,
+                const ua_model_t *model,
+                UA_UInt16 ns,
+                GError **err);
+
+#endif /* __UA_MODEL_H__ */
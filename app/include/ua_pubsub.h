@@ -0,0 +1,97 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2025 Axis Communications AB
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef __UA_PUBSUB_H__
+#define __UA_PUBSUB_H__
+
+#include <glib.h>
+#include <open62541/server.h>
+
+/* publishing of variables with OPC UA PubSub: the published variables make up
+ * a single DataSet which is encoded once per publishing interval and sent as
+ * UADP NetworkMessages to a UDP (multicast) address, however many subscribers
+ * listen to it. The variables are sampled through their regular read
+ * callbacks, so the plugins publish the values they already cache. Without an
+ * open62541 built with UA_ENABLE_PUBSUB nothing is published. */
+
+/**
+ * ua_pubsub_start:
+ * @server: the OPC-UA server, not running yet
+ * @address: the URL the NetworkMessages are sent to, e.g.
+ *    "opc.udp://224.0.0.22:4840/"
+ * @publisher_id: the PublisherId identifying the server to the subscribers
+ * @interval: the publishing interval, in milliseconds
+ * @err: return location for a #GError
+ *
+ * Adds the PubSub connection, the DataSet and its writer to @server. The
+ * variables are then added to the DataSet with ua_pubsub_publish().
+ *
+ * Returns: TRUE if the publishing is started, FALSE if @err is set.
+ */
+gboolean
+ua_pubsub_start(UA_Server *server,
+                const gchar *address,
+                UA_UInt16 publisher_id,
+                guint interval,
+                GError **err);
+
+/**
+ * ua_pubsub_publish:
+ * @server: the OPC-UA server
+ * @variable: the node id of a variable
+ * @alias: the name of the field of the variable in the DataSet, unique within
+ *    the DataSet
+ * @err: return location for a #GError
+ *
+ * Adds the value of @variable to the published DataSet. To be called from the
+ * server thread or with an exclusive access to the server, e.g. from the
+ * constructor of a plugin once its variables are added. Does nothing unless
+ * ua_pubsub_start() succeeded.
+ *
+ * Returns: TRUE if @variable is published or the publishing is not started,
+ *    FALSE if @err is set.
+ */
+gboolean
+ua_pubsub_publish(UA_Server *server,
+                  const UA_NodeId *variable,
+                  const gchar *alias,
+                  GError **err);
+
+/**
+ * ua_pubsub_unpublish:
+ * @server: the OPC-UA server
+ * @ns: the namespace index of the variables
+ * @err: return location for a #GError
+ *
+ * Removes the published variables of namespace @ns from the DataSet, e.g.
+ * before a plugin deletes them. Same calling context as ua_pubsub_publish().
+ *
+ * Returns: TRUE if none of them is published anymore or the publishing is not
+ *    started, FALSE if @err is set.
+ */
+gboolean
+ua_pubsub_unpublish(UA_Server *server, UA_UInt16 ns, GError **err);
+
+#endif /* __UA_PUBSUB_H__ */
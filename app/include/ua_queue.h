@@ -0,0 +1,156 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2025 Axis Communications AB
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef __UA_QUEUE_H__
+#define __UA_QUEUE_H__
+
+#include <glib.h>
+#include <open62541/server.h>
+
+/* a bounded queue of server mutations, owned by the server application. Any
+ * thread may push commands, a single consumer thread runs them, usually the
+ * OPC-UA server thread. */
+typedef struct ua_queue ua_queue_t;
+
+/**
+ * ua_queue_func_t:
+ * @server: the OPC-UA server
+ * @data: user data passed to ua_queue_push()
+ *
+ * A server mutation, called from the consumer thread.
+ */
+typedef void (*ua_queue_func_t)(UA_Server *server, gpointer data);
+
+/**
+ * ua_queue_notify_t:
+ * @user_data: user data passed to ua_queue_set_notify()
+ *
+ * Asks the consumer to drain the queue. Called from the pushing thread, so it
+ * must be thread safe and must not push to the queue.
+ *
+ * Returns: TRUE if the consumer will drain the queue, FALSE to have the next
+ *    push call it again.
+ */
+typedef gboolean (*ua_queue_notify_t)(gpointer user_data);
+
+/**
+ * ua_queue_new:
+ * @capacity: the maximum number of pending commands, rounded up to a power of
+ *    two
+ *
+ * Creates an empty queue. Pushing and draining never block nor allocate.
+ *
+ * Returns: a new queue to be freed with ua_queue_free().
+ */
+ua_queue_t *
+ua_queue_new(guint capacity);
+
+/**
+ * ua_queue_set_notify:
+ * @queue: a queue obtained with ua_queue_new()
+ * @notify: (nullable): the consumer wakeup
+ * @user_data: user data passed to @notify
+ *
+ * Sets the function called when a command is pushed and the consumer isn't
+ * signalled yet, i.e. once per non-empty ring between two ua_queue_drain()
+ * calls. @notify is also called once right away for the commands already
+ * pending. Once this returns with a NULL @notify, the previous one is neither
+ * running nor called anymore.
+ */
+void
+ua_queue_set_notify(ua_queue_t *queue,
+                    ua_queue_notify_t notify,
+                    gpointer user_data);
+
+/**
+ * ua_queue_close:
+ * @queue: a queue obtained with ua_queue_new()
+ *
+ * Refuses new commands and frees the pending ones without running them.
+ */
+void
+ua_queue_close(ua_queue_t *queue);
+
+/**
+ * ua_queue_free:
+ * @queue: a queue obtained with ua_queue_new() or NULL
+ *
+ * Closes and frees @queue.
+ */
+void
+ua_queue_free(ua_queue_t *queue);
+
+/**
+ * ua_queue_push:
+ * @queue: a queue obtained with ua_queue_new()
+ * @func: the command to run in the consumer thread
+ * @data: user data passed to @func
+ * @destroy: (nullable): called on @data after @func has run, or when the
+ *    command is dropped
+ * @err: return location for a #GError
+ *
+ * Adds a command to @queue. It is safe to call this from any thread, the
+ * commands pushed by one thread are run in the same order. What @func and
+ * @destroy allocate through open62541 is accounted to the memory owner of the
+ * calling thread, see ua_memory_set_owner(). On failure @data is left
+ * untouched.
+ *
+ * Returns: TRUE on success, FALSE if @err is set because @queue is full or
+ *    closed.
+ */
+gboolean
+ua_queue_push(ua_queue_t *queue,
+              ua_queue_func_t func,
+              gpointer data,
+              GDestroyNotify destroy,
+              GError **err);
+
+/**
+ * ua_queue_drain:
+ * @queue: a queue obtained with ua_queue_new()
+ * @server: (nullable): the OPC-UA server passed to the commands
+ *
+ * Runs the commands pending in @queue, at most its capacity per call so that
+ * producers can't starve the server, the notify function is called again for
+ * the rest. Must be called from the consumer thread only.
+ *
+ * Returns: the number of commands run.
+ */
+guint
+ua_queue_drain(ua_queue_t *queue, UA_Server *server);
+
+/**
+ * ua_queue_length:
+ * @queue: a queue obtained with ua_queue_new()
+ *
+ * Counts the commands claimed by the producers and not run yet, including the
+ * ones still being pushed. Must be called from the consumer thread only.
+ *
+ * Returns: the number of pending commands.
+ */
+guint
+ua_queue_length(ua_queue_t *queue);
+
+#endif /* __UA_QUEUE_H__ */
@@ -0,0 +1,134 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2025 Axis Communications AB
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef __UA_SCHED_H__
+#define __UA_SCHED_H__
+
+#include <glib.h>
+
+/* the periodic work of all the plugins, owned by the server application. The
+ * plugins are ticked from the GLib main loop by a single timer, on a shared
+ * grid, and their VAPIX requests are drawn from one global budget. */
+typedef struct ua_sched ua_sched_t;
+
+/* a plugin ticked by the scheduler */
+typedef struct ua_sched_client ua_sched_client_t;
+
+/**
+ * ua_sched_tick_t:
+ * @client: the plugin as known by the scheduler
+ * @now: the monotonic time of the tick, in microseconds
+ *
+ * The periodic work of a plugin, called from the GLib main loop.
+ *
+ * Returns: the milliseconds until the next tick, 0 to be ticked again only
+ *   after ua_sched_wake().
+ */
+typedef guint (*ua_sched_tick_t)(ua_sched_client_t *client, gint64 now);
+
+/**
+ * ua_sched_new:
+ * @budget: the VAPIX requests per second shared by all the plugins, 0 for no
+ *    limit
+ *
+ * Creates a scheduler without clients, to be used from the GLib main loop.
+ *
+ * Returns: a new scheduler to be freed with ua_sched_free().
+ */
+ua_sched_t *
+ua_sched_new(guint budget);
+
+/**
+ * ua_sched_free:
+ * @sched: a scheduler obtained with ua_sched_new() or NULL
+ *
+ * Stops the ticks and frees @sched, its clients must have been removed.
+ */
+void
+ua_sched_free(ua_sched_t *sched);
+
+/**
+ * ua_sched_add:
+ * @sched: a scheduler obtained with ua_sched_new()
+ * @name: the name of the client, used in the logs and the metrics, and the
+ *    memory owner of its ticks, see ua_memory_get_owner_id()
+ * @tick: the periodic work of the client
+ *
+ * Adds a client to @sched, it is ticked for the first time on the next
+ * wakeup of the scheduler.
+ *
+ * Returns: the new client, to be removed with ua_sched_remove().
+ */
+ua_sched_client_t *
+ua_sched_add(ua_sched_t *sched, const gchar *name, ua_sched_tick_t tick);
+
+/**
+ * ua_sched_remove:
+ * @client: a client obtained with ua_sched_add() or NULL
+ *
+ * Stops ticking @client and frees it.
+ */
+void
+ua_sched_remove(ua_sched_client_t *client);
+
+/**
+ * ua_sched_wake:
+ * @client: a client obtained with ua_sched_add()
+ * @delay: the longest time to wait for the tick, in milliseconds
+ *
+ * Brings the next tick of @client forward to at most @delay milliseconds from
+ * now, e.g. when new work shows up while it is idle. The tick is still
+ * aligned with the wakeups of the other clients and delayed by the backoff.
+ * May be called from any thread.
+ */
+void
+ua_sched_wake(ua_sched_client_t *client, guint delay);
+
+/**
+ * ua_sched_acquire:
+ * @client: a client obtained with ua_sched_add()
+ *
+ * Takes one VAPIX request from the global budget. When the budget is spent
+ * the request must not be issued, @client is then ticked again as soon as
+ * the budget allows one more.
+ *
+ * Returns: TRUE if the request may be issued now.
+ */
+gboolean
+ua_sched_acquire(ua_sched_client_t *client);
+
+/**
+ * ua_sched_report:
+ * @client: a client obtained with ua_sched_add()
+ * @success: whether the last VAPIX request of @client succeeded
+ *
+ * Each failure doubles the shortest time until the next tick of @client, up
+ * to a minute, with a random jitter so that the clients failing together do
+ * not retry together. A success cancels the backoff.
+ */
+void
+ua_sched_report(ua_sched_client_t *client, gboolean success);
+
+#endif /* __UA_SCHED_H__ */
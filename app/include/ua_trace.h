@@ -0,0 +1,77 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2025 Axis Communications AB
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef __UA_TRACE_H__
+#define __UA_TRACE_H__
+
+/* static tracepoints of the hot paths, for finding where the time goes on a
+ * device where no debugger can be attached. They are USDT probes of the
+ * "opcua" provider, built in with CFLAGS=-DUA_ENABLE_TRACEPOINTS (which needs
+ * <sys/sdt.h> in the sysroot) and compiled out otherwise. A built in probe is
+ * a single nop until a tracer attaches to it.
+ *
+ * Every stage has a "<stage>_entry" probe given a tag, a string telling which
+ * instance of the stage runs (the VAPIX endpoint, the callback), and a
+ * "<stage>_exit" probe given the same tag and an integer status. The exit is
+ * fired by the thread which fired the entry, stages may nest. See
+ * tools/ua_trace.bt for recording them and tools/ua_trace_report.py for the
+ * latency of each stage. */
+
+/**
+ * UA_TRACE_ENTRY:
+ * @stage: the name of the stage, e.g. vapix_request
+ * @tag: a string, valid until the stage exits
+ *
+ * Fires the entry probe of @stage.
+ */
+
+/**
+ * UA_TRACE_EXIT:
+ * @stage: the name of the stage
+ * @tag: the tag given to UA_TRACE_ENTRY()
+ * @status: an integer, e.g. a #UA_StatusCode, 0 if there is none
+ *
+ * Fires the exit probe of @stage.
+ */
+#ifdef UA_ENABLE_TRACEPOINTS
+#include <sys/sdt.h>
+
+#define UA_TRACE_ENTRY(stage, tag) STAP_PROBE1(opcua, stage##_entry, tag)
+#define UA_TRACE_EXIT(stage, tag, status)                                      \
+  STAP_PROBE2(opcua, stage##_exit, tag, status)
+#else
+/* the arguments are not evaluated */
+#define UA_TRACE_ENTRY(stage, tag)                                             \
+  do {                                                                         \
+    (void) sizeof(tag);                                                        \
+  } while (0)
+#define UA_TRACE_EXIT(stage, tag, status)                                      \
+  do {                                                                         \
+    (void) sizeof(tag);                                                        \
+    (void) sizeof(status);                                                     \
+  } while (0)
+#endif
+
+#endif /* __UA_TRACE_H__ */
@@ -29,29 +29,164 @@
 #include <glib.h>
 #include <open62541/types.h>
 
+/* maps (parent node, browse name) pairs to node ids so that hot paths access
+ * nodes directly instead of translating browse paths, it can be shared between
+ * threads */
+typedef struct ua_node_cache ua_node_cache_t;
+
+/* a few event nodes of one event type which are triggered over and over
+ * instead of creating and deleting a node for every event */
+typedef struct ua_event_pool ua_event_pool_t;
+
+/* the BaseEventType fields of a pooled event */
+typedef struct ua_event_fields {
+  UA_DateTime time;
+  UA_UInt16 severity;
+  UA_LocalizedText message;
+  UA_String sourceName;
+} ua_event_fields_t;
+
+/* a node added by ua_utils_add_nodes(), only objects and variables are
+ * supported. The strings and the attributes are only read during the call. */
+typedef struct ua_node_desc {
+  /* UA_NODECLASS_OBJECT or UA_NODECLASS_VARIABLE */
+  UA_NodeClass node_class;
+  UA_NodeId requested_id;
+  /* an existing node or a node coming earlier in the same batch */
+  UA_NodeId parent;
+  UA_NodeId reference_type;
+  UA_QualifiedName browse_name;
+  UA_NodeId type_definition;
+  union {
+    UA_ObjectAttributes object;
+    UA_VariableAttributes variable;
+  } attr;
+  /* optional, for a variable: serves its value instead of
+   * attr.variable.value */
+  const UA_DataSource *data_source;
+  void *context;
+} ua_node_desc_t;
+
 typedef struct rollback_data {
   /* used to save the existing 'customDataTypes' of the server configuration
    * (struct UA_ServerConfig) */
   const UA_DataTypeArray *saved_cdt;
 
-  /* a list of 'struct UA_NodeId' that have been added to the server */
-  GList *node_ids;
+  /* the journal of the 'struct UA_NodeId' that have been added to the server,
+   * in the order of their addition, created on first use */
+  GArray *node_ids;
+
+  /* optional, not owned: the nodes added through the *_rb() wrappers are
+   * registered in this cache and the rollback removes them from it again */
+  ua_node_cache_t *node_cache;
+
+  /* optional, set by ua_model_load(): a static model whose nodes are deleted
+   * after the ones of 'node_ids', and its namespace index */
+  const struct ua_model *model;
+  UA_UInt16 model_ns;
 } rollback_data_t;
 
 /* Performs a 'deep' free() to deallocate the 'rollback_data_t' structure with
- * its associated 'node_ids' list */
+ * its associated 'node_ids' journal */
 void
 ua_utils_clear_rbd(rollback_data_t **rbd);
 
-/* Loops over the rbd->node_ids list in reverse order and deletes the nodes
- * from the information model.
- * NOTE: the list is populated by pre-pending, traversing it in forward
- * direction will visit the nodes in the reverse order of their addition.
- * IMPORTANT: This can only be called before the server thread gets started
- * as it can change the server configuration. */
+/* Walks the rbd->node_ids journal backwards and deletes the nodes from the
+ * information model in the reverse order of their addition, then the nodes of
+ * rbd->model if any.
+ * IMPORTANT: This can only be called before the server thread gets started,
+ * or with an exclusive access to the server, as it can change the server
+ * configuration. */
 gboolean
 ua_utils_do_rollback(UA_Server *server, rollback_data_t *rbd, GError **err);
 
+/* Allocates an empty node cache */
+ua_node_cache_t *
+ua_utils_node_cache_new(void);
+
+/* Frees the node cache and all its entries */
+void
+ua_utils_node_cache_free(ua_node_cache_t *cache);
+
+/* Registers 'nodeId' as the child of 'parent' with the given browse name */
+gboolean
+ua_utils_node_cache_add(ua_node_cache_t *cache,
+                        const UA_NodeId *parent,
+                        const UA_QualifiedName *browseName,
+                        const UA_NodeId *nodeId);
+
+/* Copies the nodeId of the child of 'parent' with the given browse name to
+ * 'outNodeId', returns FALSE if the child is not in the cache */
+gboolean
+ua_utils_node_cache_lookup(ua_node_cache_t *cache,
+                           const UA_NodeId *parent,
+                           const UA_QualifiedName *browseName,
+                           UA_NodeId *outNodeId);
+
+/* Like ua_utils_node_cache_lookup() but on a cache miss the child node is
+ * looked up in the information model through a 'referenceTypeId' reference
+ * and added to the cache */
+gboolean
+ua_utils_node_cache_resolve(ua_node_cache_t *cache,
+                            UA_Server *server,
+                            const UA_NodeId *parent,
+                            UA_UInt32 referenceTypeId,
+                            const UA_QualifiedName *browseName,
+                            UA_NodeId *outNodeId,
+                            GError **err);
+
+/* Drops the entries of 'nodeId' and of all its cached descendants, to be
+ * called when the node is deleted from the information model */
+void
+ua_utils_node_cache_invalidate(ua_node_cache_t *cache, const UA_NodeId *nodeId);
+
+/* Allocates a pool of at most 'size' event nodes of 'eventType'. The nodes are
+ * only created by the first triggers, from the server thread. */
+ua_event_pool_t *
+ua_utils_event_pool_new(const UA_NodeId *eventType, guint size);
+
+/* Frees the pool, its event nodes are left to be deleted with the server */
+void
+ua_utils_event_pool_free(ua_event_pool_t *pool);
+
+/* Deletes the event nodes of the pool from the server, e.g. before the plugin
+ * is unloaded at runtime. The next triggers create them again. */
+void
+ua_utils_event_pool_remove(ua_event_pool_t *pool, UA_Server *server);
+
+/* Keeps the last 'capacity' triggered events of the pool in a history served
+ * to HistoryReadEvents, see ua_history.h. 0 drops the history. To be called
+ * before the first trigger. */
+void
+ua_utils_event_pool_keep_history(ua_event_pool_t *pool, guint capacity);
+
+/* Writes 'fields' to an event node of the pool and triggers it from 'origin'.
+ * When all the nodes are in use a one-shot node is created, triggered and
+ * deleted. */
+gboolean
+ua_utils_event_pool_trigger(ua_event_pool_t *pool,
+                            UA_Server *server,
+                            const UA_NodeId *origin,
+                            const ua_event_fields_t *fields,
+                            GError **err);
+
+/* Makes the calls of 'methodId' be served by the method worker threads of the
+ * server instead of its own thread, UA_STATUSCODE_BADNOTSUPPORTED if open62541
+ * was built without multithreading */
+UA_StatusCode
+ua_utils_set_method_async(UA_Server *server, const UA_NodeId methodId);
+
+/* Adds the 'nr_nodes' nodes of 'nodes' in one pass, in order, as a unit. They
+ * are journaled in 'rbd' for ua_utils_do_rollback(), and registered in its
+ * node cache if any. If one of them can't be added the ones added before it
+ * are deleted again, 'rbd' is left as it was and FALSE is returned. */
+gboolean
+ua_utils_add_nodes(UA_Server *server,
+                   const ua_node_desc_t *nodes,
+                   gsize nr_nodes,
+                   rollback_data_t *rbd,
+                   GError **err);
+
 /* wrapper around the open62541 UA_Server_addObjectNode()
  * If underlying UA_Server_addObjectNode() succeeds it also adds the nodeId to
  * the rbd (rollback data) */
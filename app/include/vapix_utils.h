@@ -26,7 +26,6 @@
 #ifndef __VAPIX_UTILS_H__
 #define __VAPIX_UTILS_H__
 
-#include <curl/curl.h>
 #include <glib.h>
 
 /* HTTP request methods we use for VAPIX APIs */
@@ -43,7 +42,9 @@ typedef enum { NONE_data, XML_data, JSON_data } HTTP_media_t;
  *    VAPIX calls
  * @err: return location for a #GError
  *
- * Returns the required credentials for @username to perform VAPIX calls.
+ * Returns the required credentials for @username to perform VAPIX calls. The
+ * plugins don't need to call this, the credentials of a #vapix_session_t are
+ * fetched and refreshed by its service.
  *
  * Returns: a newly-allocated string holding the credentials on success, NULL
  *    if @err is set.
@@ -51,28 +52,196 @@ typedef enum { NONE_data, XML_data, JSON_data } HTTP_media_t;
 gchar *
 vapix_get_credentials(const gchar *username, GError **err);
 
+/* a pool of VAPIX connections shared by all the plugins, owned by the server
+ * application */
+typedef struct vapix_service vapix_service_t;
+
+/* the VAPIX account of a plugin, see vapix_session_new() */
+typedef struct vapix_session vapix_session_t;
+
+/**
+ * vapix_response_cb_t:
+ * @response: the VAPIX response or NULL if @err is set
+ * @err: the reason for the failed request or NULL on success
+ * @user_data: user data passed to vapix_request_async()
+ *
+ * Called from the context given to vapix_service_new() when an asynchronous
+ * request is completed. @response is the receive buffer of the connection,
+ * both @response and @err are only valid until returning.
+ */
+typedef void (*vapix_response_cb_t)(const gchar *response,
+                                    const GError *err,
+                                    gpointer user_data);
+
+/**
+ * vapix_parse_func_t:
+ * @response: the VAPIX response, NUL-terminated
+ * @len: the length of @response
+ * @user_data: user data passed to vapix_request_parse()
+ * @err: return location for a #GError
+ *
+ * Parses a response in the receive buffer of the connection, @response is only
+ * valid until returning. It must not make VAPIX requests itself.
+ *
+ * Returns: TRUE on success, FALSE if @err is set.
+ */
+typedef gboolean (*vapix_parse_func_t)(const gchar *response,
+                                       gsize len,
+                                       gpointer user_data,
+                                       GError **err);
+
+/**
+ * vapix_service_new:
+ * @context: the #GMainContext driving the asynchronous requests, NULL for the
+ *    global default main context
+ * @max_connections: the maximum number of connections used for synchronous
+ *    requests, the same bound applies to the asynchronous ones
+ * @err: return location for a #GError
+ *
+ * Creates the VAPIX service and connects to the system bus, which is used to
+ * fetch the credentials of the sessions. Synchronous requests are served
+ * concurrently by a pool of at most @max_connections connections, a request
+ * waits for a connection to be released if they are all busy. Asynchronous
+ * requests are dispatched by a cURL multi handle attached to @context. All the
+ * connections are kept alive between requests.
+ *
+ * Returns: a new service to be freed with vapix_service_free() on success,
+ *    NULL if @err is set.
+ */
+vapix_service_t *
+vapix_service_new(GMainContext *context, guint max_connections, GError **err);
+
+/**
+ * vapix_service_shutdown:
+ * @service: a service obtained with vapix_service_new()
+ *
+ * Cancels all pending asynchronous requests, their callbacks are called with
+ * an error, and refuses new ones. Synchronous requests are still served.
+ */
+void
+vapix_service_shutdown(vapix_service_t *service);
+
+/**
+ * vapix_service_free:
+ * @service: a service obtained with vapix_service_new() or NULL
+ *
+ * Shuts down @service and closes all its connections. All the sessions of
+ * @service must have been freed, which removes their queued requests from the
+ * context.
+ */
+void
+vapix_service_free(vapix_service_t *service);
+
+/**
+ * vapix_session_new:
+ * @service: the service performing the requests of the session
+ * @username: the VAPIX service account used by the session
+ * @err: return location for a #GError
+ *
+ * Creates a VAPIX session, i.e. the requests performed by one plugin using the
+ * @username account. The credentials of @username are fetched over D-Bus the
+ * first time the account is used and then cached by @service. A request which
+ * is rejected with HTTP 401 is retried once with re-fetched credentials. A
+ * session can be used concurrently by several threads.
+ *
+ * Returns: a new session to be freed with vapix_session_free() on success,
+ *    NULL if @err is set.
+ */
+vapix_session_t *
+vapix_session_new(vapix_service_t *service,
+                  const gchar *username,
+                  GError **err);
+
+/**
+ * vapix_session_free:
+ * @session: a session obtained with vapix_session_new() or NULL
+ *
+ * Drops the pending asynchronous requests of @session, without calling their
+ * callbacks, and frees @session. The requests queued but not started yet are
+ * dropped too, it must be called from the context given to vapix_service_new().
+ */
+void
+vapix_session_free(vapix_session_t *session);
+
 /**
  * vapix_request:
- * @handle: a cURL handle obtained with curl_easy_init()
- * @credentials: credentials string obtained via vapix_get_credentials()
+ * @session: a session obtained with vapix_session_new()
  * @endpoint: the endpoint part of the VAPIX API
  * @req_type: HTTP_GET or HTTP_POST
+ * @media_type: the media type of @post_req (used for HTTP_POST only)
  * @post_req: NULL if @req_type is HTTP_GET or a string holding the POST data
  *    if @req_type is HTTP_POST
  * @err: return location for a #GError
  *
- * Performs a VAPIX API request.
+ * Performs a VAPIX API request with the credentials of @session using one of
+ * the pooled connections of its service.
  *
  * Returns: a newly-allocated string holding the VAPIX response on success, NULL
  *    if @err is set.
  */
 gchar *
-vapix_request(CURL *handle,
-              const gchar *credentials,
+vapix_request(vapix_session_t *session,
               const gchar *endpoint,
               HTTP_req_method_t req_type,
               HTTP_media_t media_type,
               const gchar *post_req,
               GError **err);
 
+/**
+ * vapix_request_parse:
+ * @session: a session obtained with vapix_session_new()
+ * @endpoint: the endpoint part of the VAPIX API
+ * @req_type: HTTP_GET or HTTP_POST
+ * @media_type: the media type of @post_req (used for HTTP_POST only)
+ * @post_req: NULL if @req_type is HTTP_GET or a string holding the POST data
+ *    if @req_type is HTTP_POST
+ * @parse: called with the response
+ * @user_data: user data passed to @parse
+ * @err: return location for a #GError
+ *
+ * Like vapix_request() but @parse is given the response without copying it,
+ * e.g. to json_loadb() it. The connection is held while @parse runs.
+ *
+ * Returns: TRUE if the request and @parse succeeded, FALSE if @err is set.
+ */
+gboolean
+vapix_request_parse(vapix_session_t *session,
+                    const gchar *endpoint,
+                    HTTP_req_method_t req_type,
+                    HTTP_media_t media_type,
+                    const gchar *post_req,
+                    vapix_parse_func_t parse,
+                    gpointer user_data,
+                    GError **err);
+
+/**
+ * vapix_request_async:
+ * @session: a session obtained with vapix_session_new()
+ * @endpoint: the endpoint part of the VAPIX API
+ * @req_type: HTTP_GET or HTTP_POST
+ * @media_type: the media type of @post_req (used for HTTP_POST only)
+ * @post_req: NULL if @req_type is HTTP_GET or a string holding the POST data
+ *    if @req_type is HTTP_POST
+ * @callback: called when the request is completed
+ * @user_data: user data passed to @callback
+ * @err: return location for a #GError
+ *
+ * Queues a VAPIX API request without blocking the caller. It can be called
+ * from any thread, the request itself is performed by the context given to
+ * vapix_service_new() where @callback is called as well. @callback is never
+ * called before returning, even from the thread running that context. Pending
+ * requests are dropped, without calling @callback, if @session is freed.
+ *
+ * Returns: TRUE if the request was queued, FALSE if @err is set.
+ */
+gboolean
+vapix_request_async(vapix_session_t *session,
+                    const gchar *endpoint,
+                    HTTP_req_method_t req_type,
+                    HTTP_media_t media_type,
+                    const gchar *post_req,
+                    vapix_response_cb_t callback,
+                    gpointer user_data,
+                    GError **err);
+
 #endif /* __VAPIX_UTILS_H__ */
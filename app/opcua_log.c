@@ -0,0 +1,275 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2025 Axis Communications AB
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <errno.h>
+#include <glib.h>
+#include <sys/resource.h>
+
+#include "log.h"
+#include "opcua_log.h"
+#include "ua_queue.h"
+
+/* nice value of the log thread, on Linux it only applies to that thread */
+#define LOG_THREAD_NICE 10
+
+/* a formatted message waiting to be written out */
+typedef struct log_msg {
+  UA_LogLevel level;
+  UA_LogCategory category;
+  gchar *text;
+} log_msg_t;
+
+typedef struct {
+  /* the logger messages are handed over to, the syslog one. It is set up once
+   * by ua_log_start_async() to let every level through, async_log_cb()
+   * filters the messages by 'ua_log_level' instead. */
+  UA_Logger sink;
+  /* the pending messages, the log thread is the consumer */
+  ua_queue_t *queue;
+  /* messages dropped since the last report because the queue was full */
+  gint dropped;
+  GMutex lock;
+  GCond cond;
+  /* the queue got non-empty since the log thread last woke up, protected by
+   * 'lock' */
+  gboolean pending;
+  /* protected by 'lock' */
+  gboolean running;
+  GThread *thread;
+} async_log_t;
+
+gint ua_log_level = UA_LOGLEVEL_WARNING;
+
+static async_log_t async_log;
+
+static void
+sink_log(UA_LogLevel level, UA_LogCategory category, const gchar *format, ...)
+        G_GNUC_PRINTF(3, 4);
+
+static void
+sink_log(UA_LogLevel level, UA_LogCategory category, const gchar *format, ...)
+{
+  va_list args;
+
+  va_start(args, format);
+  async_log.sink.log(async_log.sink.context, level, category, format, args);
+  va_end(args);
+}
+
+static void
+free_msg(gpointer data)
+{
+  log_msg_t *msg = data;
+
+  g_free(msg->text);
+  g_free(msg);
+}
+
+/* an #ua_queue_func_t writing a message out from the log thread */
+static void
+write_msg(G_GNUC_UNUSED UA_Server *server, gpointer data)
+{
+  log_msg_t *msg = data;
+
+  g_assert(msg != NULL);
+
+  sink_log(msg->level, msg->category, "%s", msg->text);
+}
+
+/* the log function of the logger while asynchronous, queues the formatted
+ * message */
+static void
+async_log_cb(void *context,
+             UA_LogLevel level,
+             UA_LogCategory category,
+             const char *msg,
+             va_list args)
+{
+  async_log_t *al = context;
+  log_msg_t *log_msg;
+
+  g_assert(al != NULL);
+
+  if ((gint) level < g_atomic_int_get(&ua_log_level)) {
+    return;
+  }
+
+  log_msg = g_new(log_msg_t, 1);
+  log_msg->level = level;
+  log_msg->category = category;
+  log_msg->text = g_strdup_vprintf(msg, args);
+
+  if (!ua_queue_push(al->queue, write_msg, log_msg, free_msg, NULL)) {
+    /* the log thread is behind, rather lose the message than wait */
+    free_msg(log_msg);
+    g_atomic_int_inc(&al->dropped);
+  }
+}
+
+/* an #ua_queue_notify_t waking the log thread up */
+static gboolean
+wake_log_thread(gpointer user_data)
+{
+  async_log_t *al = user_data;
+
+  g_assert(al != NULL);
+
+  g_mutex_lock(&al->lock);
+  al->pending = TRUE;
+  g_cond_signal(&al->cond);
+  g_mutex_unlock(&al->lock);
+
+  return TRUE;
+}
+
+/* writes out the pending messages */
+static void
+drain_messages(async_log_t *al)
+{
+  gint dropped;
+
+  g_assert(al != NULL);
+
+  while (ua_queue_drain(al->queue, NULL) > 0) {
+  }
+
+  dropped = (gint) g_atomic_int_and(&al->dropped, 0);
+  if (dropped > 0) {
+    sink_log(UA_LOGLEVEL_WARNING,
+             UA_LOGCATEGORY_USERLAND,
+             "%d log messages dropped, the log queue was full",
+             dropped);
+  }
+}
+
+static gpointer
+log_thread(gpointer data)
+{
+  async_log_t *al = data;
+
+  g_assert(al != NULL);
+
+  /* the messages are written out whenever nothing else needs the CPU */
+  errno = 0;
+  if (setpriority(PRIO_PROCESS, 0, LOG_THREAD_NICE) != 0) {
+    sink_log(UA_LOGLEVEL_WARNING,
+             UA_LOGCATEGORY_USERLAND,
+             "setpriority() failed: %s",
+             g_strerror(errno));
+  }
+
+  g_mutex_lock(&al->lock);
+  while (al->running) {
+    /* sleeps until a message is logged or the logger is stopped */
+    while (!al->pending && al->running) {
+      g_cond_wait(&al->cond, &al->lock);
+    }
+    al->pending = FALSE;
+    g_mutex_unlock(&al->lock);
+
+    drain_messages(al);
+
+    g_mutex_lock(&al->lock);
+  }
+  g_mutex_unlock(&al->lock);
+
+  /* the messages logged before stopping */
+  drain_messages(al);
+
+  return NULL;
+}
+
+void
+ua_log_set_level(UA_Logger *logger, UA_LogLevel level)
+{
+  g_return_if_fail(logger != NULL);
+
+  g_atomic_int_set(&ua_log_level, (gint) level);
+
+  /* the syslog logger keeps its level as context, the sink of the
+   * asynchronous logger keeps letting every level through */
+  if (logger->log != async_log_cb) {
+    g_atomic_pointer_set(&logger->context, GINT_TO_POINTER(level));
+  }
+}
+
+gboolean
+ua_log_start_async(UA_Logger *logger, guint capacity, GError **err)
+{
+  g_return_val_if_fail(logger != NULL, FALSE);
+  g_return_val_if_fail(logger->log != async_log_cb, FALSE);
+  g_return_val_if_fail(capacity > 0 && capacity <= G_MAXINT / 2, FALSE);
+  g_return_val_if_fail(err == NULL || *err == NULL, FALSE);
+
+  async_log.sink = *logger;
+  async_log.sink.context = GINT_TO_POINTER(UA_LOGLEVEL_TRACE);
+  async_log.queue = ua_queue_new(capacity);
+  g_mutex_init(&async_log.lock);
+  g_cond_init(&async_log.cond);
+  async_log.running = TRUE;
+  ua_queue_set_notify(async_log.queue, wake_log_thread, &async_log);
+
+  async_log.thread = g_thread_try_new("ua-log", log_thread, &async_log, err);
+  if (async_log.thread == NULL) {
+    g_prefix_error(err, "g_thread_try_new() failed: ");
+    goto err_out;
+  }
+
+  logger->log = async_log_cb;
+  logger->context = &async_log;
+
+  return TRUE;
+
+err_out:
+  g_clear_pointer(&async_log.queue, ua_queue_free);
+  g_cond_clear(&async_log.cond);
+  g_mutex_clear(&async_log.lock);
+
+  return FALSE;
+}
+
+void
+ua_log_stop_async(UA_Logger *logger)
+{
+  g_return_if_fail(logger != NULL);
+
+  if (logger->log != async_log_cb) {
+    return;
+  }
+
+  g_mutex_lock(&async_log.lock);
+  async_log.running = FALSE;
+  g_cond_signal(&async_log.cond);
+  g_mutex_unlock(&async_log.lock);
+
+  g_thread_join(async_log.thread);
+  async_log.thread = NULL;
+
+  *logger = async_log.sink;
+  logger->context = GINT_TO_POINTER(g_atomic_int_get(&ua_log_level));
+  g_clear_pointer(&async_log.queue, ua_queue_free);
+  g_cond_clear(&async_log.cond);
+  g_mutex_clear(&async_log.lock);
+}
@@ -0,0 +1,71 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2025 Axis Communications AB
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef __OPCUA_LOG_H__
+#define __OPCUA_LOG_H__
+
+#include <glib.h>
+#include <open62541/plugin/log.h>
+
+/**
+ * ua_log_set_level:
+ * @logger: the application logger
+ * @level: the lowest level to log
+ *
+ * Sets the level of @logger and of the LOG_* macros. Can be called while
+ * other threads log.
+ */
+void
+ua_log_set_level(UA_Logger *logger, UA_LogLevel level);
+
+/**
+ * ua_log_start_async:
+ * @logger: the application logger
+ * @capacity: the maximum number of pending messages, rounded up to a power of
+ *    two
+ * @err: return location for a #GError
+ *
+ * Makes @logger queue its formatted messages to a low priority thread, which
+ * hands them over to the previous sink of @logger. Logging never blocks, a
+ * message is dropped when the queue is full. The thread sleeps while nothing
+ * is logged. Must be called before any other thread uses @logger.
+ *
+ * Returns: TRUE if successful, FALSE otherwise.
+ */
+gboolean
+ua_log_start_async(UA_Logger *logger, guint capacity, GError **err);
+
+/**
+ * ua_log_stop_async:
+ * @logger: the application logger
+ *
+ * Writes out the pending messages and restores the previous sink of @logger.
+ * Must be called once no other thread uses @logger anymore. Does nothing if
+ * ua_log_start_async() was not called.
+ */
+void
+ua_log_stop_async(UA_Logger *logger);
+
+#endif /* __OPCUA_LOG_H__ */
@@ -25,14 +25,404 @@
 
 #include <open62541/server_config_default.h>
 #include <open62541/plugin/accesscontrol_default.h>
+#include <open62541/plugin/nodestore_default.h>
+#include <string.h>
 
 #include "error.h"
 #include "log.h"
 #include "opcua_open62541.h"
+#include "opcua_publish.h"
+#include "opcua_security.h"
 #include "opcua_server.h"
+#include "ua_history.h"
+#include "ua_memory.h"
+#include "ua_metrics.h"
+#include "ua_pubsub.h"
 
 DEFINE_GQUARK("opc-ua-open62541")
 
+#if UA_MULTITHREADING < 100
+/* how often the server thread runs the commands queued by the plugins, the
+ * producers can't schedule a drain from their own thread */
+#define UA_QUEUE_DRAIN_INTERVAL 10.0 /* milliseconds */
+#endif
+
+/* limits of each #server_profile_t, 0 keeps the open62541 default */
+static const server_limits_t server_profiles[SERVER_PROFILE_LAST] = {
+  [SERVER_PROFILE_DEFAULT] = {0},
+  /* a handful of clients on a device short of memory */
+  [SERVER_PROFILE_LOW_MEMORY] = {.max_sessions = 5,
+                                 .max_subscriptions_per_session = 4,
+                                 .max_monitored_items_per_subscription = 100,
+                                 .min_publishing_interval = 500,
+                                 .min_sampling_interval = 500,
+                                 .chunk_size = 8192,
+                                 .max_message_size = 262144},
+  /* e.g. a historian and several HMIs */
+  [SERVER_PROFILE_MANY_CLIENTS] = {.max_sessions = 50,
+                                   .max_subscriptions_per_session = 10,
+                                   .max_monitored_items_per_subscription = 500,
+                                   .min_publishing_interval = 250,
+                                   .min_sampling_interval = 250,
+                                   .chunk_size = 32768,
+                                   .max_message_size = 2097152},
+  /* few clients wanting fast notifications */
+  [SERVER_PROFILE_LOW_LATENCY] = {.max_sessions = 10,
+                                  .max_subscriptions_per_session = 20,
+                                  .max_monitored_items_per_subscription = 1000,
+                                  .min_publishing_interval = 20,
+                                  .min_sampling_interval = 10,
+                                  .chunk_size = 65535,
+                                  .max_message_size = 8388608},
+};
+
+/* hands the server over to another thread, see ua_server_call_exclusive() */
+static struct {
+  GMutex lock;
+  GCond cond;
+  /* the server thread waits in park_server_cb() */
+  gboolean parked;
+  /* the server thread ran its last commands, the server is about to be
+   * deleted */
+  gboolean stopped;
+} exclusive;
+
+#if UA_MULTITHREADING >= 100
+/* threads serving the asynchronous method calls, there is a single server */
+static struct {
+  GThread **threads;
+  guint nr_threads;
+  GMutex lock;
+  GCond cond;
+  /* asynchronous operations queued since the workers were last woken up */
+  guint pending;
+  /* no operation is taken while held, see ua_server_call_exclusive() */
+  gboolean held;
+  /* workers serving an operation */
+  guint busy;
+  /* set by join_method_workers() */
+  gboolean stopping;
+} workers;
+
+/* asyncOperationNotifyCallback of the server config, called when a method
+ * call is queued */
+static void
+notify_method_workers(G_GNUC_UNUSED UA_Server *server)
+{
+  g_mutex_lock(&workers.lock);
+  workers.pending++;
+  g_cond_signal(&workers.cond);
+  g_mutex_unlock(&workers.lock);
+}
+
+/* a #GThreadFunc serving the asynchronous method calls until the server is
+ * stopped */
+static gpointer
+run_method_worker(gpointer data)
+{
+  app_context_t *ctx = data;
+  UA_AsyncOperationType type;
+  const UA_AsyncOperationRequest *request;
+  void *context;
+  UA_CallMethodResult result;
+
+  g_assert(ctx != NULL);
+  g_assert(ctx->server != NULL);
+
+  ua_memory_attach_thread();
+
+  for (;;) {
+    gboolean found;
+
+    g_mutex_lock(&workers.lock);
+    while (workers.held && !workers.stopping) {
+      g_cond_wait(&workers.cond, &workers.lock);
+    }
+    if (workers.stopping) {
+      g_mutex_unlock(&workers.lock);
+      break;
+    }
+    workers.busy++;
+    g_mutex_unlock(&workers.lock);
+
+    found = UA_Server_getAsyncOperationNonBlocking(ctx->server,
+                                                   &type,
+                                                   &request,
+                                                   &context,
+                                                   NULL);
+    if (found && type == UA_ASYNCOPERATIONTYPE_CALL) {
+      /* runs the method callback in this thread */
+      result = UA_Server_call(ctx->server, &request->callMethodRequest);
+      UA_Server_setAsyncOperationResult(ctx->server,
+                                        (UA_AsyncOperationResponse *) &result,
+                                        context);
+      UA_CallMethodResult_clear(&result);
+    }
+
+    g_mutex_lock(&workers.lock);
+    workers.busy--;
+    g_cond_broadcast(&workers.cond);
+    g_mutex_unlock(&workers.lock);
+
+    if (!found) {
+      /* sleeps until a call is queued or the server is stopped */
+      g_mutex_lock(&workers.lock);
+      while (workers.pending == 0 && !workers.stopping) {
+        g_cond_wait(&workers.cond, &workers.lock);
+      }
+      if (workers.pending > 0) {
+        workers.pending--;
+      }
+      g_mutex_unlock(&workers.lock);
+    }
+  }
+
+  return NULL;
+}
+
+static void
+start_method_workers(app_context_t *ctx)
+{
+  guint nr_threads = ctx->plugin_params.method_workers;
+
+  g_assert(ctx != NULL);
+
+  workers.threads = g_new0(GThread *, nr_threads);
+  for (guint i = 0; i < nr_threads; i++) {
+    gchar *name = g_strdup_printf("opc_ua_method_worker_%u", i);
+
+    workers.threads[i] = g_thread_new(name, run_method_worker, ctx);
+    g_free(name);
+  }
+  workers.nr_threads = nr_threads;
+}
+
+/* waits for the operations in progress, no new one is taken until
+ * release_method_workers() */
+static void
+hold_method_workers(void)
+{
+  g_mutex_lock(&workers.lock);
+  workers.held = TRUE;
+  while (workers.busy > 0) {
+    g_cond_wait(&workers.cond, &workers.lock);
+  }
+  g_mutex_unlock(&workers.lock);
+}
+
+static void
+release_method_workers(void)
+{
+  g_mutex_lock(&workers.lock);
+  workers.held = FALSE;
+  g_cond_broadcast(&workers.cond);
+  g_mutex_unlock(&workers.lock);
+}
+
+/* the server must have been stopped */
+static void
+join_method_workers(void)
+{
+  g_mutex_lock(&workers.lock);
+  workers.stopping = TRUE;
+  g_cond_broadcast(&workers.cond);
+  g_mutex_unlock(&workers.lock);
+
+  for (guint i = 0; i < workers.nr_threads; i++) {
+    g_thread_join(workers.threads[i]);
+  }
+  g_clear_pointer(&workers.threads, g_free);
+  workers.nr_threads = 0;
+  workers.stopping = FALSE;
+  workers.pending = 0;
+}
+#endif /* UA_MULTITHREADING >= 100 */
+
+/* a #ua_queue_func_t holding the server thread until the exclusive access is
+ * over */
+static void
+park_server_cb(G_GNUC_UNUSED UA_Server *server, G_GNUC_UNUSED gpointer data)
+{
+  g_mutex_lock(&exclusive.lock);
+  exclusive.parked = TRUE;
+  g_cond_broadcast(&exclusive.cond);
+  while (exclusive.parked) {
+    g_cond_wait(&exclusive.cond, &exclusive.lock);
+  }
+  g_mutex_unlock(&exclusive.lock);
+}
+
+/* a #ua_queue_func_t telling ua_server_sync() that the server thread got
+ * there */
+static void
+sync_server_cb(G_GNUC_UNUSED UA_Server *server, gpointer data)
+{
+  gboolean *reached = data;
+
+  g_mutex_lock(&exclusive.lock);
+  *reached = TRUE;
+  g_cond_broadcast(&exclusive.cond);
+  g_mutex_unlock(&exclusive.lock);
+}
+
+/* sets the limits of the selected server profile, overridden by the user
+ * configured ones, in the server config */
+static void
+apply_server_limits(app_context_t *ctx, UA_ServerConfig *config)
+{
+  const server_limits_t *user = &ctx->server_limits;
+  server_limits_t limits;
+
+  g_assert(ctx != NULL);
+  g_assert(ctx->server_profile < SERVER_PROFILE_LAST);
+  g_assert(config != NULL);
+
+  limits = server_profiles[ctx->server_profile];
+  if (user->max_sessions > 0) {
+    limits.max_sessions = user->max_sessions;
+  }
+  if (user->max_subscriptions_per_session > 0) {
+    limits.max_subscriptions_per_session = user->max_subscriptions_per_session;
+  }
+  if (user->max_monitored_items_per_subscription > 0) {
+    limits.max_monitored_items_per_subscription =
+            user->max_monitored_items_per_subscription;
+  }
+  if (user->min_publishing_interval > 0) {
+    limits.min_publishing_interval = user->min_publishing_interval;
+  }
+  if (user->min_sampling_interval > 0) {
+    limits.min_sampling_interval = user->min_sampling_interval;
+  }
+  if (user->chunk_size > 0) {
+    limits.chunk_size = user->chunk_size;
+  }
+  if (user->max_message_size > 0) {
+    limits.max_message_size = user->max_message_size;
+  }
+
+  if (limits.max_sessions > 0) {
+    config->maxSessions = limits.max_sessions;
+    /* a spare channel lets a client reconnect before its old one times out */
+    config->maxSecureChannels = MIN(limits.max_sessions + 1, G_MAXUINT16);
+  }
+  if (limits.max_subscriptions_per_session > 0) {
+    config->maxSubscriptionsPerSession = limits.max_subscriptions_per_session;
+  }
+  if (limits.max_monitored_items_per_subscription > 0) {
+    config->maxMonitoredItemsPerSubscription =
+            limits.max_monitored_items_per_subscription;
+  }
+  if (limits.min_publishing_interval > 0) {
+    config->publishingIntervalLimits.min = limits.min_publishing_interval;
+    config->publishingIntervalLimits.max =
+            MAX(config->publishingIntervalLimits.max,
+                config->publishingIntervalLimits.min);
+  }
+  if (limits.min_sampling_interval > 0) {
+    config->samplingIntervalLimits.min = limits.min_sampling_interval;
+    config->samplingIntervalLimits.max =
+            MAX(config->samplingIntervalLimits.max,
+                config->samplingIntervalLimits.min);
+  }
+  if (limits.chunk_size > 0) {
+    config->tcpBufSize = limits.chunk_size;
+  }
+  if (limits.max_message_size > 0) {
+    config->tcpMaxMsgSize = MAX(limits.max_message_size, config->tcpBufSize);
+  }
+
+  LOG_I(&ctx->logger,
+        "Server limits: %u sessions, %u subscriptions per session, %u "
+        "monitored items per subscription, publishing >= %.0f ms, sampling "
+        ">= %.0f ms, %u bytes chunks, %u bytes messages",
+        config->maxSessions,
+        config->maxSubscriptionsPerSession,
+        config->maxMonitoredItemsPerSubscription,
+        config->publishingIntervalLimits.min,
+        config->samplingIntervalLimits.min,
+        config->tcpBufSize,
+        config->tcpMaxMsgSize);
+}
+
+/* replaces the node store of 'config' with the one selected with the
+ * 'Nodestore' parameter */
+static gboolean
+set_nodestore(app_context_t *ctx, UA_ServerConfig *config, GError **err)
+{
+  UA_StatusCode status;
+
+  g_assert(ctx != NULL);
+  g_assert(config != NULL);
+  g_assert(err == NULL || *err == NULL);
+
+  if (config->nodestore.context != NULL) {
+    config->nodestore.clear(config->nodestore.context);
+    memset(&config->nodestore, 0, sizeof(config->nodestore));
+  }
+
+  switch (ctx->nodestore) {
+  case NODESTORE_ZIPTREE:
+    status = UA_Nodestore_ZipTree(&config->nodestore);
+    break;
+  case NODESTORE_HASHMAP:
+  default:
+    status = UA_Nodestore_HashMap(&config->nodestore);
+    break;
+  }
+  if (status != UA_STATUSCODE_GOOD) {
+    SET_ERROR(err,
+              -1,
+              "Failed to create the node store: %s",
+              UA_StatusCode_name(status));
+    return FALSE;
+  }
+
+  LOG_I(&ctx->logger,
+        "Node store: %s",
+        ctx->nodestore == NODESTORE_ZIPTREE ? "zip tree" : "hash map");
+
+  return TRUE;
+}
+
+/* a #UA_ServerCallback running the pending plugin commands */
+static void
+drain_queue_cb(UA_Server *server, void *data)
+{
+  ua_queue_t *queue = data;
+  static ua_metric_t *depth;
+  ua_metric_t *metric;
+
+  g_assert(queue != NULL);
+
+  /* the backlog left by the producers since the previous run */
+  metric = ua_metrics_get_cached(&depth, UA_METRIC_GAUGE, "ua_queue.depth");
+  ua_metric_set(metric, (gint) ua_queue_length(queue));
+
+  (void) ua_queue_drain(queue, server);
+}
+
+#if UA_MULTITHREADING >= 100
+/* an #ua_queue_notify_t having the server thread drain the queue once */
+static gboolean
+schedule_drain(gpointer user_data)
+{
+  app_context_t *ctx = user_data;
+  UA_StatusCode status;
+
+  g_assert(ctx != NULL);
+  g_assert(ctx->server != NULL);
+
+  status = UA_Server_addTimedCallback(ctx->server,
+                                      drain_queue_cb,
+                                      ctx->plugin_params.queue,
+                                      UA_DateTime_nowMonotonic(),
+                                      NULL);
+
+  return status == UA_STATUSCODE_GOOD;
+}
+#endif
+
 /**
  * run_ua_server:
  * @gdata: pointer to the application context #app_context_t
@@ -48,10 +438,36 @@ run_ua_server(gpointer data)
   g_assert(NULL != ctx);
   g_assert(NULL != ctx->server);
 
+  ua_memory_attach_thread();
+
+#if UA_MULTITHREADING >= 100
+  if (ctx->plugin_params.method_workers > 0) {
+    start_method_workers(ctx);
+  }
+#endif
+
   LOG_D(&ctx->logger, "Starting UA server ...");
   status = UA_Server_run(ctx->server, &ctx->ua_server_running);
 
   LOG_D(&ctx->logger, "UA Server exit status: %s", UA_StatusCode_name(status));
+
+#if UA_MULTITHREADING >= 100
+  /* the server is still needed by the workers to answer their calls */
+  join_method_workers();
+
+  /* the server stops running timed callbacks, the producers can't reach it */
+  ua_queue_set_notify(ctx->plugin_params.queue, NULL, NULL);
+#endif
+
+  /* run what was queued while the server was shutting down */
+  (void) ua_queue_drain(ctx->plugin_params.queue, ctx->server);
+
+  /* waits for an exclusive access in progress to be over */
+  g_mutex_lock(&exclusive.lock);
+  exclusive.stopped = TRUE;
+  g_cond_broadcast(&exclusive.cond);
+  g_mutex_unlock(&exclusive.lock);
+
   UA_Server_delete(ctx->server);
   ctx->server = NULL;
 
@@ -65,15 +481,45 @@ ua_server_init(app_context_t *ctx,
                GError **err)
 {
   UA_StatusCode status;
+  UA_ServerConfig init_config;
   UA_ServerConfig *config;
+  GError *lerr = NULL;
 
   g_return_val_if_fail(NULL != ctx, FALSE);
   g_return_val_if_fail(NULL == ctx->server, FALSE);
+  g_return_val_if_fail(NULL != ctx->plugin_params.queue, FALSE);
   g_return_val_if_fail(err == NULL || *err == NULL, FALSE);
 
-  ctx->server = UA_Server_new();
+  /* the node store is part of the configuration the server is created with,
+   * it can't be replaced once the namespace 0 is in it */
+  memset(&init_config, 0, sizeof(init_config));
+  if (ctx->security != SECURITY_NONE) {
+    if (!ua_security_setup(ctx, &init_config, port, err)) {
+      g_prefix_error(err, "ua_security_setup() failed: ");
+      UA_ServerConfig_clear(&init_config);
+      return FALSE;
+    }
+  } else {
+    status = UA_ServerConfig_setMinimal(&init_config, port, NULL);
+    if (status != UA_STATUSCODE_GOOD) {
+      SET_ERROR(err,
+                -1,
+                "UA_ServerConfig_setMinimal() failed: %s",
+                UA_StatusCode_name(status));
+      UA_ServerConfig_clear(&init_config);
+      return FALSE;
+    }
+  }
+
+  if (!set_nodestore(ctx, &init_config, err)) {
+    g_prefix_error(err, "set_nodestore() failed: ");
+    UA_ServerConfig_clear(&init_config);
+    return FALSE;
+  }
+
+  ctx->server = UA_Server_newWithConfig(&init_config);
   if (ctx->server == NULL) {
-    SET_ERROR(err, -1, "UA_Server_new() failed!");
+    SET_ERROR(err, -1, "UA_Server_newWithConfig() failed!");
     return FALSE;
   }
 
@@ -83,15 +529,6 @@ ua_server_init(app_context_t *ctx,
     return FALSE;
   }
 
-  status = UA_ServerConfig_setMinimal(config, port, NULL);
-  if (status != UA_STATUSCODE_GOOD) {
-    SET_ERROR(err,
-              -1,
-              "UA_ServerConfig_setMinimal() failed: %s",
-              UA_StatusCode_name(status));
-    return FALSE;
-  }
-
   /* Adjust the logging level for the server thread to be in sync with the
    * logging level set for the ACAP via the 'LogLevel' configuration parameter.
    */
@@ -107,7 +544,179 @@ ua_server_init(app_context_t *ctx,
   /* custom Application URI */
   UA_String_clear(&config->applicationDescription.applicationUri);
   config->applicationDescription.applicationUri =
-          UA_String_fromChars("urn:axis.opcua.server");
+          UA_String_fromChars(UA_APPLICATION_URI);
+
+  apply_server_limits(ctx, config);
+
+  /* a client asking for a longer lifetime renews its token less often, each
+   * renewal being an asymmetric handshake run by the server thread */
+  config->maxSecurityTokenLifetime = ctx->secure_channel_lifetime * 1000;
+
+  /* the queues are capped even when the subscriptions can't be checked */
+  if (!ua_publish_setup(ctx, &lerr)) {
+    LOG_W(&ctx->logger,
+          "The slow clients are not detected, ua_publish_setup() failed: %s",
+          GERROR_MSG(lerr));
+    g_clear_error(&lerr);
+  }
+
+  /* the clients keep their sessions when the publishing can't be set up */
+  if (ctx->pubsub &&
+      !ua_pubsub_start(ctx->server,
+                       ctx->pubsub_address,
+                       ctx->pubsub_publisher_id,
+                       ctx->pubsub_interval,
+                       &lerr)) {
+    LOG_W(&ctx->logger,
+          "Nothing is published, ua_pubsub_start() failed: %s",
+          GERROR_MSG(lerr));
+    g_clear_error(&lerr);
+  }
+
+  /* the plugins only keep the events which can be read back */
+  if (ctx->plugin_params.event_history > 0 &&
+      !ua_history_setup(ctx->server, &lerr)) {
+    LOG_W(&ctx->logger,
+          "No event history is kept, ua_history_setup() failed: %s",
+          GERROR_MSG(lerr));
+    g_clear_error(&lerr);
+    ctx->plugin_params.event_history = 0;
+  }
+
+  if (ctx->plugin_params.method_workers > 0) {
+#if UA_MULTITHREADING >= 100
+    config->asyncOperationNotifyCallback = notify_method_workers;
+#else
+    LOG_W(&ctx->logger,
+          "open62541 is built without multithreading, ignoring %u method "
+          "workers",
+          ctx->plugin_params.method_workers);
+    /* the plugins keep their methods synchronous */
+    ctx->plugin_params.method_workers = 0;
+#endif
+  }
+
+#if UA_MULTITHREADING >= 100
+  /* the server thread only wakes up for the queue when something is pushed */
+  ua_queue_set_notify(ctx->plugin_params.queue, schedule_drain, ctx);
+#else
+  status = UA_Server_addRepeatedCallback(ctx->server,
+                                         drain_queue_cb,
+                                         ctx->plugin_params.queue,
+                                         UA_QUEUE_DRAIN_INTERVAL,
+                                         NULL);
+  if (status != UA_STATUSCODE_GOOD) {
+    SET_ERROR(err,
+              -1,
+              "UA_Server_addRepeatedCallback() failed: %s",
+              UA_StatusCode_name(status));
+    return FALSE;
+  }
+#endif
+
+  return TRUE;
+}
+
+gboolean
+ua_server_call_exclusive(app_context_t *ctx,
+                         ua_queue_func_t func,
+                         gpointer data,
+                         GError **err)
+{
+  g_return_val_if_fail(NULL != ctx, FALSE);
+  g_return_val_if_fail(NULL != func, FALSE);
+  g_return_val_if_fail(err == NULL || *err == NULL, FALSE);
+
+  if (ctx->ua_server_thread_id == NULL) {
+    /* the server thread isn't started, nobody else uses the server */
+    if (ctx->server == NULL) {
+      SET_ERROR(err, -1, "There is no server");
+      return FALSE;
+    }
+    func(ctx->server, data);
+    return TRUE;
+  }
+
+  /* the server API serializing the calls of a multithreaded open62541 isn't
+   * enough, a plugin is created or removed in several calls which must not be
+   * interleaved with the server serving its nodes */
+  if (!ua_queue_push(ctx->plugin_params.queue,
+                     park_server_cb,
+                     NULL,
+                     NULL,
+                     err)) {
+    g_prefix_error(err, "ua_queue_push() failed: ");
+    return FALSE;
+  }
+
+  g_mutex_lock(&exclusive.lock);
+  while (!exclusive.parked && !exclusive.stopped) {
+    g_cond_wait(&exclusive.cond, &exclusive.lock);
+  }
+  if (!exclusive.parked) {
+    g_mutex_unlock(&exclusive.lock);
+    SET_ERROR(err, -1, "The server thread is stopped");
+    return FALSE;
+  }
+
+#if UA_MULTITHREADING >= 100
+  /* the method workers call into the plugins outside of the server thread */
+  hold_method_workers();
+#endif
+
+  /* the server is not deleted before the lock is released */
+  func(ctx->server, data);
+
+#if UA_MULTITHREADING >= 100
+  release_method_workers();
+#endif
+
+  exclusive.parked = FALSE;
+  g_cond_broadcast(&exclusive.cond);
+  g_mutex_unlock(&exclusive.lock);
+
+  return TRUE;
+}
+
+gboolean
+ua_server_sync(app_context_t *ctx, GError **err)
+{
+  gboolean reached = FALSE;
+  gboolean stopped;
+
+  g_return_val_if_fail(NULL != ctx, FALSE);
+  g_return_val_if_fail(err == NULL || *err == NULL, FALSE);
+
+  if (ctx->ua_server_thread_id == NULL) {
+    /* the server thread isn't started, the queue is ours */
+    if (ctx->server != NULL) {
+      while (ua_queue_drain(ctx->plugin_params.queue, ctx->server) > 0) {
+      }
+    }
+    return TRUE;
+  }
+
+  /* the barrier lives on the stack, it must not be freed if dropped */
+  if (!ua_queue_push(ctx->plugin_params.queue,
+                     sync_server_cb,
+                     &reached,
+                     NULL,
+                     err)) {
+    g_prefix_error(err, "ua_queue_push() failed: ");
+    return FALSE;
+  }
+
+  g_mutex_lock(&exclusive.lock);
+  while (!reached && !exclusive.stopped) {
+    g_cond_wait(&exclusive.cond, &exclusive.lock);
+  }
+  stopped = !reached;
+  g_mutex_unlock(&exclusive.lock);
+
+  if (stopped) {
+    SET_ERROR(err, -1, "The server thread is stopped");
+    return FALSE;
+  }
 
   return TRUE;
 }
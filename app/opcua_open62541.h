@@ -49,6 +49,41 @@ ua_server_init(app_context_t *ctx,
                UA_LogLevel log_level,
                GError **err);
 
+/**
+ * ua_server_call_exclusive:
+ * @ctx: application context
+ * @func: called from the calling thread with the server
+ * @data: user data passed to @func
+ * @err: return location for a #GError
+ *
+ * Calls @func with exclusive access to the server, which may be running. The
+ * server thread is held in between two iterations of its loop until @func
+ * returns, as are the method workers of a multithreaded open62541 once done
+ * with their calls in progress. Only one thread at a time, the main one, may
+ * use this.
+ *
+ * Returns: TRUE if @func was called, FALSE if @err is set.
+ */
+gboolean
+ua_server_call_exclusive(app_context_t *ctx,
+                         ua_queue_func_t func,
+                         gpointer data,
+                         GError **err);
+
+/**
+ * ua_server_sync:
+ * @ctx: application context
+ * @err: return location for a #GError
+ *
+ * Waits until the server thread ran the commands queued so far with
+ * ua_queue_push(), e.g. before freeing what they refer to. Only the main
+ * thread may use this.
+ *
+ * Returns: TRUE if the commands were run, FALSE if @err is set.
+ */
+gboolean
+ua_server_sync(app_context_t *ctx, GError **err);
+
 /**
  * ua_server_run:
  * @data: application context
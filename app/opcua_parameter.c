@@ -26,11 +26,50 @@
 #include <axsdk/axparameter.h>
 
 #include "error.h"
+#include "log.h"
+#include "opcua_log.h"
 #include "opcua_parameter.h"
 #include "opcua_server.h"
 
 DEFINE_GQUARK("opcua-parameter")
 
+/* parameters overriding the limits of the server profile */
+static const struct {
+  const gchar *name;
+  gsize offset; /* in #server_limits_t */
+  guint min;    /* when not 0, smaller values are raised to it */
+  guint max;
+} server_limit_params[] = {
+  {"MaxSessions",
+   G_STRUCT_OFFSET(server_limits_t, max_sessions),
+   1,
+   MAX_SESSIONS},
+  {"MaxSubscriptionsPerSession",
+   G_STRUCT_OFFSET(server_limits_t, max_subscriptions_per_session),
+   1,
+   MAX_SUBSCRIPTIONS_PER_SESSION},
+  {"MaxMonitoredItemsPerSubscription",
+   G_STRUCT_OFFSET(server_limits_t, max_monitored_items_per_subscription),
+   1,
+   MAX_MONITORED_ITEMS_PER_SUBSCRIPTION},
+  {"MinPublishingInterval",
+   G_STRUCT_OFFSET(server_limits_t, min_publishing_interval),
+   1,
+   MAX_MIN_PUBLISHING_INTERVAL},
+  {"MinClientSamplingInterval",
+   G_STRUCT_OFFSET(server_limits_t, min_sampling_interval),
+   1,
+   MAX_MIN_CLIENT_SAMPLING_INTERVAL},
+  {"ChunkSize",
+   G_STRUCT_OFFSET(server_limits_t, chunk_size),
+   MIN_CHUNK_SIZE,
+   MAX_CHUNK_SIZE},
+  {"MaxMessageSize",
+   G_STRUCT_OFFSET(server_limits_t, max_message_size),
+   MIN_CHUNK_SIZE,
+   MAX_MESSAGE_SIZE},
+};
+
 static gboolean
 handle_loglevel(app_context_t *ctx, gint val, GError **err)
 {
@@ -62,7 +101,7 @@ handle_loglevel(app_context_t *ctx, gint val, GError **err)
     break;
   }
 
-  ctx->logger.context = (void *) ctx->log_level;
+  ua_log_set_level(&ctx->logger, ctx->log_level);
 
   return TRUE;
 }
@@ -82,6 +121,281 @@ handle_port(app_context_t *ctx, gint val, GError **err)
   return TRUE;
 }
 
+static gboolean
+handle_min_sampling_interval(app_context_t *ctx, gint val, GError **err)
+{
+  g_assert(ctx != NULL);
+  g_assert(err == NULL || *err == NULL);
+
+  if (val < MIN_SAMPLING_INTERVAL || val > MAX_SAMPLING_INTERVAL) {
+    SET_ERROR(err, -1, "MinSamplingInterval value is out of range");
+    return FALSE;
+  }
+  ctx->plugin_params.min_sampling_interval = val;
+
+  return TRUE;
+}
+
+static gboolean
+handle_io_event_window(app_context_t *ctx, gint val, GError **err)
+{
+  g_assert(ctx != NULL);
+  g_assert(err == NULL || *err == NULL);
+
+  if (val < MIN_IO_EVENT_WINDOW || val > MAX_IO_EVENT_WINDOW) {
+    SET_ERROR(err, -1, "IOEventWindow value is out of range");
+    return FALSE;
+  }
+  ctx->plugin_params.io_event_window = val;
+
+  return TRUE;
+}
+
+static gboolean
+handle_io_event_max_rate(app_context_t *ctx, gint val, GError **err)
+{
+  g_assert(ctx != NULL);
+  g_assert(err == NULL || *err == NULL);
+
+  if (val < MIN_IO_EVENT_MAX_RATE || val > MAX_IO_EVENT_MAX_RATE) {
+    SET_ERROR(err, -1, "IOEventMaxRate value is out of range");
+    return FALSE;
+  }
+  ctx->plugin_params.io_event_max_rate = val;
+
+  return TRUE;
+}
+
+static gboolean
+handle_method_workers(app_context_t *ctx, gint val, GError **err)
+{
+  g_assert(ctx != NULL);
+  g_assert(err == NULL || *err == NULL);
+
+  if (val < MIN_METHOD_WORKERS || val > MAX_METHOD_WORKERS) {
+    SET_ERROR(err, -1, "MethodWorkers value is out of range");
+    return FALSE;
+  }
+  ctx->plugin_params.method_workers = val;
+
+  return TRUE;
+}
+
+static gboolean
+handle_vapix_budget(app_context_t *ctx, gint val, GError **err)
+{
+  g_assert(ctx != NULL);
+  g_assert(err == NULL || *err == NULL);
+
+  if (val < MIN_VAPIX_BUDGET || val > MAX_VAPIX_BUDGET) {
+    SET_ERROR(err, -1, "VAPIXBudget value is out of range");
+    return FALSE;
+  }
+  ctx->vapix_budget = val;
+
+  return TRUE;
+}
+
+static gboolean
+handle_event_history(app_context_t *ctx, gint val, GError **err)
+{
+  g_assert(ctx != NULL);
+  g_assert(err == NULL || *err == NULL);
+
+  if (val < MIN_EVENT_HISTORY || val > MAX_EVENT_HISTORY) {
+    SET_ERROR(err, -1, "EventHistory value is out of range");
+    return FALSE;
+  }
+  ctx->plugin_params.event_history = val;
+
+  return TRUE;
+}
+
+static gboolean
+handle_server_profile(app_context_t *ctx, gint val, GError **err)
+{
+  g_assert(ctx != NULL);
+  g_assert(err == NULL || *err == NULL);
+
+  if (val < SERVER_PROFILE_DEFAULT || val >= SERVER_PROFILE_LAST) {
+    SET_ERROR(err, -1, "ServerProfile value is out of range");
+    return FALSE;
+  }
+  ctx->server_profile = val;
+
+  return TRUE;
+}
+
+static gboolean
+handle_nodestore(app_context_t *ctx, gint val, GError **err)
+{
+  g_assert(ctx != NULL);
+  g_assert(err == NULL || *err == NULL);
+
+  if (val < NODESTORE_HASHMAP || val >= NODESTORE_LAST) {
+    SET_ERROR(err, -1, "Nodestore value is out of range");
+    return FALSE;
+  }
+  ctx->nodestore = val;
+
+  return TRUE;
+}
+
+static gboolean
+handle_security(app_context_t *ctx, gint val, GError **err)
+{
+  g_assert(ctx != NULL);
+  g_assert(err == NULL || *err == NULL);
+
+  if (val < SECURITY_NONE || val >= SECURITY_LAST) {
+    SET_ERROR(err, -1, "Security value is out of range");
+    return FALSE;
+  }
+  ctx->security = val;
+
+  return TRUE;
+}
+
+static gboolean
+handle_accept_all_clients(app_context_t *ctx, const gchar *val, GError **err)
+{
+  g_assert(ctx != NULL);
+  g_assert(val != NULL);
+  g_assert(err == NULL || *err == NULL);
+
+  if (g_strcmp0(val, "no") == 0) {
+    ctx->accept_all_clients = FALSE;
+  } else if (g_strcmp0(val, "yes") == 0) {
+    ctx->accept_all_clients = TRUE;
+  } else {
+    SET_ERROR(err, -1, "Invalid values for \"accept all clients\"");
+    return FALSE;
+  }
+
+  return TRUE;
+}
+
+static gboolean
+handle_secure_channel_lifetime(app_context_t *ctx, gint val, GError **err)
+{
+  g_assert(ctx != NULL);
+  g_assert(err == NULL || *err == NULL);
+
+  if (val < MIN_SECURE_CHANNEL_LIFETIME || val > MAX_SECURE_CHANNEL_LIFETIME) {
+    SET_ERROR(err, -1, "SecureChannelLifetime value is out of range");
+    return FALSE;
+  }
+  ctx->secure_channel_lifetime = val;
+
+  return TRUE;
+}
+
+static gboolean
+handle_publish_queue_size(app_context_t *ctx, gint val, GError **err)
+{
+  g_assert(ctx != NULL);
+  g_assert(err == NULL || *err == NULL);
+
+  if (val < MIN_PUBLISH_QUEUE_SIZE || val > MAX_PUBLISH_QUEUE_SIZE) {
+    SET_ERROR(err, -1, "PublishQueueSize value is out of range");
+    return FALSE;
+  }
+  ctx->publish_limits.queue_size = val;
+
+  return TRUE;
+}
+
+static gboolean
+handle_retransmission_queue_size(app_context_t *ctx, gint val, GError **err)
+{
+  g_assert(ctx != NULL);
+  g_assert(err == NULL || *err == NULL);
+
+  if (val < MIN_RETRANSMISSION_QUEUE_SIZE ||
+      val > MAX_RETRANSMISSION_QUEUE_SIZE) {
+    SET_ERROR(err, -1, "RetransmissionQueueSize value is out of range");
+    return FALSE;
+  }
+  ctx->publish_limits.retransmission_size = val;
+
+  return TRUE;
+}
+
+static gboolean
+handle_publish_backlog(app_context_t *ctx, gint val, GError **err)
+{
+  g_assert(ctx != NULL);
+  g_assert(err == NULL || *err == NULL);
+
+  if (val < MIN_PUBLISH_BACKLOG || val > MAX_PUBLISH_BACKLOG) {
+    SET_ERROR(err, -1, "PublishBacklog value is out of range");
+    return FALSE;
+  }
+  ctx->publish_limits.total_backlog = val;
+
+  return TRUE;
+}
+
+static gboolean
+handle_slow_client_policy(app_context_t *ctx, gint val, GError **err)
+{
+  g_assert(ctx != NULL);
+  g_assert(err == NULL || *err == NULL);
+
+  if (val < SLOW_CLIENT_DROP_OLDEST || val >= SLOW_CLIENT_LAST) {
+    SET_ERROR(err, -1, "SlowClientPolicy value is out of range");
+    return FALSE;
+  }
+  ctx->publish_limits.policy = val;
+
+  return TRUE;
+}
+
+static gint
+find_server_limit(const gchar *name)
+{
+  g_assert(name != NULL);
+
+  for (guint i = 0; i < G_N_ELEMENTS(server_limit_params); i++) {
+    if (g_strcmp0(name, server_limit_params[i].name) == 0) {
+      return i;
+    }
+  }
+
+  return -1;
+}
+
+static gboolean
+handle_server_limit(app_context_t *ctx, gint idx, gint64 val, GError **err)
+{
+  g_assert(ctx != NULL);
+  g_assert(idx >= 0 && idx < (gint) G_N_ELEMENTS(server_limit_params));
+  g_assert(err == NULL || *err == NULL);
+
+  if (val < 0 || val > server_limit_params[idx].max) {
+    SET_ERROR(err,
+              -1,
+              "%s value is out of range",
+              server_limit_params[idx].name);
+    return FALSE;
+  }
+
+  /* the manifest lets any value down to 0 (the profile default) through */
+  if (val != 0 && val < server_limit_params[idx].min) {
+    LOG_W(&ctx->logger,
+          "%s %" G_GINT64_FORMAT " is below the minimum, using %u",
+          server_limit_params[idx].name,
+          val,
+          server_limit_params[idx].min);
+    val = server_limit_params[idx].min;
+  }
+  G_STRUCT_MEMBER(guint,
+                  &ctx->server_limits,
+                  server_limit_params[idx].offset) = val;
+
+  return TRUE;
+}
+
 static gboolean
 handle_extend_logs(app_context_t *ctx, const gchar *val, GError **err)
 {
@@ -101,6 +415,140 @@ handle_extend_logs(app_context_t *ctx, const gchar *val, GError **err)
   return TRUE;
 }
 
+static gboolean
+handle_async_logs(app_context_t *ctx, const gchar *val, GError **err)
+{
+  g_assert(ctx != NULL);
+  g_assert(val != NULL);
+  g_assert(err == NULL || *err == NULL);
+
+  if (g_strcmp0(val, "no") == 0) {
+    ctx->async_logs = FALSE;
+  } else if (g_strcmp0(val, "yes") == 0) {
+    ctx->async_logs = TRUE;
+  } else {
+    SET_ERROR(err, -1, "Invalid values for \"asynchronous logs\"");
+    return FALSE;
+  }
+
+  return TRUE;
+}
+
+static gboolean
+handle_pubsub(app_context_t *ctx, const gchar *val, GError **err)
+{
+  g_assert(ctx != NULL);
+  g_assert(val != NULL);
+  g_assert(err == NULL || *err == NULL);
+
+  if (g_strcmp0(val, "no") == 0) {
+    ctx->pubsub = FALSE;
+  } else if (g_strcmp0(val, "yes") == 0) {
+    ctx->pubsub = TRUE;
+  } else {
+    SET_ERROR(err, -1, "Invalid values for \"PubSub\"");
+    return FALSE;
+  }
+
+  return TRUE;
+}
+
+static gboolean
+handle_memory_accounting(app_context_t *ctx, const gchar *val, GError **err)
+{
+  g_assert(ctx != NULL);
+  g_assert(val != NULL);
+  g_assert(err == NULL || *err == NULL);
+
+  if (g_strcmp0(val, "no") == 0) {
+    ctx->memory_accounting = FALSE;
+  } else if (g_strcmp0(val, "yes") == 0) {
+    ctx->memory_accounting = TRUE;
+  } else {
+    SET_ERROR(err, -1, "Invalid values for \"MemoryAccounting\"");
+    return FALSE;
+  }
+
+  return TRUE;
+}
+
+static gboolean
+handle_pubsub_address(app_context_t *ctx, const gchar *val, GError **err)
+{
+  g_assert(ctx != NULL);
+  g_assert(val != NULL);
+  g_assert(err == NULL || *err == NULL);
+
+  if (!g_str_has_prefix(val, PUBSUB_ADDRESS_PREFIX)) {
+    SET_ERROR(err,
+              -1,
+              "PubSubAddress must start with \"" PUBSUB_ADDRESS_PREFIX "\"");
+    return FALSE;
+  }
+  g_free(ctx->pubsub_address);
+  ctx->pubsub_address = g_strdup(val);
+
+  return TRUE;
+}
+
+static gboolean
+handle_pubsub_publisher_id(app_context_t *ctx, gint val, GError **err)
+{
+  g_assert(ctx != NULL);
+  g_assert(err == NULL || *err == NULL);
+
+  if (val < MIN_PUBSUB_PUBLISHER_ID || val > MAX_PUBSUB_PUBLISHER_ID) {
+    SET_ERROR(err, -1, "PubSubPublisherId value is out of range");
+    return FALSE;
+  }
+  ctx->pubsub_publisher_id = val;
+
+  return TRUE;
+}
+
+static gboolean
+handle_pubsub_interval(app_context_t *ctx, gint val, GError **err)
+{
+  g_assert(ctx != NULL);
+  g_assert(err == NULL || *err == NULL);
+
+  if (val < MIN_PUBSUB_INTERVAL || val > MAX_PUBSUB_INTERVAL) {
+    SET_ERROR(err, -1, "PubSubInterval value is out of range");
+    return FALSE;
+  }
+  ctx->pubsub_interval = val;
+
+  return TRUE;
+}
+
+static gboolean
+handle_disabled_plugins(app_context_t *ctx, const gchar *val, GError **err)
+{
+  gchar **ids;
+  guint n = 0;
+
+  g_assert(ctx != NULL);
+  g_assert(val != NULL);
+  g_assert(err == NULL || *err == NULL);
+
+  /* e.g. "thermal, bdi", the empty entries are dropped */
+  ids = g_strsplit(val, ",", -1);
+  for (guint i = 0; ids[i] != NULL; i++) {
+    g_strstrip(ids[i]);
+    if (*ids[i] == '\0') {
+      g_free(ids[i]);
+    } else {
+      ids[n++] = ids[i];
+    }
+  }
+  ids[n] = NULL;
+
+  g_strfreev(ctx->disabled_plugins);
+  ctx->disabled_plugins = ids;
+
+  return TRUE;
+}
+
 static gboolean
 handle_param(app_context_t *ctx,
              const gchar *name,
@@ -108,6 +556,7 @@ handle_param(app_context_t *ctx,
              GError **err)
 {
   gint64 val;
+  gint idx;
 
   g_assert(NULL != ctx);
   g_assert(NULL != name);
@@ -131,6 +580,138 @@ handle_param(app_context_t *ctx,
       g_prefix_error(err, "handle_port() failed: ");
       return FALSE;
     }
+  } else if (g_strcmp0(name, "AsyncLogs") == 0) {
+    if (!handle_async_logs(ctx, value, err)) {
+      g_prefix_error(err, "handle_async_logs() failed: ");
+      return FALSE;
+    }
+  } else if (g_strcmp0(name, "MinSamplingInterval") == 0) {
+    val = g_ascii_strtoll(value, NULL, 10);
+    if (!handle_min_sampling_interval(ctx, val, err)) {
+      g_prefix_error(err, "handle_min_sampling_interval() failed: ");
+      return FALSE;
+    }
+  } else if (g_strcmp0(name, "IOEventWindow") == 0) {
+    val = g_ascii_strtoll(value, NULL, 10);
+    if (!handle_io_event_window(ctx, val, err)) {
+      g_prefix_error(err, "handle_io_event_window() failed: ");
+      return FALSE;
+    }
+  } else if (g_strcmp0(name, "IOEventMaxRate") == 0) {
+    val = g_ascii_strtoll(value, NULL, 10);
+    if (!handle_io_event_max_rate(ctx, val, err)) {
+      g_prefix_error(err, "handle_io_event_max_rate() failed: ");
+      return FALSE;
+    }
+  } else if (g_strcmp0(name, "MethodWorkers") == 0) {
+    val = g_ascii_strtoll(value, NULL, 10);
+    if (!handle_method_workers(ctx, val, err)) {
+      g_prefix_error(err, "handle_method_workers() failed: ");
+      return FALSE;
+    }
+  } else if (g_strcmp0(name, "VAPIXBudget") == 0) {
+    val = g_ascii_strtoll(value, NULL, 10);
+    if (!handle_vapix_budget(ctx, val, err)) {
+      g_prefix_error(err, "handle_vapix_budget() failed: ");
+      return FALSE;
+    }
+  } else if (g_strcmp0(name, "EventHistory") == 0) {
+    val = g_ascii_strtoll(value, NULL, 10);
+    if (!handle_event_history(ctx, val, err)) {
+      g_prefix_error(err, "handle_event_history() failed: ");
+      return FALSE;
+    }
+  } else if (g_strcmp0(name, "ServerProfile") == 0) {
+    val = g_ascii_strtoll(value, NULL, 10);
+    if (!handle_server_profile(ctx, val, err)) {
+      g_prefix_error(err, "handle_server_profile() failed: ");
+      return FALSE;
+    }
+  } else if (g_strcmp0(name, "Nodestore") == 0) {
+    val = g_ascii_strtoll(value, NULL, 10);
+    if (!handle_nodestore(ctx, val, err)) {
+      g_prefix_error(err, "handle_nodestore() failed: ");
+      return FALSE;
+    }
+  } else if (g_strcmp0(name, "PublishQueueSize") == 0) {
+    val = g_ascii_strtoll(value, NULL, 10);
+    if (!handle_publish_queue_size(ctx, val, err)) {
+      g_prefix_error(err, "handle_publish_queue_size() failed: ");
+      return FALSE;
+    }
+  } else if (g_strcmp0(name, "RetransmissionQueueSize") == 0) {
+    val = g_ascii_strtoll(value, NULL, 10);
+    if (!handle_retransmission_queue_size(ctx, val, err)) {
+      g_prefix_error(err, "handle_retransmission_queue_size() failed: ");
+      return FALSE;
+    }
+  } else if (g_strcmp0(name, "PublishBacklog") == 0) {
+    val = g_ascii_strtoll(value, NULL, 10);
+    if (!handle_publish_backlog(ctx, val, err)) {
+      g_prefix_error(err, "handle_publish_backlog() failed: ");
+      return FALSE;
+    }
+  } else if (g_strcmp0(name, "SlowClientPolicy") == 0) {
+    val = g_ascii_strtoll(value, NULL, 10);
+    if (!handle_slow_client_policy(ctx, val, err)) {
+      g_prefix_error(err, "handle_slow_client_policy() failed: ");
+      return FALSE;
+    }
+  } else if (g_strcmp0(name, "Security") == 0) {
+    val = g_ascii_strtoll(value, NULL, 10);
+    if (!handle_security(ctx, val, err)) {
+      g_prefix_error(err, "handle_security() failed: ");
+      return FALSE;
+    }
+  } else if (g_strcmp0(name, "AcceptAllClients") == 0) {
+    if (!handle_accept_all_clients(ctx, value, err)) {
+      g_prefix_error(err, "handle_accept_all_clients() failed: ");
+      return FALSE;
+    }
+  } else if (g_strcmp0(name, "SecureChannelLifetime") == 0) {
+    val = g_ascii_strtoll(value, NULL, 10);
+    if (!handle_secure_channel_lifetime(ctx, val, err)) {
+      g_prefix_error(err, "handle_secure_channel_lifetime() failed: ");
+      return FALSE;
+    }
+  } else if (g_strcmp0(name, "MemoryAccounting") == 0) {
+    if (!handle_memory_accounting(ctx, value, err)) {
+      g_prefix_error(err, "handle_memory_accounting() failed: ");
+      return FALSE;
+    }
+  } else if (g_strcmp0(name, "PubSub") == 0) {
+    if (!handle_pubsub(ctx, value, err)) {
+      g_prefix_error(err, "handle_pubsub() failed: ");
+      return FALSE;
+    }
+  } else if (g_strcmp0(name, "PubSubAddress") == 0) {
+    if (!handle_pubsub_address(ctx, value, err)) {
+      g_prefix_error(err, "handle_pubsub_address() failed: ");
+      return FALSE;
+    }
+  } else if (g_strcmp0(name, "PubSubPublisherId") == 0) {
+    val = g_ascii_strtoll(value, NULL, 10);
+    if (!handle_pubsub_publisher_id(ctx, val, err)) {
+      g_prefix_error(err, "handle_pubsub_publisher_id() failed: ");
+      return FALSE;
+    }
+  } else if (g_strcmp0(name, "PubSubInterval") == 0) {
+    val = g_ascii_strtoll(value, NULL, 10);
+    if (!handle_pubsub_interval(ctx, val, err)) {
+      g_prefix_error(err, "handle_pubsub_interval() failed: ");
+      return FALSE;
+    }
+  } else if (g_strcmp0(name, "DisabledPlugins") == 0) {
+    if (!handle_disabled_plugins(ctx, value, err)) {
+      g_prefix_error(err, "handle_disabled_plugins() failed: ");
+      return FALSE;
+    }
+  } else if ((idx = find_server_limit(name)) >= 0) {
+    val = g_ascii_strtoll(value, NULL, 10);
+    if (!handle_server_limit(ctx, idx, val, err)) {
+      g_prefix_error(err, "handle_server_limit() failed: ");
+      return FALSE;
+    }
   } else {
     SET_ERROR(err, -1, "Axparam: %s is not supported", name);
     return FALSE;
@@ -196,5 +777,141 @@ init_ua_parameters(app_context_t *ctx, const gchar *app_name, GError **err)
     return FALSE;
   }
 
+  if (!setup_param(ctx, "AsyncLogs", ctx->axparam, err)) {
+    g_prefix_error(err, "setup_param() failed: ");
+    return FALSE;
+  }
+
+  if (!setup_param(ctx, "MinSamplingInterval", ctx->axparam, err)) {
+    g_prefix_error(err, "setup_param() failed: ");
+    return FALSE;
+  }
+
+  if (!setup_param(ctx, "IOEventWindow", ctx->axparam, err)) {
+    g_prefix_error(err, "setup_param() failed: ");
+    return FALSE;
+  }
+
+  if (!setup_param(ctx, "IOEventMaxRate", ctx->axparam, err)) {
+    g_prefix_error(err, "setup_param() failed: ");
+    return FALSE;
+  }
+
+  if (!setup_param(ctx, "MethodWorkers", ctx->axparam, err)) {
+    g_prefix_error(err, "setup_param() failed: ");
+    return FALSE;
+  }
+
+  if (!setup_param(ctx, "VAPIXBudget", ctx->axparam, err)) {
+    g_prefix_error(err, "setup_param() failed: ");
+    return FALSE;
+  }
+
+  if (!setup_param(ctx, "EventHistory", ctx->axparam, err)) {
+    g_prefix_error(err, "setup_param() failed: ");
+    return FALSE;
+  }
+
+  if (!setup_param(ctx, "ServerProfile", ctx->axparam, err)) {
+    g_prefix_error(err, "setup_param() failed: ");
+    return FALSE;
+  }
+
+  if (!setup_param(ctx, "Nodestore", ctx->axparam, err)) {
+    g_prefix_error(err, "setup_param() failed: ");
+    return FALSE;
+  }
+
+  if (!setup_param(ctx, "PublishQueueSize", ctx->axparam, err)) {
+    g_prefix_error(err, "setup_param() failed: ");
+    return FALSE;
+  }
+
+  if (!setup_param(ctx, "RetransmissionQueueSize", ctx->axparam, err)) {
+    g_prefix_error(err, "setup_param() failed: ");
+    return FALSE;
+  }
+
+  if (!setup_param(ctx, "PublishBacklog", ctx->axparam, err)) {
+    g_prefix_error(err, "setup_param() failed: ");
+    return FALSE;
+  }
+
+  if (!setup_param(ctx, "SlowClientPolicy", ctx->axparam, err)) {
+    g_prefix_error(err, "setup_param() failed: ");
+    return FALSE;
+  }
+
+  if (!setup_param(ctx, "Security", ctx->axparam, err)) {
+    g_prefix_error(err, "setup_param() failed: ");
+    return FALSE;
+  }
+
+  if (!setup_param(ctx, "AcceptAllClients", ctx->axparam, err)) {
+    g_prefix_error(err, "setup_param() failed: ");
+    return FALSE;
+  }
+
+  if (!setup_param(ctx, "SecureChannelLifetime", ctx->axparam, err)) {
+    g_prefix_error(err, "setup_param() failed: ");
+    return FALSE;
+  }
+
+  if (!setup_param(ctx, "MemoryAccounting", ctx->axparam, err)) {
+    g_prefix_error(err, "setup_param() failed: ");
+    return FALSE;
+  }
+
+  if (!setup_param(ctx, "PubSub", ctx->axparam, err)) {
+    g_prefix_error(err, "setup_param() failed: ");
+    return FALSE;
+  }
+
+  if (!setup_param(ctx, "PubSubAddress", ctx->axparam, err)) {
+    g_prefix_error(err, "setup_param() failed: ");
+    return FALSE;
+  }
+
+  if (!setup_param(ctx, "PubSubPublisherId", ctx->axparam, err)) {
+    g_prefix_error(err, "setup_param() failed: ");
+    return FALSE;
+  }
+
+  if (!setup_param(ctx, "PubSubInterval", ctx->axparam, err)) {
+    g_prefix_error(err, "setup_param() failed: ");
+    return FALSE;
+  }
+
+  if (!setup_param(ctx, "DisabledPlugins", ctx->axparam, err)) {
+    g_prefix_error(err, "setup_param() failed: ");
+    return FALSE;
+  }
+
+  for (guint i = 0; i < G_N_ELEMENTS(server_limit_params); i++) {
+    if (!setup_param(ctx, server_limit_params[i].name, ctx->axparam, err)) {
+      g_prefix_error(err, "setup_param() failed: ");
+      return FALSE;
+    }
+  }
+
+  return TRUE;
+}
+
+gboolean
+update_ua_parameter(app_context_t *ctx,
+                    const gchar *name,
+                    const gchar *value,
+                    GError **err)
+{
+  g_return_val_if_fail(NULL != ctx, FALSE);
+  g_return_val_if_fail(NULL != name, FALSE);
+  g_return_val_if_fail(NULL != value, FALSE);
+  g_return_val_if_fail(err == NULL || *err == NULL, FALSE);
+
+  if (!handle_param(ctx, name, value, err)) {
+    g_prefix_error(err, "handle_param() failed: ");
+    return FALSE;
+  }
+
   return TRUE;
 }
@@ -38,6 +38,70 @@
 #define MIN_PORT 1024
 #define MAX_PORT 65535
 
+/* milliseconds */
+#define MIN_SAMPLING_INTERVAL 100
+#define MAX_SAMPLING_INTERVAL 60000
+
+/* milliseconds, 0 disables the coalescing of the I/O port events */
+#define MIN_IO_EVENT_WINDOW 0
+#define MAX_IO_EVENT_WINDOW 10000
+
+/* events per second and port, 0 disables the rate limiting */
+#define MIN_IO_EVENT_MAX_RATE 0
+#define MAX_IO_EVENT_MAX_RATE 1000
+
+/* threads serving the method calls, 0 serves them from the server thread */
+#define MIN_METHOD_WORKERS 0
+#define MAX_METHOD_WORKERS 8
+
+/* VAPIX requests per second of the periodic work, 0 disables the budget */
+#define MIN_VAPIX_BUDGET 0
+#define MAX_VAPIX_BUDGET 1000
+
+/* events kept per event type for HistoryReadEvents, 0 disables the history */
+#define MIN_EVENT_HISTORY 0
+#define MAX_EVENT_HISTORY 4096
+
+/* milliseconds */
+#define MIN_PUBSUB_INTERVAL 10
+#define MAX_PUBSUB_INTERVAL 60000
+
+#define MIN_PUBSUB_PUBLISHER_ID 1
+#define MAX_PUBSUB_PUBLISHER_ID 65535
+
+/* seconds, each renewal of a secure channel token is an asymmetric
+ * handshake */
+#define MIN_SECURE_CHANNEL_LIFETIME 60
+#define MAX_SECURE_CHANNEL_LIFETIME 86400
+
+/* notifications per monitored item */
+#define MIN_PUBLISH_QUEUE_SIZE 1
+#define MAX_PUBLISH_QUEUE_SIZE 1000
+
+/* unacknowledged notification messages per subscription */
+#define MIN_RETRANSMISSION_QUEUE_SIZE 1
+#define MAX_RETRANSMISSION_QUEUE_SIZE 1000
+
+/* unacknowledged notification messages of all the subscriptions, 0 disables
+ * the cap */
+#define MIN_PUBLISH_BACKLOG 0
+#define MAX_PUBLISH_BACKLOG 100000
+
+/* the only transport of the published DataSets */
+#define PUBSUB_ADDRESS_PREFIX "opc.udp://"
+
+/* overrides of the server profile limits, 0 keeps the value of the profile */
+#define MAX_SESSIONS 1000
+#define MAX_SUBSCRIPTIONS_PER_SESSION 1000
+#define MAX_MONITORED_ITEMS_PER_SUBSCRIPTION 100000
+/* milliseconds */
+#define MAX_MIN_PUBLISHING_INTERVAL 60000
+#define MAX_MIN_CLIENT_SAMPLING_INTERVAL 60000
+/* bytes, OPC UA requires chunks of at least 8 KiB */
+#define MIN_CHUNK_SIZE 8192
+#define MAX_CHUNK_SIZE 1048576
+#define MAX_MESSAGE_SIZE 268435456
+
 /**
  * init_ua_parameters:
  * @ctx: application context
@@ -52,4 +116,22 @@
 gboolean
 init_ua_parameters(app_context_t *ctx, const gchar *app_name, GError **err);
 
+/**
+ * update_ua_parameter:
+ * @ctx: application context
+ * @name: name of the parameter, as in `manifest.json`
+ * @value: the new value of the parameter
+ * @err: return location for a #GError
+ *
+ * Applies a parameter changed while the application is running, e.g. from an
+ * #AXParameterCallback. The caller acts on the new value.
+ *
+ * Returns: TRUE if @value is valid, FALSE otherwise.
+ */
+gboolean
+update_ua_parameter(app_context_t *ctx,
+                    const gchar *name,
+                    const gchar *value,
+                    GError **err);
+
 #endif /* __OPCUA_PARAMETER_H__ */
@@ -0,0 +1,367 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2025 Axis Communications AB
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <glib.h>
+#include <open62541/server.h>
+#include <string.h>
+
+#include "error.h"
+#include "log.h"
+#include "opcua_publish.h"
+#include "ua_metrics.h"
+
+/* how often the subscriptions are checked */
+#define PUBLISH_CHECK_INTERVAL 1000.0 /* milliseconds */
+
+/* the diagnostics of all the subscriptions, for the admin session */
+#define SUBSCRIPTION_DIAGNOSTICS                                               \
+  UA_NS0ID_SERVER_SERVERDIAGNOSTICS_SUBSCRIPTIONDIAGNOSTICSARRAY
+
+DEFINE_GQUARK("opcua-publish")
+
+/* the counters of a subscription when it was last checked */
+typedef struct {
+  UA_NodeId session;
+  UA_UInt32 id;
+  guint64 generation;
+  UA_UInt32 overflows;
+  UA_UInt32 discarded;
+} subscription_state_t;
+
+/* the subscriptions of a session, during a check */
+typedef struct {
+  const UA_NodeId *id;
+  guint64 backlog;
+  /* a retransmission queue is full or discarded messages */
+  gboolean lagging;
+  gboolean closed;
+} session_state_t;
+
+/* only accessed from the server thread, once the server is running */
+static struct {
+  publish_limits_t limits;
+  const UA_Logger *logger;
+  /* subscription_state_t, by themselves */
+  GHashTable *subscriptions;
+  /* the subscriptions not seen by the current check are gone */
+  guint64 generation;
+  ua_metric_t *backlog;
+  ua_metric_t *overflows;
+  ua_metric_t *discarded;
+  ua_metric_t *disconnects;
+} publish;
+
+#ifdef UA_ENABLE_DIAGNOSTICS
+
+static guint
+subscription_hash(gconstpointer key)
+{
+  const subscription_state_t *sub = key;
+
+  return UA_NodeId_hash(&sub->session) ^ sub->id;
+}
+
+static gboolean
+subscription_equal(gconstpointer a, gconstpointer b)
+{
+  const subscription_state_t *sub_a = a;
+  const subscription_state_t *sub_b = b;
+
+  return sub_a->id == sub_b->id &&
+         UA_NodeId_equal(&sub_a->session, &sub_b->session);
+}
+
+static void
+free_subscription_state(gpointer data)
+{
+  subscription_state_t *sub = data;
+
+  UA_NodeId_clear(&sub->session);
+  g_free(sub);
+}
+
+static gboolean
+is_stale_subscription(gpointer key, gpointer value, gpointer data)
+{
+  const subscription_state_t *sub = value;
+
+  (void) key;
+  (void) data;
+
+  return sub->generation != publish.generation;
+}
+
+static subscription_state_t *
+get_subscription_state(const UA_SubscriptionDiagnosticsDataType *diag)
+{
+  subscription_state_t *sub;
+  subscription_state_t key;
+
+  g_assert(diag != NULL);
+
+  /* only for the lookup, the session id is not copied */
+  key.session = diag->sessionId;
+  key.id = diag->subscriptionId;
+  sub = g_hash_table_lookup(publish.subscriptions, &key);
+  if (sub == NULL) {
+    sub = g_new0(subscription_state_t, 1);
+    (void) UA_NodeId_copy(&diag->sessionId, &sub->session);
+    sub->id = diag->subscriptionId;
+    g_hash_table_add(publish.subscriptions, sub);
+  }
+
+  return sub;
+}
+
+static session_state_t *
+get_session_state(GArray *sessions, const UA_NodeId *id)
+{
+  session_state_t session = {0};
+
+  g_assert(sessions != NULL);
+  g_assert(id != NULL);
+
+  /* a handful of sessions, see the 'MaxSessions' parameter */
+  for (guint i = 0; i < sessions->len; i++) {
+    if (UA_NodeId_equal(g_array_index(sessions, session_state_t, i).id, id)) {
+      return &g_array_index(sessions, session_state_t, i);
+    }
+  }
+
+  session.id = id;
+  g_array_append_val(sessions, session);
+
+  return &g_array_index(sessions, session_state_t, sessions->len - 1);
+}
+
+static void
+close_session(UA_Server *server, session_state_t *session, const gchar *why)
+{
+  UA_String id = UA_STRING_NULL;
+  UA_StatusCode status;
+
+  g_assert(server != NULL);
+  g_assert(session != NULL);
+  g_assert(why != NULL);
+
+  (void) UA_NodeId_print(session->id, &id);
+  status = UA_Server_closeSession(server, session->id);
+  if (status != UA_STATUSCODE_GOOD) {
+    LOG_E(publish.logger,
+          "Failed to close the session %.*s: %s",
+          (gint) id.length,
+          (const gchar *) id.data,
+          UA_StatusCode_name(status));
+  } else {
+    LOG_W(publish.logger,
+          "Closed the session %.*s, %s",
+          (gint) id.length,
+          (const gchar *) id.data,
+          why);
+    ua_metric_add(publish.disconnects, 1);
+  }
+  session->closed = TRUE;
+
+  UA_String_clear(&id);
+}
+
+/* a #UA_ServerCallback counting what the queues of the subscriptions dropped
+ * since the last check and closing the sessions not keeping up */
+static void
+check_subscriptions_cb(UA_Server *server, void *data)
+{
+  const UA_SubscriptionDiagnosticsDataType *diags;
+  session_state_t *worst = NULL;
+  GArray *sessions;
+  UA_Variant value;
+  UA_StatusCode status;
+  guint64 backlog = 0;
+
+  g_assert(server != NULL);
+  (void) data;
+
+  UA_Variant_init(&value);
+  status = UA_Server_readValue(server,
+                               UA_NODEID_NUMERIC(0, SUBSCRIPTION_DIAGNOSTICS),
+                               &value);
+  if (status != UA_STATUSCODE_GOOD ||
+      !UA_Variant_hasArrayType(
+              &value,
+              &UA_TYPES[UA_TYPES_SUBSCRIPTIONDIAGNOSTICSDATATYPE])) {
+    UA_Variant_clear(&value);
+    return;
+  }
+
+  publish.generation++;
+  sessions = g_array_new(FALSE, FALSE, sizeof(session_state_t));
+  diags = value.data;
+  for (gsize i = 0; i < value.arrayLength; i++) {
+    const UA_SubscriptionDiagnosticsDataType *diag = &diags[i];
+    subscription_state_t *sub = get_subscription_state(diag);
+    session_state_t *session = get_session_state(sessions, &diag->sessionId);
+    UA_UInt32 overflows;
+
+    /* the counters only grow during the lifetime of a subscription */
+    overflows = diag->monitoringQueueOverflowCount +
+                diag->eventQueueOverFlowCount;
+    if (overflows > sub->overflows) {
+      ua_metric_add(publish.overflows, overflows - sub->overflows);
+    }
+    if (diag->discardedMessageCount > sub->discarded) {
+      ua_metric_add(publish.discarded,
+                    diag->discardedMessageCount - sub->discarded);
+      session->lagging = TRUE;
+    }
+    if (diag->unacknowledgedMessageCount >=
+        publish.limits.retransmission_size) {
+      session->lagging = TRUE;
+    }
+    sub->overflows = overflows;
+    sub->discarded = diag->discardedMessageCount;
+    sub->generation = publish.generation;
+
+    session->backlog += diag->unacknowledgedMessageCount;
+    backlog += diag->unacknowledgedMessageCount;
+  }
+  (void) g_hash_table_foreach_remove(publish.subscriptions,
+                                     is_stale_subscription,
+                                     NULL);
+  ua_metric_set(publish.backlog, (gint) MIN(backlog, G_MAXINT));
+
+  if (publish.limits.policy == SLOW_CLIENT_DISCONNECT) {
+    for (guint i = 0; i < sessions->len; i++) {
+      session_state_t *session = &g_array_index(sessions, session_state_t, i);
+
+      if (session->lagging) {
+        close_session(server,
+                      session,
+                      "it does not acknowledge its notifications");
+        backlog -= session->backlog;
+      }
+    }
+  }
+
+  /* one client should not hold the memory of the others */
+  if (publish.limits.total_backlog > 0 &&
+      backlog > publish.limits.total_backlog) {
+    for (guint i = 0; i < sessions->len; i++) {
+      session_state_t *session = &g_array_index(sessions, session_state_t, i);
+
+      if (!session->closed &&
+          (worst == NULL || session->backlog > worst->backlog)) {
+        worst = session;
+      }
+    }
+    if (worst != NULL) {
+      close_session(server,
+                    worst,
+                    "it has the most unacknowledged notifications");
+    }
+  }
+
+  g_array_free(sessions, TRUE);
+  UA_Variant_clear(&value);
+}
+
+#endif /* UA_ENABLE_DIAGNOSTICS */
+
+gboolean
+ua_publish_setup(app_context_t *ctx, GError **err)
+{
+  const publish_limits_t *limits;
+  UA_ServerConfig *config;
+
+  g_return_val_if_fail(ctx != NULL, FALSE);
+  g_return_val_if_fail(ctx->server != NULL, FALSE);
+  g_return_val_if_fail(publish.subscriptions == NULL, FALSE);
+  g_return_val_if_fail(err == NULL || *err == NULL, FALSE);
+
+  limits = &ctx->publish_limits;
+  config = UA_Server_getConfig(ctx->server);
+
+  /* the queue size requested by a client is revised into these limits */
+  if (limits->policy == SLOW_CLIENT_COALESCE) {
+    config->queueSizeLimits.min = 1;
+    config->queueSizeLimits.max = 1;
+  } else {
+    config->queueSizeLimits.min = MIN(config->queueSizeLimits.min,
+                                      limits->queue_size);
+    config->queueSizeLimits.max = limits->queue_size;
+  }
+  config->maxRetransmissionQueueSize = limits->retransmission_size;
+
+  LOG_I(&ctx->logger,
+        "Publish queues: %u notifications per monitored item, %u "
+        "unacknowledged messages per subscription, %u per session",
+        config->queueSizeLimits.max,
+        config->maxRetransmissionQueueSize,
+        config->maxRetransmissionQueueSize *
+                config->maxSubscriptionsPerSession);
+
+#ifdef UA_ENABLE_DIAGNOSTICS
+  UA_StatusCode status;
+
+  publish.limits = *limits;
+  publish.logger = &ctx->logger;
+  publish.subscriptions = g_hash_table_new_full(subscription_hash,
+                                                subscription_equal,
+                                                NULL,
+                                                free_subscription_state);
+  publish.backlog = ua_metrics_get(UA_METRIC_GAUGE, "publish.backlog");
+  publish.overflows =
+          ua_metrics_get(UA_METRIC_COUNTER, "publish.queue_overflows");
+  publish.discarded =
+          ua_metrics_get(UA_METRIC_COUNTER, "publish.discarded_messages");
+  publish.disconnects =
+          ua_metrics_get(UA_METRIC_COUNTER, "publish.disconnects");
+
+  status = UA_Server_addRepeatedCallback(ctx->server,
+                                         check_subscriptions_cb,
+                                         NULL,
+                                         PUBLISH_CHECK_INTERVAL,
+                                         NULL);
+  if (status != UA_STATUSCODE_GOOD) {
+    SET_ERROR(err,
+              -1,
+              "UA_Server_addRepeatedCallback() failed: %s",
+              UA_StatusCode_name(status));
+    ua_publish_clear();
+    return FALSE;
+  }
+
+  return TRUE;
+#else
+  SET_ERROR(err, -1, "open62541 is built without UA_ENABLE_DIAGNOSTICS");
+
+  return FALSE;
+#endif
+}
+
+void
+ua_publish_clear(void)
+{
+  g_clear_pointer(&publish.subscriptions, g_hash_table_destroy);
+  memset(&publish, 0, sizeof(publish));
+}
@@ -0,0 +1,64 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2025 Axis Communications AB
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef __OPCUA_PUBLISH_H__
+#define __OPCUA_PUBLISH_H__
+
+#include <glib.h>
+
+#include "opcua_server.h"
+
+/**
+ * ua_publish_setup:
+ * @ctx: application context, with a server which is not running yet
+ * @err: return location for a #GError
+ *
+ * Caps the queues the server keeps for the subscriptions with the publish
+ * limits of @ctx: the notifications of a monitored item, one with
+ * #SLOW_CLIENT_COALESCE, and the unacknowledged messages of a subscription.
+ *
+ * The subscription diagnostics of the server are then checked every second
+ * from the server thread. The notifications dropped from full queues, the
+ * messages discarded from full retransmission queues and the unacknowledged
+ * messages are published as the `publish.*` metrics. With
+ * #SLOW_CLIENT_DISCONNECT a session whose retransmission queue is full is
+ * closed, and so is the session with the most unacknowledged messages when
+ * all the sessions have more than the 'PublishBacklog' parameter.
+ *
+ * Returns: TRUE if the subscriptions are checked, FALSE if @err is set. The
+ *    queues are capped in both cases.
+ */
+gboolean
+ua_publish_setup(app_context_t *ctx, GError **err);
+
+/**
+ * ua_publish_clear:
+ *
+ * Frees what ua_publish_setup() keeps, once the server is deleted.
+ */
+void
+ua_publish_clear(void);
+
+#endif /* __OPCUA_PUBLISH_H__ */
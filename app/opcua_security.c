@@ -0,0 +1,402 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2025 Axis Communications AB
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <errno.h>
+#include <glib.h>
+#include <open62541/plugin/accesscontrol_default.h>
+#include <open62541/server_config_default.h>
+#ifdef UA_ENABLE_ENCRYPTION
+#include <open62541/plugin/create_certificate.h>
+#endif
+#if defined(__aarch64__) || defined(__arm__)
+#include <asm/hwcap.h>
+#include <sys/auxv.h>
+#endif
+
+#include "error.h"
+#include "log.h"
+#include "opcua_security.h"
+
+/* can be set at build time, e.g. for a host build of the application */
+#ifndef SECURITY_DIR
+#define SECURITY_DIR "/usr/local/packages/" APPNAME "/localdata"
+#endif
+
+#define CERTIFICATE_PATH SECURITY_DIR "/server_cert.der"
+#define PRIVATE_KEY_PATH SECURITY_DIR "/server_key.der"
+#define TRUSTED_DIR      SECURITY_DIR "/pki/trusted"
+#define TRUSTED_SUFFIX   ".der"
+
+/* a handshake with a 4096 bits key, the open62541 default, costs about 7
+ * times as much as one with a 2048 bits key */
+#define CERTIFICATE_KEY_SIZE 2048
+#define CERTIFICATE_DAYS     3650
+
+DEFINE_GQUARK("opcua-security")
+
+#ifdef UA_ENABLE_ENCRYPTION
+
+/* a view of @bytes, which keeps the data */
+static UA_ByteString
+byte_string_view(GBytes *bytes)
+{
+  UA_ByteString view;
+  gsize len;
+
+  g_assert(bytes != NULL);
+
+  view.data = (UA_Byte *) g_bytes_get_data(bytes, &len);
+  view.length = len;
+
+  return view;
+}
+
+static GBytes *
+load_file(const gchar *path, GError **err)
+{
+  gchar *contents;
+  gsize len;
+
+  g_assert(path != NULL);
+  g_assert(err == NULL || *err == NULL);
+
+  if (!g_file_get_contents(path, &contents, &len, err)) {
+    return NULL;
+  }
+
+  return g_bytes_new_take(contents, len);
+}
+
+/* creates a self-signed certificate for the application URI and the host
+ * name and stores it, with its private key, in the localdata directory */
+static gboolean
+create_certificate(app_context_t *ctx, GError **err)
+{
+  gchar *common_name = NULL;
+  gchar *dns_name = NULL;
+  UA_ByteString key = UA_BYTESTRING_NULL;
+  UA_ByteString cert = UA_BYTESTRING_NULL;
+  UA_UInt16 key_size = CERTIFICATE_KEY_SIZE;
+  UA_UInt16 days = CERTIFICATE_DAYS;
+  UA_KeyValuePair params[2];
+  UA_KeyValueMap param_map;
+  UA_String subject[3];
+  UA_String alt_names[2];
+  UA_StatusCode status;
+  gboolean ret = FALSE;
+
+  g_assert(ctx != NULL);
+  g_assert(err == NULL || *err == NULL);
+
+  common_name = g_strconcat("CN=", APPNAME, "@", g_get_host_name(), NULL);
+  dns_name = g_strconcat("DNS:", g_get_host_name(), NULL);
+
+  subject[0] = UA_STRING("C=SE");
+  subject[1] = UA_STRING("O=Axis Communications AB");
+  subject[2] = UA_STRING(common_name);
+  /* the clients check the URI against the application description */
+  alt_names[0] = UA_STRING("URI:" UA_APPLICATION_URI);
+  alt_names[1] = UA_STRING(dns_name);
+
+  params[0].key = UA_QUALIFIEDNAME(0, "key-size-bits");
+  UA_Variant_setScalar(&params[0].value, &key_size, &UA_TYPES[UA_TYPES_UINT16]);
+  params[1].key = UA_QUALIFIEDNAME(0, "expires-in-days");
+  UA_Variant_setScalar(&params[1].value, &days, &UA_TYPES[UA_TYPES_UINT16]);
+  param_map.mapSize = G_N_ELEMENTS(params);
+  param_map.map = params;
+
+  status = UA_CreateCertificate(&ctx->logger,
+                                subject,
+                                G_N_ELEMENTS(subject),
+                                alt_names,
+                                G_N_ELEMENTS(alt_names),
+                                UA_CERTIFICATEFORMAT_DER,
+                                &param_map,
+                                &key,
+                                &cert);
+  if (status != UA_STATUSCODE_GOOD) {
+    SET_ERROR(err,
+              -1,
+              "UA_CreateCertificate() failed: %s",
+              UA_StatusCode_name(status));
+    goto out;
+  }
+
+  if (g_mkdir_with_parents(SECURITY_DIR, 0755) != 0) {
+    SET_ERROR(err,
+              -1,
+              "Failed to create %s: %s",
+              SECURITY_DIR,
+              g_strerror(errno));
+    goto out;
+  }
+
+  if (!g_file_set_contents_full(PRIVATE_KEY_PATH,
+                                (const gchar *) key.data,
+                                key.length,
+                                G_FILE_SET_CONTENTS_CONSISTENT,
+                                0600,
+                                err) ||
+      !g_file_set_contents(CERTIFICATE_PATH,
+                           (const gchar *) cert.data,
+                           cert.length,
+                           err)) {
+    goto out;
+  }
+
+  ret = TRUE;
+
+out:
+  UA_ByteString_clear(&key);
+  UA_ByteString_clear(&cert);
+  g_free(dns_name);
+  g_free(common_name);
+
+  return ret;
+}
+
+/* loads the client certificates to trust, as #GBytes, into @trusted */
+static gboolean
+load_trust_list(GPtrArray *trusted, GError **err)
+{
+  const gchar *name;
+  GDir *dir;
+
+  g_assert(trusted != NULL);
+  g_assert(err == NULL || *err == NULL);
+
+  /* where the certificates are to be copied to */
+  if (g_mkdir_with_parents(TRUSTED_DIR, 0755) != 0) {
+    SET_ERROR(err,
+              -1,
+              "Failed to create %s: %s",
+              TRUSTED_DIR,
+              g_strerror(errno));
+    return FALSE;
+  }
+
+  dir = g_dir_open(TRUSTED_DIR, 0, err);
+  if (dir == NULL) {
+    return FALSE;
+  }
+
+  while ((name = g_dir_read_name(dir)) != NULL) {
+    gchar *path;
+    GBytes *bytes;
+
+    if (!g_str_has_suffix(name, TRUSTED_SUFFIX)) {
+      continue;
+    }
+
+    path = g_build_filename(TRUSTED_DIR, name, NULL);
+    bytes = load_file(path, err);
+    g_free(path);
+    if (bytes == NULL) {
+      g_dir_close(dir);
+      return FALSE;
+    }
+    g_ptr_array_add(trusted, bytes);
+  }
+  g_dir_close(dir);
+
+  return TRUE;
+}
+
+/* OpenSSL uses the AES and SHA-2 instructions of the SoC when the CPU has
+ * them, which makes the symmetric part of the encrypted messages cheap */
+static void
+log_crypto_extensions(app_context_t *ctx)
+{
+  g_assert(ctx != NULL);
+
+#if defined(__aarch64__)
+  gulong hwcap = getauxval(AT_HWCAP);
+
+  LOG_I(&ctx->logger,
+        "Crypto extensions: AES %s, SHA-2 %s",
+        (hwcap & HWCAP_AES) ? "yes" : "no",
+        (hwcap & HWCAP_SHA2) ? "yes" : "no");
+#elif defined(__arm__)
+  gulong hwcap = getauxval(AT_HWCAP2);
+
+  LOG_I(&ctx->logger,
+        "Crypto extensions: AES %s, SHA-2 %s",
+        (hwcap & HWCAP2_AES) ? "yes" : "no",
+        (hwcap & HWCAP2_SHA2) ? "yes" : "no");
+#else
+  LOG_I(&ctx->logger, "Crypto extensions: unknown");
+#endif
+}
+
+#endif /* UA_ENABLE_ENCRYPTION */
+
+gboolean
+ua_security_setup(app_context_t *ctx,
+                  UA_ServerConfig *config,
+                  UA_UInt16 port,
+                  GError **err)
+{
+  g_return_val_if_fail(ctx != NULL, FALSE);
+  g_return_val_if_fail(ctx->security != SECURITY_NONE, FALSE);
+  g_return_val_if_fail(config != NULL, FALSE);
+  g_return_val_if_fail(err == NULL || *err == NULL, FALSE);
+
+#ifdef UA_ENABLE_ENCRYPTION
+  UA_ByteString *trust_list = NULL;
+  UA_ByteString cert_view;
+  UA_ByteString key_view;
+  GPtrArray *trusted = NULL;
+  GBytes *cert = NULL;
+  GBytes *key = NULL;
+  UA_StatusCode status;
+  gboolean ret = FALSE;
+
+  /* on the first start, or once the pair was removed for a new one */
+  if (!g_file_test(CERTIFICATE_PATH, G_FILE_TEST_EXISTS) ||
+      !g_file_test(PRIVATE_KEY_PATH, G_FILE_TEST_EXISTS)) {
+    LOG_I(&ctx->logger, "Creating a self-signed certificate");
+    if (!create_certificate(ctx, err)) {
+      g_prefix_error(err, "create_certificate() failed: ");
+      return FALSE;
+    }
+  }
+
+  cert = load_file(CERTIFICATE_PATH, err);
+  if (cert == NULL) {
+    g_prefix_error(err, "Failed to load the server certificate: ");
+    goto out;
+  }
+
+  key = load_file(PRIVATE_KEY_PATH, err);
+  if (key == NULL) {
+    g_prefix_error(err, "Failed to load the private key: ");
+    goto out;
+  }
+
+  trusted = g_ptr_array_new_with_free_func((GDestroyNotify) g_bytes_unref);
+  if (!load_trust_list(trusted, err)) {
+    g_prefix_error(err, "load_trust_list() failed: ");
+    goto out;
+  }
+
+  /* open62541 accepts any client certificate with an empty trust list */
+  if (ctx->accept_all_clients) {
+    LOG_W(&ctx->logger,
+          "AcceptAllClients is set, any client certificate is accepted");
+    g_ptr_array_set_size(trusted, 0);
+  } else if (trusted->len == 0) {
+    SET_ERROR(err,
+              -1,
+              "No trusted client certificates in %s and AcceptAllClients is "
+              "not set",
+              TRUSTED_DIR);
+    goto out;
+  }
+
+  trust_list = g_new0(UA_ByteString, trusted->len);
+  for (guint i = 0; i < trusted->len; i++) {
+    trust_list[i] = byte_string_view(g_ptr_array_index(trusted, i));
+  }
+  cert_view = byte_string_view(cert);
+  key_view = byte_string_view(key);
+
+  /* the policies copy the certificate and parse the private key, once for
+   * all the secure channels */
+  if (ctx->security == SECURITY_REQUIRED) {
+    status = UA_ServerConfig_setDefaultWithSecureSecurityPolicies(config,
+                                                                  port,
+                                                                  &cert_view,
+                                                                  &key_view,
+                                                                  trust_list,
+                                                                  trusted->len,
+                                                                  NULL,
+                                                                  0,
+                                                                  NULL,
+                                                                  0);
+  } else {
+    status = UA_ServerConfig_setDefaultWithSecurityPolicies(config,
+                                                            port,
+                                                            &cert_view,
+                                                            &key_view,
+                                                            trust_list,
+                                                            trusted->len,
+                                                            NULL,
+                                                            0,
+                                                            NULL,
+                                                            0);
+  }
+  if (status != UA_STATUSCODE_GOOD) {
+    SET_ERROR(err,
+              -1,
+              "Failed to set up the security policies: %s",
+              UA_StatusCode_name(status));
+    goto out;
+  }
+
+  if (ctx->security == SECURITY_REQUIRED) {
+    /* the clients still find the endpoints without a secure channel */
+    config->securityPolicyNoneDiscoveryOnly = true;
+  }
+
+  /* anonymous sessions as with SecurityPolicy None, it's the certificate of
+   * the client application which is verified */
+  status = UA_AccessControl_default(
+          config,
+          true,
+          &config->securityPolicies[config->securityPoliciesSize - 1].policyUri,
+          0,
+          NULL);
+  if (status != UA_STATUSCODE_GOOD) {
+    SET_ERROR(err,
+              -1,
+              "UA_AccessControl_default() failed: %s",
+              UA_StatusCode_name(status));
+    goto out;
+  }
+
+  LOG_I(&ctx->logger,
+        "Security %s: %zu security policies, %u trusted certificates",
+        ctx->security == SECURITY_REQUIRED ? "required" : "optional",
+        config->securityPoliciesSize,
+        trusted->len);
+  log_crypto_extensions(ctx);
+
+  ret = TRUE;
+
+out:
+  g_free(trust_list);
+  g_clear_pointer(&trusted, g_ptr_array_unref);
+  g_clear_pointer(&key, g_bytes_unref);
+  g_clear_pointer(&cert, g_bytes_unref);
+
+  return ret;
+#else
+  (void) port;
+
+  SET_ERROR(err, -1, "open62541 is built without UA_ENABLE_ENCRYPTION");
+
+  return FALSE;
+#endif
+}
@@ -0,0 +1,60 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2025 Axis Communications AB
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef __OPCUA_SECURITY_H__
+#define __OPCUA_SECURITY_H__
+
+#include <glib.h>
+#include <open62541/server.h>
+
+#include "opcua_server.h"
+
+/**
+ * ua_security_setup:
+ * @ctx: application context
+ * @config: configuration the server is to be created with
+ * @port: TCP port number for the server
+ * @err: return location for a #GError
+ *
+ * Sets up @config with the signed and encrypted security policies selected
+ * with the 'Security' parameter, instead of UA_ServerConfig_setMinimal().
+ *
+ * The certificate and the private key of the server are read from the
+ * `localdata` directory of the application, a self-signed pair is created
+ * there on the first start. The private key is parsed once here, the
+ * security policies keep it for all the secure channels. The client
+ * certificates in `localdata/pki/trusted` are trusted. Without any, this
+ * fails unless the 'AcceptAllClients' parameter is set, which accepts any
+ * client certificate.
+ *
+ * Returns: TRUE if @config is set up, FALSE if @err is set.
+ */
+gboolean
+ua_security_setup(app_context_t *ctx,
+                  UA_ServerConfig *config,
+                  UA_UInt16 port,
+                  GError **err);
+
+#endif /* __OPCUA_SECURITY_H__ */
@@ -24,14 +24,29 @@
  */
 
 #include <glib-unix.h>
+#include <string.h>
 #include <syslog.h>
 
 #include "error.h"
 #include "log.h"
+#include "opcua_log.h"
 #include "plugin.h"
 #include "opcua_parameter.h"
 #include "opcua_open62541.h"
+#include "opcua_publish.h"
 #include "opcua_server.h"
+#include "ua_memory.h"
+#include "ua_metrics.h"
+#include "ua_queue.h"
+#include "ua_sched.h"
+#include "vapix_utils.h"
+
+/* upper bound of concurrent VAPIX requests issued by all the plugins */
+#define VAPIX_MAX_CONNECTIONS 4
+/* upper bound of server mutations the plugins may have pending */
+#define UA_QUEUE_CAPACITY 1024
+/* upper bound of log messages waiting to be written when 'AsyncLogs' is set */
+#define UA_LOG_CAPACITY 128
 
 static void
 open_syslog(const gchar *app_name)
@@ -80,19 +95,125 @@ init_ua_logger(app_context_t *ctx)
 
   /* initial log level until we get to read in our configuration parameters */
   ctx->logger = UA_Log_Syslog_withLevel(UA_LOGLEVEL_WARNING);
+  ua_log_set_level(&ctx->logger, UA_LOGLEVEL_WARNING);
 }
 
+/* a plugin being initialized */
+typedef struct {
+  app_context_t *ctx;
+  gchar *name;
+  opc_plugin_t *plugin;
+  /* thread running the preparation of the plugin, if it has one */
+  GThread *thread;
+  gboolean prepared;
+  gboolean created;
+  GError *err;
+} plugin_init_t;
+
+static gboolean
+create_ua_plugin_cb(gpointer data);
+
+/* the name of a plugin in the metrics, e.g. "opcua_thermal" for
+ * "libopcua_thermal.so" */
+static gchar *
+get_metric_name(const plugin_init_t *init)
+{
+  const gchar *name;
+
+  g_assert(init != NULL);
+
+  name = init->name;
+  if (g_str_has_prefix(name, "lib")) {
+    name += strlen("lib");
+  }
+
+  return g_strndup(name, strcspn(name, "."));
+}
+
+/* records how long a stage of the start-up of a plugin took, in e.g.
+ * "plugin.opcua_thermal.prepare" */
+static void
+record_startup(const plugin_init_t *init, const gchar *stage, gint64 start)
+{
+  gchar *name;
+  gchar *metric;
+
+  g_assert(init != NULL);
+  g_assert(stage != NULL);
+
+  name = get_metric_name(init);
+  metric = g_strdup_printf("plugin.%s.%s", name, stage);
+  ua_metric_observe_since(ua_metrics_get(UA_METRIC_TIMING, metric), start);
+  g_free(metric);
+  g_free(name);
+}
+
+/* the plugins listed in the 'DisabledPlugins' parameter aren't loaded */
+static gboolean
+is_plugin_disabled(const app_context_t *ctx, const gchar *name)
+{
+  gchar *id;
+  gboolean disabled;
+
+  g_assert(ctx != NULL);
+  g_assert(name != NULL);
+
+  if (ctx->disabled_plugins == NULL) {
+    return FALSE;
+  }
+
+  id = plugin_get_id(name);
+  disabled = g_strv_contains((const gchar *const *) ctx->disabled_plugins, id);
+  g_free(id);
+
+  return disabled;
+}
+
+/* a #GThreadFunc running the preparation of a plugin */
+static gpointer
+prepare_ua_plugin(gpointer data)
+{
+  plugin_init_t *init = data;
+  gint64 start = g_get_monotonic_time();
+
+  g_assert(init != NULL);
+  g_assert(init->plugin != NULL);
+  g_assert(init->plugin->fs.ua_prepare != NULL);
+
+  ua_memory_attach_thread();
+  (void) ua_memory_set_owner(init->plugin->mem_owner);
+
+  init->prepared =
+          init->plugin->fs.ua_prepare(&init->ctx->logger,
+                                      (gpointer *) &init->ctx->plugin_params,
+                                      &init->err);
+  record_startup(init, "prepare", start);
+
+  /* the plugin is created from the main loop as soon as it is prepared */
+  g_idle_add(create_ua_plugin_cb, init);
+
+  return NULL;
+}
+
+/* loads a plugin and starts its preparation in a thread of its own */
 static void
-init_ua_plugin(gpointer data, gpointer user_data)
+start_ua_plugin(gpointer data, gpointer user_data)
 {
   gchar *name = (gchar *) data;
   app_context_t *ctx = (app_context_t *) user_data;
+  plugin_init_t *init;
   opc_plugin_t *plugin;
+  gchar *owner;
   GError *lerr = NULL;
 
   g_assert(name != NULL);
   g_assert(ctx != NULL);
 
+  if (is_plugin_disabled(ctx, name)) {
+    LOG_I(&ctx->logger, "Plugin '%s' is disabled", name);
+    return;
+  }
+
   plugin = plugin_load(name, &ctx->logger, &lerr);
 
   if (plugin == NULL) {
@@ -104,17 +225,332 @@ init_ua_plugin(gpointer data, gpointer user_data)
     return;
   }
 
-  if (!plugin->fs.ua_create(ctx->server, &ctx->logger, NULL, &lerr)) {
+  init = g_new0(plugin_init_t, 1);
+  init->ctx = ctx;
+  init->name = g_strdup(name);
+  init->plugin = plugin;
+  owner = get_metric_name(init);
+  plugin->mem_owner = ua_memory_get_owner_id(owner);
+  g_free(owner);
+  ctx->pending_plugins = g_slist_append(ctx->pending_plugins, init);
+
+  if (plugin->fs.ua_prepare == NULL) {
+    init->prepared = TRUE;
+    g_idle_add(create_ua_plugin_cb, init);
+  } else {
+    init->thread = g_thread_new("opc_ua_prepare", prepare_ua_plugin, init);
+  }
+}
+
+/* a #ua_queue_func_t calling the constructor of a plugin */
+static void
+create_ua_plugin(UA_Server *server, gpointer data)
+{
+  plugin_init_t *init = data;
+  gint64 start = g_get_monotonic_time();
+  guint owner;
+
+  g_assert(server != NULL);
+  g_assert(init != NULL);
+
+  /* the nodes of the plugin are accounted to it */
+  owner = ua_memory_set_owner(init->plugin->mem_owner);
+  init->created =
+          init->plugin->fs.ua_create(server,
+                                     &init->ctx->logger,
+                                     (gpointer *) &init->ctx->plugin_params,
+                                     &init->err);
+  (void) ua_memory_set_owner(owner);
+  record_startup(init, "create", start);
+}
+
+/* moves a plugin to the list of the loaded ones, which are all destroyed on
+ * exit whether they were created or not */
+static void
+finish_ua_plugin(plugin_init_t *init)
+{
+  app_context_t *ctx;
+
+  g_assert(init != NULL);
+
+  ctx = init->ctx;
+
+  if (init->thread != NULL) {
+    g_thread_join(init->thread);
+    init->thread = NULL;
+  }
+
+  ctx->plugins = g_slist_append(ctx->plugins, init->plugin);
+
+  g_clear_error(&init->err);
+  g_free(init->name);
+  g_free(init);
+}
+
+/* a plugin being removed from the address space */
+typedef struct {
+  opc_plugin_t *plugin;
+  gboolean removed;
+  GError *err;
+} plugin_remove_t;
+
+/* a #ua_queue_func_t calling the removal of a plugin */
+static void
+remove_ua_plugin(UA_Server *server, gpointer data)
+{
+  plugin_remove_t *rm = data;
+  guint owner;
+
+  g_assert(server != NULL);
+  g_assert(rm != NULL);
+
+  owner = ua_memory_set_owner(rm->plugin->mem_owner);
+  rm->removed = rm->plugin->fs.ua_remove(server, &rm->err);
+  (void) ua_memory_set_owner(owner);
+}
+
+/* removes a loaded plugin from the address space, destroys and unloads it
+ * while the server keeps running. A created plugin which can't be removed
+ * stays loaded until the application exits */
+static gboolean
+unload_ua_plugin(app_context_t *ctx, opc_plugin_t *p)
+{
+  plugin_remove_t rm = { .plugin = p };
+  GError *lerr = NULL;
+
+  g_assert(ctx != NULL);
+  g_assert(p != NULL);
+
+  if (p->created) {
+    if (p->fs.ua_remove == NULL) {
+      LOG_W(&ctx->logger,
+            "Plugin '%s' can't be unloaded at runtime, it is unloaded on "
+            "restart",
+            p->fs.ua_get_plugin_name());
+      return FALSE;
+    }
+
+    /* the commands the plugin queued run while its nodes are still there, no
+     * tick can queue more as the main loop is held until the plugin is
+     * removed */
+    if (!ua_server_sync(ctx, &lerr)) {
+      LOG_E(&ctx->logger,
+            "Failed to unload plugin '%s': ua_server_sync() failed: %s",
+            p->fs.ua_get_plugin_name(),
+            GERROR_MSG(lerr));
+      g_clear_error(&lerr);
+      return FALSE;
+    }
+
+    if (!ua_server_call_exclusive(ctx, remove_ua_plugin, &rm, &lerr)) {
+      LOG_E(&ctx->logger,
+            "Failed to unload plugin '%s': ua_server_call_exclusive() "
+            "failed: %s",
+            p->fs.ua_get_plugin_name(),
+            GERROR_MSG(lerr));
+      g_clear_error(&lerr);
+      return FALSE;
+    }
+    if (!rm.removed) {
+      /* some of its nodes may still refer to the plugin */
+      LOG_E(&ctx->logger,
+            "Failed to unload plugin '%s': %s",
+            p->fs.ua_get_plugin_name(),
+            GERROR_MSG(rm.err));
+      g_clear_error(&rm.err);
+      return FALSE;
+    }
+    p->created = FALSE;
+  }
+
+  LOG_I(&ctx->logger, "Unload plugin '%s'", p->fs.ua_get_plugin_name());
+
+  /* the nodes whose data sources may wake the client are gone, the plugin
+   * keeps using the client until it is destroyed */
+  p->fs.ua_destroy();
+  g_clear_pointer(&p->sched_client, ua_sched_remove);
+
+  ctx->plugins = g_slist_remove(ctx->plugins, p);
+  plugin_unload(p, &ctx->logger);
+
+  return TRUE;
+}
+
+/* hands the periodic work of a created plugin to the scheduler, which aligns
+ * its wakeups with those of the other plugins */
+static void
+start_ticks(plugin_init_t *init)
+{
+  gchar *name;
+
+  g_assert(init != NULL);
+  g_assert(init->ctx->sched != NULL);
+
+  if (init->plugin->fs.ua_tick == NULL) {
+    return;
+  }
+
+  name = get_metric_name(init);
+  init->plugin->sched_client =
+          ua_sched_add(init->ctx->sched, name, init->plugin->fs.ua_tick);
+  g_free(name);
+}
+
+/* creates a plugin from the main loop once it is prepared, the server may be
+ * serving its clients already */
+static gboolean
+create_ua_plugin_cb(gpointer data)
+{
+  plugin_init_t *init = data;
+  app_context_t *ctx;
+  opc_plugin_t *plugin;
+  gboolean disabled;
+  GError *lerr = NULL;
+
+  g_assert(init != NULL);
+
+  ctx = init->ctx;
+  plugin = init->plugin;
+  ctx->pending_plugins = g_slist_remove(ctx->pending_plugins, init);
+  disabled = is_plugin_disabled(ctx, init->name);
+
+  if (disabled) {
+    LOG_I(&ctx->logger,
+          "Plugin '%s' got disabled while being prepared",
+          init->name);
+  } else if (!init->prepared) {
     LOG_E(&ctx->logger,
-          "Failed to create plugin '%s': %s",
-          name,
+          "Failed to prepare plugin '%s': %s",
+          init->name,
+          GERROR_MSG(init->err));
+  } else if (!ua_server_call_exclusive(ctx, create_ua_plugin, init, &lerr)) {
+    LOG_E(&ctx->logger,
+          "Failed to create plugin '%s': ua_server_call_exclusive() failed: "
+          "%s",
+          init->name,
           GERROR_MSG(lerr));
     g_clear_error(&lerr);
+  } else if (!init->created) {
+    LOG_E(&ctx->logger,
+          "Failed to create plugin '%s': %s",
+          init->name,
+          GERROR_MSG(init->err));
   } else {
-    LOG_I(&ctx->logger, "Loaded plugin: %s", plugin->fs.ua_get_plugin_name());
+    LOG_I(&ctx->logger,
+          "Loaded plugin: %s",
+          init->plugin->fs.ua_get_plugin_name());
+    init->plugin->created = TRUE;
+    start_ticks(init);
+  }
+
+  finish_ua_plugin(init);
+  if (disabled) {
+    (void) unload_ua_plugin(ctx, plugin);
   }
 
-  ctx->plugins = g_slist_append(ctx->plugins, plugin);
+  return G_SOURCE_REMOVE;
+}
+
+/* gives up on a plugin which isn't created yet when the application exits */
+static void
+abort_ua_plugin(gpointer data, G_GNUC_UNUSED gpointer user_data)
+{
+  plugin_init_t *init = data;
+
+  g_assert(init != NULL);
+
+  if (init->thread != NULL) {
+    g_thread_join(init->thread);
+    init->thread = NULL;
+  }
+
+  /* the creation is queued once the plugin is prepared */
+  (void) g_source_remove_by_user_data(init);
+
+  finish_ua_plugin(init);
+}
+
+/* a plugin is loaded or being prepared */
+static gboolean
+is_plugin_loaded(const app_context_t *ctx, const gchar *name)
+{
+  gchar *id;
+  gboolean loaded = FALSE;
+
+  g_assert(ctx != NULL);
+  g_assert(name != NULL);
+
+  id = plugin_get_id(name);
+  for (GSList *l = ctx->plugins; l != NULL && !loaded; l = l->next) {
+    gchar *other = plugin_get_id(((opc_plugin_t *) l->data)->filename);
+
+    loaded = g_strcmp0(id, other) == 0;
+    g_free(other);
+  }
+  for (GSList *l = ctx->pending_plugins; l != NULL && !loaded; l = l->next) {
+    gchar *other = plugin_get_id(((plugin_init_t *) l->data)->name);
+
+    loaded = g_strcmp0(id, other) == 0;
+    g_free(other);
+  }
+  g_free(id);
+
+  return loaded;
+}
+
+/* applies a change of 'DisabledPlugins': unloads the plugins disabled since
+ * and loads the ones enabled again. The plugins being prepared are dealt with
+ * once they are */
+static void
+update_ua_plugins(app_context_t *ctx)
+{
+  GSList *plugin_names;
+  GSList *next;
+
+  g_assert(ctx != NULL);
+
+  for (GSList *l = ctx->plugins; l != NULL; l = next) {
+    opc_plugin_t *p = l->data;
+
+    next = l->next;
+    if (is_plugin_disabled(ctx, p->filename)) {
+      (void) unload_ua_plugin(ctx, p);
+    }
+  }
+
+  plugin_names = plugin_get_names(&ctx->logger);
+  for (GSList *l = plugin_names; l != NULL; l = l->next) {
+    if (!is_plugin_loaded(ctx, l->data)) {
+      start_ua_plugin(l->data, ctx);
+    }
+  }
+  g_slist_free_full(plugin_names, g_free);
+}
+
+/* an #AXParameterCallback following the 'DisabledPlugins' parameter */
+static void
+disabled_plugins_cb(const gchar *name, const gchar *value, gpointer data)
+{
+  app_context_t *ctx = data;
+  const gchar *param;
+  GError *lerr = NULL;
+
+  g_assert(name != NULL);
+  g_assert(ctx != NULL);
+
+  /* the name may be qualified, e.g. "root.Opcpluginserver.DisabledPlugins" */
+  param = strrchr(name, '.');
+  param = param != NULL ? param + 1 : name;
+
+  if (!update_ua_parameter(ctx, param, value != NULL ? value : "", &lerr)) {
+    LOG_E(&ctx->logger,
+          "update_ua_parameter() failed: %s",
+          GERROR_MSG(lerr));
+    g_clear_error(&lerr);
+    return;
+  }
+
+  update_ua_plugins(ctx);
 }
 
 static gboolean
@@ -134,6 +570,15 @@ launch_ua_server(app_context_t *ctx)
     return FALSE;
   }
 
+  /* the clients may connect while the plugins are being set up */
+  ctx->ua_server_running = TRUE;
+  LOG_D(&ctx->logger, "Starting UA server on port %u ...", ctx->port);
+  if (!ua_server_run(ctx, &ctx->ua_server_thread_id)) {
+    LOG_E(&ctx->logger, "Failed to launch UA server!");
+    ctx->ua_server_running = FALSE;
+    return FALSE;
+  }
+
   /* Search the lib dir and load all opc-plugins */
   plugin_names = plugin_get_names(&ctx->logger);
 
@@ -142,18 +587,13 @@ launch_ua_server(app_context_t *ctx)
           "No plugins found... Starting the server without plugins");
     g_slist_free(plugin_names);
   } else {
-    g_slist_foreach(plugin_names, init_ua_plugin, ctx);
+    /* the plugins are prepared concurrently, their blocking VAPIX requests
+     * overlap, and each one is added to the address space, from the main
+     * loop, as soon as it is prepared */
+    g_slist_foreach(plugin_names, start_ua_plugin, ctx);
     g_slist_free_full(plugin_names, g_free);
   }
 
-  ctx->ua_server_running = TRUE;
-  LOG_D(&ctx->logger, "Starting UA server on port %u ...", ctx->port);
-  if (!ua_server_run(ctx, &ctx->ua_server_thread_id)) {
-    LOG_E(&ctx->logger, "Failed to launch UA server!");
-    ctx->ua_server_running = FALSE;
-    return FALSE;
-  }
-
   return TRUE;
 }
 
@@ -168,7 +608,9 @@ free_plugins(gpointer data, gpointer user_data)
 
   LOG_I(&ctx->logger, "Unload plugin '%s'", p->fs.ua_get_plugin_name());
 
+  /* the plugin keeps using its client until it is destroyed */
   p->fs.ua_destroy();
+  g_clear_pointer(&p->sched_client, ua_sched_remove);
 
   plugin_unload(p, &ctx->logger);
 }
@@ -180,6 +622,10 @@ cleanup(app_context_t *ctx)
 
   g_clear_pointer(&ctx->main_loop, g_main_loop_unref);
 
+  /* the plugins which never got created are destroyed with the others */
+  g_slist_foreach(ctx->pending_plugins, abort_ua_plugin, ctx);
+  g_clear_pointer(&ctx->pending_plugins, g_slist_free);
+
   if (ctx->ua_server_running) {
     /* flag the UA server that we want it to finish */
     ctx->ua_server_running = FALSE;
@@ -192,12 +638,35 @@ cleanup(app_context_t *ctx)
 
   } else if (ctx->server != NULL) {
     /* the server thread is not running but a UA_Server struct was allocated */
+    ua_queue_set_notify(ctx->plugin_params.queue, NULL, NULL);
     UA_Server_delete(ctx->server);
   }
 
+  /* pending VAPIX requests call back into the plugins, finish them first */
+  if (ctx->plugin_params.vapix != NULL) {
+    vapix_service_shutdown(ctx->plugin_params.vapix);
+  }
+
+  /* drop the commands which never reached the server while the plugins which
+   * queued them are still loaded */
+  if (ctx->plugin_params.queue != NULL) {
+    ua_queue_close(ctx->plugin_params.queue);
+  }
+
   g_slist_foreach(ctx->plugins, free_plugins, ctx);
   g_slist_free(ctx->plugins);
 
+  g_clear_pointer(&ctx->plugin_params.vapix, vapix_service_free);
+  g_clear_pointer(&ctx->plugin_params.queue, ua_queue_free);
+  g_clear_pointer(&ctx->sched, ua_sched_free);
+
+  /* every thread which could update them is gone */
+  ua_publish_clear();
+  ua_memory_clear();
+  ua_metrics_clear();
+
+  g_clear_pointer(&ctx->pubsub_address, g_free);
+  g_clear_pointer(&ctx->disabled_plugins, g_strfreev);
   ax_parameter_free(ctx->axparam);
 }
 
@@ -218,15 +687,57 @@ main(G_GNUC_UNUSED int argc, G_GNUC_UNUSED char **argv)
     goto err_out;
   }
 
+  /* before anything is allocated through open62541 */
+  if (ctx.memory_accounting && !ua_memory_setup(&lerr)) {
+    LOG_W(&ctx.logger,
+          "No memory accounting, ua_memory_setup() failed: %s",
+          GERROR_MSG(lerr));
+    g_clear_error(&lerr);
+  }
+
+  /* before any other thread logs */
+  if (ctx.async_logs &&
+      !ua_log_start_async(&ctx.logger, UA_LOG_CAPACITY, &lerr)) {
+    LOG_W(&ctx.logger,
+          "ua_log_start_async() failed, logging synchronously: %s",
+          GERROR_MSG(lerr));
+    g_clear_error(&lerr);
+  }
+
   LOG_I(&ctx.logger, "%s: Starting", APPNAME);
 
   init_signal_handlers(&ctx);
 
+  /* the plugins perform their asynchronous VAPIX requests from the main loop */
+  ctx.plugin_params.vapix =
+          vapix_service_new(NULL, VAPIX_MAX_CONNECTIONS, &lerr);
+  if (ctx.plugin_params.vapix == NULL) {
+    LOG_E(&ctx.logger, "vapix_service_new() failed: %s", GERROR_MSG(lerr));
+    g_clear_error(&lerr);
+    goto err_out;
+  }
+
+  ctx.plugin_params.queue = ua_queue_new(UA_QUEUE_CAPACITY);
+  ctx.sched = ua_sched_new(ctx.vapix_budget);
+
   if (!launch_ua_server(&ctx)) {
     LOG_E(&ctx.logger, "Failed to launch UA server");
     goto err_out;
   }
 
+  /* the plugins are loaded and unloaded as they are enabled and disabled */
+  if (!ax_parameter_register_callback(ctx.axparam,
+                                      "DisabledPlugins",
+                                      disabled_plugins_cb,
+                                      &ctx,
+                                      &lerr)) {
+    LOG_W(&ctx.logger,
+          "ax_parameter_register_callback() failed, 'DisabledPlugins' is "
+          "applied on restart: %s",
+          GERROR_MSG(lerr));
+    g_clear_error(&lerr);
+  }
+
   /* Main loop */
   ctx.main_loop = g_main_loop_new(NULL, FALSE);
   g_main_loop_run(ctx.main_loop);
@@ -238,6 +749,7 @@ err_out:
   cleanup(&ctx);
 
   LOG_I(&ctx.logger, "%s: Exiting", APPNAME);
+  ua_log_stop_async(&ctx.logger);
   close_syslog(&ctx);
 
   return retval;
@@ -33,6 +33,61 @@
 
 #include "plugin.h"
 
+/* sizing of the OPC-UA server selected with the 'ServerProfile' parameter */
+typedef enum {
+  SERVER_PROFILE_DEFAULT = 0, /* open62541 defaults */
+  SERVER_PROFILE_LOW_MEMORY,
+  SERVER_PROFILE_MANY_CLIENTS,
+  SERVER_PROFILE_LOW_LATENCY,
+  SERVER_PROFILE_LAST
+} server_profile_t;
+
+/* node store of the OPC-UA server selected with the 'Nodestore' parameter */
+typedef enum {
+  NODESTORE_HASHMAP = 0, /* open62541 default, O(1) lookups */
+  NODESTORE_ZIPTREE,     /* O(log n) lookups, no table to grow */
+  NODESTORE_LAST
+} nodestore_t;
+
+/* endpoints of the OPC-UA server selected with the 'Security' parameter */
+typedef enum {
+  SECURITY_NONE = 0, /* SecurityPolicy None only */
+  SECURITY_OPTIONAL, /* None and the signed and encrypted policies */
+  SECURITY_REQUIRED, /* signed and encrypted policies, None for discovery */
+  SECURITY_LAST
+} security_t;
+
+/* what is done with a client not keeping up with its subscriptions, selected
+ * with the 'SlowClientPolicy' parameter */
+typedef enum {
+  SLOW_CLIENT_DROP_OLDEST = 0, /* full queues drop their oldest notification */
+  SLOW_CLIENT_COALESCE,        /* one notification per monitored item */
+  SLOW_CLIENT_DISCONNECT,      /* the session is closed */
+  SLOW_CLIENT_LAST
+} slow_client_policy_t;
+
+/* caps of the queues the server keeps for the subscriptions of the clients */
+typedef struct {
+  guint queue_size;          /* notifications per monitored item */
+  guint retransmission_size; /* unacknowledged messages per subscription */
+  guint total_backlog;       /* unacknowledged messages, 0 for no cap */
+  slow_client_policy_t policy;
+} publish_limits_t;
+
+/* the URI in the server certificate has to be the application URI */
+#define UA_APPLICATION_URI "urn:axis.opcua.server"
+
+/* limits of the OPC-UA server, a limit set to 0 is taken from the profile */
+typedef struct {
+  guint max_sessions;
+  guint max_subscriptions_per_session;
+  guint max_monitored_items_per_subscription;
+  guint min_publishing_interval; /* milliseconds */
+  guint min_sampling_interval;   /* milliseconds */
+  guint chunk_size;              /* bytes, send and receive buffers */
+  guint max_message_size;        /* bytes */
+} server_limits_t;
+
 typedef struct {
   /* application main loop */
   GMainLoop *main_loop;
@@ -40,12 +95,33 @@ typedef struct {
   AXParameter *axparam;
   /* list of actively loaded OPC-UA plugins */
   GSList *plugins;
+  /* plugins loaded but not created yet, being prepared */
+  GSList *pending_plugins;
   /* an open62541 logger instance */
   UA_Logger logger;
   /* runtime logging level (user configurable parameter) */
   UA_LogLevel log_level;
   /* TCP listening port of the OPC-UA server (user configurable parameter) */
   guint port;
+  /* server profile and overrides of its limits (user configurable
+   * parameters) */
+  server_profile_t server_profile;
+  server_limits_t server_limits;
+  /* caps of the publish queues, see ua_publish_setup() (user configurable
+   * parameters) */
+  publish_limits_t publish_limits;
+  /* node store of the address space (user configurable parameter) */
+  nodestore_t nodestore;
+  /* security policies of the endpoints, see ua_security_setup(), whether
+   * client certificates are accepted without a trust list, and the longest
+   * lifetime in seconds granted to a secure channel token (user configurable
+   * parameters) */
+  security_t security;
+  gboolean accept_all_clients;
+  guint secure_channel_lifetime;
+  /* account the heap of open62541 to the plugins, see ua_memory_setup()
+   * (user configurable parameter) */
+  gboolean memory_accounting;
   /* an open62541 server instance */
   UA_Server *server;
   /* flag to signal the server thread to finish */
@@ -54,6 +130,26 @@ typedef struct {
   GThread *ua_server_thread_id;
   /* flag to extend the logs or not */
   gboolean extend_logs;
+  /* flag to write the logs from a thread of their own (user configurable
+   * parameter) */
+  gboolean async_logs;
+  /* publish the values of the plugins with OPC UA PubSub, to which address,
+   * as which PublisherId and every how many milliseconds (user configurable
+   * parameters) */
+  gboolean pubsub;
+  gchar *pubsub_address;
+  guint pubsub_publisher_id;
+  guint pubsub_interval;
+  /* VAPIX requests per second shared by the periodic work of all the
+   * plugins, 0 for no limit (user configurable parameter) */
+  guint vapix_budget;
+  /* ticks the plugins which have periodic work */
+  ua_sched_t *sched;
+  /* ids of the plugins not to load, e.g. "thermal" (user configurable
+   * parameter, applied at runtime) */
+  gchar **disabled_plugins;
+  /* services handed to the plugins */
+  ua_plugin_params_t plugin_params;
 } app_context_t;
 
 #endif /* __OPCUA_SERVER_H__ */
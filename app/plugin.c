@@ -26,11 +26,15 @@
 #include <gio/gio.h>
 #include <glib-unix.h>
 #include <glib.h>
+#include <string.h>
 
 #include "error.h"
 #include "log.h"
 #include "plugin.h"
 
+/* the file names of the plugins are the prefix, their id and ".so" */
+#define PLUGIN_FILE_PREFIX "libopcua_"
+
 DEFINE_GQUARK("plugin")
 
 GSList *
@@ -90,6 +94,26 @@ err_out:
   return plugin_names;
 }
 
+gchar *
+plugin_get_id(const gchar *plugin_name)
+{
+  gchar *basename;
+  const gchar *name;
+  gchar *id;
+
+  g_return_val_if_fail(plugin_name != NULL, NULL);
+
+  basename = g_path_get_basename(plugin_name);
+  name = basename;
+  if (g_str_has_prefix(name, PLUGIN_FILE_PREFIX)) {
+    name += strlen(PLUGIN_FILE_PREFIX);
+  }
+  id = g_strndup(name, strcspn(name, "."));
+  g_free(basename);
+
+  return id;
+}
+
 opc_plugin_t *
 plugin_load(const gchar *plugin_name, UA_Logger *logger, GError **err)
 {
@@ -126,6 +150,20 @@ plugin_load(const gchar *plugin_name, UA_Logger *logger, GError **err)
   g_module_symbol(p->module,
                   "opc_ua_get_plugin_name",
                   (gpointer *) &p->fs.ua_get_plugin_name);
+  /* optional */
+  if (!g_module_symbol(p->module,
+                       "opc_ua_prepare",
+                       (gpointer *) &p->fs.ua_prepare)) {
+    p->fs.ua_prepare = NULL;
+  }
+  if (!g_module_symbol(p->module, "opc_ua_tick", (gpointer *) &p->fs.ua_tick)) {
+    p->fs.ua_tick = NULL;
+  }
+  if (!g_module_symbol(p->module,
+                       "opc_ua_remove",
+                       (gpointer *) &p->fs.ua_remove)) {
+    p->fs.ua_remove = NULL;
+  }
 
   if (p->fs.ua_create == NULL || p->fs.ua_destroy == NULL ||
       p->fs.ua_get_plugin_name == NULL) {
@@ -23,7 +23,6 @@
  * SOFTWARE.
  */
 
-#include <curl/curl.h>
 #include <gio/gio.h>
 #include <glib.h>
 #include <jansson.h>
@@ -32,6 +31,9 @@
 #include "bdi_plugin.h"
 #include "error.h"
 #include "log.h"
+#include "plugin.h"
+#include "ua_cache.h"
+#include "ua_queue.h"
 #include "ua_utils.h"
 #include "vapix_utils.h"
 
@@ -44,6 +46,14 @@
 #define ERR_NO_NAME         "The " UA_PLUGIN_NAME " was not given a name"
 
 #define BASIC_DEVICE_INFO_CGI_ENDPOINT "basicdeviceinfo.cgi"
+#define BASIC_DEVICE_INFO_REQUEST                                              \
+  "{"                                                                          \
+  "  \"apiVersion\": \"1.3\","                                                 \
+  "  \"method\": \"getAllProperties\""                                         \
+  "}"
+
+/* name of the on-disk copy of the basic device information */
+#define BDI_CACHE_NAME "bdi"
 
 DEFINE_GQUARK(UA_PLUGIN_NAME)
 
@@ -54,57 +64,58 @@ typedef struct plugin {
   UA_UInt16 ns;
   /* an open62541 logger */
   UA_Logger *logger;
-  /* keep track of data that needs to be rolled back in case of failure */
+  /* keep track of data that needs to be rolled back in case of failure, or
+   * when the plugin is removed */
   rollback_data_t *rbd;
+  /* VAPIX service shared by all the plugins, owned by the server */
+  vapix_service_t *vapix;
+  /* the server the information model was added to, NULL until created */
+  UA_Server *server;
+  /* basic device information fetched before the plugin is created, then the
+   * values in the address space, only accessed from the main loop once the
+   * plugin is created */
+  GHashTable *device_info;
+  /* the device information was loaded from the cache and is revalidated over
+   * VAPIX once the plugin is created */
+  gboolean cached;
+  /* the BasicDeviceInfo object and its property nodes by name, only accessed
+   * from the OPC-UA server thread once the plugin is created */
+  UA_NodeId bdi_node;
+  GHashTable *nodes;
+  /* mutations of the address space, run by the OPC-UA server thread */
+  ua_queue_t *queue;
+  /* VAPIX account of the revalidation request */
+  vapix_session_t *vapix_h;
 } plugin_t;
 
+/* a property of the BasicDeviceInfo object to update, or to delete if
+ * 'value' is NULL */
+typedef struct bdi_update {
+  gchar *key;
+  gchar *value;
+} bdi_update_t;
+
 static plugin_t *plugin;
 
+/* parses a getAllProperties response into a hash table of the properties */
 static gboolean
-vapix_get_basic_device_information(GHashTable **bdi_hashtable, GError **err)
+parse_basic_device_information(const gchar *response,
+                               GHashTable **bdi_hashtable,
+                               GError **err)
 {
   gboolean retval = FALSE;
-  CURL *curl_h;
-  g_autofree gchar *credentials = NULL;
-  g_autofree gchar *response = NULL;
   json_error_t parse_error;
   json_t *json_response = NULL;
   const gchar *key;
   json_t *value;
   json_t *data;
   json_t *prop_list;
-  const gchar *request = "{"
-                         "  \"apiVersion\": \"1.3\","
-                         "  \"method\": \"getAllProperties\""
-                         "}";
 
+  g_assert(plugin != NULL);
+  g_assert(response != NULL);
   g_assert(bdi_hashtable != NULL);
   g_assert(err == NULL || *err == NULL);
 
-  curl_h = curl_easy_init();
-  if (curl_h == NULL) {
-    SET_ERROR(err, -1, "curl_easy_init failed");
-    goto out;
-  }
-
-  credentials = vapix_get_credentials("vapix-basicdeviceinfo-user", err);
-  if (credentials == NULL) {
-    g_prefix_error(err, "Failed to get the VAPIX credentials: ");
-    goto out;
-  }
-
-  response = vapix_request(curl_h,
-                           credentials,
-                           BASIC_DEVICE_INFO_CGI_ENDPOINT,
-                           HTTP_POST,
-                           JSON_data,
-                           request,
-                           err);
-  if (response == NULL) {
-    g_prefix_error(err, "Failed to get the basic device information: ");
-    goto out;
-  }
-
   json_response = json_loads(response, 0, &parse_error);
 
   if (json_response == NULL) {
@@ -145,14 +156,33 @@ vapix_get_basic_device_information(GHashTable **bdi_hashtable, GError **err)
   retval = TRUE;
 
 out:
-  g_clear_pointer(&response, g_free);
   g_clear_pointer(&json_response, json_decref);
 
-  if (curl_h != NULL) {
-    curl_easy_cleanup(curl_h);
+  return retval;
+}
+
+static gboolean
+vapix_get_basic_device_information(GHashTable **bdi_hashtable, GError **err)
+{
+  g_autofree gchar *response = NULL;
+
+  g_assert(plugin != NULL);
+  g_assert(plugin->vapix_h != NULL);
+  g_assert(bdi_hashtable != NULL);
+  g_assert(err == NULL || *err == NULL);
+
+  response = vapix_request(plugin->vapix_h,
+                           BASIC_DEVICE_INFO_CGI_ENDPOINT,
+                           HTTP_POST,
+                           JSON_data,
+                           BASIC_DEVICE_INFO_REQUEST,
+                           err);
+  if (response == NULL) {
+    g_prefix_error(err, "Failed to get the basic device information: ");
+    return FALSE;
   }
 
-  return retval;
+  return parse_basic_device_information(response, bdi_hashtable, err);
 }
 
 static gboolean
@@ -165,6 +195,7 @@ add_variable_to_object(UA_Server *server,
   UA_StatusCode retval;
   UA_VariableAttributes attr = UA_VariableAttributes_default;
   UA_String ua_value;
+  UA_NodeId *node_id;
 
   g_assert(server != NULL);
   g_assert(name != NULL);
@@ -172,6 +203,7 @@ add_variable_to_object(UA_Server *server,
   g_assert(err == NULL || *err == NULL);
   g_assert(plugin != NULL);
   g_assert(plugin->rbd != NULL);
+  g_assert(plugin->nodes != NULL);
 
   attr.accessLevel = UA_ACCESSLEVELMASK_READ;
   ua_value = UA_STRING(value);
@@ -180,6 +212,7 @@ add_variable_to_object(UA_Server *server,
   attr.displayName = UA_LOCALIZEDTEXT("en-US", name);
   attr.description = UA_LOCALIZEDTEXT("en-US", name);
 
+  node_id = UA_NodeId_new();
   retval =
           UA_Server_addVariableNode_rb(server,
                                        UA_NODEID_NUMERIC(plugin->ns, 0),
@@ -192,8 +225,9 @@ add_variable_to_object(UA_Server *server,
                                        attr,
                                        NULL,
                                        plugin->rbd,
-                                       NULL);
+                                       node_id);
   if (retval != UA_STATUSCODE_GOOD) {
+    UA_NodeId_delete(node_id);
     SET_ERROR(err,
               -1,
               "UA_Server_addVariableNode_rb() failed: %s",
@@ -201,6 +235,9 @@ add_variable_to_object(UA_Server *server,
     return FALSE;
   }
 
+  /* kept for the updates of the revalidation */
+  g_hash_table_replace(plugin->nodes, g_strdup(name), node_id);
+
   return TRUE;
 }
 
@@ -252,22 +289,17 @@ add_basic_device_info_data(UA_Server *server, UA_NodeId bdiNode, GError **err)
   GHashTableIter ht_iter;
   gpointer key;
   gpointer value;
-  gboolean retval = FALSE;
 
   g_assert(server != NULL);
   g_assert(plugin != NULL);
   g_assert(err == NULL || *err == NULL);
 
-  /* Fetch the available basic device information over vapix placing the
-   * result in a hash table */
-  if (!vapix_get_basic_device_information(&bdi_hashtable, err)) {
-    g_prefix_error(err, "vapix_get_basic_device_information() failed: ");
-    goto err_out;
-  }
+  /* fetched over VAPIX or loaded from the cache by plugin_prefetch() */
+  bdi_hashtable = plugin->device_info;
 
   if (bdi_hashtable == NULL) {
     SET_ERROR(err, -1, "vapix_get_basic_device_information(): emtpy result!");
-    goto err_out;
+    return FALSE;
   }
 
   LOG_D(plugin->logger,
@@ -284,16 +316,192 @@ add_basic_device_info_data(UA_Server *server, UA_NodeId bdiNode, GError **err)
                                 (gchar *) value,
                                 err)) {
       g_prefix_error(err, "add_variable_to_object() failed: ");
-      goto err_out;
+      return FALSE;
     }
   }
 
-  retval = TRUE;
+  return TRUE;
+}
 
-err_out:
-  g_hash_table_unref(bdi_hashtable);
+static void
+free_update(gpointer data)
+{
+  bdi_update_t *update = data;
 
-  return retval;
+  g_assert(update != NULL);
+
+  g_free(update->key);
+  g_free(update->value);
+  g_free(update);
+}
+
+/* runs in the OPC-UA server thread */
+static void
+update_property_cb(UA_Server *server, gpointer data)
+{
+  bdi_update_t *update = data;
+  UA_NodeId *node_id;
+  UA_Variant value;
+  UA_String ua_value;
+  UA_StatusCode ua_status;
+  GError *lerr = NULL;
+
+  g_assert(server != NULL);
+  g_assert(update != NULL);
+  g_assert(plugin != NULL);
+  g_assert(plugin->nodes != NULL);
+
+  node_id = g_hash_table_lookup(plugin->nodes, update->key);
+
+  if (update->value == NULL) {
+    if (node_id != NULL) {
+      ua_status = UA_Server_deleteNode(server, *node_id, TRUE);
+      if (ua_status != UA_STATUSCODE_GOOD) {
+        LOG_W(plugin->logger,
+              "Failed to delete the %s property: %s",
+              update->key,
+              UA_StatusCode_name(ua_status));
+      }
+      g_hash_table_remove(plugin->nodes, update->key);
+    }
+    return;
+  }
+
+  if (node_id == NULL) {
+    if (!add_variable_to_object(server,
+                                plugin->bdi_node,
+                                update->key,
+                                update->value,
+                                &lerr)) {
+      LOG_W(plugin->logger,
+            "Failed to add the %s property: %s",
+            update->key,
+            GERROR_MSG(lerr));
+      g_clear_error(&lerr);
+    }
+    return;
+  }
+
+  ua_value = UA_STRING(update->value);
+  UA_Variant_setScalar(&value, &ua_value, &UA_TYPES[UA_TYPES_STRING]);
+  ua_status = UA_Server_writeValue(server, *node_id, value);
+  if (ua_status != UA_STATUSCODE_GOOD) {
+    LOG_W(plugin->logger,
+          "Failed to update the %s property: %s",
+          update->key,
+          UA_StatusCode_name(ua_status));
+  }
+}
+
+static void
+push_update(const gchar *key, const gchar *value)
+{
+  bdi_update_t *update;
+  GError *lerr = NULL;
+
+  g_assert(plugin != NULL);
+  g_assert(plugin->queue != NULL);
+  g_assert(key != NULL);
+
+  LOG_I(plugin->logger,
+        "BasicDeviceInfo %s changed: %s",
+        key,
+        value != NULL ? value : "(removed)");
+
+  update = g_new0(bdi_update_t, 1);
+  update->key = g_strdup(key);
+  update->value = g_strdup(value);
+  if (!ua_queue_push(plugin->queue,
+                     update_property_cb,
+                     update,
+                     free_update,
+                     &lerr)) {
+    LOG_W(plugin->logger,
+          "Failed to update the %s property: %s",
+          key,
+          GERROR_MSG(lerr));
+    g_clear_error(&lerr);
+    free_update(update);
+  }
+}
+
+/* called from the main loop with the current basic device information, the
+ * properties which differ from the cached ones are updated */
+static void
+revalidate_done_cb(const gchar *response,
+                   const GError *err,
+                   G_GNUC_UNUSED gpointer user_data)
+{
+  GHashTable *device_info = NULL;
+  GHashTableIter ht_iter;
+  gpointer key;
+  gpointer value;
+  GError *lerr = NULL;
+
+  g_assert(plugin != NULL);
+  g_assert(plugin->device_info != NULL);
+
+  if (response == NULL) {
+    LOG_W(plugin->logger,
+          "Failed to revalidate the basic device information: %s",
+          GERROR_MSG(err));
+    return;
+  }
+
+  if (!parse_basic_device_information(response, &device_info, &lerr)) {
+    LOG_W(plugin->logger,
+          "Failed to revalidate the basic device information: %s",
+          GERROR_MSG(lerr));
+    g_clear_error(&lerr);
+    return;
+  }
+
+  g_hash_table_iter_init(&ht_iter, device_info);
+  while (g_hash_table_iter_next(&ht_iter, &key, &value)) {
+    if (g_strcmp0(g_hash_table_lookup(plugin->device_info, key), value) != 0) {
+      push_update(key, value);
+    }
+  }
+
+  g_hash_table_iter_init(&ht_iter, plugin->device_info);
+  while (g_hash_table_iter_next(&ht_iter, &key, NULL)) {
+    if (!g_hash_table_contains(device_info, key)) {
+      push_update(key, NULL);
+    }
+  }
+
+  if (!ua_cache_store(BDI_CACHE_NAME, device_info, &lerr)) {
+    LOG_W(plugin->logger, "ua_cache_store() failed: %s", GERROR_MSG(lerr));
+    g_clear_error(&lerr);
+  }
+
+  g_hash_table_unref(plugin->device_info);
+  plugin->device_info = device_info;
+}
+
+/* refreshes the basic device information loaded from the cache, without
+ * delaying the start up */
+static void
+revalidate_device_info(void)
+{
+  GError *lerr = NULL;
+
+  g_assert(plugin != NULL);
+  g_assert(plugin->vapix_h != NULL);
+
+  if (!vapix_request_async(plugin->vapix_h,
+                           BASIC_DEVICE_INFO_CGI_ENDPOINT,
+                           HTTP_POST,
+                           JSON_data,
+                           BASIC_DEVICE_INFO_REQUEST,
+                           revalidate_done_cb,
+                           NULL,
+                           &lerr)) {
+    LOG_W(plugin->logger,
+          "Failed to revalidate the basic device information: %s",
+          GERROR_MSG(lerr));
+    g_clear_error(&lerr);
+  }
 }
 
 static void
@@ -302,7 +510,11 @@ plugin_cleanup(void)
   g_assert(plugin != NULL);
 
   plugin->logger = NULL;
+  plugin->server = NULL;
   g_clear_pointer(&plugin->name, g_free);
+  g_clear_pointer(&plugin->device_info, g_hash_table_unref);
+  g_clear_pointer(&plugin->nodes, g_hash_table_unref);
+  g_clear_pointer(&plugin->vapix_h, vapix_session_free);
 
   /* free up allocated rollback data, if any */
   ua_utils_clear_rbd(&plugin->rbd);
@@ -310,47 +522,135 @@ plugin_cleanup(void)
   g_clear_pointer(&plugin, g_free);
 }
 
+/* allocates the plugin and loads the basic device information from the cache
+ * or else fetches it over VAPIX, blocking but without accessing the server */
+static gboolean
+plugin_prefetch(UA_Logger *logger,
+                ua_plugin_params_t *services,
+                GError **err)
+{
+  GError *lerr = NULL;
+
+  g_assert(plugin == NULL);
+  g_assert(logger != NULL);
+  g_assert(services != NULL);
+  g_assert(err == NULL || *err == NULL);
+
+  plugin = g_new0(plugin_t, 1);
+
+  plugin->name = g_strdup(UA_PLUGIN_NAME);
+  plugin->logger = logger;
+  plugin->rbd = g_new0(rollback_data_t, 1);
+  plugin->vapix = services->vapix;
+  plugin->queue = services->queue;
+  plugin->nodes = g_hash_table_new_full(g_str_hash,
+                                        g_str_equal,
+                                        g_free,
+                                        (GDestroyNotify) UA_NodeId_delete);
+
+  plugin->vapix_h =
+          vapix_session_new(plugin->vapix, "vapix-basicdeviceinfo-user", err);
+  if (plugin->vapix_h == NULL) {
+    g_prefix_error(err, "vapix_session_new() failed: ");
+    plugin_cleanup();
+    return FALSE;
+  }
+
+  /* the information only changes with the firmware, a cached copy is used
+   * right away and revalidated once the plugin is created */
+  plugin->device_info = ua_cache_load(BDI_CACHE_NAME, &lerr);
+  if (plugin->device_info != NULL) {
+    plugin->cached = TRUE;
+    return TRUE;
+  }
+  LOG_D(plugin->logger, "ua_cache_load() failed: %s", GERROR_MSG(lerr));
+  g_clear_error(&lerr);
+
+  /* Fetch the available basic device information over vapix placing the
+   * result in a hash table */
+  if (!vapix_get_basic_device_information(&plugin->device_info, err)) {
+    g_prefix_error(err, "vapix_get_basic_device_information() failed: ");
+    plugin_cleanup();
+    return FALSE;
+  }
+
+  if (!ua_cache_store(BDI_CACHE_NAME, plugin->device_info, &lerr)) {
+    LOG_W(plugin->logger, "ua_cache_store() failed: %s", GERROR_MSG(lerr));
+    g_clear_error(&lerr);
+  }
+
+  return TRUE;
+}
+
 /* Exported functions */
+gboolean
+opc_ua_prepare(UA_Logger *logger, gpointer *params, GError **err)
+{
+  ua_plugin_params_t *services = (ua_plugin_params_t *) params;
+
+  g_return_val_if_fail(logger != NULL, FALSE);
+  g_return_val_if_fail(services != NULL, FALSE);
+  g_return_val_if_fail(services->vapix != NULL, FALSE);
+  g_return_val_if_fail(err == NULL || *err == NULL, FALSE);
+
+  if (plugin != NULL) {
+    return TRUE;
+  }
+
+  if (!plugin_prefetch(logger, services, err)) {
+    g_prefix_error(err, "plugin_prefetch() failed: ");
+    return FALSE;
+  }
+
+  return TRUE;
+}
+
 gboolean
 opc_ua_create(UA_Server *server,
               UA_Logger *logger,
-              G_GNUC_UNUSED gpointer *params,
+              gpointer *params,
               GError **err)
 {
+  ua_plugin_params_t *services = (ua_plugin_params_t *) params;
   GError *lerr = NULL;
-  UA_NodeId bdi_node;
 
   g_return_val_if_fail(server != NULL, FALSE);
   g_return_val_if_fail(logger != NULL, FALSE);
+  g_return_val_if_fail(services != NULL, FALSE);
+  g_return_val_if_fail(services->vapix != NULL, FALSE);
+  g_return_val_if_fail(services->queue != NULL, FALSE);
   g_return_val_if_fail(err == NULL || *err == NULL, FALSE);
 
-  if (plugin != NULL) {
+  if (plugin != NULL && plugin->server != NULL) {
     return TRUE;
   }
 
-  plugin = g_new0(plugin_t, 1);
-
-  plugin->name = g_strdup(UA_PLUGIN_NAME);
-  plugin->logger = logger;
-  plugin->rbd = g_new0(rollback_data_t, 1);
+  /* unless already done by opc_ua_prepare() */
+  if (plugin == NULL && !plugin_prefetch(logger, services, err)) {
+    g_prefix_error(err, "plugin_prefetch() failed: ");
+    return FALSE;
+  }
 
+  plugin->server = server;
   plugin->ns = UA_Server_addNamespace(server, UA_PLUGIN_NAMESPACE);
 
   /* add a bdi object to the opc-ua server */
-  if (!add_bdi_object(server, &bdi_node, err)) {
+  if (!add_bdi_object(server, &plugin->bdi_node, err)) {
     g_prefix_error(err, "add_bdi_object() failed: ");
     goto err_out;
   }
 
   /* add the actual values to the nodes */
-  if (!add_basic_device_info_data(server, bdi_node, err)) {
+  if (!add_basic_device_info_data(server, plugin->bdi_node, err)) {
     g_prefix_error(err, "add_basic_device_info_data() failed: ");
     goto err_out;
   }
 
-  /* the information model was successfully populated so now we can free up our
-   * rollback data since we no longer need it */
-  ua_utils_clear_rbd(&plugin->rbd);
+  if (plugin->cached) {
+    revalidate_device_info();
+  }
+
+  /* the rollback data is kept, opc_ua_remove() deletes the nodes it lists */
 
   return TRUE;
 
@@ -367,6 +667,25 @@ err_out:
   return FALSE;
 }
 
+gboolean
+opc_ua_remove(UA_Server *server, GError **err)
+{
+  g_return_val_if_fail(server != NULL, FALSE);
+  g_return_val_if_fail(err == NULL || *err == NULL, FALSE);
+
+  if (plugin == NULL || plugin->rbd == NULL) {
+    return TRUE;
+  }
+
+  if (!ua_utils_do_rollback(server, plugin->rbd, err)) {
+    g_prefix_error(err, "ua_utils_do_rollback() failed: ");
+    return FALSE;
+  }
+  ua_utils_clear_rbd(&plugin->rbd);
+
+  return TRUE;
+}
+
 void
 opc_ua_destroy(void)
 {
@@ -0,0 +1,544 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2025 Axis Communications AB
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <glib.h>
+#include <open62541/server.h>
+
+#include "diagnostics_plugin.h"
+#include "error.h"
+#include "log.h"
+#include "ua_metrics.h"
+#include "ua_utils.h"
+
+#define UA_PLUGIN_NAMESPACE "http://www.axis.com/OpcUA/Diagnostics/"
+#define UA_PLUGIN_NAME      "opc-diagnostics-plugin"
+#define UA_DISPLAY_NAME     "Diagnostics"
+#define UA_DESCRIPTION      "Server and VAPIX metrics"
+#define BUCKET_BOUNDS_BNAME "BucketBounds"
+
+#define ERR_NOT_INITIALIZED "The " UA_PLUGIN_NAME " is not initialized"
+#define ERR_NO_NAME         "The " UA_PLUGIN_NAME " was not given a name"
+
+/* how often the metrics registered meanwhile are added, in milliseconds */
+#define DIAG_PUBLISH_INTERVAL 1000.0
+
+#define DIAG_TYPE(type) (1u << (type))
+
+DEFINE_GQUARK(UA_PLUGIN_NAME)
+
+/* the variables of a metric object */
+typedef enum {
+  DIAG_FIELD_COUNT = 0,
+  DIAG_FIELD_TOTAL_TIME,
+  DIAG_FIELD_MAX_TIME,
+  DIAG_FIELD_HISTOGRAM,
+  DIAG_FIELD_VALUE,
+  DIAG_NBR_OF_FIELDS
+} diag_field_t;
+
+/* node context of a metric variable */
+typedef struct diag_var {
+  const ua_metric_t *metric;
+  diag_field_t field;
+} diag_var_t;
+
+typedef struct diag_field_desc {
+  const gchar *name;
+  const gchar *description;
+  /* DIAG_TYPE() mask of the metric types having the variable */
+  guint types;
+  guint value_type;
+  UA_Int32 value_rank;
+} diag_field_desc_t;
+
+typedef struct plugin {
+  /* user-friendly name of the plugin */
+  gchar *name;
+  /* OPC-UA namespace index */
+  UA_UInt16 ns;
+  /* an open62541 logger */
+  UA_Logger *logger;
+  /* keep track of data that needs to be rolled back in case of failure, or
+   * when the plugin is removed */
+  rollback_data_t *rbd;
+  /* node id of the diagnostics object */
+  UA_NodeId diag_obj;
+  /* number of metrics of the registry added to the address space */
+  guint nr_published;
+  /* diag_var_t arrays of the published metrics, only accessed from the
+   * OPC-UA server thread */
+  GPtrArray *vars;
+  /* the server callback publishing the metrics */
+  UA_UInt64 publish_cb_id;
+} plugin_t;
+
+static plugin_t *plugin;
+
+static const diag_field_desc_t diag_fields[DIAG_NBR_OF_FIELDS] = {
+  [DIAG_FIELD_COUNT] = { "Count",
+                         "Number of events or samples",
+                         DIAG_TYPE(UA_METRIC_COUNTER) |
+                                 DIAG_TYPE(UA_METRIC_TIMING),
+                         UA_TYPES_UINT64,
+                         UA_VALUERANK_SCALAR },
+  [DIAG_FIELD_TOTAL_TIME] = { "TotalTime",
+                              "Sum of the samples in microseconds",
+                              DIAG_TYPE(UA_METRIC_TIMING),
+                              UA_TYPES_UINT64,
+                              UA_VALUERANK_SCALAR },
+  [DIAG_FIELD_MAX_TIME] = { "MaxTime",
+                            "Longest sample in microseconds",
+                            DIAG_TYPE(UA_METRIC_TIMING),
+                            UA_TYPES_UINT64,
+                            UA_VALUERANK_SCALAR },
+  [DIAG_FIELD_HISTOGRAM] = { "Histogram",
+                             "Number of samples up to each of the "
+                             "BucketBounds",
+                             DIAG_TYPE(UA_METRIC_TIMING),
+                             UA_TYPES_UINT64,
+                             UA_VALUERANK_ONE_DIMENSION },
+  [DIAG_FIELD_VALUE] = { "Value",
+                         "Current value",
+                         DIAG_TYPE(UA_METRIC_GAUGE),
+                         UA_TYPES_INT64,
+                         UA_VALUERANK_SCALAR },
+};
+
+/* Local functions */
+
+/* called from the OPC-UA server thread, the metric is summed up over the
+ * threads updating it on every read */
+static UA_StatusCode
+diag_read_cb(G_GNUC_UNUSED UA_Server *server,
+             G_GNUC_UNUSED const UA_NodeId *sessionId,
+             G_GNUC_UNUSED void *sessionContext,
+             G_GNUC_UNUSED const UA_NodeId *nodeId,
+             void *nodeContext,
+             UA_Boolean includeSourceTimeStamp,
+             const UA_NumericRange *range,
+             UA_DataValue *value)
+{
+  diag_var_t *var = (diag_var_t *) nodeContext;
+  ua_metric_value_t snapshot;
+  UA_StatusCode status;
+
+  g_assert(var != NULL);
+  g_assert(value != NULL);
+
+  if (range != NULL) {
+    value->hasStatus = true;
+    value->status = UA_STATUSCODE_BADINDEXRANGEINVALID;
+    return UA_STATUSCODE_GOOD;
+  }
+
+  ua_metric_read(var->metric, &snapshot);
+
+  switch (var->field) {
+  case DIAG_FIELD_COUNT:
+    status = UA_Variant_setScalarCopy(&value->value,
+                                      &snapshot.count,
+                                      &UA_TYPES[UA_TYPES_UINT64]);
+    break;
+  case DIAG_FIELD_TOTAL_TIME:
+    status = UA_Variant_setScalarCopy(&value->value,
+                                      &snapshot.sum,
+                                      &UA_TYPES[UA_TYPES_UINT64]);
+    break;
+  case DIAG_FIELD_MAX_TIME:
+    status = UA_Variant_setScalarCopy(&value->value,
+                                      &snapshot.max,
+                                      &UA_TYPES[UA_TYPES_UINT64]);
+    break;
+  case DIAG_FIELD_HISTOGRAM:
+    status = UA_Variant_setArrayCopy(&value->value,
+                                     snapshot.buckets,
+                                     UA_METRICS_NR_BUCKETS,
+                                     &UA_TYPES[UA_TYPES_UINT64]);
+    break;
+  case DIAG_FIELD_VALUE:
+    status = UA_Variant_setScalarCopy(&value->value,
+                                      &snapshot.value,
+                                      &UA_TYPES[UA_TYPES_INT64]);
+    break;
+  default:
+    status = UA_STATUSCODE_BADINTERNALERROR;
+    break;
+  }
+
+  if (status != UA_STATUSCODE_GOOD) {
+    return status;
+  }
+  value->hasValue = true;
+
+  if (includeSourceTimeStamp) {
+    value->hasSourceTimestamp = true;
+    value->sourceTimestamp = UA_DateTime_now();
+  }
+
+  return UA_STATUSCODE_GOOD;
+}
+
+/* adds an object named after the metric with one variable per field of its
+ * type */
+static gboolean
+add_metric_node(UA_Server *server, const ua_metric_t *metric, GError **err)
+{
+  UA_StatusCode status;
+  UA_ObjectAttributes oattr = UA_ObjectAttributes_default;
+  UA_VariableAttributes vattr;
+  UA_DataSource source = { .read = diag_read_cb, .write = NULL };
+  UA_UInt32 dimensions = UA_METRICS_NR_BUCKETS;
+  UA_NodeId metric_obj;
+  diag_var_t *vars;
+  const gchar *name;
+  guint type;
+
+  g_assert(plugin != NULL);
+  g_assert(server != NULL);
+  g_assert(metric != NULL);
+  g_assert(err == NULL || *err == NULL);
+
+  name = ua_metric_get_name(metric);
+  type = DIAG_TYPE(ua_metric_get_type(metric));
+
+  oattr.displayName = UA_LOCALIZEDTEXT("en-US", (gchar *) name);
+  oattr.description = UA_LOCALIZEDTEXT("en-US", (gchar *) name);
+
+  status = UA_Server_addObjectNode(server,
+                                   UA_NODEID_NUMERIC(plugin->ns, 0),
+                                   plugin->diag_obj,
+                                   UA_NODEID_NUMERIC(0, UA_NS0ID_HASCOMPONENT),
+                                   UA_QUALIFIEDNAME(plugin->ns, (gchar *) name),
+                                   UA_NODEID_NUMERIC(0,
+                                                     UA_NS0ID_BASEOBJECTTYPE),
+                                   oattr,
+                                   NULL,
+                                   &metric_obj);
+  if (status != UA_STATUSCODE_GOOD) {
+    SET_ERROR(err,
+              -1,
+              "UA_Server_addObjectNode() failed: %s",
+              UA_StatusCode_name(status));
+    return FALSE;
+  }
+
+  /* owned by the plugin, the server only references them */
+  vars = g_new0(diag_var_t, DIAG_NBR_OF_FIELDS);
+  g_ptr_array_add(plugin->vars, vars);
+
+  for (gint i = 0; i < DIAG_NBR_OF_FIELDS; i++) {
+    const diag_field_desc_t *desc = &diag_fields[i];
+
+    if ((desc->types & type) == 0) {
+      continue;
+    }
+
+    vars[i].metric = metric;
+    vars[i].field = (diag_field_t) i;
+
+    vattr = UA_VariableAttributes_default;
+    vattr.accessLevel = UA_ACCESSLEVELMASK_READ;
+    vattr.dataType = UA_TYPES[desc->value_type].typeId;
+    vattr.valueRank = desc->value_rank;
+    if (desc->value_rank == UA_VALUERANK_ONE_DIMENSION) {
+      vattr.arrayDimensionsSize = 1;
+      vattr.arrayDimensions = &dimensions;
+    }
+    vattr.displayName = UA_LOCALIZEDTEXT("en-US", (gchar *) desc->name);
+    vattr.description = UA_LOCALIZEDTEXT("en-US", (gchar *) desc->description);
+
+    status = UA_Server_addDataSourceVariableNode(
+            server,
+            UA_NODEID_NUMERIC(plugin->ns, 0),
+            metric_obj,
+            UA_NODEID_NUMERIC(0, UA_NS0ID_HASCOMPONENT),
+            UA_QUALIFIEDNAME(plugin->ns, (gchar *) desc->name),
+            UA_NODEID_NUMERIC(0, UA_NS0ID_BASEDATAVARIABLETYPE),
+            vattr,
+            source,
+            &vars[i],
+            NULL);
+    if (status != UA_STATUSCODE_GOOD) {
+      SET_ERROR(err,
+                -1,
+                "Failed to add variable %s: %s",
+                desc->name,
+                UA_StatusCode_name(status));
+      UA_NodeId_clear(&metric_obj);
+      return FALSE;
+    }
+  }
+
+  UA_NodeId_clear(&metric_obj);
+
+  return TRUE;
+}
+
+/* adds the metrics registered since the previous call */
+static gboolean
+publish_metrics(UA_Server *server, GError **err)
+{
+  ua_metric_t *metric;
+  guint size;
+
+  g_assert(plugin != NULL);
+  g_assert(server != NULL);
+  g_assert(err == NULL || *err == NULL);
+
+  size = ua_metrics_get_size();
+  while (plugin->nr_published < size) {
+    metric = ua_metrics_get_nth(plugin->nr_published);
+    /* a metric which can't be added isn't retried on every period */
+    plugin->nr_published++;
+
+    if (!add_metric_node(server, metric, err)) {
+      g_prefix_error(err,
+                     "add_metric_node(%s) failed: ",
+                     ua_metric_get_name(metric));
+      return FALSE;
+    }
+  }
+
+  return TRUE;
+}
+
+/* a repeated callback of the server, most metrics are registered lazily, e.g.
+ * the one of a VAPIX endpoint on its first request */
+static void
+publish_metrics_cb(UA_Server *server, G_GNUC_UNUSED void *data)
+{
+  GError *lerr = NULL;
+
+  g_assert(plugin != NULL);
+
+  if (!publish_metrics(server, &lerr)) {
+    LOG_W(plugin->logger, "publish_metrics() failed: %s", GERROR_MSG(lerr));
+    g_clear_error(&lerr);
+  }
+}
+
+static gboolean
+add_diagnostics_object(UA_Server *server, GError **err)
+{
+  UA_StatusCode status;
+  UA_ObjectAttributes oattr = UA_ObjectAttributes_default;
+  UA_VariableAttributes vattr = UA_VariableAttributes_default;
+  UA_UInt32 dimensions = UA_METRICS_NR_BUCKETS;
+
+  g_assert(plugin != NULL);
+  g_assert(plugin->rbd != NULL);
+  g_assert(server != NULL);
+  g_assert(err == NULL || *err == NULL);
+
+  oattr.displayName = UA_LOCALIZEDTEXT("en-US", UA_DISPLAY_NAME);
+  oattr.description = UA_LOCALIZEDTEXT("en-US", UA_DESCRIPTION);
+
+  status = UA_Server_addObjectNode_rb(
+          server,
+          UA_NODEID_STRING(plugin->ns, UA_DISPLAY_NAME),
+          UA_NODEID_NUMERIC(0, UA_NS0ID_OBJECTSFOLDER),
+          UA_NODEID_NUMERIC(0, UA_NS0ID_ORGANIZES),
+          UA_QUALIFIEDNAME(plugin->ns, UA_DISPLAY_NAME),
+          UA_NODEID_NUMERIC(0, UA_NS0ID_BASEOBJECTTYPE),
+          oattr,
+          NULL,
+          plugin->rbd,
+          &plugin->diag_obj);
+  if (status != UA_STATUSCODE_GOOD) {
+    SET_ERROR(err,
+              -1,
+              "Failed to add object node %s: %s",
+              UA_DISPLAY_NAME,
+              UA_StatusCode_name(status));
+    return FALSE;
+  }
+
+  /* the bounds are constant, the server keeps a copy of them */
+  vattr.accessLevel = UA_ACCESSLEVELMASK_READ;
+  vattr.dataType = UA_TYPES[UA_TYPES_UINT64].typeId;
+  vattr.valueRank = UA_VALUERANK_ONE_DIMENSION;
+  vattr.arrayDimensionsSize = 1;
+  vattr.arrayDimensions = &dimensions;
+  UA_Variant_setArray(&vattr.value,
+                      (gpointer) ua_metrics_get_bucket_bounds(),
+                      UA_METRICS_NR_BUCKETS,
+                      &UA_TYPES[UA_TYPES_UINT64]);
+  vattr.displayName = UA_LOCALIZEDTEXT("en-US", BUCKET_BOUNDS_BNAME);
+  vattr.description =
+          UA_LOCALIZEDTEXT("en-US",
+                           "Upper bounds of the histogram buckets in "
+                           "microseconds");
+
+  status = UA_Server_addVariableNode_rb(
+          server,
+          UA_NODEID_NUMERIC(plugin->ns, 0),
+          plugin->diag_obj,
+          UA_NODEID_NUMERIC(0, UA_NS0ID_HASPROPERTY),
+          UA_QUALIFIEDNAME(plugin->ns, BUCKET_BOUNDS_BNAME),
+          UA_NODEID_NUMERIC(0, UA_NS0ID_PROPERTYTYPE),
+          vattr,
+          NULL,
+          plugin->rbd,
+          NULL);
+  if (status != UA_STATUSCODE_GOOD) {
+    SET_ERROR(err,
+              -1,
+              "Failed to add variable node %s: %s",
+              BUCKET_BOUNDS_BNAME,
+              UA_StatusCode_name(status));
+    return FALSE;
+  }
+
+  return TRUE;
+}
+
+static void
+plugin_cleanup(void)
+{
+  g_assert(plugin != NULL);
+
+  plugin->logger = NULL;
+  g_clear_pointer(&plugin->name, g_free);
+  UA_NodeId_clear(&plugin->diag_obj);
+  g_clear_pointer(&plugin->vars, g_ptr_array_unref);
+
+  /* free up allocated rollback data, if any */
+  ua_utils_clear_rbd(&plugin->rbd);
+
+  g_clear_pointer(&plugin, g_free);
+}
+
+/* Exported functions */
+gboolean
+opc_ua_create(UA_Server *server,
+              UA_Logger *logger,
+              G_GNUC_UNUSED gpointer *params,
+              GError **err)
+{
+  UA_StatusCode status;
+  GError *lerr = NULL;
+
+  g_return_val_if_fail(server != NULL, FALSE);
+  g_return_val_if_fail(logger != NULL, FALSE);
+  g_return_val_if_fail(err == NULL || *err == NULL, FALSE);
+
+  if (plugin != NULL) {
+    return TRUE;
+  }
+
+  plugin = g_new0(plugin_t, 1);
+
+  plugin->name = g_strdup(UA_PLUGIN_NAME);
+  plugin->logger = logger;
+  plugin->rbd = g_new0(rollback_data_t, 1);
+  plugin->vars = g_ptr_array_new_with_free_func(g_free);
+
+  plugin->ns = UA_Server_addNamespace(server, UA_PLUGIN_NAMESPACE);
+
+  if (!add_diagnostics_object(server, err)) {
+    g_prefix_error(err, "add_diagnostics_object() failed: ");
+    goto err_out;
+  }
+
+  /* the rollback of the diagnostics object also removes the metrics */
+  if (!publish_metrics(server, err)) {
+    g_prefix_error(err, "publish_metrics() failed: ");
+    goto err_out;
+  }
+
+  /* removed by opc_ua_remove(), or along with the server which is deleted
+   * before the plugins are destroyed */
+  status = UA_Server_addRepeatedCallback(server,
+                                         publish_metrics_cb,
+                                         NULL,
+                                         DIAG_PUBLISH_INTERVAL,
+                                         &plugin->publish_cb_id);
+  if (status != UA_STATUSCODE_GOOD) {
+    SET_ERROR(err,
+              -1,
+              "UA_Server_addRepeatedCallback() failed: %s",
+              UA_StatusCode_name(status));
+    goto err_out;
+  }
+
+  /* the rollback data is kept, opc_ua_remove() deletes the nodes it lists */
+
+  return TRUE;
+
+err_out:
+  if (!ua_utils_do_rollback(server, plugin->rbd, &lerr)) {
+    LOG_E(plugin->logger,
+          "ua_utils_do_rollback() failed: %s",
+          GERROR_MSG(lerr));
+    g_clear_error(&lerr);
+  }
+
+  plugin_cleanup();
+
+  return FALSE;
+}
+
+gboolean
+opc_ua_remove(UA_Server *server, GError **err)
+{
+  g_return_val_if_fail(server != NULL, FALSE);
+  g_return_val_if_fail(err == NULL || *err == NULL, FALSE);
+
+  if (plugin == NULL || plugin->rbd == NULL) {
+    return TRUE;
+  }
+
+  UA_Server_removeRepeatedCallback(server, plugin->publish_cb_id);
+
+  if (!ua_utils_do_rollback(server, plugin->rbd, err)) {
+    g_prefix_error(err, "ua_utils_do_rollback() failed: ");
+    return FALSE;
+  }
+  ua_utils_clear_rbd(&plugin->rbd);
+
+  return TRUE;
+}
+
+void
+opc_ua_destroy(void)
+{
+  if (plugin == NULL) {
+    return;
+  }
+
+  plugin_cleanup();
+}
+
+const gchar *
+opc_ua_get_plugin_name(void)
+{
+  if (plugin == NULL) {
+    return ERR_NOT_INITIALIZED;
+  } else if (plugin->name == NULL) {
+    return ERR_NO_NAME;
+  }
+
+  return plugin->name;
+}
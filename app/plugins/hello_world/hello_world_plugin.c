@@ -49,7 +49,8 @@ typedef struct plugin {
   UA_UInt16 ns;
   /* an open62541 logger */
   UA_Logger *logger;
-  /* keep track of data that needs to be rolled back in case of failure */
+  /* keep track of data that needs to be rolled back in case of failure, or
+   * when the plugin is removed */
   rollback_data_t *rbd;
 } plugin_t;
 
@@ -141,9 +142,7 @@ opc_ua_create(UA_Server *server,
     goto err_out;
   }
 
-  /* the information model was successfully populated so now we can free up our
-   * rollback data since we no longer need it */
-  ua_utils_clear_rbd(&plugin->rbd);
+  /* the rollback data is kept, opc_ua_remove() deletes the nodes it lists */
 
   return TRUE;
 
@@ -160,6 +159,25 @@ err_out:
   return FALSE;
 }
 
+gboolean
+opc_ua_remove(UA_Server *server, GError **err)
+{
+  g_return_val_if_fail(server != NULL, FALSE);
+  g_return_val_if_fail(err == NULL || *err == NULL, FALSE);
+
+  if (plugin == NULL || plugin->rbd == NULL) {
+    return TRUE;
+  }
+
+  if (!ua_utils_do_rollback(server, plugin->rbd, err)) {
+    g_prefix_error(err, "ua_utils_do_rollback() failed: ");
+    return FALSE;
+  }
+  ua_utils_clear_rbd(&plugin->rbd);
+
+  return TRUE;
+}
+
 void
 opc_ua_destroy(void)
 {
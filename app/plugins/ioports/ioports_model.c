@@ -0,0 +1,316 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2025 Axis Communications AB
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/* Generated by tools/ua_model_gen.py from ioports.NodeSet2.xml, do not edit */
+
+#include <glib.h>
+
+#include "ioports_model.h"
+#include "ioports_nodeids.h"
+#include "ioports_types.h"
+
+/* clang-format off */
+static const char *const strings_6042[] = { "Open", "Closed" };
+static const char *const strings_6026[] = { "Input", "Output" };
+
+static UA_DataTypeArray types = {
+  NULL,
+  UA_TYPES_IOP_COUNT,
+  UA_TYPES_IOP,
+  UA_FALSE
+};
+
+static const ua_model_node_t nodes[] = {
+  { /* IOPortStateType */
+    .node_class = UA_NODECLASS_DATATYPE,
+    .id = UA_MODEL_LOCAL(UA_IOPID_IOPORTSTATETYPE),
+    .parent = UA_MODEL_NS0(29), /* Enumeration */
+    .reference_type = UA_MODEL_NS0(45), /* HasSubtype */
+    .browse_name = "IOPortStateType",
+    .display_name = "IOPortStateType",
+  },
+  { /* IOPortStateType_EnumStrings */
+    .node_class = UA_NODECLASS_VARIABLE,
+    .id = UA_MODEL_LOCAL(UA_IOPID_IOPORTSTATETYPE_ENUMSTRINGS),
+    .parent = UA_MODEL_LOCAL(UA_IOPID_IOPORTSTATETYPE),
+    .reference_type = UA_MODEL_NS0(46), /* HasProperty */
+    .type_definition = UA_MODEL_NS0(68), /* PropertyType */
+    .browse_ns0 = UA_TRUE,
+    .browse_name = "EnumStrings",
+    .display_name = "EnumStrings",
+    .data_type = UA_MODEL_NS0(21), /* LocalizedText */
+    .access_level = UA_ACCESSLEVELMASK_READ,
+    .user_access_level = UA_ACCESSLEVELMASK_READ,
+    .value_rank = UA_VALUERANK_ONE_DIMENSION,
+    .array_length = 2,
+    .enum_strings = strings_6042,
+    .nr_enum_strings = G_N_ELEMENTS(strings_6042),
+  },
+  { /* IOPortDirectionType */
+    .node_class = UA_NODECLASS_DATATYPE,
+    .id = UA_MODEL_LOCAL(UA_IOPID_IOPORTDIRECTIONTYPE),
+    .parent = UA_MODEL_NS0(29), /* Enumeration */
+    .reference_type = UA_MODEL_NS0(45), /* HasSubtype */
+    .browse_name = "IOPortDirectionType",
+    .display_name = "IOPortDirectionType",
+  },
+  { /* IOPortDirectionType_EnumStrings */
+    .node_class = UA_NODECLASS_VARIABLE,
+    .id = UA_MODEL_LOCAL(UA_IOPID_IOPORTDIRECTIONTYPE_ENUMSTRINGS),
+    .parent = UA_MODEL_LOCAL(UA_IOPID_IOPORTDIRECTIONTYPE),
+    .reference_type = UA_MODEL_NS0(46), /* HasProperty */
+    .type_definition = UA_MODEL_NS0(68), /* PropertyType */
+    .browse_ns0 = UA_TRUE,
+    .browse_name = "EnumStrings",
+    .display_name = "EnumStrings",
+    .data_type = UA_MODEL_NS0(21), /* LocalizedText */
+    .access_level = UA_ACCESSLEVELMASK_READ,
+    .user_access_level = UA_ACCESSLEVELMASK_READ,
+    .value_rank = UA_VALUERANK_ONE_DIMENSION,
+    .array_length = 2,
+    .enum_strings = strings_6026,
+    .nr_enum_strings = G_N_ELEMENTS(strings_6026),
+  },
+  { /* IOPortObjType */
+    .node_class = UA_NODECLASS_OBJECTTYPE,
+    .id = UA_MODEL_LOCAL(UA_IOPID_IOPORTOBJTYPE),
+    .parent = UA_MODEL_NS0(58), /* BaseObjectType */
+    .reference_type = UA_MODEL_NS0(45), /* HasSubtype */
+    .browse_name = "IOPortObjType",
+    .display_name = "IOPortObjType",
+  },
+  { /* IOPortObjType_Configurable */
+    .node_class = UA_NODECLASS_VARIABLE,
+    .id = UA_MODEL_LOCAL(UA_IOPID_IOPORTOBJTYPE_CONFIGURABLE),
+    .parent = UA_MODEL_LOCAL(UA_IOPID_IOPORTOBJTYPE),
+    .reference_type = UA_MODEL_NS0(46), /* HasProperty */
+    .type_definition = UA_MODEL_NS0(68), /* PropertyType */
+    .browse_name = "Configurable",
+    .display_name = "Configurable",
+    .data_type = UA_MODEL_NS0(1), /* Boolean */
+    .access_level = UA_ACCESSLEVELMASK_READ,
+    .value_rank = UA_VALUERANK_ANY,
+  },
+  { /* IOPortObjType_Direction */
+    .node_class = UA_NODECLASS_VARIABLE,
+    .id = UA_MODEL_LOCAL(UA_IOPID_IOPORTOBJTYPE_DIRECTION),
+    .parent = UA_MODEL_LOCAL(UA_IOPID_IOPORTOBJTYPE),
+    .reference_type = UA_MODEL_NS0(46), /* HasProperty */
+    .type_definition = UA_MODEL_NS0(68), /* PropertyType */
+    .browse_name = "Direction",
+    .display_name = "Direction",
+    .data_type = UA_MODEL_LOCAL(UA_IOPID_IOPORTDIRECTIONTYPE),
+    .access_level = UA_ACCESSLEVELMASK_READ | UA_ACCESSLEVELMASK_WRITE,
+    .value_rank = UA_VALUERANK_ANY,
+  },
+  { /* IOPortObjType_Disabled */
+    .node_class = UA_NODECLASS_VARIABLE,
+    .id = UA_MODEL_LOCAL(UA_IOPID_IOPORTOBJTYPE_DISABLED),
+    .parent = UA_MODEL_LOCAL(UA_IOPID_IOPORTOBJTYPE),
+    .reference_type = UA_MODEL_NS0(46), /* HasProperty */
+    .type_definition = UA_MODEL_NS0(68), /* PropertyType */
+    .browse_name = "Disabled",
+    .display_name = "Disabled",
+    .data_type = UA_MODEL_NS0(1), /* Boolean */
+    .access_level = UA_ACCESSLEVELMASK_READ,
+    .value_rank = UA_VALUERANK_ANY,
+  },
+  { /* IOPortObjType_Index */
+    .node_class = UA_NODECLASS_VARIABLE,
+    .id = UA_MODEL_LOCAL(UA_IOPID_IOPORTOBJTYPE_INDEX),
+    .parent = UA_MODEL_LOCAL(UA_IOPID_IOPORTOBJTYPE),
+    .reference_type = UA_MODEL_NS0(46), /* HasProperty */
+    .type_definition = UA_MODEL_NS0(68), /* PropertyType */
+    .browse_name = "Index",
+    .display_name = "Index",
+    .data_type = UA_MODEL_NS0(6), /* Int32 */
+    .access_level = UA_ACCESSLEVELMASK_READ,
+    .value_rank = UA_VALUERANK_ANY,
+  },
+  { /* IOPortObjType_Name */
+    .node_class = UA_NODECLASS_VARIABLE,
+    .id = UA_MODEL_LOCAL(UA_IOPID_IOPORTOBJTYPE_NAME),
+    .parent = UA_MODEL_LOCAL(UA_IOPID_IOPORTOBJTYPE),
+    .reference_type = UA_MODEL_NS0(46), /* HasProperty */
+    .type_definition = UA_MODEL_NS0(68), /* PropertyType */
+    .browse_name = "Name",
+    .display_name = "Name",
+    .data_type = UA_MODEL_NS0(12), /* String */
+    .access_level = UA_ACCESSLEVELMASK_READ | UA_ACCESSLEVELMASK_WRITE,
+    .value_rank = UA_VALUERANK_ANY,
+  },
+  { /* IOPortObjType_NormalState */
+    .node_class = UA_NODECLASS_VARIABLE,
+    .id = UA_MODEL_LOCAL(UA_IOPID_IOPORTOBJTYPE_NORMALSTATE),
+    .parent = UA_MODEL_LOCAL(UA_IOPID_IOPORTOBJTYPE),
+    .reference_type = UA_MODEL_NS0(46), /* HasProperty */
+    .type_definition = UA_MODEL_NS0(68), /* PropertyType */
+    .browse_name = "NormalState",
+    .display_name = "NormalState",
+    .data_type = UA_MODEL_LOCAL(UA_IOPID_IOPORTSTATETYPE),
+    .access_level = UA_ACCESSLEVELMASK_READ | UA_ACCESSLEVELMASK_WRITE,
+    .value_rank = UA_VALUERANK_ANY,
+  },
+  { /* IOPortObjType_State */
+    .node_class = UA_NODECLASS_VARIABLE,
+    .id = UA_MODEL_LOCAL(UA_IOPID_IOPORTOBJTYPE_STATE),
+    .parent = UA_MODEL_LOCAL(UA_IOPID_IOPORTOBJTYPE),
+    .reference_type = UA_MODEL_NS0(46), /* HasProperty */
+    .type_definition = UA_MODEL_NS0(68), /* PropertyType */
+    .browse_name = "State",
+    .display_name = "State",
+    .data_type = UA_MODEL_LOCAL(UA_IOPID_IOPORTSTATETYPE),
+    .access_level = UA_ACCESSLEVELMASK_READ | UA_ACCESSLEVELMASK_WRITE,
+    .value_rank = UA_VALUERANK_ANY,
+  },
+  { /* IOPortObjType_Usage */
+    .node_class = UA_NODECLASS_VARIABLE,
+    .id = UA_MODEL_LOCAL(UA_IOPID_IOPORTOBJTYPE_USAGE),
+    .parent = UA_MODEL_LOCAL(UA_IOPID_IOPORTOBJTYPE),
+    .reference_type = UA_MODEL_NS0(46), /* HasProperty */
+    .type_definition = UA_MODEL_NS0(68), /* PropertyType */
+    .browse_name = "Usage",
+    .display_name = "Usage",
+    .data_type = UA_MODEL_NS0(12), /* String */
+    .access_level = UA_ACCESSLEVELMASK_READ | UA_ACCESSLEVELMASK_WRITE,
+    .value_rank = UA_VALUERANK_ANY,
+  },
+  { /* IOPEventType */
+    .node_class = UA_NODECLASS_OBJECTTYPE,
+    .id = UA_MODEL_LOCAL(UA_IOPID_IOPEVENTTYPE),
+    .parent = UA_MODEL_NS0(2041), /* BaseEventType */
+    .reference_type = UA_MODEL_NS0(45), /* HasSubtype */
+    .browse_name = "IOPEventType",
+    .display_name = "IOPEventType",
+    .is_abstract = UA_TRUE,
+  },
+  { /* IOPDirectionEventType */
+    .node_class = UA_NODECLASS_OBJECTTYPE,
+    .id = UA_MODEL_LOCAL(UA_IOPID_IOPDIRECTIONEVENTTYPE),
+    .parent = UA_MODEL_LOCAL(UA_IOPID_IOPEVENTTYPE),
+    .reference_type = UA_MODEL_NS0(45), /* HasSubtype */
+    .browse_name = "IOPDirectionEventType",
+    .display_name = "IOPDirectionEventType",
+    .is_abstract = UA_TRUE,
+  },
+  { /* IOPNormalStateEventType */
+    .node_class = UA_NODECLASS_OBJECTTYPE,
+    .id = UA_MODEL_LOCAL(UA_IOPID_IOPNORMALSTATEEVENTTYPE),
+    .parent = UA_MODEL_LOCAL(UA_IOPID_IOPEVENTTYPE),
+    .reference_type = UA_MODEL_NS0(45), /* HasSubtype */
+    .browse_name = "IOPNormalStateEventType",
+    .display_name = "IOPNormalStateEventType",
+    .is_abstract = UA_TRUE,
+  },
+  { /* IOPStateEventType */
+    .node_class = UA_NODECLASS_OBJECTTYPE,
+    .id = UA_MODEL_LOCAL(UA_IOPID_IOPSTATEEVENTTYPE),
+    .parent = UA_MODEL_LOCAL(UA_IOPID_IOPEVENTTYPE),
+    .reference_type = UA_MODEL_NS0(45), /* HasSubtype */
+    .browse_name = "IOPStateEventType",
+    .display_name = "IOPStateEventType",
+    .is_abstract = UA_TRUE,
+  },
+  { /* IOPorts */
+    .node_class = UA_NODECLASS_OBJECT,
+    .id = UA_MODEL_LOCAL(UA_IOPID_IOPORTS),
+    .parent = UA_MODEL_NS0(85), /* ObjectsFolder */
+    .reference_type = UA_MODEL_NS0(35), /* Organizes */
+    .type_definition = UA_MODEL_NS0(58), /* BaseObjectType */
+    .browse_name = "I/O Ports",
+    .display_name = "I/O Ports",
+    .description = "I/O Ports",
+    .event_notifier = UA_EVENTNOTIFIER_SUBSCRIBE_TO_EVENT,
+  },
+};
+
+static const ua_model_reference_t references[] = {
+  {
+    .source = UA_MODEL_LOCAL(UA_IOPID_IOPORTOBJTYPE_CONFIGURABLE),
+    .reference_type = UA_MODEL_NS0(37), /* HasModellingRule */
+    .target = UA_MODEL_NS0(78), /* Mandatory */
+    .is_forward = UA_TRUE,
+  },
+  {
+    .source = UA_MODEL_LOCAL(UA_IOPID_IOPORTOBJTYPE_DIRECTION),
+    .reference_type = UA_MODEL_NS0(37), /* HasModellingRule */
+    .target = UA_MODEL_NS0(78), /* Mandatory */
+    .is_forward = UA_TRUE,
+  },
+  {
+    .source = UA_MODEL_LOCAL(UA_IOPID_IOPORTOBJTYPE_DISABLED),
+    .reference_type = UA_MODEL_NS0(37), /* HasModellingRule */
+    .target = UA_MODEL_NS0(78), /* Mandatory */
+    .is_forward = UA_TRUE,
+  },
+  {
+    .source = UA_MODEL_LOCAL(UA_IOPID_IOPORTOBJTYPE_INDEX),
+    .reference_type = UA_MODEL_NS0(37), /* HasModellingRule */
+    .target = UA_MODEL_NS0(78), /* Mandatory */
+    .is_forward = UA_TRUE,
+  },
+  {
+    .source = UA_MODEL_LOCAL(UA_IOPID_IOPORTOBJTYPE_NAME),
+    .reference_type = UA_MODEL_NS0(37), /* HasModellingRule */
+    .target = UA_MODEL_NS0(78), /* Mandatory */
+    .is_forward = UA_TRUE,
+  },
+  {
+    .source = UA_MODEL_LOCAL(UA_IOPID_IOPORTOBJTYPE_NORMALSTATE),
+    .reference_type = UA_MODEL_NS0(37), /* HasModellingRule */
+    .target = UA_MODEL_NS0(78), /* Mandatory */
+    .is_forward = UA_TRUE,
+  },
+  {
+    .source = UA_MODEL_LOCAL(UA_IOPID_IOPORTOBJTYPE_STATE),
+    .reference_type = UA_MODEL_NS0(37), /* HasModellingRule */
+    .target = UA_MODEL_NS0(78), /* Mandatory */
+    .is_forward = UA_TRUE,
+  },
+  {
+    .source = UA_MODEL_LOCAL(UA_IOPID_IOPORTOBJTYPE_USAGE),
+    .reference_type = UA_MODEL_NS0(37), /* HasModellingRule */
+    .target = UA_MODEL_NS0(78), /* Mandatory */
+    .is_forward = UA_TRUE,
+  },
+  {
+    .source = UA_MODEL_LOCAL(UA_IOPID_IOPEVENTTYPE),
+    .reference_type = UA_MODEL_NS0(41), /* GeneratesEvent */
+    .target = UA_MODEL_LOCAL(UA_IOPID_IOPORTOBJTYPE),
+    .is_forward = UA_FALSE,
+  },
+};
+/* clang-format on */
+
+const ua_model_t ioports_model = {
+  .namespace_uri = "http://www.axis.com/OpcUA/IOPorts/",
+  .nodes = nodes,
+  .nr_nodes = G_N_ELEMENTS(nodes),
+  .references = references,
+  .nr_references = G_N_ELEMENTS(references),
+  .types = UA_TYPES_IOP,
+  .nr_types = UA_TYPES_IOP_COUNT,
+  .type_array = &types,
+};
@@ -23,6 +23,8 @@
  * SOFTWARE.
  */
 
+/* Generated by tools/ua_model_gen.py from ioports.NodeSet2.xml, do not edit */
+
 #ifndef __IOPORTS_NODEIDS_H__
 #define __IOPORTS_NODEIDS_H__
 
@@ -26,10 +26,7 @@
 #ifndef __IOPORTS_NS_H__
 #define __IOPORTS_NS_H__
 
-#include <open62541/server.h>
-
 #include "ioports_types.h"
-#include "ua_utils.h"
 
 #define UA_PLUGIN_NAMESPACE "http://www.axis.com/OpcUA/IOPorts/"
 
@@ -44,8 +41,4 @@
 #define STATE_BNAME        "State"
 #define USAGE_BNAME        "Usage"
 
-/* adds the ioports namespace to the information model */
-UA_StatusCode
-ioports_ns(UA_Server *server, rollback_data_t *rbd);
-
 #endif /* __IOPORTS_NS_H__ */
@@ -24,17 +24,23 @@
  */
 
 #include <axsdk/axevent.h>
-#include <curl/curl.h>
-#include <errno.h>
 #include <gio/gio.h>
 #include <glib.h>
+#include <string.h>
 
 #include "error.h"
+#include "ioports_model.h"
 #include "ioports_nodeids.h"
 #include "ioports_ns.h"
 #include "ioports_plugin.h"
 #include "ioports_vapix.h"
 #include "log.h"
+#include "plugin.h"
+#include "ua_arena.h"
+#include "ua_metrics.h"
+#include "ua_model.h"
+#include "ua_pubsub.h"
+#include "ua_trace.h"
 #include "ua_utils.h"
 #include "vapix_utils.h"
 
@@ -43,15 +49,14 @@
 #define ERR_NOT_INITIALIZED "The " UA_PLUGIN_NAME " is not initialized"
 #define ERR_NO_NAME         "The " UA_PLUGIN_NAME " was not given a name"
 
-#define IOP_HT_LOCK(mtx)   (g_mutex_lock(&plugin->mtx))
-#define IOP_HT_UNLOCK(mtx) (g_mutex_unlock(&plugin->mtx))
-
 #define IOP_DBUS_CFG_SERVICE "com.axis.Configuration.Legacy.IOControl1.IOPort"
 #define IOP_LABEL_FMT        "I/O Port %d"
 
 #define IOP_STATE_CHANGE             0
 #define IOP_CFG_CHANGE               1
 #define IOP_STATE_CHANGE_EV_SEVERITY 100
+/* number of reusable state change event nodes */
+#define IOP_STATE_EV_POOL_SIZE 2
 
 /* parameters monitored for value changes via AxEvent */
 #define IOP_CFG_CHANGE_NAME  "Name"
@@ -61,6 +66,28 @@
 #define IOP_CFG_CHANGE_NS_IN  "Trig"
 #define IOP_CFG_CHANGE_NS_OUT "Active"
 
+/* the port index stored as nodeContext of the property nodes, offset by one
+ * since port 0 would otherwise read as "no context" */
+#define IOP_INDEX_TO_CTX(idx) GUINT_TO_POINTER((idx) + 1)
+#define IOP_CTX_TO_INDEX(ctx) (GPOINTER_TO_UINT(ctx) - 1)
+
+/* initial size of the arena of the state change events */
+#define IOP_EMIT_ARENA_SIZE 256
+
+/* how often the replaced labels are checked for readers until freed */
+#define IOP_LABELS_GRACE_PERIOD 100 /* milliseconds */
+
+/* browse name of the states of all the ports */
+#define IOP_PORT_STATES_BNAME "PortStates"
+/* name of 'PortStates' in the published DataSet */
+#define IOP_PORT_STATES_ALIAS "IOPorts." IOP_PORT_STATES_BNAME
+
+/* browse name of the method setting properties of several ports at once */
+#define IOP_SET_PORTS_BNAME "SetPorts"
+/* properties a 'SetPorts' call may set, each port can appear once per
+ * property */
+#define IOP_SET_PORTS_MAX 256
+
 #define NAME_PROP   0
 #define USAGE_PROP  1
 #define STATE_PROP  0
@@ -75,14 +102,44 @@ typedef struct plugin {
   gchar *name;
   /* OPC-UA namespace index */
   UA_UInt16 ns;
-  /* keep track of data that needs to be rolled back in case of failure */
+  /* keep track of data that needs to be rolled back in case of failure, or
+   * when the plugin is removed */
   rollback_data_t *rbd;
+  /* node ids of the I/O port objects and their properties */
+  ua_node_cache_t *nodes;
+  /* runs our server mutations in the OPC-UA server thread */
+  ua_queue_t *queue;
+  /* the nodes of the state change events */
+  ua_event_pool_t *state_events;
+  /* temporaries of the state change events, only used by the server thread */
+  ua_arena_t *emit_arena;
+  /* node id of 'PortStates' */
+  UA_NodeId port_states;
+  /* coalescing window (ms) and rate limit (events/s and port) of the state
+   * change events, 0 to disable */
+  guint event_window;
+  guint event_max_rate;
 
   /* an open62541 logger */
   UA_Logger *logger;
-  /* hash table with the I/O Ports returned by VAPIX 'getPorts' */
-  GHashTable *iop_ht;
-  GMutex iop_mtx;
+  /* the I/O ports returned by VAPIX 'getPorts', indexed by port index. The
+   * records are updated from the main loop and read without locking from the
+   * OPC-UA server thread */
+  struct iop_port *ports;
+  guint nr_ports;
+  /* the labels of the ports are read in epochs, see iop_labels_ref(). The
+   * labels replaced during an epoch are freed once the next epoch has begun
+   * and no reader of theirs is left. */
+  gint label_epoch;
+  /* number of readers currently copying the labels, per epoch parity */
+  gint label_readers[2];
+  /* labels replaced during the current epoch and the previous one */
+  GSList *retired_labels[2];
+  /* retries the freeing while replaced labels are left */
+  guint reclaim_id;
+
+  /* serve the 'SetPorts' method from the method workers */
+  gboolean async_methods;
 
   /* AxEvent handlers */
   /* monitor I/O port state changes */
@@ -92,10 +149,54 @@ typedef struct plugin {
   /* event subscriptions for state and configuration changes respectively */
   guint event_subs[2];
 
-  gchar *vapix_credentials;
-  CURL *curl_h;
+  /* VAPIX account of the plugin, served by the shared connection pool */
+  vapix_session_t *vapix_h;
+  /* ioport_obj_t of the ports fetched before the plugin is created, keyed by
+   * port index */
+  GHashTable *port_info;
+  /* timings of the data sources and of the state change events, from the
+   * moment they are queued until they are emitted */
+  ua_metric_t *reads;
+  ua_metric_t *writes;
+  ua_metric_t *event_latency;
+  /* time spent handling a configuration change AxEvent */
+  ua_metric_t *cfg_event;
 } plugin_t;
 
+/* immutable once published, replaced as a whole when the name or usage of
+ * the port changes */
+typedef struct iop_labels {
+  gchar *name;
+  gchar *usage;
+} iop_labels_t;
+
+/* cached state and configuration of an I/O port */
+typedef struct iop_port {
+  /* FALSE for port indexes the device does not have */
+  gboolean valid;
+  /* UA_IOPortStateType and UA_IOPortDirectionType values, accessed with
+   * g_atomic_int_get() and g_atomic_int_set() */
+  gint state;
+  gint normal_state;
+  gint direction;
+  /* accessed with g_atomic_pointer_get() inside iop_labels_ref() and
+   * iop_labels_unref() */
+  iop_labels_t *labels;
+
+  /* coalescing of the state change events, main loop only */
+  /* monotonic time (us) before which a new state change is folded */
+  gint64 window_end;
+  /* token bucket of the rate limit */
+  gdouble tokens;
+  gint64 refilled;
+  /* state changes folded since the last emitted event and the time of the
+   * latest one */
+  guint coalesced;
+  UA_DateTime changed;
+  /* timer emitting the folded state changes */
+  guint flush_id;
+} iop_port_t;
+
 typedef struct ioport_proptype_map {
   gchar *browse_name;
   UA_DataType *data_type_array;
@@ -114,6 +215,25 @@ typedef struct ua_ioport_obj {
   UA_String usage;
 } ua_ioport_obj_t;
 
+/* the 'State' access level change following a 'Direction' write */
+typedef struct iop_dir_req {
+  UA_UInt32 iop_index;
+  /* the 'State' property of the port and its new access level */
+  UA_NodeId state_nodeId;
+  UA_Byte access_level;
+} iop_dir_req_t;
+
+/* a state change of an I/O port waiting to be emitted as an OPC-UA event */
+typedef struct iop_state_change {
+  guint port;
+  UA_IOPortStateType state;
+  UA_DateTime time;
+  /* number of earlier state changes folded into this one */
+  guint coalesced;
+  /* g_get_monotonic_time() when the change was queued */
+  gint64 queued;
+} iop_state_change_t;
+
 static plugin_t *plugin;
 
 static const ioport_proptype_map_t IOPort_obj_type_map[] = {
@@ -129,49 +249,6 @@ static const ioport_proptype_map_t IOPort_obj_type_map[] = {
 };
 
 /* Local functions */
-/* Wrapper around g_ascii_strtoll() using decimal base & with error handling */
-static gint64
-ascii_strtoll_dec(const gchar *nptr, GError **error)
-{
-  gchar *endptr = NULL;
-  gint64 value = 0;
-
-  g_assert(nptr != NULL);
-  g_assert(error == NULL || *error == NULL);
-
-  if (*nptr == '\0') {
-    SET_ERROR(error, -1, "Empty string");
-    return 0;
-  }
-
-  errno = 0;
-  value = g_ascii_strtoll(nptr, &endptr, 10);
-
-  /* out of range */
-  if (errno == ERANGE) {
-    SET_ERROR(error, -1, "String '%s' out of gint64 range", nptr);
-    return 0;
-  }
-
-  /* no characters consumed */
-  if (endptr == nptr) {
-    SET_ERROR(error, -1, "Failed converting '%s': no valid digits", nptr);
-    return 0;
-  }
-
-  /* invalid trailing characters */
-  if (*endptr != '\0') {
-    SET_ERROR(error,
-              -1,
-              "Failed converting '%s': trailing junk at: '%s'",
-              nptr,
-              endptr);
-    return 0;
-  }
-
-  return value;
-}
-
 static gpointer
 get_member_from_browsename(const ua_ioport_obj_t *ioport, const gchar *bname)
 {
@@ -199,8 +276,208 @@ get_member_from_browsename(const ua_ioport_obj_t *ioport, const gchar *bname)
   return NULL;
 }
 
+static void
+free_labels(gpointer data)
+{
+  iop_labels_t *labels = (iop_labels_t *) data;
+
+  if (labels == NULL) {
+    return;
+  }
+
+  g_clear_pointer(&labels->name, g_free);
+  g_clear_pointer(&labels->usage, g_free);
+  g_free(labels);
+}
+
+/* returns the record of port 'index', NULL if the device has no such port */
+static iop_port_t *
+iop_get_port(guint index)
+{
+  g_assert(plugin != NULL);
+
+  if (plugin->ports == NULL || index >= plugin->nr_ports ||
+      !plugin->ports[index].valid) {
+    return NULL;
+  }
+
+  return &plugin->ports[index];
+}
+
+/* gives access to the labels of a port until iop_labels_unref() is called
+ * with the returned @epoch, this never blocks */
+static const iop_labels_t *
+iop_labels_ref(iop_port_t *port, gint *epoch)
+{
+  gint parity;
+
+  g_assert(plugin != NULL);
+  g_assert(port != NULL);
+  g_assert(epoch != NULL);
+
+  /* the reader is counted in the epoch which is current once it's counted,
+   * which is the one the labels it reads belong to */
+  for (;;) {
+    parity = g_atomic_int_get(&plugin->label_epoch) & 1;
+    g_atomic_int_inc(&plugin->label_readers[parity]);
+    if ((g_atomic_int_get(&plugin->label_epoch) & 1) == parity) {
+      break;
+    }
+    (void) g_atomic_int_dec_and_test(&plugin->label_readers[parity]);
+  }
+  *epoch = parity;
+
+  return g_atomic_pointer_get(&port->labels);
+}
+
+static void
+iop_labels_unref(gint epoch)
+{
+  g_assert(plugin != NULL);
+
+  (void) g_atomic_int_dec_and_test(&plugin->label_readers[epoch]);
+}
+
+/* frees the labels replaced before the current epoch once their readers are
+ * gone and begins a new epoch for the ones replaced since, from the main loop.
+ * Returns TRUE while replaced labels are left. */
+static gboolean
+iop_labels_reclaim(void)
+{
+  gint current;
+  gint previous;
+
+  g_assert(plugin != NULL);
+
+  current = plugin->label_epoch & 1;
+  previous = current ^ 1;
+
+  if (g_atomic_int_get(&plugin->label_readers[previous]) != 0) {
+    return TRUE;
+  }
+  g_slist_free_full(plugin->retired_labels[previous], free_labels);
+  plugin->retired_labels[previous] = NULL;
+
+  if (plugin->retired_labels[current] == NULL) {
+    return FALSE;
+  }
+
+  /* a reader arriving from now on can only see the new labels */
+  g_atomic_int_inc(&plugin->label_epoch);
+
+  return TRUE;
+}
+
+static gboolean
+iop_labels_reclaim_cb(G_GNUC_UNUSED gpointer data)
+{
+  g_assert(plugin != NULL);
+
+  if (iop_labels_reclaim()) {
+    return G_SOURCE_CONTINUE;
+  }
+  plugin->reclaim_id = 0;
+
+  return G_SOURCE_REMOVE;
+}
+
+/* publishes new labels of a port, must be called from the main loop. The old
+ * labels are only freed once no reader can still be using them. */
+static void
+iop_labels_replace(iop_port_t *port, const gchar *name, const gchar *usage)
+{
+  iop_labels_t *labels;
+  iop_labels_t *old;
+  gint current;
+
+  g_assert(plugin != NULL);
+  g_assert(port != NULL);
+
+  old = g_atomic_pointer_get(&port->labels);
+
+  labels = g_new0(iop_labels_t, 1);
+  labels->name = g_strdup(name != NULL ? name : old->name);
+  labels->usage = g_strdup(usage != NULL ? usage : old->usage);
+
+  /* there is a single writer so no compare-and-exchange is needed */
+  g_atomic_pointer_set(&port->labels, labels);
+  current = plugin->label_epoch & 1;
+  plugin->retired_labels[current] =
+          g_slist_prepend(plugin->retired_labels[current], old);
+
+  /* with readers all the time, the labels are freed a grace period later */
+  if (iop_labels_reclaim() && plugin->reclaim_id == 0) {
+    plugin->reclaim_id = g_timeout_add(IOP_LABELS_GRACE_PERIOD,
+                                       iop_labels_reclaim_cb,
+                                       NULL);
+  }
+}
+
+/* builds the port records from the 'getPorts' hash table */
+static void
+iop_init_ports(GHashTable *iop_ht)
+{
+  GHashTableIter ht_iter;
+  gpointer key;
+  gpointer value;
+  guint nr_ports = 0;
+
+  g_assert(plugin != NULL);
+  g_assert(plugin->ports == NULL);
+  g_assert(iop_ht != NULL);
+
+  g_hash_table_iter_init(&ht_iter, iop_ht);
+  while (g_hash_table_iter_next(&ht_iter, &key, NULL)) {
+    nr_ports = MAX(nr_ports, *(guint32 *) key + 1);
+  }
+
+  plugin->ports = g_new0(iop_port_t, nr_ports);
+  plugin->nr_ports = nr_ports;
+
+  g_hash_table_iter_init(&ht_iter, iop_ht);
+  while (g_hash_table_iter_next(&ht_iter, &key, &value)) {
+    const ioport_obj_t *iop = (const ioport_obj_t *) value;
+    iop_port_t *port = &plugin->ports[*(guint32 *) key];
+
+    port->valid = TRUE;
+    port->state = iop->state;
+    port->normal_state = iop->normal_state;
+    port->direction = iop->direction;
+    port->labels = g_new0(iop_labels_t, 1);
+    port->labels->name = g_strdup(iop->name);
+    port->labels->usage = g_strdup(iop->usage);
+    port->tokens = plugin->event_max_rate;
+    port->refilled = g_get_monotonic_time();
+  }
+}
+
+static void
+iop_free_ports(void)
+{
+  g_assert(plugin != NULL);
+
+  for (guint i = 0; i < plugin->nr_ports; i++) {
+    if (plugin->ports[i].flush_id != 0) {
+      g_source_remove(plugin->ports[i].flush_id);
+    }
+    g_clear_pointer(&plugin->ports[i].labels, free_labels);
+  }
+  g_clear_pointer(&plugin->ports, g_free);
+  plugin->nr_ports = 0;
+
+  if (plugin->reclaim_id != 0) {
+    g_source_remove(plugin->reclaim_id);
+    plugin->reclaim_id = 0;
+  }
+  for (guint i = 0; i < G_N_ELEMENTS(plugin->retired_labels); i++) {
+    g_slist_free_full(plugin->retired_labels[i], free_labels);
+    plugin->retired_labels[i] = NULL;
+  }
+}
+
 /* Find out and return the nodeId of an ioport object property node given its
- * browseName.
+ * browseName. The nodeId is resolved once and then served from the node cache
+ * of the plugin.
  *
  * Input parameters:
  *  * server
@@ -220,12 +497,7 @@ iop_ua_get_nodeid_from_browsename(UA_Server *server,
                                   UA_NodeId *out_nodeId,
                                   GError **error)
 {
-  UA_RelativePathElement rpe;
-  UA_BrowsePath bp;
-  UA_BrowsePathResult bpr;
-  UA_StatusCode status;
-
-  gboolean found = FALSE;
+  UA_QualifiedName qn;
 
   g_assert(server != NULL);
   g_assert(start_node != NULL);
@@ -236,45 +508,17 @@ iop_ua_get_nodeid_from_browsename(UA_Server *server,
   g_assert(error == NULL || *error == NULL);
 
   g_assert(plugin != NULL);
+  g_assert(plugin->nodes != NULL);
 
-  UA_RelativePathElement_init(&rpe);
-  rpe.referenceTypeId = UA_NODEID_NUMERIC(0, referenceTypeId);
-  rpe.isInverse = FALSE;
-  rpe.includeSubtypes = FALSE;
-  rpe.targetName = UA_QUALIFIEDNAME(plugin->ns, browse_name);
-
-  UA_BrowsePath_init(&bp);
-  bp.startingNode = *start_node;
-  bp.relativePath.elementsSize = 1;
-  bp.relativePath.elements = &rpe;
-
-  UA_BrowsePathResult_init(&bpr);
-  bpr = UA_Server_translateBrowsePathToNodeIds(server, &bp);
-  if (bpr.statusCode != UA_STATUSCODE_GOOD || bpr.targetsSize < 1) {
-    SET_ERROR(error,
-              -1,
-              "Unable to find nodeId of obj property '%s', err: %s",
-              browse_name,
-              UA_StatusCode_name(bpr.statusCode));
-    goto bail_out;
-
-  } else {
-    status = UA_NodeId_copy(&bpr.targets[0].targetId.nodeId, out_nodeId);
-    if (status != UA_STATUSCODE_GOOD) {
-      SET_ERROR(error,
-                -1,
-                "UA_NodeId_copy() failed: %s",
-                UA_StatusCode_name(status));
-      goto bail_out;
-    }
-
-    found = TRUE;
-  }
-
-bail_out:
-  UA_BrowsePathResult_clear(&bpr);
+  qn = UA_QUALIFIEDNAME(plugin->ns, browse_name);
 
-  return found;
+  return ua_utils_node_cache_resolve(plugin->nodes,
+                                     server,
+                                     start_node,
+                                     referenceTypeId,
+                                     &qn,
+                                     out_nodeId,
+                                     error);
 }
 
 /* Get the parent nodeId (the ioport object node id) of an ioport object
@@ -396,112 +640,41 @@ err_out:
   return retval;
 }
 
-/* Given the nodeId of any ioport object property, return the value of any other
- * property node given its browseName.
- *
- * Input parameters:
- *  * server
- *  * nodeId      - the nodeId of any ioport object property
- *  * browse_name - the Browse Name of the other property for which we want to
- *                  fetch the value
- *
- * Output parameters:
- *  * ua_value - the value (UA_Variant) of the requested property node
- *  * error    - a GError in case an error occurs */
-static gboolean
-iop_ua_get_iop_prop_value(UA_Server *server,
-                          const UA_NodeId *nodeId,
-                          gchar *browse_name,
-                          UA_Variant *ua_value,
-                          GError **error)
-{
-  gboolean retval = FALSE;
-  UA_StatusCode ua_status = UA_STATUSCODE_BAD;
-  UA_NodeId parent = UA_NODEID_NULL;
-
-  g_assert(server != NULL);
-  g_assert(nodeId != NULL);
-  g_assert(browse_name != NULL);
-  g_assert(ua_value != NULL);
-  g_assert(error == NULL || *error == NULL);
-
-  g_assert(plugin != NULL);
-
-  /* find our parent node (the I/O port object we belong to) */
-  if (!iop_ua_get_iop_prop_parent(server, nodeId, &parent, error)) {
-    g_prefix_error(error, "iop_ua_get_iop_prop_parent() failed: ");
-    goto err_out;
-  }
-
-  /* read the value of the 'browse_name' property */
-  ua_status = UA_Server_readObjectProperty(server,
-                                           parent,
-                                           UA_QUALIFIEDNAME(plugin->ns,
-                                                            browse_name),
-                                           ua_value);
-  if (ua_status != UA_STATUSCODE_GOOD) {
-    SET_ERROR(error,
-              -1,
-              "UA_Server_readObjectProperty(...'%s'...) failed: %s",
-              browse_name,
-              UA_StatusCode_name(ua_status));
-    goto err_out;
-  }
-
-  retval = TRUE;
-
-err_out:
-  UA_NodeId_clear(&parent);
-
-  return retval;
-}
-
-/* Given any property node of an ioport object, returns the 'Index' value of
- * the respective ioport object.
+/* Given the nodeContext of any ioport object property, returns the 'Index'
+ * value of the respective ioport object. The object constructor stores it as
+ * the context of the property nodes so no browsing is needed.
  *
  * Input parameters:
- *  * server -
- *  * nodeId - the nodeId of any ioport object property
+ *  * nodeContext - the nodeContext of any ioport object property
  *
  * Output parameters:
  *  * iop_index - the value of the 'Index' property of the same ioport object
  *  * error     - a GError if an error occurs */
 static gboolean
-iop_ua_get_iop_index(UA_Server *server,
-                     const UA_NodeId *nodeId,
+iop_ua_get_iop_index(const void *nodeContext,
                      UA_UInt32 *iop_index,
                      GError **error)
 {
-  UA_Variant ua_value;
-
-  g_assert(server != NULL);
-  g_assert(nodeId != NULL);
   g_assert(iop_index != NULL);
   g_assert(error == NULL || *error == NULL);
 
-  g_assert(plugin != NULL);
-
-  if (!iop_ua_get_iop_prop_value(server,
-                                 nodeId,
-                                 INDEX_BNAME,
-                                 &ua_value,
-                                 error)) {
-    g_prefix_error(error, "Could not fetch 'Index' property: ");
+  if (nodeContext == NULL) {
+    SET_ERROR(error, -1, "The property node has no I/O port context");
     return FALSE;
   }
-  *iop_index = *(UA_UInt32 *) ua_value.data;
-  UA_Variant_clear(&ua_value);
+  *iop_index = IOP_CTX_TO_INDEX(nodeContext);
 
   return TRUE;
 }
 
 /**
- * Adds a new I/O Port object to the server.
+ * Adds the I/O Port objects to the server in one batch, either all of them or
+ * none.
  *
  * Input parameters:
- *  * server    - OPC-UA server instance
- *  * port_nr   - port index (0-based indexing)
- *  * port_data - a structure describing the properties of the I/O Port object
+ *  * server  - OPC-UA server instance
+ *  * iop_ht  - the structures describing the properties of the I/O Port
+ *              objects (ioport_obj_t), keyed by port index (0-based indexing)
  *
  * Output parameters:
  *  * error - a GError if an error occurs
@@ -510,62 +683,71 @@ iop_ua_get_iop_index(UA_Server *server,
  *  TRUE if successful, FALSE otherwise
  */
 static gboolean
-iop_add_ioport_object(UA_Server *server,
-                      guint32 port_nr,
-                      const ioport_obj_t *port_data,
-                      GError **err)
+iop_add_ioport_objects(UA_Server *server, GHashTable *iop_ht, GError **err)
 {
-  gboolean ret = TRUE;
-  UA_ObjectAttributes oAttr = UA_ObjectAttributes_default;
-  UA_StatusCode status;
-  ua_ioport_obj_t node_ctx;
-  gchar *label;
+  gboolean ret;
+  GHashTableIter ht_iter;
+  gpointer key, value;
+  guint nr_ports;
+  guint i = 0;
+  ua_node_desc_t *nodes;
+  ua_ioport_obj_t *node_ctx;
+  gchar **labels;
 
   g_assert(server != NULL);
-  g_assert(port_data != NULL);
+  g_assert(iop_ht != NULL);
   g_assert(err == NULL || *err == NULL);
   g_assert(plugin != NULL);
   g_assert(plugin->rbd != NULL);
 
-  /* NOTE: the web GUI uses 1-based indexing */
-  label = g_strdup_printf(IOP_LABEL_FMT, port_nr + 1);
-  oAttr.displayName = UA_LOCALIZEDTEXT("", label);
-  oAttr.description = UA_LOCALIZEDTEXT("", "I/O port");
-
-  /* node context to be passed on to the iop_ua_obj_constructor() callback */
-  node_ctx.index = port_nr;
-  node_ctx.configurable = port_data->configurable;
-  node_ctx.direction = port_data->direction;
-  node_ctx.disabled = port_data->readonly;
-  node_ctx.name = UA_STRING(port_data->name);
-  node_ctx.normalState = port_data->normal_state;
-  node_ctx.state = port_data->state;
-  node_ctx.usage = UA_STRING(port_data->usage);
-
-  /* create an object instance for the given IO port and add it to the
-   * "I/O Ports" parent object */
-  status = UA_Server_addObjectNode_rb(server,
-                                      UA_NODEID_NUMERIC(plugin->ns, 0),
-                                      UA_NODEID_NUMERIC(plugin->ns,
-                                                        UA_IOPID_IOPORTS),
-                                      UA_NODEID_NUMERIC(0, UA_NS0ID_ORGANIZES),
-                                      UA_QUALIFIEDNAME(plugin->ns, label),
-                                      UA_NODEID_NUMERIC(plugin->ns,
-                                                        UA_IOPID_IOPORTOBJTYPE),
-                                      oAttr,
-                                      &node_ctx,
-                                      plugin->rbd,
-                                      NULL);
-  if (status != UA_STATUSCODE_GOOD) {
-    SET_ERROR(err,
-              -1,
-              "UA_Server_addObjectNode_rb('%s') failed: %s",
-              label,
-              UA_StatusCode_name(status));
-    ret = FALSE;
-  }
+  nr_ports = g_hash_table_size(iop_ht);
+  nodes = g_new0(ua_node_desc_t, nr_ports);
+  /* the node contexts are passed on to the iop_ua_obj_constructor() callback,
+   * which runs while the batch is added */
+  node_ctx = g_new0(ua_ioport_obj_t, nr_ports);
+  labels = g_new0(gchar *, nr_ports + 1);
 
-  g_clear_pointer(&label, g_free);
+  g_hash_table_iter_init(&ht_iter, iop_ht);
+  while (g_hash_table_iter_next(&ht_iter, &key, &value)) {
+    guint32 port_nr = *(guint32 *) key;
+    const ioport_obj_t *port_data = value;
+
+    /* NOTE: the web GUI uses 1-based indexing */
+    labels[i] = g_strdup_printf(IOP_LABEL_FMT, port_nr + 1);
+
+    node_ctx[i].index = port_nr;
+    node_ctx[i].configurable = port_data->configurable;
+    node_ctx[i].direction = port_data->direction;
+    node_ctx[i].disabled = port_data->readonly;
+    node_ctx[i].name = UA_STRING(port_data->name);
+    node_ctx[i].normalState = port_data->normal_state;
+    node_ctx[i].state = port_data->state;
+    node_ctx[i].usage = UA_STRING(port_data->usage);
+
+    /* an object instance for the given IO port, added to the "I/O Ports"
+     * parent object */
+    nodes[i].node_class = UA_NODECLASS_OBJECT;
+    nodes[i].requested_id = UA_NODEID_NUMERIC(plugin->ns, 0);
+    nodes[i].parent = UA_NODEID_NUMERIC(plugin->ns, UA_IOPID_IOPORTS);
+    nodes[i].reference_type = UA_NODEID_NUMERIC(0, UA_NS0ID_ORGANIZES);
+    nodes[i].browse_name = UA_QUALIFIEDNAME(plugin->ns, labels[i]);
+    nodes[i].type_definition =
+            UA_NODEID_NUMERIC(plugin->ns, UA_IOPID_IOPORTOBJTYPE);
+    nodes[i].attr.object = UA_ObjectAttributes_default;
+    nodes[i].attr.object.displayName = UA_LOCALIZEDTEXT("", labels[i]);
+    nodes[i].attr.object.description = UA_LOCALIZEDTEXT("", "I/O port");
+    nodes[i].context = &node_ctx[i];
+    i++;
+  }
+
+  ret = ua_utils_add_nodes(server, nodes, nr_ports, plugin->rbd, err);
+  if (!ret) {
+    g_prefix_error(err, "ua_utils_add_nodes() failed: ");
+  }
+
+  g_strfreev(labels);
+  g_free(node_ctx);
+  g_free(nodes);
 
   return ret;
 }
@@ -577,23 +759,25 @@ iop_ua_get_string(UA_Server *server,
                   G_GNUC_UNUSED const UA_NodeId *sessionId,
                   G_GNUC_UNUSED void *sessionContext,
                   const UA_NodeId *nodeId,
-                  G_GNUC_UNUSED void *nodeContext,
+                  void *nodeContext,
                   G_GNUC_UNUSED UA_Boolean includeSourceTimeStamp,
                   G_GNUC_UNUSED const UA_NumericRange *range,
                   UA_DataValue *dataValue,
                   gint property)
 {
   GError *lerr = NULL;
-  ioport_obj_t *iop = NULL;
+  iop_port_t *port;
+  const iop_labels_t *labels;
   UA_StatusCode ua_status;
   UA_UInt32 iop_index;
   UA_String ua_string;
+  gint epoch;
 
   g_assert(server != NULL);
   g_assert(nodeId != NULL);
   g_assert(dataValue != NULL);
   g_assert(plugin != NULL);
-  g_assert(plugin->iop_ht != NULL);
+  g_assert(plugin->ports != NULL);
   g_assert(plugin->logger != NULL);
 
   /* property can only be one of 'Name' or 'Usage' */
@@ -606,7 +790,7 @@ iop_ua_get_string(UA_Server *server,
   dataValue->hasValue = FALSE;
 
   /* find the index (port number) of the I/O port node we belong to */
-  if (!iop_ua_get_iop_index(server, nodeId, &iop_index, &lerr)) {
+  if (!iop_ua_get_iop_index(nodeContext, &iop_index, &lerr)) {
     LOG_E(plugin->logger,
           "iop_ua_get_iop_index() failed: %s",
           GERROR_MSG(lerr));
@@ -614,21 +798,20 @@ iop_ua_get_string(UA_Server *server,
     return UA_STATUSCODE_BADNOTFOUND;
   }
 
-  IOP_HT_LOCK(iop_mtx);
-  iop = g_hash_table_lookup(plugin->iop_ht, &iop_index);
-  if (!iop) {
-    LOG_E(plugin->logger, "g_hash_table_lookup(port: %d) failed", iop_index);
-    IOP_HT_UNLOCK(iop_mtx);
+  port = iop_get_port(iop_index);
+  if (port == NULL) {
+    LOG_E(plugin->logger, "iop_get_port(port: %d) failed", iop_index);
     return UA_STATUSCODE_BADINTERNALERROR;
   }
 
-  ua_string = (property == NAME_PROP) ? UA_STRING(iop->name) :
-                                        UA_STRING(iop->usage);
-  IOP_HT_UNLOCK(iop_mtx);
-
+  labels = iop_labels_ref(port, &epoch);
+  ua_string = (property == NAME_PROP) ? UA_STRING(labels->name) :
+                                        UA_STRING(labels->usage);
   ua_status = UA_Variant_setScalarCopy(&dataValue->value,
                                        &ua_string,
                                        &UA_TYPES[UA_TYPES_STRING]);
+  iop_labels_unref(epoch);
+
   if (ua_status != UA_STATUSCODE_GOOD) {
     LOG_E(plugin->logger,
           "UA_Variant_setScalarCopy() failed: %s",
@@ -648,7 +831,7 @@ iop_ua_set_string(UA_Server *server,
                   G_GNUC_UNUSED const UA_NodeId *sessionId,
                   G_GNUC_UNUSED void *sessionContext,
                   const UA_NodeId *nodeId,
-                  G_GNUC_UNUSED void *nodeContext,
+                  void *nodeContext,
                   G_GNUC_UNUSED const UA_NumericRange *range,
                   const UA_DataValue *dataValue,
                   gint property)
@@ -663,8 +846,7 @@ iop_ua_set_string(UA_Server *server,
   g_assert(nodeId != NULL);
   g_assert(dataValue != NULL);
   g_assert(plugin != NULL);
-  g_assert(plugin->curl_h != NULL);
-  g_assert(plugin->vapix_credentials != NULL);
+  g_assert(plugin->vapix_h != NULL);
   g_assert(plugin->logger != NULL);
 
   /* property can only be one of 'Name' or 'Usage' */
@@ -682,7 +864,7 @@ iop_ua_set_string(UA_Server *server,
     goto err_out;
   }
 
-  if (!iop_ua_get_iop_index(server, nodeId, &iop_index, &lerr)) {
+  if (!iop_ua_get_iop_index(nodeContext, &iop_index, &lerr)) {
     LOG_E(plugin->logger,
           "iop_ua_get_iop_index() failed: %s",
           GERROR_MSG(lerr));
@@ -691,8 +873,9 @@ iop_ua_set_string(UA_Server *server,
     goto err_out;
   }
 
-  if (!iop_vapix_set_port(plugin->curl_h,
-                          plugin->vapix_credentials,
+  /* the new value shows up in the cache once the device emits its port
+   * configuration event */
+  if (!iop_vapix_set_port(plugin->vapix_h,
                           iop_index,
                           (property == NAME_PROP) ? IO_VAPIX_JSON_NAME :
                                                     IO_VAPIX_JSON_USAGE,
@@ -718,14 +901,14 @@ iop_ua_get_state(UA_Server *server,
                  G_GNUC_UNUSED const UA_NodeId *sessionId,
                  G_GNUC_UNUSED void *sessionContext,
                  const UA_NodeId *nodeId,
-                 G_GNUC_UNUSED void *nodeContext,
+                 void *nodeContext,
                  G_GNUC_UNUSED UA_Boolean includeSourceTimeStamp,
                  G_GNUC_UNUSED const UA_NumericRange *range,
                  UA_DataValue *dataValue,
                  gint property)
 {
   GError *lerr = NULL;
-  ioport_obj_t *iop = NULL;
+  iop_port_t *port;
   UA_IOPortStateType ua_state;
   UA_StatusCode ua_status;
   UA_UInt32 iop_index;
@@ -734,7 +917,7 @@ iop_ua_get_state(UA_Server *server,
   g_assert(nodeId != NULL);
   g_assert(dataValue != NULL);
   g_assert(plugin != NULL);
-  g_assert(plugin->iop_ht != NULL);
+  g_assert(plugin->ports != NULL);
   g_assert(plugin->logger != NULL);
 
   /* property can only be one of 'State' or 'NormalState' */
@@ -746,7 +929,7 @@ iop_ua_get_state(UA_Server *server,
   /* open62541 'false' (flags if dataValue holds any data) */
   dataValue->hasValue = FALSE;
 
-  if (!iop_ua_get_iop_index(server, nodeId, &iop_index, &lerr)) {
+  if (!iop_ua_get_iop_index(nodeContext, &iop_index, &lerr)) {
     LOG_E(plugin->logger,
           "iop_ua_get_iop_index() failed: %s",
           GERROR_MSG(lerr));
@@ -754,16 +937,14 @@ iop_ua_get_state(UA_Server *server,
     return UA_STATUSCODE_BADNOTFOUND;
   }
 
-  IOP_HT_LOCK(iop_mtx);
-  iop = g_hash_table_lookup(plugin->iop_ht, &iop_index);
-  if (!iop) {
-    LOG_E(plugin->logger, "g_hash_table_lookup(port: %d) failed", iop_index);
-    IOP_HT_UNLOCK(iop_mtx);
+  port = iop_get_port(iop_index);
+  if (port == NULL) {
+    LOG_E(plugin->logger, "iop_get_port(port: %d) failed", iop_index);
     return UA_STATUSCODE_BADINTERNALERROR;
   }
 
-  ua_state = (property == STATE_PROP) ? iop->state : iop->normal_state;
-  IOP_HT_UNLOCK(iop_mtx);
+  ua_state = (UA_IOPortStateType) g_atomic_int_get(
+          (property == STATE_PROP) ? &port->state : &port->normal_state);
 
   ua_status =
           UA_Variant_setScalarCopy(&dataValue->value,
@@ -788,7 +969,7 @@ iop_ua_set_state(UA_Server *server,
                  G_GNUC_UNUSED const UA_NodeId *sessionId,
                  G_GNUC_UNUSED void *sessionContext,
                  const UA_NodeId *nodeId,
-                 G_GNUC_UNUSED void *nodeContext,
+                 void *nodeContext,
                  G_GNUC_UNUSED const UA_NumericRange *range,
                  const UA_DataValue *dataValue,
                  gint property)
@@ -802,8 +983,7 @@ iop_ua_set_state(UA_Server *server,
   g_assert(nodeId != NULL);
   g_assert(dataValue != NULL);
   g_assert(plugin != NULL);
-  g_assert(plugin->curl_h != NULL);
-  g_assert(plugin->vapix_credentials != NULL);
+  g_assert(plugin->vapix_h != NULL);
   g_assert(plugin->logger != NULL);
 
   /* property can only be one of 'State' or 'NormalState' */
@@ -831,7 +1011,7 @@ iop_ua_set_state(UA_Server *server,
   }
 
   /* find the index (port number) of the I/O port node we belong to */
-  if (!iop_ua_get_iop_index(server, nodeId, &iop_index, &lerr)) {
+  if (!iop_ua_get_iop_index(nodeContext, &iop_index, &lerr)) {
     LOG_E(plugin->logger,
           "iop_ua_get_iop_index() failed: %s",
           GERROR_MSG(lerr));
@@ -839,8 +1019,7 @@ iop_ua_set_state(UA_Server *server,
     return UA_STATUSCODE_BADNOTFOUND;
   }
 
-  if (!iop_vapix_set_port(plugin->curl_h,
-                          plugin->vapix_credentials,
+  if (!iop_vapix_set_port(plugin->vapix_h,
                           iop_index,
                           (property == STATE_PROP) ? IO_VAPIX_JSON_STATE :
                                                      IO_VAPIX_JSON_NSTATE,
@@ -948,13 +1127,13 @@ iop_ua_read_dir_cb(UA_Server *server,
                    G_GNUC_UNUSED const UA_NodeId *sessionId,
                    G_GNUC_UNUSED void *sessionContext,
                    const UA_NodeId *nodeId,
-                   G_GNUC_UNUSED void *nodeContext,
+                   void *nodeContext,
                    G_GNUC_UNUSED UA_Boolean includeSourceTimeStamp,
                    G_GNUC_UNUSED const UA_NumericRange *range,
                    UA_DataValue *dataValue)
 {
   GError *lerr = NULL;
-  ioport_obj_t *iop = NULL;
+  iop_port_t *port;
   UA_IOPortDirectionType ua_dir;
   UA_StatusCode ua_status;
   UA_UInt32 iop_index;
@@ -963,13 +1142,13 @@ iop_ua_read_dir_cb(UA_Server *server,
   g_assert(nodeId != NULL);
   g_assert(dataValue != NULL);
   g_assert(plugin != NULL);
-  g_assert(plugin->iop_ht != NULL);
+  g_assert(plugin->ports != NULL);
   g_assert(plugin->logger != NULL);
 
   /* open62541 'false' (flags if dataValue holds any data) */
   dataValue->hasValue = FALSE;
 
-  if (!iop_ua_get_iop_index(server, nodeId, &iop_index, &lerr)) {
+  if (!iop_ua_get_iop_index(nodeContext, &iop_index, &lerr)) {
     LOG_E(plugin->logger,
           "iop_ua_get_iop_index() failed: %s",
           GERROR_MSG(lerr));
@@ -977,15 +1156,12 @@ iop_ua_read_dir_cb(UA_Server *server,
     return UA_STATUSCODE_BADNOTFOUND;
   }
 
-  IOP_HT_LOCK(iop_mtx);
-  iop = g_hash_table_lookup(plugin->iop_ht, &iop_index);
-  if (!iop) {
-    LOG_E(plugin->logger, "g_hash_table_lookup(port: %d) failed", iop_index);
-    IOP_HT_UNLOCK(iop_mtx);
+  port = iop_get_port(iop_index);
+  if (port == NULL) {
+    LOG_E(plugin->logger, "iop_get_port(port: %d) failed", iop_index);
     return UA_STATUSCODE_BADINTERNALERROR;
   }
-  ua_dir = iop->direction;
-  IOP_HT_UNLOCK(iop_mtx);
+  ua_dir = (UA_IOPortDirectionType) g_atomic_int_get(&port->direction);
 
   ua_status = UA_Variant_setScalarCopy(
           &dataValue->value,
@@ -1004,31 +1180,61 @@ iop_ua_read_dir_cb(UA_Server *server,
   return UA_STATUSCODE_GOOD;
 }
 
+static void
+iop_free_dir_req(gpointer data)
+{
+  iop_dir_req_t *req = data;
+
+  g_assert(req != NULL);
+
+  UA_NodeId_clear(&req->state_nodeId);
+  g_free(req);
+}
+
+/* an #ua_queue_func_t updating the access level of the 'State' property */
+static void
+iop_apply_dir_req(UA_Server *server, gpointer data)
+{
+  iop_dir_req_t *req = data;
+  UA_StatusCode ua_status;
+
+  g_assert(server != NULL);
+  g_assert(req != NULL);
+  g_assert(plugin != NULL);
+  g_assert(plugin->logger != NULL);
+
+  ua_status = UA_Server_writeAccessLevel(server,
+                                         req->state_nodeId,
+                                         req->access_level);
+  if (ua_status != UA_STATUSCODE_GOOD) {
+    LOG_E(plugin->logger,
+          "Failed to set the access level for port-%u - 'State' node: %s",
+          req->iop_index,
+          UA_StatusCode_name(ua_status));
+  }
+}
+
 /* callback executed when the 'Direction' property of an IO port is written */
 static UA_StatusCode
 iop_ua_write_dir_cb(UA_Server *server,
                     G_GNUC_UNUSED const UA_NodeId *sessionId,
                     G_GNUC_UNUSED void *sessionContext,
                     const UA_NodeId *nodeId,
-                    G_GNUC_UNUSED void *nodeContext,
+                    void *nodeContext,
                     G_GNUC_UNUSED const UA_NumericRange *range,
                     const UA_DataValue *dataValue)
 {
   GError *lerr = NULL;
   const gchar *newdir = NULL;
   UA_IOPortDirectionType ua_newdir;
-  UA_Byte access_level;
-  UA_StatusCode ua_status;
-  UA_UInt32 iop_index;
-  UA_NodeId state_nodeId = UA_NODEID_NULL;
+  iop_dir_req_t *req = NULL;
   UA_StatusCode ret = UA_STATUSCODE_GOOD;
 
   g_assert(server != NULL);
   g_assert(nodeId != NULL);
   g_assert(dataValue != NULL);
   g_assert(plugin != NULL);
-  g_assert(plugin->curl_h != NULL);
-  g_assert(plugin->vapix_credentials != NULL);
+  g_assert(plugin->vapix_h != NULL);
   g_assert(plugin->logger != NULL);
 
   /* get the requested 'direction' from the OPC-UA write node request */
@@ -1046,11 +1252,12 @@ iop_ua_write_dir_cb(UA_Server *server,
     LOG_E(plugin->logger,
           "Invalid 'Direction' value: %d in node write request!",
           ua_newdir);
-    ret = UA_STATUSCODE_BAD;
-    goto err_out;
+    return UA_STATUSCODE_BAD;
   }
 
-  if (!iop_ua_get_iop_index(server, nodeId, &iop_index, &lerr)) {
+  req = g_new0(iop_dir_req_t, 1);
+
+  if (!iop_ua_get_iop_index(nodeContext, &req->iop_index, &lerr)) {
     LOG_E(plugin->logger,
           "iop_ua_get_iop_index() failed: %s",
           GERROR_MSG(lerr));
@@ -1059,31 +1266,19 @@ iop_ua_write_dir_cb(UA_Server *server,
     goto err_out;
   }
 
-  if (!iop_vapix_set_port(plugin->curl_h,
-                          plugin->vapix_credentials,
-                          iop_index,
-                          IO_VAPIX_JSON_DIR,
-                          newdir,
-                          &lerr)) {
-    LOG_E(plugin->logger, "iop_vapix_set_port() failed: %s", GERROR_MSG(lerr));
-
-    ret = UA_STATUSCODE_BADINTERNALERROR;
-    goto err_out;
-  }
-
   if (ua_newdir == UA_IOPORTDIRECTIONTYPE_OUTPUT) {
-    /* port was configured as output, make the 'State' property r/w*/
-    access_level = UA_ACCESSLEVELMASK_READ | UA_ACCESSLEVELMASK_WRITE;
+    /* port is configured as output, make the 'State' property r/w*/
+    req->access_level = UA_ACCESSLEVELMASK_READ | UA_ACCESSLEVELMASK_WRITE;
   } else {
-    /* port was configured as input, make the 'State' property r/o*/
-    access_level = UA_ACCESSLEVELMASK_READ;
+    /* port is configured as input, make the 'State' property r/o*/
+    req->access_level = UA_ACCESSLEVELMASK_READ;
   }
 
   /* we need to find the nodeid of the 'State' property */
   if (!iop_ua_get_iop_prop_nodeid(server,
                                   nodeId,
                                   "State",
-                                  &state_nodeId,
+                                  &req->state_nodeId,
                                   &lerr)) {
     LOG_E(plugin->logger,
           "iop_ua_get_iop_prop_nodeid() failed: %s",
@@ -1093,20 +1288,41 @@ iop_ua_write_dir_cb(UA_Server *server,
     goto err_out;
   }
 
-  ua_status = UA_Server_writeAccessLevel(server, state_nodeId, access_level);
-  if (ua_status != UA_STATUSCODE_GOOD) {
+  if (!iop_vapix_set_port(plugin->vapix_h,
+                          req->iop_index,
+                          IO_VAPIX_JSON_DIR,
+                          newdir,
+                          &lerr)) {
+    LOG_E(plugin->logger, "iop_vapix_set_port() failed: %s", GERROR_MSG(lerr));
+
+    ret = UA_STATUSCODE_BADINTERNALERROR;
+    goto err_out;
+  }
+
+  /* the server can't be modified from within the write callback, the access
+   * level is updated from the queue once the write is completed */
+  if (!ua_queue_push(plugin->queue,
+                     iop_apply_dir_req,
+                     req,
+                     iop_free_dir_req,
+                     &lerr)) {
     LOG_E(plugin->logger,
-          "Failed to set the access level for port-%d - 'State' node: %s",
-          iop_index,
-          UA_StatusCode_name(ua_status));
+          "Failed to set the access level for port-%u - 'State' node: %s",
+          req->iop_index,
+          GERROR_MSG(lerr));
 
-    ret = ua_status;
+    ret = UA_STATUSCODE_BADINTERNALERROR;
     goto err_out;
   }
 
+  /* owned by the queue from now on */
+  req = NULL;
+
 err_out:
   g_clear_error(&lerr);
-  UA_NodeId_clear(&state_nodeId);
+  if (req != NULL) {
+    iop_free_dir_req(req);
+  }
 
   return ret;
 }
@@ -1199,21 +1415,357 @@ iop_ua_write_state_cb(UA_Server *server,
                           STATE_PROP);
 }
 
-/* Constructor callback for IOPortObjType object nodes.
- * It loops over all the object property nodes and:
- *   - initializes each node with the appropriate value from the data provided
- *     via the nodeContext
- *   - sets the access level (R/O or R/W) for the node according to applicable
- *     conditions
- *   - attaches UA_DataSource callbacks (to handle read/write access) to
- *     applicable property nodes */
+/* callback executed when 'PortStates' is read, the 'State' of all the ports
+ * indexed by their 0-based port index. An index the device does not have reads
+ * as closed. */
 static UA_StatusCode
-iop_ua_obj_constructor(UA_Server *server,
-                       G_GNUC_UNUSED const UA_NodeId *sessionId,
-                       G_GNUC_UNUSED void *sessionContext,
-                       G_GNUC_UNUSED const UA_NodeId *typeNodeId,
-                       G_GNUC_UNUSED void *typeNodeContext,
-                       const UA_NodeId *nodeId,
+iop_ua_read_port_states_cb(G_GNUC_UNUSED UA_Server *server,
+                           G_GNUC_UNUSED const UA_NodeId *sessionId,
+                           G_GNUC_UNUSED void *sessionContext,
+                           G_GNUC_UNUSED const UA_NodeId *nodeId,
+                           G_GNUC_UNUSED void *nodeContext,
+                           G_GNUC_UNUSED UA_Boolean includeSourceTimeStamp,
+                           G_GNUC_UNUSED const UA_NumericRange *range,
+                           UA_DataValue *dataValue)
+{
+  UA_IOPortStateType *states;
+  iop_port_t *port;
+
+  g_assert(dataValue != NULL);
+  g_assert(plugin != NULL);
+
+  /* the array is handed over to the data value */
+  states = UA_Array_new(plugin->nr_ports,
+                        &UA_TYPES_IOP[UA_TYPES_IOP_IOPORTSTATETYPE]);
+  if (states == NULL && plugin->nr_ports > 0) {
+    return UA_STATUSCODE_BADOUTOFMEMORY;
+  }
+
+  for (guint i = 0; i < plugin->nr_ports; i++) {
+    port = iop_get_port(i);
+    states[i] = (port != NULL) ?
+                        (UA_IOPortStateType) g_atomic_int_get(&port->state) :
+                        UA_IOPORTSTATETYPE_CLOSED;
+  }
+
+  UA_Variant_setArray(&dataValue->value,
+                      states,
+                      plugin->nr_ports,
+                      &UA_TYPES_IOP[UA_TYPES_IOP_IOPORTSTATETYPE]);
+  dataValue->hasValue = TRUE;
+
+  return UA_STATUSCODE_GOOD;
+}
+
+UA_METRICS_TIMED_READ(timed_read_dir_cb, iop_ua_read_dir_cb, plugin->reads)
+UA_METRICS_TIMED_WRITE(timed_write_dir_cb, iop_ua_write_dir_cb, plugin->writes)
+UA_METRICS_TIMED_READ(timed_read_name_cb, iop_ua_read_name_cb, plugin->reads)
+UA_METRICS_TIMED_WRITE(timed_write_name_cb,
+                       iop_ua_write_name_cb,
+                       plugin->writes)
+UA_METRICS_TIMED_READ(timed_read_usage_cb, iop_ua_read_usage_cb, plugin->reads)
+UA_METRICS_TIMED_WRITE(timed_write_usage_cb,
+                       iop_ua_write_usage_cb,
+                       plugin->writes)
+UA_METRICS_TIMED_READ(timed_read_state_cb, iop_ua_read_state_cb, plugin->reads)
+UA_METRICS_TIMED_WRITE(timed_write_state_cb,
+                       iop_ua_write_state_cb,
+                       plugin->writes)
+UA_METRICS_TIMED_READ(timed_read_normalstate_cb,
+                      iop_ua_read_normalstate_cb,
+                      plugin->reads)
+UA_METRICS_TIMED_WRITE(timed_write_normalstate_cb,
+                       iop_ua_write_normalstate_cb,
+                       plugin->writes)
+
+UA_METRICS_TIMED_READ(timed_read_port_states_cb,
+                      iop_ua_read_port_states_cb,
+                      plugin->reads)
+
+/* adds 'PortStates' to the "I/O Ports" object, one monitored item on it
+ * covers the state of all the ports */
+static gboolean
+iop_add_port_states(UA_Server *server, GError **err)
+{
+  UA_VariableAttributes vattr = UA_VariableAttributes_default;
+  UA_DataSource source = { .read = timed_read_port_states_cb };
+  UA_StatusCode status;
+
+  g_assert(server != NULL);
+  g_assert(err == NULL || *err == NULL);
+  g_assert(plugin != NULL);
+  g_assert(plugin->rbd != NULL);
+
+  vattr.accessLevel = UA_ACCESSLEVELMASK_READ;
+  vattr.dataType = UA_NODEID_NUMERIC(plugin->ns, UA_IOPID_IOPORTSTATETYPE);
+  vattr.valueRank = UA_VALUERANK_ONE_DIMENSION;
+  vattr.displayName = UA_LOCALIZEDTEXT("", IOP_PORT_STATES_BNAME);
+  vattr.description = UA_LOCALIZEDTEXT(
+          "",
+          "State of all the I/O ports by 0-based port index (the Index "
+          "property), element 0 is I/O Port 1");
+
+  status = UA_Server_addVariableNode_rb(
+          server,
+          UA_NODEID_NUMERIC(plugin->ns, 0),
+          UA_NODEID_NUMERIC(plugin->ns, UA_IOPID_IOPORTS),
+          UA_NODEID_NUMERIC(0, UA_NS0ID_HASCOMPONENT),
+          UA_QUALIFIEDNAME(plugin->ns, IOP_PORT_STATES_BNAME),
+          UA_NODEID_NUMERIC(0, UA_NS0ID_BASEDATAVARIABLETYPE),
+          vattr,
+          NULL,
+          plugin->rbd,
+          &plugin->port_states);
+  if (status != UA_STATUSCODE_GOOD) {
+    SET_ERROR(err,
+              -1,
+              "UA_Server_addVariableNode_rb('%s') failed: %s",
+              IOP_PORT_STATES_BNAME,
+              UA_StatusCode_name(status));
+    return FALSE;
+  }
+
+  status = UA_Server_setVariableNode_dataSource(server,
+                                                plugin->port_states,
+                                                source);
+  if (status != UA_STATUSCODE_GOOD) {
+    SET_ERROR(err,
+              -1,
+              "UA_Server_setVariableNode_dataSource('%s') failed: %s",
+              IOP_PORT_STATES_BNAME,
+              UA_StatusCode_name(status));
+    return FALSE;
+  }
+
+  return TRUE;
+}
+
+/* the 'setPorts' key of a property browse name accepted by 'SetPorts', NULL
+ * for the others. 'Direction' is left out since a change of it also changes
+ * the access level of 'State', see iop_ua_write_dir_cb(). */
+static const gchar *
+iop_set_ports_key(const UA_String *bname)
+{
+  /* clang-format off */
+  static const struct {
+    const gchar *bname;
+    const gchar *key;
+  } keys[] = {
+    { NAME_BNAME, IO_VAPIX_JSON_NAME },
+    { USAGE_BNAME, IO_VAPIX_JSON_USAGE },
+    { STATE_BNAME, IO_VAPIX_JSON_STATE },
+    { NORMALSTATE_BNAME, IO_VAPIX_JSON_NSTATE },
+  };
+  /* clang-format on */
+  UA_String key_bname;
+
+  g_assert(bname != NULL);
+
+  for (guint i = 0; i < G_N_ELEMENTS(keys); i++) {
+    key_bname = UA_STRING((gchar *) keys[i].bname);
+    if (UA_String_equal(bname, &key_bname)) {
+      return keys[i].key;
+    }
+  }
+
+  return NULL;
+}
+
+/* sets properties of several ports in one 'setPorts' request, the input
+ * arguments are arrays of the same length holding the port indexes, the
+ * property browse names and the values. 'State' and 'NormalState' take
+ * "open" or "closed". As with the writes of the properties, the new values
+ * show up once the device emits its port events. */
+static UA_StatusCode
+iop_ua_set_ports_cb(G_GNUC_UNUSED UA_Server *server,
+                    G_GNUC_UNUSED const UA_NodeId *sessionId,
+                    G_GNUC_UNUSED void *sessionHandle,
+                    G_GNUC_UNUSED const UA_NodeId *methodId,
+                    G_GNUC_UNUSED void *methodContext,
+                    G_GNUC_UNUSED const UA_NodeId *objectId,
+                    G_GNUC_UNUSED void *objectContext,
+                    G_GNUC_UNUSED size_t inputSize,
+                    const UA_Variant *input,
+                    G_GNUC_UNUSED size_t outputSize,
+                    G_GNUC_UNUSED UA_Variant *output)
+{
+  iop_port_prop_t props[IOP_SET_PORTS_MAX];
+  gchar *values[IOP_SET_PORTS_MAX] = { NULL };
+  UA_UInt32 *ports;
+  UA_String *bnames;
+  UA_String *ua_values;
+  gsize nr_props;
+  GError *lerr = NULL;
+  UA_StatusCode ret = UA_STATUSCODE_GOOD;
+
+  g_assert(plugin != NULL);
+  g_assert(plugin->vapix_h != NULL);
+  g_assert(input != NULL);
+
+  nr_props = input[0].arrayLength;
+  if (input[1].arrayLength != nr_props || input[2].arrayLength != nr_props) {
+    return UA_STATUSCODE_BADINVALIDARGUMENT;
+  }
+  if (nr_props == 0) {
+    return UA_STATUSCODE_BADNOTHINGTODO;
+  }
+  if (nr_props > IOP_SET_PORTS_MAX) {
+    return UA_STATUSCODE_BADTOOMANYOPERATIONS;
+  }
+
+  ports = input[0].data;
+  bnames = input[1].data;
+  ua_values = input[2].data;
+
+  LOG_D(plugin->logger, "nr_props: %" G_GSIZE_FORMAT, nr_props);
+
+  for (gsize i = 0; i < nr_props; i++) {
+    if (iop_get_port(ports[i]) == NULL) {
+      ret = UA_STATUSCODE_BADOUTOFRANGE;
+      goto out;
+    }
+
+    props[i].portnr = ports[i];
+    props[i].key = iop_set_ports_key(&bnames[i]);
+    if (props[i].key == NULL) {
+      ret = UA_STATUSCODE_BADINVALIDARGUMENT;
+      goto out;
+    }
+
+    /* a later property would silently override an earlier one */
+    for (gsize j = 0; j < i; j++) {
+      if (props[j].portnr == props[i].portnr &&
+          g_strcmp0(props[j].key, props[i].key) == 0) {
+        ret = UA_STATUSCODE_BADINVALIDARGUMENT;
+        goto out;
+      }
+    }
+
+    values[i] = g_strndup((gchar *) ua_values[i].data, ua_values[i].length);
+    props[i].value = values[i];
+
+    if ((g_strcmp0(props[i].key, IO_VAPIX_JSON_STATE) == 0 ||
+         g_strcmp0(props[i].key, IO_VAPIX_JSON_NSTATE) == 0) &&
+        g_strcmp0(values[i], IO_VAPIX_STATE_OPEN) != 0 &&
+        g_strcmp0(values[i], IO_VAPIX_STATE_CLOSED) != 0) {
+      ret = UA_STATUSCODE_BADINVALIDARGUMENT;
+      goto out;
+    }
+  }
+
+  if (!iop_vapix_set_ports(plugin->vapix_h, props, nr_props, &lerr)) {
+    LOG_E(plugin->logger,
+          "iop_vapix_set_ports() failed: %s",
+          GERROR_MSG(lerr));
+    g_clear_error(&lerr);
+    ret = UA_STATUSCODE_BADINTERNALERROR;
+  }
+
+out:
+  for (gsize i = 0; i < nr_props; i++) {
+    g_free(values[i]);
+  }
+
+  return ret;
+}
+
+/* adds the 'SetPorts' method to the "I/O Ports" object */
+static gboolean
+iop_add_set_ports(UA_Server *server, GError **err)
+{
+  UA_MethodAttributes mattr = UA_MethodAttributes_default;
+  UA_Argument in_args[3];
+  UA_NodeId method;
+  UA_StatusCode status;
+
+  g_assert(server != NULL);
+  g_assert(err == NULL || *err == NULL);
+  g_assert(plugin != NULL);
+  g_assert(plugin->rbd != NULL);
+
+  UA_Argument_init(&in_args[0]);
+  in_args[0].description =
+          UA_LOCALIZEDTEXT("en-US", "I/O port indexes (0-based)");
+  in_args[0].name = UA_STRING("Ports");
+  in_args[0].dataType = UA_TYPES[UA_TYPES_UINT32].typeId;
+  in_args[0].valueRank = UA_VALUERANK_ONE_DIMENSION;
+
+  UA_Argument_init(&in_args[1]);
+  in_args[1].description = UA_LOCALIZEDTEXT(
+          "en-US",
+          "Properties to set (Name, Usage, State or NormalState)");
+  in_args[1].name = UA_STRING("Properties");
+  in_args[1].dataType = UA_TYPES[UA_TYPES_STRING].typeId;
+  in_args[1].valueRank = UA_VALUERANK_ONE_DIMENSION;
+
+  UA_Argument_init(&in_args[2]);
+  in_args[2].description = UA_LOCALIZEDTEXT(
+          "en-US",
+          "Values to set, \"open\" or \"closed\" for the states");
+  in_args[2].name = UA_STRING("Values");
+  in_args[2].dataType = UA_TYPES[UA_TYPES_STRING].typeId;
+  in_args[2].valueRank = UA_VALUERANK_ONE_DIMENSION;
+
+  mattr.description = UA_LOCALIZEDTEXT(
+          "en-US",
+          "Set properties of several I/O ports in one request");
+  mattr.displayName = UA_LOCALIZEDTEXT("en-US", IOP_SET_PORTS_BNAME);
+  mattr.executable = TRUE;
+  mattr.userExecutable = TRUE;
+
+  status = UA_Server_addMethodNode_rb(
+          server,
+          UA_NODEID_NUMERIC(plugin->ns, 0),
+          UA_NODEID_NUMERIC(plugin->ns, UA_IOPID_IOPORTS),
+          UA_NODEID_NUMERIC(0, UA_NS0ID_HASCOMPONENT),
+          UA_QUALIFIEDNAME(plugin->ns, IOP_SET_PORTS_BNAME),
+          mattr,
+          &iop_ua_set_ports_cb,
+          3,
+          in_args,
+          0,
+          NULL,
+          NULL,
+          plugin->rbd,
+          &method);
+  if (status != UA_STATUSCODE_GOOD) {
+    SET_ERROR(err,
+              -1,
+              "UA_Server_addMethodNode_rb('%s') failed: %s",
+              IOP_SET_PORTS_BNAME,
+              UA_StatusCode_name(status));
+    return FALSE;
+  }
+
+  /* a failure only leaves the method synchronous */
+  if (plugin->async_methods) {
+    status = ua_utils_set_method_async(server, method);
+    if (status != UA_STATUSCODE_GOOD) {
+      LOG_W(plugin->logger,
+            "ua_utils_set_method_async() failed: %s",
+            UA_StatusCode_name(status));
+    }
+  }
+  UA_NodeId_clear(&method);
+
+  return TRUE;
+}
+
+/* Constructor callback for IOPortObjType object nodes.
+ * It loops over all the object property nodes and:
+ *   - initializes each node with the appropriate value from the data provided
+ *     via the nodeContext
+ *   - sets the access level (R/O or R/W) for the node according to applicable
+ *     conditions
+ *   - attaches UA_DataSource callbacks (to handle read/write access) to
+ *     applicable property nodes */
+static UA_StatusCode
+iop_ua_obj_constructor(UA_Server *server,
+                       G_GNUC_UNUSED const UA_NodeId *sessionId,
+                       G_GNUC_UNUSED void *sessionContext,
+                       G_GNUC_UNUSED const UA_NodeId *typeNodeId,
+                       G_GNUC_UNUSED void *typeNodeContext,
+                       const UA_NodeId *nodeId,
                        void **nodeContext)
 {
   const ioport_proptype_map_t *iop_obj = &IOPort_obj_type_map[0];
@@ -1225,24 +1777,24 @@ iop_ua_obj_constructor(UA_Server *server,
 
   /* clang-format off */
   UA_DataSource iop_dir_cb = {
-    .read = iop_ua_read_dir_cb,
-    .write = iop_ua_write_dir_cb
+    .read = timed_read_dir_cb,
+    .write = timed_write_dir_cb
   };
   UA_DataSource iop_name_cb = {
-    .read = iop_ua_read_name_cb,
-    .write = iop_ua_write_name_cb
+    .read = timed_read_name_cb,
+    .write = timed_write_name_cb
   };
   UA_DataSource iop_usage_cb = {
-    .read = iop_ua_read_usage_cb,
-    .write = iop_ua_write_usage_cb
+    .read = timed_read_usage_cb,
+    .write = timed_write_usage_cb
   };
   UA_DataSource iop_state_cb = {
-    .read = iop_ua_read_state_cb,
-    .write = iop_ua_write_state_cb
+    .read = timed_read_state_cb,
+    .write = timed_write_state_cb
   };
   UA_DataSource iop_normalstate_cb = {
-    .read = iop_ua_read_normalstate_cb,
-    .write = iop_ua_write_normalstate_cb
+    .read = timed_read_normalstate_cb,
+    .write = timed_write_normalstate_cb
   };
   /* clang-format on */
 
@@ -1411,6 +1963,18 @@ iop_ua_obj_constructor(UA_Server *server,
       }
     }
 
+    /* the data source callbacks get the port index from the node context */
+    ua_status = UA_Server_setNodeContext(server,
+                                         prop_nodeId,
+                                         IOP_INDEX_TO_CTX(node_ctx->index));
+    if (ua_status != UA_STATUSCODE_GOOD) {
+      LOG_E(plugin->logger,
+            "Unable to set the node context of property '%s': %s",
+            iop_obj->browse_name,
+            UA_StatusCode_name(ua_status));
+      goto err_out;
+    }
+
     /* done with this property node */
     UA_NodeId_clear(&prop_nodeId);
 
@@ -1466,141 +2030,259 @@ set_ioport_lifecycle_cb(UA_Server *server, UA_UInt16 ns)
 }
 
 /**
- * Creates a new OPC-UA event object to be emitted when an I/O port changes its
- * state.
+ * Returns the new state for an I/O port given the new 'active' state and the
+ * configured 'Normal state'.
  *
  * Input parameters:
- *  * server          - OPC-UA server instance
- *  * eventSourceName - browse name of originating node
- *  * ua_state        - the new state of the I/O port
- *  * eventTypeId     - the type ID of the event
- *  * eventSeverity   - event severity
- *
- * Output parameters:
- *  * outId           - node ID of the OPC-UA event object
+ *  * active       - the 'active' (true/false) state as indicated by the AxEvent
+ *  * normal_state - the currently configured 'Normal state'
  *
  * Returns:
- *  * UA_STATUSCODE_GOOD if successful or a different UA_StatusCode otherwise
+ *  * the new corresponding state (open/closed)
  */
-static UA_StatusCode
-iop_ua_create_event(UA_Server *server,
-                    UA_String eventSourceName,
-                    UA_IOPortStateType ua_state,
-                    UA_UInt32 eventTypeId,
-                    UA_UInt16 eventSeverity,
-                    UA_NodeId *outId)
+static UA_IOPortStateType
+iop_new_state(gboolean active, UA_IOPortStateType normal_state)
 {
-  UA_StatusCode ret;
-  UA_DateTime eventTime;
-  UA_LocalizedText eventMessage;
+  UA_IOPortStateType new_state;
+
+  if (active) {
+    if (normal_state == UA_IOPORTSTATETYPE_OPEN) {
+      new_state = UA_IOPORTSTATETYPE_CLOSED;
+    } else {
+      new_state = UA_IOPORTSTATETYPE_OPEN;
+    }
+  } else {
+    if (normal_state == UA_IOPORTSTATETYPE_OPEN) {
+      new_state = UA_IOPORTSTATETYPE_OPEN;
+    } else {
+      new_state = UA_IOPORTSTATETYPE_CLOSED;
+    }
+  }
+
+  return new_state;
+}
+
+/* an #ua_queue_func_t emitting the OPC-UA event of a port state change */
+static void
+iop_emit_state_change(UA_Server *server, gpointer data)
+{
+  iop_state_change_t *change = data;
+  gchar *id_str;
+  gchar *msg;
+  GError *lerr = NULL;
+  UA_NodeId iop_node = UA_NODEID_NULL;
+  UA_NodeId ioports_obj;
+  ua_event_fields_t fields;
 
   g_assert(server != NULL);
-  g_assert(outId != NULL);
+  g_assert(change != NULL);
   g_assert(plugin != NULL);
   g_assert(plugin->logger != NULL);
 
-  ret = UA_Server_createEvent(server,
-                              UA_NODEID_NUMERIC(plugin->ns, eventTypeId),
-                              outId);
-  if (ret != UA_STATUSCODE_GOOD) {
+  ioports_obj = UA_NODEID_NUMERIC(plugin->ns, UA_IOPID_IOPORTS);
+
+  /* NOTE: web GUI uses 1-based indexing */
+  id_str = ua_arena_printf(plugin->emit_arena,
+                           IOP_LABEL_FMT,
+                           change->port + 1);
+
+  /* find the node id corresponding to the browseName */
+  if (!iop_ua_get_nodeid_from_browsename(server,
+                                         &ioports_obj,
+                                         UA_NS0ID_ORGANIZES,
+                                         id_str,
+                                         &iop_node,
+                                         &lerr)) {
     LOG_E(plugin->logger,
-          "UA_Server_createEvent() failed: %s",
-          UA_StatusCode_name(ret));
-    return ret;
+          "iop_ua_get_nodeid_from_browsename() failed: %s",
+          GERROR_MSG(lerr));
+    goto out;
   }
 
-  /* Set the Event Attributes */
-  /* Setting the Time is required or else the event will not show up in
+  /* setting the Time is required or else the event will not show up in
    * UAExpert! */
-  eventTime = UA_DateTime_now();
-  ret = UA_Server_writeObjectProperty_scalar(server,
-                                             *outId,
-                                             UA_QUALIFIEDNAME(0, "Time"),
-                                             &eventTime,
-                                             &UA_TYPES[UA_TYPES_DATETIME]);
-  if (ret != UA_STATUSCODE_GOOD) {
+  fields.time = change->time;
+  fields.severity = IOP_STATE_CHANGE_EV_SEVERITY;
+  if (change->coalesced == 0) {
+    msg = change->state == UA_IOPORTSTATETYPE_OPEN ? "New state: OPEN" :
+                                                     "New state: CLOSED";
+  } else {
+    /* a summary of the state changes during chatter */
+    msg = ua_arena_printf(plugin->emit_arena,
+                          "New state: %s (%u changes coalesced)",
+                          change->state == UA_IOPORTSTATETYPE_OPEN ? "OPEN" :
+                                                                     "CLOSED",
+                          change->coalesced);
+  }
+  fields.message = UA_LOCALIZEDTEXT("en-US", msg);
+  fields.sourceName = UA_STRING(id_str);
+
+  /* trigger the OPC-UA event, the port object is the event origin node */
+  if (!ua_utils_event_pool_trigger(plugin->state_events,
+                                   server,
+                                   &iop_node,
+                                   &fields,
+                                   &lerr)) {
     LOG_E(plugin->logger,
-          "UA_Server_writeObjectProperty_scalar('Time') failed: %s",
-          UA_StatusCode_name(ret));
-    return ret;
+          "ua_utils_event_pool_trigger() failed: %s",
+          GERROR_MSG(lerr));
   }
 
-  ret = UA_Server_writeObjectProperty_scalar(server,
-                                             *outId,
-                                             UA_QUALIFIEDNAME(0, "Severity"),
-                                             &eventSeverity,
-                                             &UA_TYPES[UA_TYPES_UINT16]);
-  if (ret != UA_STATUSCODE_GOOD) {
+  ua_metric_observe_since(plugin->event_latency, change->queued);
+
+out:
+  g_clear_error(&lerr);
+  ua_arena_reset(plugin->emit_arena);
+  UA_NodeId_clear(&iop_node);
+}
+
+/* hands a state change over to the server thread to be emitted */
+static void
+iop_queue_state_change(guint port,
+                       UA_IOPortStateType state,
+                       UA_DateTime time,
+                       guint coalesced)
+{
+  iop_state_change_t *change;
+  GError *lerr = NULL;
+
+  g_assert(plugin != NULL);
+  g_assert(plugin->logger != NULL);
+
+  change = g_new0(iop_state_change_t, 1);
+  change->port = port;
+  change->state = state;
+  change->time = time;
+  change->coalesced = coalesced;
+  change->queued = g_get_monotonic_time();
+
+  if (!ua_queue_push(plugin->queue,
+                     iop_emit_state_change,
+                     change,
+                     g_free,
+                     &lerr)) {
     LOG_E(plugin->logger,
-          "UA_Server_writeObjectProperty_scalar('Severity') failed: %s",
-          UA_StatusCode_name(ret));
-    return ret;
+          "Dropped the state change of port: %u: %s",
+          port,
+          GERROR_MSG(lerr));
+    g_clear_error(&lerr);
+    g_free(change);
   }
+}
+
+/* takes one event from the token bucket of the port, FALSE if it is empty */
+static gboolean
+iop_take_token(iop_port_t *port, gint64 now)
+{
+  gdouble rate;
+
+  g_assert(plugin != NULL);
+  g_assert(port != NULL);
 
-  if (ua_state == UA_IOPORTSTATETYPE_OPEN) {
-    eventMessage = UA_LOCALIZEDTEXT("en-US", "New state: OPEN");
-  } else if (ua_state == UA_IOPORTSTATETYPE_CLOSED) {
-    eventMessage = UA_LOCALIZEDTEXT("en-US", "New state: CLOSED");
+  if (plugin->event_max_rate == 0) {
+    return TRUE;
   }
 
-  ret = UA_Server_writeObjectProperty_scalar(server,
-                                             *outId,
-                                             UA_QUALIFIEDNAME(0, "Message"),
-                                             &eventMessage,
-                                             &UA_TYPES[UA_TYPES_LOCALIZEDTEXT]);
-  if (ret != UA_STATUSCODE_GOOD) {
-    LOG_E(plugin->logger,
-          "UA_Server_writeObjectProperty_scalar('Message') failed: %s",
-          UA_StatusCode_name(ret));
-    return ret;
+  /* refill, a burst of at most one second worth of events is allowed */
+  rate = plugin->event_max_rate;
+  port->tokens += (gdouble) (now - port->refilled) * rate / G_USEC_PER_SEC;
+  port->tokens = MIN(port->tokens, rate);
+  port->refilled = now;
+
+  if (port->tokens < 1.0) {
+    return FALSE;
   }
+  port->tokens -= 1.0;
 
-  ret = UA_Server_writeObjectProperty_scalar(server,
-                                             *outId,
-                                             UA_QUALIFIEDNAME(0, "SourceName"),
-                                             &eventSourceName,
-                                             &UA_TYPES[UA_TYPES_STRING]);
-  if (ret != UA_STATUSCODE_GOOD) {
-    LOG_E(plugin->logger,
-          "UA_Server_writeObjectProperty_scalar('SourceName') failed: %s",
-          UA_StatusCode_name(ret));
-    return ret;
+  return TRUE;
+}
+
+static gboolean
+iop_flush_state_cb(gpointer user_data);
+
+/* arms the timer emitting the folded state changes of the port once both the
+ * coalescing window and the rate limit allow it */
+static void
+iop_schedule_flush(guint index, iop_port_t *port, gint64 now)
+{
+  gint64 when;
+
+  g_assert(plugin != NULL);
+  g_assert(port != NULL);
+
+  if (port->flush_id != 0) {
+    return;
   }
 
-  return UA_STATUSCODE_GOOD;
+  when = MAX(port->window_end, now);
+  if (plugin->event_max_rate != 0 && port->tokens < 1.0) {
+    gint64 refill = (gint64) ((1.0 - port->tokens) * G_USEC_PER_SEC /
+                              plugin->event_max_rate);
+
+    when = MAX(when, port->refilled + refill);
+  }
+
+  /* round up so that the timer never fires before the deadline */
+  port->flush_id = g_timeout_add((guint) ((when - now + 999) / 1000),
+                                 iop_flush_state_cb,
+                                 GUINT_TO_POINTER(index));
 }
 
-/**
- * Returns the new state for an I/O port given the new 'active' state and the
- * configured 'Normal state'.
- *
- * Input parameters:
- *  * active       - the 'active' (true/false) state as indicated by the AxEvent
- *  * normal_state - the currently configured 'Normal state'
- *
- * Returns:
- *  * the new corresponding state (open/closed)
- */
-static UA_IOPortStateType
-iop_new_state(gboolean active, UA_IOPortStateType normal_state)
+/* emits a summary of the state changes folded during the coalescing window */
+static gboolean
+iop_flush_state_cb(gpointer user_data)
 {
-  UA_IOPortStateType new_state;
+  guint index = GPOINTER_TO_UINT(user_data);
+  iop_port_t *port;
+  gint64 now = g_get_monotonic_time();
 
-  if (active) {
-    if (normal_state == UA_IOPORTSTATETYPE_OPEN) {
-      new_state = UA_IOPORTSTATETYPE_CLOSED;
-    } else {
-      new_state = UA_IOPORTSTATETYPE_OPEN;
-    }
-  } else {
-    if (normal_state == UA_IOPORTSTATETYPE_OPEN) {
-      new_state = UA_IOPORTSTATETYPE_OPEN;
-    } else {
-      new_state = UA_IOPORTSTATETYPE_CLOSED;
-    }
+  g_assert(plugin != NULL);
+
+  port = iop_get_port(index);
+  g_assert(port != NULL);
+
+  port->flush_id = 0;
+  if (port->coalesced == 0) {
+    return G_SOURCE_REMOVE;
   }
 
-  return new_state;
+  if (now < port->window_end || !iop_take_token(port, now)) {
+    iop_schedule_flush(index, port, now);
+    return G_SOURCE_REMOVE;
+  }
+
+  iop_queue_state_change(index,
+                         (UA_IOPortStateType) g_atomic_int_get(&port->state),
+                         port->changed,
+                         port->coalesced);
+  port->coalesced = 0;
+  port->window_end = now + (gint64) plugin->event_window * 1000;
+
+  return G_SOURCE_REMOVE;
+}
+
+/* emits the state change right away unless the port is chattering, then it
+ * is folded into the summary emitted by iop_flush_state_cb() */
+static void
+iop_handle_state_change(guint index,
+                        iop_port_t *port,
+                        UA_IOPortStateType state)
+{
+  gint64 now = g_get_monotonic_time();
+
+  g_assert(plugin != NULL);
+  g_assert(port != NULL);
+
+  if (port->flush_id == 0 && now >= port->window_end &&
+      iop_take_token(port, now)) {
+    iop_queue_state_change(index, state, UA_DateTime_now(), 0);
+    port->window_end = now + (gint64) plugin->event_window * 1000;
+    return;
+  }
+
+  port->coalesced++;
+  port->changed = UA_DateTime_now();
+  iop_schedule_flush(index, port, now);
 }
 
 /**
@@ -1615,22 +2297,18 @@ iop_state_ev_cb(G_GNUC_UNUSED guint subscription,
 {
   const AXEventKeyValueSet *key_value_set;
   gint port;
-  ioport_obj_t *iop = NULL;
+  iop_port_t *iop;
   gboolean active;
   gchar *topic2 = NULL;
-  gchar *id_str = NULL;
   GError *lerr = NULL;
-  UA_StatusCode retval;
-  UA_NodeId iop_node = UA_NODEID_NULL;
-  UA_NodeId eventNodeId;
-  UA_NodeId ioports_obj = UA_NODEID_NUMERIC(plugin->ns, UA_IOPID_IOPORTS);
   UA_IOPortStateType ua_state;
 
   g_assert(event != NULL);
   g_assert(plugin != NULL);
-  g_assert(plugin->iop_ht != NULL);
+  g_assert(plugin->ports != NULL);
   g_assert(plugin->logger != NULL);
-  g_assert(plugin->server != NULL);
+
+  UA_TRACE_ENTRY(axevent, G_STRFUNC);
 
   /* extract the AXEventKeyValueSet from the event. */
   key_value_set = ax_event_get_key_value_set(event);
@@ -1686,79 +2364,37 @@ iop_state_ev_cb(G_GNUC_UNUSED guint subscription,
   if ((g_strcmp0(topic2, "Port") == 0 ||
        g_strcmp0(topic2, "OutputPort") == 0) &&
       (port > -1)) {
-    /* look up this port in our hash table and update the 'state' accordingly */
-    IOP_HT_LOCK(iop_mtx);
-    iop = g_hash_table_lookup(plugin->iop_ht, &port);
+    /* look up this port in our cache and update the 'state' accordingly */
+    iop = iop_get_port(port);
     if (!iop) {
       LOG_W(plugin->logger, "port: %d not found, ignoring AxEvent!", port);
-      IOP_HT_UNLOCK(iop_mtx);
       goto err_out;
     }
 
     /* update the current state of the port in our cache based on the AxEvent
      * ('active') we received and the current value of the "NormalState"
      * property of the port. */
-    iop->state = iop_new_state(active, iop->normal_state);
-    ua_state = iop->state;
-    IOP_HT_UNLOCK(iop_mtx);
+    ua_state = iop_new_state(active,
+                             (UA_IOPortStateType) g_atomic_int_get(
+                                     &iop->normal_state));
+    g_atomic_int_set(&iop->state, ua_state);
 
     LOG_D(plugin->logger,
           "I/O port: %d, new state: %s",
           port,
           ua_state == UA_IOPORTSTATETYPE_OPEN ? "OPEN" : "CLOSED");
 
-    /* NOTE: web GUI uses 1-based indexing */
-    id_str = g_strdup_printf(IOP_LABEL_FMT, port + 1);
-
-    /* find the node id corresponding to the browseName */
-    if (!iop_ua_get_nodeid_from_browsename(plugin->server,
-                                           &ioports_obj,
-                                           UA_NS0ID_ORGANIZES,
-                                           id_str,
-                                           &iop_node,
-                                           &lerr)) {
-      LOG_E(plugin->logger,
-            "iop_ua_get_nodeid_from_browsename() failed: %s",
-            GERROR_MSG(lerr));
-      goto err_out;
-    }
-
-    /* set up a node representation of the OPC-UA event */
-    retval = iop_ua_create_event(plugin->server,
-                                 UA_STRING(id_str),
-                                 ua_state,
-                                 UA_IOPID_IOPSTATEEVENTTYPE,
-                                 IOP_STATE_CHANGE_EV_SEVERITY,
-                                 &eventNodeId);
-    if (retval != UA_STATUSCODE_GOOD) {
-      LOG_E(plugin->logger,
-            "iop_ua_create_event() failed: %s",
-            UA_StatusCode_name(retval));
-      goto err_out;
-    }
-
-    /* trigger the OPC-UA event */
-    retval = UA_Server_triggerEvent(plugin->server,
-                                    eventNodeId,
-                                    iop_node, /* event origin node */
-                                    NULL,
-                                    UA_TRUE);
-    if (retval != UA_STATUSCODE_GOOD) {
-      LOG_E(plugin->logger,
-            "UA_Server_triggerEvent failed: %s",
-            UA_StatusCode_name(retval));
-      goto err_out;
-    }
+    /* the OPC-UA event is emitted from the server thread */
+    iop_handle_state_change((guint) port, iop, ua_state);
   }
 
 err_out:
   g_clear_error(&lerr);
   g_clear_pointer(&topic2, g_free);
-  g_clear_pointer(&id_str, g_free);
-  UA_NodeId_clear(&iop_node);
 
   /* the callback must always free 'event', NULL-case handled by the API */
   ax_event_free(event);
+  UA_TRACE_EXIT(axevent, G_STRFUNC, 0);
 
   return;
 }
@@ -1775,20 +2411,21 @@ iop_cfg_ev_cb(G_GNUC_UNUSED guint subscription,
 {
   const AXEventKeyValueSet *key_value_set;
   gint64 port_nr;
-  ioport_obj_t *iop = NULL;
+  iop_port_t *iop;
   gchar *cfg_changes = NULL;
-  gchar *cfg_changes_unq = NULL;
-  gchar **strv;
-  gchar *param, *val;
+  gchar *param = NULL;
+  gchar *val;
   gchar *id_str = NULL;
-  gchar *iop_index = NULL;
   GError *lerr = NULL;
+  gint64 start = g_get_monotonic_time();
 
   g_assert(event != NULL);
   g_assert(plugin != NULL);
-  g_assert(plugin->iop_ht != NULL);
+  g_assert(plugin->ports != NULL);
   g_assert(plugin->logger != NULL);
 
+  UA_TRACE_ENTRY(axevent, G_STRFUNC);
+
   /* extract the AXEventKeyValueSet from the event. */
   key_value_set = ax_event_get_key_value_set(event);
   if (key_value_set == NULL) {
@@ -1818,54 +2455,18 @@ iop_cfg_ev_cb(G_GNUC_UNUSED guint subscription,
     goto err_out;
   }
 
-  /* extract the port number (index) from the 'id' key of the AxEvent which is
-   * of the following form:
-   * /com/axis/Configuration/Legacy/IOControl/IOPort/<port index> */
-  iop_index = g_strrstr(id_str, "/");
-  if (!iop_index) {
-    LOG_E(plugin->logger, "Can't parse AxEvent for a port index!");
-    goto err_out;
-  }
-
-  /* iop_index + 1: skip over the '/' character */
-  port_nr = ascii_strtoll_dec(iop_index + 1, &lerr);
-  if (lerr != NULL) {
+  if (!iop_parse_cfg_change(cfg_changes,
+                            id_str,
+                            &port_nr,
+                            &param,
+                            &val,
+                            &lerr)) {
     LOG_E(plugin->logger,
-          "Invalid port index in AxEvent: %s",
+          "Can't parse the configuration change AxEvent: %s",
           GERROR_MSG(lerr));
     goto err_out;
   }
 
-  /* The string describing the parameter change is expected to be in form of:
-   * `"%s=%s"`. For example a name change of an I/O port can look like this:
-   * "Name=Port 01" */
-
-  /* strip away the double quotes */
-  cfg_changes_unq = g_shell_unquote(cfg_changes, &lerr);
-  if (lerr != NULL) {
-    LOG_E(plugin->logger, "g_shell_unquote() failed: %s", GERROR_MSG(lerr));
-    goto err_out;
-  }
-
-  /* split the string into 2 tokens (parameter and value)
-   * using '=' as separator */
-  strv = g_strsplit(cfg_changes_unq, "=", 2);
-  if (strv == NULL) {
-    LOG_E(plugin->logger, "Can't parse AxEvent key: 'configuration_changes'!");
-    goto err_out;
-  }
-
-  /* We expect to have 2 tokens in our 'strv' array of strings. This also
-   * implies they are not NULL. */
-  if (g_strv_length(strv) != 2) {
-    LOG_E(plugin->logger,
-          "Unexpected result parsing AxEvent key: 'configuration_changes'!");
-    goto err_out;
-  }
-
-  param = *strv;
-  val = *(strv + 1);
-
   LOG_D(plugin->logger,
         "configuration_changes: %s, id: %s ==> port: %" G_GINT64_FORMAT
         ", param: %s, val: %s",
@@ -1875,52 +2476,50 @@ iop_cfg_ev_cb(G_GNUC_UNUSED guint subscription,
         param,
         val);
 
-  /* update our cached information in 'iop_ht' */
-  IOP_HT_LOCK(iop_mtx);
-  iop = g_hash_table_lookup(plugin->iop_ht, &port_nr);
+  /* update our cached information of the port */
+  iop = (port_nr >= 0 && port_nr <= G_MAXUINT) ? iop_get_port(port_nr) : NULL;
   if (iop == NULL) {
     LOG_W(plugin->logger,
           "port: %" G_GINT64_FORMAT " not found, ignoring AxEvent!",
           port_nr);
-    IOP_HT_UNLOCK(iop_mtx);
     goto err_out;
   }
 
   if (g_strcmp0(param, IOP_CFG_CHANGE_NAME) == 0) {
     /* 'Name' got changed */
-    g_clear_pointer(&iop->name, g_free);
-    iop->name = g_strdup(val);
+    iop_labels_replace(iop, val, NULL);
   } else if (g_strcmp0(param, IOP_CFG_CHANGE_USAGE) == 0) {
     /* 'Usage' got changed */
-    g_clear_pointer(&iop->usage, g_free);
-    iop->usage = g_strdup(val);
+    iop_labels_replace(iop, NULL, val);
   } else if (g_strcmp0(param, IOP_CFG_CHANGE_DIR) == 0) {
     /* 'Direction' got changed */
     if (g_strcmp0(val, IO_VAPIX_DIR_INPUT) == 0) {
-      iop->direction = UA_IOPORTDIRECTIONTYPE_INPUT;
+      g_atomic_int_set(&iop->direction, UA_IOPORTDIRECTIONTYPE_INPUT);
     } else {
-      iop->direction = UA_IOPORTDIRECTIONTYPE_OUTPUT;
+      g_atomic_int_set(&iop->direction, UA_IOPORTDIRECTIONTYPE_OUTPUT);
     }
   } else if ((g_strcmp0(param, IOP_CFG_CHANGE_NS_OUT) == 0) ||
              (g_strcmp0(param, IOP_CFG_CHANGE_NS_IN) == 0)) {
     /* 'Normal state' got changed */
     if (g_strcmp0(val, IO_VAPIX_STATE_OPEN) == 0) {
-      iop->normal_state = UA_IOPORTSTATETYPE_CLOSED;
+      g_atomic_int_set(&iop->normal_state, UA_IOPORTSTATETYPE_CLOSED);
     } else {
-      iop->normal_state = UA_IOPORTSTATETYPE_OPEN;
+      g_atomic_int_set(&iop->normal_state, UA_IOPORTSTATETYPE_OPEN);
     }
   }
-  IOP_HT_UNLOCK(iop_mtx);
 
 err_out:
-  g_strfreev(strv);
-  g_clear_pointer(&cfg_changes_unq, g_free);
+  /* 'val' points into 'param' */
+  g_clear_pointer(&param, g_free);
   g_clear_pointer(&cfg_changes, g_free);
   g_clear_pointer(&id_str, g_free);
   g_clear_error(&lerr);
 
   /* the callback must always free 'event', NULL-case handled by the API */
   ax_event_free(event);
+  UA_TRACE_EXIT(axevent, G_STRFUNC, 0);
+
+  ua_metric_observe_since(plugin->cfg_event, start);
 
   return;
 }
@@ -2042,16 +2641,9 @@ plugin_cleanup(void)
   g_assert(plugin != NULL);
   g_assert(plugin->logger != NULL);
 
-  if (plugin->curl_h != NULL) {
-    curl_easy_cleanup(plugin->curl_h);
-  }
+  g_clear_pointer(&plugin->vapix_h, vapix_session_free);
 
-  IOP_HT_LOCK(iop_mtx);
-  if (plugin->iop_ht) {
-    g_hash_table_destroy(plugin->iop_ht);
-  }
-  IOP_HT_UNLOCK(iop_mtx);
-  g_mutex_clear(&plugin->iop_mtx);
+  iop_free_ports();
 
   if (plugin->iopstate_evh != NULL) {
     /* unsubscribe from I/O port state change events */
@@ -2086,71 +2678,137 @@ plugin_cleanup(void)
   }
 
   g_clear_pointer(&plugin->name, g_free);
-  g_clear_pointer(&plugin->vapix_credentials, g_free);
 
   /* free up allocated rollback data, if any */
   ua_utils_clear_rbd(&plugin->rbd);
 
+  g_clear_pointer(&plugin->nodes, ua_utils_node_cache_free);
+  plugin->queue = NULL;
+  g_clear_pointer(&plugin->state_events, ua_utils_event_pool_free);
+  g_clear_pointer(&plugin->emit_arena, ua_arena_free);
+  UA_NodeId_clear(&plugin->port_states);
+  g_clear_pointer(&plugin->port_info, g_hash_table_destroy);
+
   g_clear_pointer(&plugin, g_free);
 }
 
+/* allocates the plugin and fetches the I/O ports over VAPIX, blocking but
+ * without accessing the server */
+static gboolean
+plugin_prefetch(UA_Logger *logger,
+                ua_plugin_params_t *services,
+                GError **err)
+{
+  g_assert(plugin == NULL);
+  g_assert(logger != NULL);
+  g_assert(services != NULL);
+  g_assert(err == NULL || *err == NULL);
+
+  plugin = g_new0(plugin_t, 1);
+
+  plugin->name = g_strdup(UA_PLUGIN_NAME);
+  plugin->logger = logger;
+  plugin->rbd = g_new0(rollback_data_t, 1);
+  plugin->nodes = ua_utils_node_cache_new();
+  plugin->queue = services->queue;
+  plugin->event_window = services->io_event_window;
+  plugin->event_max_rate = services->io_event_max_rate;
+  plugin->async_methods = (services->method_workers > 0);
+  plugin->rbd->node_cache = plugin->nodes;
+  plugin->emit_arena = ua_arena_new(IOP_EMIT_ARENA_SIZE);
+  plugin->reads = ua_metrics_get(UA_METRIC_TIMING, "ioports.reads");
+  plugin->writes = ua_metrics_get(UA_METRIC_TIMING, "ioports.writes");
+  plugin->event_latency =
+          ua_metrics_get(UA_METRIC_TIMING, "ioports.event_latency");
+  plugin->cfg_event = ua_metrics_get(UA_METRIC_TIMING, "ioports.cfg_event");
+
+  /* the credentials of the VAPIX account are managed by the service */
+  plugin->vapix_h =
+          vapix_session_new(services->vapix, "vapix-ioports-user", err);
+  if (plugin->vapix_h == NULL) {
+    g_prefix_error(err, "vapix_session_new() failed: ");
+    goto err_out;
+  }
+
+  /* check API version compatibility */
+  if (!iop_vapix_check_api_ver(plugin->vapix_h, err)) {
+    g_prefix_error(err, "iop_vapix_check_api_ver() failed: ");
+    goto err_out;
+  }
+
+  /* Fetch the available I/O ports on the device */
+  if (!iop_vapix_get_ports(plugin->vapix_h, &plugin->port_info, err)) {
+    g_prefix_error(err, "iop_vapix_get_ports() failed: ");
+    goto err_out;
+  }
+
+  return TRUE;
+
+err_out:
+  plugin_cleanup();
+
+  return FALSE;
+}
+
 /* Exported functions */
+gboolean
+opc_ua_prepare(UA_Logger *logger, gpointer *params, GError **err)
+{
+  ua_plugin_params_t *services = (ua_plugin_params_t *) params;
+
+  g_return_val_if_fail(logger != NULL, FALSE);
+  g_return_val_if_fail(services != NULL, FALSE);
+  g_return_val_if_fail(services->vapix != NULL, FALSE);
+  g_return_val_if_fail(services->queue != NULL, FALSE);
+  g_return_val_if_fail(err == NULL || *err == NULL, FALSE);
+
+  if (plugin != NULL) {
+    return TRUE;
+  }
+
+  if (!plugin_prefetch(logger, services, err)) {
+    g_prefix_error(err, "plugin_prefetch() failed: ");
+    return FALSE;
+  }
+
+  return TRUE;
+}
+
 gboolean
 opc_ua_create(UA_Server *server,
               UA_Logger *logger,
-              G_GNUC_UNUSED gpointer *params,
+              gpointer *params,
               GError **err)
 {
+  ua_plugin_params_t *services = (ua_plugin_params_t *) params;
   size_t ns_idx;
   UA_StatusCode ua_status;
-  GHashTableIter ht_iter;
-  gpointer key;
-  gpointer value;
+  GHashTable *iop_ht = NULL;
+  UA_NodeId ev_type;
   GError *lerr = NULL;
 
   g_return_val_if_fail(server != NULL, FALSE);
   g_return_val_if_fail(logger != NULL, FALSE);
+  g_return_val_if_fail(services != NULL, FALSE);
+  g_return_val_if_fail(services->vapix != NULL, FALSE);
+  g_return_val_if_fail(services->queue != NULL, FALSE);
   g_return_val_if_fail(err == NULL || *err == NULL, FALSE);
 
-  if (plugin != NULL) {
+  if (plugin != NULL && plugin->server != NULL) {
     return TRUE;
   }
 
-  plugin = g_new0(plugin_t, 1);
-
-  plugin->name = g_strdup(UA_PLUGIN_NAME);
-  plugin->logger = logger;
-  plugin->iop_ht = NULL;
-  plugin->server = server;
-  plugin->rbd = g_new0(rollback_data_t, 1);
-  g_mutex_init(&plugin->iop_mtx);
-
-  /* allocate a curl handle that we are going to use throughout our requests */
-  plugin->curl_h = curl_easy_init();
-  if (plugin->curl_h == NULL) {
-    SET_ERROR(err, -1, "curl_easy_init() failed!");
-    goto err_out;
-  }
-
-  /* obtain credentials to make VAPIX calls */
-  plugin->vapix_credentials = vapix_get_credentials("vapix-ioports-user", err);
-  if (plugin->vapix_credentials == NULL) {
-    g_prefix_error(err, "Failed to get the VAPIX credentials: ");
-    goto err_out;
+  /* unless already done by opc_ua_prepare() */
+  if (plugin == NULL && !plugin_prefetch(logger, services, err)) {
+    g_prefix_error(err, "plugin_prefetch() failed: ");
+    return FALSE;
   }
 
-  /* check API version compatibility */
-  if (!iop_vapix_check_api_ver(plugin->curl_h,
-                               plugin->vapix_credentials,
-                               err)) {
-    g_prefix_error(err, "iop_vapix_check_api_ver() failed: ");
-    goto err_out;
-  }
+  plugin->server = server;
 
   /* add the "I/O Ports" namespace to the information model */
-  ua_status = ioports_ns(server, plugin->rbd);
-  if (ua_status != UA_STATUSCODE_GOOD) {
-    g_prefix_error(err, "ns_ioports() failed: ");
+  if (!ua_model_load(server, &ioports_model, plugin->rbd, err)) {
+    g_prefix_error(err, "ua_model_load() failed: ");
     goto err_out;
   }
 
@@ -2163,7 +2821,7 @@ opc_ua_create(UA_Server *server,
               "UA_Server_getNamespaceByName('%s') failed: %s",
               UA_PLUGIN_NAMESPACE,
               UA_StatusCode_name(ua_status));
-    return FALSE;
+    goto err_out;
   }
   plugin->ns = ns_idx;
 
@@ -2177,31 +2835,34 @@ opc_ua_create(UA_Server *server,
     goto err_out;
   }
 
-  IOP_HT_LOCK(iop_mtx);
-  /* Fetch the available I/O ports on the device */
-  if (!iop_vapix_get_ports(plugin->curl_h,
-                           plugin->vapix_credentials,
-                           &plugin->iop_ht,
-                           err)) {
-    g_prefix_error(err, "iop_vapix_get_ports() failed: ");
-    IOP_HT_UNLOCK(iop_mtx);
+  /* fetched over VAPIX by plugin_prefetch() */
+  iop_ht = g_steal_pointer(&plugin->port_info);
+
+  /* the port records must exist before the objects are constructed */
+  iop_init_ports(iop_ht);
+
+  /* add the ports to the UA information model */
+  if (!iop_add_ioport_objects(server, iop_ht, err)) {
+    g_prefix_error(err, "iop_add_ioport_objects() failed: ");
     goto err_out;
   }
+  g_clear_pointer(&iop_ht, g_hash_table_destroy);
 
-  /* iterate over the hash table elements and add the ports to the UA
-   * information model */
-  g_hash_table_iter_init(&ht_iter, plugin->iop_ht);
-  while (g_hash_table_iter_next(&ht_iter, &key, &value)) {
-    if (!iop_add_ioport_object(server,
-                               *(guint32 *) key,
-                               (ioport_obj_t *) value,
-                               err)) {
-      g_prefix_error(err, "iop_add_ioport_object() failed: ");
-      IOP_HT_UNLOCK(iop_mtx);
-      goto err_out;
-    }
+  if (!iop_add_port_states(server, err)) {
+    g_prefix_error(err, "iop_add_port_states() failed: ");
+    goto err_out;
+  }
+
+  if (!iop_add_set_ports(server, err)) {
+    g_prefix_error(err, "iop_add_set_ports() failed: ");
+    goto err_out;
   }
-  IOP_HT_UNLOCK(iop_mtx);
+
+  ev_type = UA_NODEID_NUMERIC(plugin->ns, UA_IOPID_IOPSTATEEVENTTYPE);
+  plugin->state_events =
+          ua_utils_event_pool_new(&ev_type, IOP_STATE_EV_POOL_SIZE);
+  ua_utils_event_pool_keep_history(plugin->state_events,
+                                   services->event_history);
 
   plugin->iopstate_evh = ax_event_handler_new();
   if (!plugin->iopstate_evh) {
@@ -2220,13 +2881,22 @@ opc_ua_create(UA_Server *server,
     goto err_out;
   }
 
-  /* the information model was successfully populated so now we can free up our
-   * rollback data since we no longer need it */
-  ua_utils_clear_rbd(&plugin->rbd);
+  /* the clients of the server don't depend on the publishing */
+  if (!ua_pubsub_publish(server,
+                         &plugin->port_states,
+                         IOP_PORT_STATES_ALIAS,
+                         &lerr)) {
+    LOG_W(plugin->logger, "ua_pubsub_publish() failed: %s", GERROR_MSG(lerr));
+    g_clear_error(&lerr);
+  }
+
+  /* the rollback data is kept, opc_ua_remove() deletes the nodes it lists */
 
   return TRUE;
 
 err_out:
+  g_clear_pointer(&iop_ht, g_hash_table_destroy);
+
   /* remove any nodes created so far */
   if (!iop_ua_do_rollback(&lerr)) {
     /* NOTE: if we land here we might just as well terminate the whole
@@ -2241,6 +2911,36 @@ err_out:
   return FALSE;
 }
 
+gboolean
+opc_ua_remove(UA_Server *server, GError **err)
+{
+  g_return_val_if_fail(server != NULL, FALSE);
+  g_return_val_if_fail(err == NULL || *err == NULL, FALSE);
+
+  if (plugin == NULL || plugin->rbd == NULL) {
+    return TRUE;
+  }
+
+  /* the published fields refer to the variables of the plugin */
+  if (!ua_pubsub_unpublish(server, plugin->ns, err)) {
+    g_prefix_error(err, "ua_pubsub_unpublish() failed: ");
+    return FALSE;
+  }
+
+  /* the event nodes are created as the events are triggered */
+  if (plugin->state_events != NULL) {
+    ua_utils_event_pool_remove(plugin->state_events, server);
+  }
+
+  if (!ua_utils_do_rollback(server, plugin->rbd, err)) {
+    g_prefix_error(err, "ua_utils_do_rollback() failed: ");
+    return FALSE;
+  }
+  ua_utils_clear_rbd(&plugin->rbd);
+
+  return TRUE;
+}
+
 void
 opc_ua_destroy(void)
 {
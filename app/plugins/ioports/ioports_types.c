@@ -23,6 +23,8 @@
  * SOFTWARE.
  */
 
+/* Generated by tools/ua_model_gen.py from ioports.NodeSet2.xml, do not edit */
+
 #include "ioports_nodeids.h"
 #include "ioports_types.h"
 
@@ -47,7 +49,7 @@ UA_DataType UA_TYPES_IOP[UA_TYPES_IOP_COUNT] = {
           0,                                        /* .membersSize */
           IOPortDirectionType_members               /* .members */
   },
- /* IOPortStateType */
+  /* IOPortStateType */
   {
    UA_TYPENAME("IOPortStateType")                   /* .typeName */
           { 0, UA_NODEIDTYPE_NUMERIC, { UA_IOPID_IOPORTSTATETYPE } },
@@ -23,6 +23,8 @@
  * SOFTWARE.
  */
 
+/* Generated by tools/ua_model_gen.py from ioports.NodeSet2.xml, do not edit */
+
 #ifndef __IOPORTS_TYPES_H__
 #define __IOPORTS_TYPES_H__
 
@@ -59,7 +61,4 @@ UA_STATIC_ASSERT(sizeof(UA_IOPortStateType) == sizeof(UA_Int32),
 
 #define UA_TYPES_IOP_IOPORTSTATETYPE 1
 
-#define UA_TYPE_IOP_STATETYPE_NAME "IOPortStateType"
-#define UA_TYPE_IOP_DIRTYPE_NAME   "IOPortDirectionType"
-
 #endif /* __IOPORTS_TYPES_H__ */
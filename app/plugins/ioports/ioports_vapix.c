@@ -23,14 +23,17 @@
  * SOFTWARE.
  */
 
-#include <curl/curl.h>
+#include <errno.h>
 #include <glib.h>
 #include <jansson.h>
 #include <open62541/server.h>
+#include <stdlib.h>
+#include <string.h>
 
 #include "error.h"
 #include "ioports_ns.h"
 #include "ioports_vapix.h"
+#include "ua_metrics.h"
 #include "vapix_utils.h"
 
 DEFINE_GQUARK("ioports-vapix")
@@ -55,25 +58,9 @@ DEFINE_GQUARK("ioports-vapix")
   "  \"method\": \"" IO_VAPIX_GET_PORTS "\""                                   \
   "}"
 
-/* JSON payload: setPorts
- * NOTE: we do a single property for a single port at time with this request
- *       %d - port number
- *       %s - key (name/usage/direction/state/normalState)
- *       %s - value
- **/
-#define IO_VAPIX_SET_PORT_FMT                                                  \
-  "{"                                                                          \
-  "  \"apiVersion\": \"" IO_VAPIX_VERSION "\","                                \
-  "  \"method\": \"" IO_VAPIX_SET_PORTS "\","                                  \
-  "  \"params\": {"                                                            \
-  "               \"ports\": ["                                                \
-  "                            {"                                              \
-  "                              \"port\": \"%d\","                            \
-  "                              \"%s\":   \"%s\""                             \
-  "                            }"                                              \
-  "                          ]"                                                \
-  "              }"                                                            \
-  "}"
+/* the JSON payload of setPorts is built with jansson, see
+ * build_set_ports_request(), since names and usages may hold characters that
+ * need escaping */
 
 /* clang-format off */
 typedef enum json_key_type {
@@ -88,6 +75,49 @@ typedef struct port_json_obj {
   const gchar *browse_name;
 } port_json_t;
 
+/* Wrapper around g_ascii_strtoll() using decimal base & with error handling */
+static gint64
+ascii_strtoll_dec(const gchar *nptr, GError **error)
+{
+  gchar *endptr = NULL;
+  gint64 value = 0;
+
+  g_assert(nptr != NULL);
+  g_assert(error == NULL || *error == NULL);
+
+  if (*nptr == '\0') {
+    SET_ERROR(error, -1, "Empty string");
+    return 0;
+  }
+
+  errno = 0;
+  value = g_ascii_strtoll(nptr, &endptr, 10);
+
+  /* out of range */
+  if (errno == ERANGE) {
+    SET_ERROR(error, -1, "String '%s' out of gint64 range", nptr);
+    return 0;
+  }
+
+  /* no characters consumed */
+  if (endptr == nptr) {
+    SET_ERROR(error, -1, "Failed converting '%s': no valid digits", nptr);
+    return 0;
+  }
+
+  /* invalid trailing characters */
+  if (*endptr != '\0') {
+    SET_ERROR(error,
+              -1,
+              "Failed converting '%s': trailing junk at: '%s'",
+              nptr,
+              endptr);
+    return 0;
+  }
+
+  return value;
+}
+
 /* frees up an 'ioport_obj_t' structure pointed to by 'data' */
 static void
 free_ioport_obj(gpointer data)
@@ -106,7 +136,7 @@ free_ioport_obj(gpointer data)
 }
 
 gboolean
-iop_vapix_check_api_ver(CURL *curl_h, const gchar *credentials, GError **err)
+iop_vapix_check_api_ver(vapix_session_t *vapix_h, GError **err)
 {
   gboolean found = FALSE;
   gchar *response;
@@ -122,12 +152,10 @@ iop_vapix_check_api_ver(CURL *curl_h, const gchar *credentials, GError **err)
   size_t size;
   guint i = 0;
 
-  g_return_val_if_fail(curl_h != NULL, FALSE);
-  g_return_val_if_fail(credentials != NULL, FALSE);
+  g_return_val_if_fail(vapix_h != NULL, FALSE);
   g_return_val_if_fail(err == NULL || *err == NULL, FALSE);
 
-  response = vapix_request(curl_h,
-                           credentials,
+  response = vapix_request(vapix_h,
                            IO_VAPIX_CGI_ENDPOINT,
                            HTTP_POST,
                            JSON_data,
@@ -226,14 +254,16 @@ err_out:
   return found;
 }
 
-gboolean
-iop_vapix_get_ports(CURL *curl_h,
-                    const gchar *credentials,
-                    GHashTable **iop_ht,
-                    GError **err)
+/* a #vapix_parse_func_t decoding a 'getPorts' response into a table of
+ * ioport_obj_t keyed by port index */
+static gboolean
+parse_ports_cb(const gchar *response,
+               gsize len,
+               gpointer user_data,
+               GError **err)
 {
+  GHashTable **iop_ht = user_data;
   gboolean retv = FALSE;
-  gchar *response;
   /* clang-format off */
   const port_json_t port_map[IOP_OBJ_NR_PROPS] = {
   /*  JSON key,              JSON type, Browse name  */
@@ -270,24 +300,15 @@ iop_vapix_get_ports(CURL *curl_h,
   size_t i, j;
   json_t *port_item;
 
-  g_return_val_if_fail(curl_h != NULL, FALSE);
-  g_return_val_if_fail(credentials != NULL, FALSE);
-  g_return_val_if_fail(iop_ht == NULL || *iop_ht == NULL, FALSE);
-  g_return_val_if_fail(err == NULL || *err == NULL, FALSE);
+  static ua_metric_t *parse_time;
+  gint64 start = g_get_monotonic_time();
 
-  response = vapix_request(curl_h,
-                           credentials,
-                           IO_VAPIX_CGI_ENDPOINT,
-                           HTTP_POST,
-                           JSON_data,
-                           IO_VAPIX_GET_PORTS_FMT,
-                           err);
-  if (response == NULL) {
-    g_prefix_error(err, "'%s' failed: ", IO_VAPIX_GET_PORTS);
-    goto err_out;
-  }
+  g_assert(response != NULL);
+  g_assert(iop_ht != NULL && *iop_ht == NULL);
+  g_assert(err == NULL || *err == NULL);
 
-  json_response = json_loads(response, 0, &parse_err);
+  /* decoded in the receive buffer, without copying the response first */
+  json_response = json_loadb(response, len, 0, &parse_err);
   if (json_response == NULL) {
     SET_ERROR(err,
               -1,
@@ -470,22 +491,45 @@ iop_vapix_get_ports(CURL *curl_h,
     }
   } /* for loop through port objects in the array of returned ports */
 
+  ua_metric_observe_since(ua_metrics_get_cached(&parse_time,
+                                                UA_METRIC_TIMING,
+                                                "ioports.parse"),
+                          start);
   retv = TRUE;
 
 err_out:
-  g_clear_pointer(&response, g_free);
   g_clear_pointer(&json_response, json_decref);
 
   return retv;
 }
 
 gboolean
-iop_vapix_set_port(CURL *curl_h,
-                   const gchar *credentials,
-                   UA_UInt32 portnr,
-                   const gchar *iop_key,
-                   const gchar *iop_value,
-                   GError **err)
+iop_vapix_get_ports(vapix_session_t *vapix_h,
+                    GHashTable **iop_ht,
+                    GError **err)
+{
+  g_return_val_if_fail(vapix_h != NULL, FALSE);
+  g_return_val_if_fail(iop_ht != NULL && *iop_ht == NULL, FALSE);
+  g_return_val_if_fail(err == NULL || *err == NULL, FALSE);
+
+  if (!vapix_request_parse(vapix_h,
+                           IO_VAPIX_CGI_ENDPOINT,
+                           HTTP_POST,
+                           JSON_data,
+                           IO_VAPIX_GET_PORTS_FMT,
+                           parse_ports_cb,
+                           iop_ht,
+                           err)) {
+    g_prefix_error(err, "'%s' failed: ", IO_VAPIX_GET_PORTS);
+    return FALSE;
+  }
+
+  return TRUE;
+}
+
+/* checks that 'iop_key' is a property supported by the 'setPorts' API */
+static gboolean
+check_port_prop(const gchar *iop_key, GError **err)
 {
   /* properties supported by the 'setPorts' API */
   /* clang-format off */
@@ -501,55 +545,45 @@ iop_vapix_set_port(CURL *curl_h,
   /* clang-format on */
   guint i = 0;
   const gchar *property = port_props[i];
-  gboolean found = FALSE;
-  gboolean retv = FALSE;
-  gchar *response;
-  gchar *request = NULL;
-  json_error_t parse_err;
-  json_t *json_response = NULL;
-  json_t *json_err = NULL;
-  json_t *json_err_msg = NULL;
-  json_t *data;
 
-  g_return_val_if_fail(curl_h != NULL, FALSE);
-  g_return_val_if_fail(credentials != NULL, FALSE);
-  g_return_val_if_fail(iop_key != NULL, FALSE);
-  g_return_val_if_fail(iop_value != NULL, FALSE);
-  g_return_val_if_fail(err == NULL || *err == NULL, FALSE);
+  g_assert(iop_key != NULL);
+  g_assert(err == NULL || *err == NULL);
 
   /* NOTE: the portmanagement.cgi doesn't do a very good job at properly
    * validating the properties to be set via 'setPort'. It can return success
    * even if for example 'name' is misspelled as 'nameee'. At least the property
    * values are properly validated but we better do our own input validation of
    * the keys/properties. */
-  while ((property != NULL) && !found) {
+  while (property != NULL) {
     if (g_strcmp0(iop_key, property) == 0) {
-      found = TRUE;
-    } else {
-      property = port_props[++i];
+      return TRUE;
     }
+    property = port_props[++i];
   }
 
-  if (!found) {
-    SET_ERROR(err, -1, "Invalid port property: \"%s\"!", iop_key);
-    return FALSE;
-  }
+  SET_ERROR(err, -1, "Invalid port property: \"%s\"!", iop_key);
 
-  request = g_strdup_printf(IO_VAPIX_SET_PORT_FMT, portnr, iop_key, iop_value);
-  response = vapix_request(curl_h,
-                           credentials,
-                           IO_VAPIX_CGI_ENDPOINT,
-                           HTTP_POST,
-                           JSON_data,
-                           request,
-                           err);
-  g_clear_pointer(&request, g_free);
-  if (response == NULL) {
-    g_prefix_error(err, "'%s' failed: ", IO_VAPIX_SET_PORTS);
-    goto err_out;
-  }
+  return FALSE;
+}
 
-  json_response = json_loads(response, 0, &parse_err);
+/* a #vapix_parse_func_t checking the response of a 'setPorts' request */
+static gboolean
+parse_set_port_cb(const gchar *response,
+                  gsize len,
+                  G_GNUC_UNUSED gpointer user_data,
+                  GError **err)
+{
+  gboolean retv = FALSE;
+  json_error_t parse_err;
+  json_t *json_response = NULL;
+  json_t *json_err = NULL;
+  json_t *json_err_msg = NULL;
+  json_t *data;
+
+  g_assert(response != NULL);
+  g_assert(err == NULL || *err == NULL);
+
+  json_response = json_loadb(response, len, 0, &parse_err);
   if (json_response == NULL) {
     SET_ERROR(err,
               -1,
@@ -585,8 +619,202 @@ iop_vapix_set_port(CURL *curl_h,
   retv = TRUE;
 
 err_out:
-  g_clear_pointer(&response, g_free);
   g_clear_pointer(&json_response, json_decref);
 
   return retv;
 }
+
+/* the JSON payload of a 'setPorts' request setting all of 'props', the
+ * properties of one port are merged into the same "ports" item */
+static gchar *
+build_set_ports_request(const iop_port_prop_t *props,
+                        gsize nr_props,
+                        GError **err)
+{
+  GHashTable *by_port;
+  json_t *ports;
+  json_t *port;
+  json_t *value;
+  json_t *request = NULL;
+  gchar *port_str;
+  gchar *payload = NULL;
+
+  g_assert(props != NULL);
+  g_assert(err == NULL || *err == NULL);
+
+  by_port = g_hash_table_new(NULL, NULL);
+  ports = json_array();
+  for (gsize i = 0; i < nr_props; i++) {
+    /* NULL unless the value is valid UTF-8 */
+    value = json_string(props[i].value);
+    if (value == NULL) {
+      SET_ERROR(err,
+                -1,
+                "Invalid '%s' value of port %u",
+                props[i].key,
+                props[i].portnr);
+      json_decref(ports);
+      goto out;
+    }
+
+    port = g_hash_table_lookup(by_port, GUINT_TO_POINTER(props[i].portnr));
+    if (port == NULL) {
+      port_str = g_strdup_printf("%u", props[i].portnr);
+      port = json_pack("{s:s}", IO_VAPIX_JSON_PORT, port_str);
+      g_free(port_str);
+      json_array_append_new(ports, port);
+      g_hash_table_insert(by_port, GUINT_TO_POINTER(props[i].portnr), port);
+    }
+    json_object_set_new(port, props[i].key, value);
+  }
+
+  request = json_pack("{s:s, s:s, s:{s:o}}",
+                      "apiVersion",
+                      IO_VAPIX_VERSION,
+                      "method",
+                      IO_VAPIX_SET_PORTS,
+                      "params",
+                      "ports",
+                      ports);
+  if (request != NULL) {
+    payload = json_dumps(request, JSON_COMPACT);
+  }
+  if (payload == NULL) {
+    SET_ERROR(err, -1, "Failed to build the '%s' request", IO_VAPIX_SET_PORTS);
+  }
+
+out:
+  g_hash_table_destroy(by_port);
+  g_clear_pointer(&request, json_decref);
+
+  return payload;
+}
+
+gboolean
+iop_vapix_set_ports(vapix_session_t *vapix_h,
+                    const iop_port_prop_t *props,
+                    gsize nr_props,
+                    GError **err)
+{
+  gboolean retv;
+  gchar *request;
+
+  g_return_val_if_fail(vapix_h != NULL, FALSE);
+  g_return_val_if_fail(props != NULL, FALSE);
+  g_return_val_if_fail(nr_props > 0, FALSE);
+  g_return_val_if_fail(err == NULL || *err == NULL, FALSE);
+
+  for (gsize i = 0; i < nr_props; i++) {
+    g_return_val_if_fail(props[i].key != NULL, FALSE);
+    g_return_val_if_fail(props[i].value != NULL, FALSE);
+
+    if (!check_port_prop(props[i].key, err)) {
+      return FALSE;
+    }
+  }
+
+  request = build_set_ports_request(props, nr_props, err);
+  if (request == NULL) {
+    return FALSE;
+  }
+
+  retv = vapix_request_parse(vapix_h,
+                             IO_VAPIX_CGI_ENDPOINT,
+                             HTTP_POST,
+                             JSON_data,
+                             request,
+                             parse_set_port_cb,
+                             NULL,
+                             err);
+  g_clear_pointer(&request, free);
+  if (!retv) {
+    g_prefix_error(err, "'%s' failed: ", IO_VAPIX_SET_PORTS);
+  }
+
+  return retv;
+}
+
+gboolean
+iop_vapix_set_port(vapix_session_t *vapix_h,
+                   UA_UInt32 portnr,
+                   const gchar *iop_key,
+                   const gchar *iop_value,
+                   GError **err)
+{
+  iop_port_prop_t prop = {
+    .portnr = portnr,
+    .key = iop_key,
+    .value = iop_value,
+  };
+
+  g_return_val_if_fail(vapix_h != NULL, FALSE);
+  g_return_val_if_fail(iop_key != NULL, FALSE);
+  g_return_val_if_fail(iop_value != NULL, FALSE);
+  g_return_val_if_fail(err == NULL || *err == NULL, FALSE);
+
+  return iop_vapix_set_ports(vapix_h, &prop, 1, err);
+}
+
+gboolean
+iop_parse_cfg_change(const gchar *cfg_changes,
+                     const gchar *id,
+                     gint64 *port_nr,
+                     gchar **param,
+                     gchar **value,
+                     GError **err)
+{
+  const gchar *iop_index;
+  gchar *unquoted;
+  gchar *val;
+  GError *lerr = NULL;
+
+  g_return_val_if_fail(cfg_changes != NULL, FALSE);
+  g_return_val_if_fail(id != NULL, FALSE);
+  g_return_val_if_fail(port_nr != NULL, FALSE);
+  g_return_val_if_fail(param != NULL, FALSE);
+  g_return_val_if_fail(value != NULL, FALSE);
+  g_return_val_if_fail(err == NULL || *err == NULL, FALSE);
+
+  /* extract the port number (index) from the 'id' key of the AxEvent which is
+   * of the following form:
+   * /com/axis/Configuration/Legacy/IOControl/IOPort/<port index> */
+  iop_index = g_strrstr(id, "/");
+  if (iop_index == NULL) {
+    SET_ERROR(err, -1, "No port index in '%s'", id);
+    return FALSE;
+  }
+
+  /* iop_index + 1: skip over the '/' character */
+  *port_nr = ascii_strtoll_dec(iop_index + 1, &lerr);
+  if (lerr != NULL) {
+    SET_ERROR(err, -1, "Invalid port index: %s", lerr->message);
+    g_clear_error(&lerr);
+    return FALSE;
+  }
+
+  /* The string describing the parameter change is expected to be in form of:
+   * `"%s=%s"`. For example a name change of an I/O port can look like this:
+   * "Name=Port 01" */
+
+  /* strip away the double quotes */
+  unquoted = g_shell_unquote(cfg_changes, err);
+  if (unquoted == NULL) {
+    g_prefix_error(err, "g_shell_unquote() failed: ");
+    return FALSE;
+  }
+
+  /* split the string in place into 2 tokens (parameter and value) using the
+   * first '=' as separator */
+  val = strchr(unquoted, '=');
+  if (val == NULL) {
+    SET_ERROR(err, -1, "No '=' in '%s'", cfg_changes);
+    g_free(unquoted);
+    return FALSE;
+  }
+  *val++ = '\0';
+
+  *param = unquoted;
+  *value = val;
+
+  return TRUE;
+}
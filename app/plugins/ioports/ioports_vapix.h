@@ -26,6 +26,8 @@
 #ifndef __IOPORTS_VAPIX_H__
 #define __IOPORTS_VAPIX_H__
 
+#include "vapix_utils.h"
+
 #define IO_VAPIX_JSON_ERR     "error"
 #define IO_VAPIX_JSON_ERRMSG  "message"
 #define IO_VAPIX_JSON_DATA    "data"
@@ -58,30 +60,59 @@ typedef struct ioport_obj {
   UA_IOPortDirectionType direction;
 } ioport_obj_t;
 
+/* a property of an I/O port to set with iop_vapix_set_ports() */
+typedef struct iop_port_prop {
+  UA_UInt32 portnr;
+  /* one of the IO_VAPIX_JSON_* keys accepted by 'setPorts' */
+  const gchar *key;
+  const gchar *value;
+} iop_port_prop_t;
+
 /* Checks if the device supports version `IO_VAPIX_VERSION` of the
  * "portmanagement.cgi" API. */
 gboolean
-iop_vapix_check_api_ver(CURL *curl_h, const gchar *credentials, GError **err);
+iop_vapix_check_api_ver(vapix_session_t *vapix_h, GError **err);
 
 /**
  * Calls the 'getPorts' method of the "portmanagement.cgi" API and returns a
  * hash table (iop_ht) with information about the I/O ports found on the device.
  */
 gboolean
-iop_vapix_get_ports(CURL *curl_h,
-                    const gchar *credentials,
+iop_vapix_get_ports(vapix_session_t *vapix_h,
                     GHashTable **iop_ht,
                     GError **err);
 
 /**
- * Calls the 'setPorts' method of the "portmanagement.cgi" API. Only one
- * property ('iop_key') of an I/O port can be set ('iop_value') at a time. */
+ * Calls the 'setPorts' method of the "portmanagement.cgi" API. Only one property
+ * ('iop_key') of an I/O port can be set ('iop_value') at a time. */
 gboolean
-iop_vapix_set_port(CURL *curl_h,
-                   const gchar *credentials,
+iop_vapix_set_port(vapix_session_t *vapix_h,
                    UA_UInt32 portnr,
                    const gchar *iop_key,
                    const gchar *iop_value,
                    GError **err);
 
+/**
+ * Calls the 'setPorts' method of the "portmanagement.cgi" API once to set all
+ * of 'props', which may span several ports. The outcome is reported for the
+ * request as a whole. */
+gboolean
+iop_vapix_set_ports(vapix_session_t *vapix_h,
+                    const iop_port_prop_t *props,
+                    gsize nr_props,
+                    GError **err);
+
+/**
+ * Parses the keys of an I/O port configuration change AxEvent: 'cfg_changes'
+ * ('configuration_changes', a quoted "<parameter>=<value>") and 'id'
+ * (/com/axis/Configuration/Legacy/IOControl/IOPort/<port index>). 'value'
+ * points into 'param', only 'param' is to be freed with g_free(). */
+gboolean
+iop_parse_cfg_change(const gchar *cfg_changes,
+                     const gchar *id,
+                     gint64 *port_nr,
+                     gchar **param,
+                     gchar **value,
+                     GError **err);
+
 #endif /* __IOPORTS_VAPIX_H__ */
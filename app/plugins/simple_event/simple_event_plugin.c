@@ -29,21 +29,22 @@
 
 #include "error.h"
 #include "log.h"
+#include "plugin.h"
 #include "simple_event_plugin.h"
+#include "ua_metrics.h"
+#include "ua_trace.h"
 #include "ua_utils.h"
 
 #define UA_PLUGIN_NAMESPACE "http://www.axis.com/OpcUA/SimpleEvent/"
 #define UA_PLUGIN_NAME      "opc-simple-event-plugin"
 
-#define TIME_PROPERTY                  "Time"
-#define SEVERITY_PROPERTY              "Severity"
-#define MESSAGE_PROPERTY               "Message"
-#define SOURCE_NAME_PROPERTY           "SourceName"
 #define ACCESSED_VARIABLE_NAME         "Accessed"
 #define UA_LIVESTREAM_OBJ_DISPLAY_NAME "LiveStreamAccessed"
 #define UA_LIVESTREAM_OBJ_DESCRIPTION  "Livestream Accessed Object"
 
 #define SEVERITY 500
+/* number of reusable event nodes */
+#define EVENT_POOL_SIZE 2
 
 #define ERR_NOT_INITIALIZED "The " UA_PLUGIN_NAME " is not initialized"
 #define ERR_NO_NAME         "The " UA_PLUGIN_NAME " was not given a name"
@@ -63,177 +64,142 @@ typedef struct plugin {
   guint sub_id;
   /* event object node id */
   UA_NodeId event_obj;
-  /* keep track of data that needs to be rolled back in case of failure */
+  /* keep track of data that needs to be rolled back in case of failure, or
+   * when the plugin is removed */
   rollback_data_t *rbd;
+  /* runs our server mutations in the OPC-UA server thread */
+  ua_queue_t *queue;
+  /* the nodes of the emitted events */
+  ua_event_pool_t *events;
+  /* time from the AxEvent callback until the OPC-UA event is emitted */
+  ua_metric_t *event_latency;
 } plugin_t;
 
+/* a 'LiveStreamAccessed' AxEvent waiting to be applied to the server */
+typedef struct access_event {
+  gchar *topic;
+  gboolean active;
+  UA_DateTime time;
+  /* g_get_monotonic_time() when the AxEvent was received */
+  gint64 received;
+} access_event_t;
+
 static plugin_t *plugin;
 
 /* Local functions */
 static gboolean
-create_opc_event(UA_Server *server,
-                 const gchar *source_name,
-                 UA_UInt16 eventSeverity,
-                 UA_LocalizedText *eventMessage,
-                 UA_DateTime ax_eventTime,
-                 UA_NodeId *eventId,
-                 GError **err)
+trigger_opc_event(UA_Server *server,
+                  UA_UInt16 eventSeverity,
+                  const gchar *source_name,
+                  UA_LocalizedText *eventMessage,
+                  UA_DateTime ax_eventTime,
+                  GError **err)
 {
-  UA_StatusCode ret;
-  UA_String eventSourceName;
-  gchar *reason = "";
+  ua_event_fields_t fields;
 
   g_assert(server != NULL);
   g_assert(source_name != NULL);
   g_assert(eventMessage != NULL);
-  g_assert(eventId != NULL);
   g_assert(err == NULL || *err == NULL);
+  g_assert(plugin != NULL);
 
-  ret = UA_Server_createEvent(server,
-                              UA_NODEID_NUMERIC(0, UA_NS0ID_BASEEVENTTYPE),
-                              eventId);
+  LOG_I(plugin->logger, "Try to create event %s ...", eventMessage->text.data);
 
-  if (ret != UA_STATUSCODE_GOOD) {
-    SET_ERROR(err, -1, "Failed to create event: %s", UA_StatusCode_name(ret));
+  fields.time = ax_eventTime;
+  fields.severity = eventSeverity;
+  fields.message = *eventMessage;
+  fields.sourceName = UA_STRING((gchar *) source_name);
+
+  /* Write and trigger the event */
+  if (!ua_utils_event_pool_trigger(plugin->events,
+                                   server,
+                                   &plugin->event_obj,
+                                   &fields,
+                                   err)) {
+    g_prefix_error(err, "ua_utils_event_pool_trigger() failed: ");
     return FALSE;
   }
 
-  /* Set properties for base event type */
-
-  /* Set the event Time */
-  ret = UA_Server_writeObjectProperty_scalar(server,
-                                             *eventId,
-                                             UA_QUALIFIEDNAME(0, TIME_PROPERTY),
-                                             &ax_eventTime,
-                                             &UA_TYPES[UA_TYPES_DATETIME]);
-
-  if (ret != UA_STATUSCODE_GOOD) {
-    reason = TIME_PROPERTY;
-    goto out;
-  }
-
-  /* Set the event Severity */
-  ret = UA_Server_writeObjectProperty_scalar(
-          server,
-          *eventId,
-          UA_QUALIFIEDNAME(0, SEVERITY_PROPERTY),
-          &eventSeverity,
-          &UA_TYPES[UA_TYPES_UINT16]);
-
-  if (ret != UA_STATUSCODE_GOOD) {
-    reason = SEVERITY_PROPERTY;
-    goto out;
-  }
-
-  /* Set the event Message */
-  ret = UA_Server_writeObjectProperty_scalar(server,
-                                             *eventId,
-                                             UA_QUALIFIEDNAME(0,
-                                                              MESSAGE_PROPERTY),
-                                             eventMessage,
-                                             &UA_TYPES[UA_TYPES_LOCALIZEDTEXT]);
-
-  if (ret != UA_STATUSCODE_GOOD) {
-    reason = MESSAGE_PROPERTY;
-    goto out;
-  }
-
-  /* Set the event SourceName */
-  eventSourceName = UA_STRING((gchar *) source_name);
-  ret = UA_Server_writeObjectProperty_scalar(
-          server,
-          *eventId,
-          UA_QUALIFIEDNAME(0, SOURCE_NAME_PROPERTY),
-          &eventSourceName,
-          &UA_TYPES[UA_TYPES_STRING]);
-
-  if (ret != UA_STATUSCODE_GOOD) {
-    reason = SOURCE_NAME_PROPERTY;
-    goto out;
-  }
+  LOG_I(plugin->logger,
+        "Event: %s created successfully",
+        eventMessage->text.data);
 
   return TRUE;
+}
 
-out:
-  SET_ERROR(err,
-            -1,
-            "Failed to create event '%s': %s",
-            reason,
-            UA_StatusCode_name(ret));
+static void
+free_access_event(gpointer data)
+{
+  access_event_t *ev = data;
 
-  return FALSE;
+  g_assert(ev != NULL);
+
+  g_clear_pointer(&ev->topic, g_free);
+  g_free(ev);
 }
 
-static gboolean
-trigger_opc_event(UA_Server *server,
-                  UA_UInt16 eventSeverity,
-                  const gchar *source_name,
-                  UA_LocalizedText *eventMessage,
-                  UA_DateTime ax_eventTime,
-                  GError **err)
+/* an #ua_queue_func_t applying an AxEvent in the OPC-UA server thread */
+static void
+apply_access_event(UA_Server *server, gpointer data)
 {
-  UA_StatusCode ret;
-  UA_NodeId eventNodeId;
+  access_event_t *ev = data;
+  GError *lerr = NULL;
+  UA_StatusCode status;
 
   g_assert(server != NULL);
-  g_assert(source_name != NULL);
-  g_assert(eventMessage != NULL);
-  g_assert(err == NULL || *err == NULL);
+  g_assert(ev != NULL);
   g_assert(plugin != NULL);
 
-  LOG_I(plugin->logger, "Try to create event %s ...", eventMessage->text.data);
-
-  /* Write the event */
-  if (!create_opc_event(server,
-                        source_name,
-                        eventSeverity,
-                        eventMessage,
-                        ax_eventTime,
-                        &eventNodeId,
-                        err)) {
-    g_prefix_error(err, "create_opc_event() failed: ");
-    return FALSE;
-  }
+  if (ev->active) {
+    UA_UInt16 severity = SEVERITY;
+    UA_LocalizedText eventMsg;
+    const gchar *source_name = UA_LIVESTREAM_OBJ_DISPLAY_NAME;
 
-  /* Trigger an event */
-  ret = UA_Server_triggerEvent(server,
-                               eventNodeId,
-                               plugin->event_obj,
-                               NULL,
-                               UA_TRUE);
+    eventMsg = UA_LOCALIZEDTEXT("en-US", ev->topic);
 
-  if (ret != UA_STATUSCODE_GOOD) {
-    SET_ERROR(err,
-              -1,
-              "%s Failed to trigger event: %s",
-              __func__,
-              UA_StatusCode_name(ret));
-    return FALSE;
+    if (!trigger_opc_event(server,
+                           severity,
+                           source_name,
+                           &eventMsg,
+                           ev->time,
+                           &lerr)) {
+      LOG_E(plugin->logger, "Event failure: %s", GERROR_MSG(lerr));
+      g_clear_error(&lerr);
+      return;
+    }
+    ua_metric_observe_since(plugin->event_latency, ev->received);
   }
 
-  LOG_I(plugin->logger,
-        "Event: %s created successfully",
-        eventMessage->text.data);
+  status = UA_Server_writeObjectProperty_scalar(
+          server,
+          plugin->event_obj,
+          UA_QUALIFIEDNAME(plugin->ns, ACCESSED_VARIABLE_NAME),
+          &ev->active,
+          &UA_TYPES[UA_TYPES_BOOLEAN]);
 
-  return TRUE;
-};
+  if (status != UA_STATUSCODE_GOOD) {
+    LOG_E(plugin->logger,
+          "UA_Server_writeObjectProperty_scalar() failed: %s",
+          UA_StatusCode_name(status));
+  }
+}
 
 static void
 simple_opc_event_cb(G_GNUC_UNUSED guint subscription,
                     AXEvent *event,
-                    gpointer user_data)
+                    G_GNUC_UNUSED gpointer user_data)
 {
   const AXEventKeyValueSet *key_value_set;
   gboolean active;
   gchar *s1 = NULL;
-  UA_Server *server = (UA_Server *) user_data;
+  access_event_t *ev;
   GError *lerr = NULL;
-  UA_StatusCode status;
 
   g_assert(event != NULL);
-  g_assert(server != NULL);
   g_assert(plugin != NULL);
 
+  UA_TRACE_ENTRY(axevent, G_STRFUNC);
+
   key_value_set = ax_event_get_key_value_set(event);
 
   if (key_value_set == NULL) {
@@ -267,43 +233,32 @@ simple_opc_event_cb(G_GNUC_UNUSED guint subscription,
 
   LOG_D(plugin->logger, "%s: Accessed=%s", s1, active ? "true" : "false");
 
+  /* we are running in the main loop, the server is updated from its own
+   * thread */
+  ev = g_new0(access_event_t, 1);
+  ev->received = g_get_monotonic_time();
+  ev->active = active;
   if (active) {
     GDateTime *d = ax_event_get_time_stamp2(event);
-    UA_UInt16 severity = SEVERITY;
-    UA_LocalizedText eventMsg;
-    const gchar *source_name = UA_LIVESTREAM_OBJ_DISPLAY_NAME;
 
-    eventMsg = UA_LOCALIZEDTEXT("en-US", s1);
-
-    if (!trigger_opc_event(server,
-                           severity,
-                           source_name,
-                           &eventMsg,
-                           UA_DateTime_fromUnixTime(g_date_time_to_unix(d)),
-                           &lerr)) {
-      LOG_E(plugin->logger, "Event failure: %s", GERROR_MSG(lerr));
-      g_clear_error(&lerr);
-      goto out;
-    }
+    ev->time = UA_DateTime_fromUnixTime(g_date_time_to_unix(d));
   }
-
-  status = UA_Server_writeObjectProperty_scalar(
-          server,
-          plugin->event_obj,
-          UA_QUALIFIEDNAME(plugin->ns, ACCESSED_VARIABLE_NAME),
-          &active,
-          &UA_TYPES[UA_TYPES_BOOLEAN]);
-
-  if (status != UA_STATUSCODE_GOOD) {
-    LOG_E(plugin->logger,
-          "UA_Server_writeObjectProperty_scalar() failed: %s",
-          UA_StatusCode_name(status));
-    goto out;
+  ev->topic = g_steal_pointer(&s1);
+
+  if (!ua_queue_push(plugin->queue,
+                     apply_access_event,
+                     ev,
+                     free_access_event,
+                     &lerr)) {
+    LOG_E(plugin->logger, "ua_queue_push() failed: %s", GERROR_MSG(lerr));
+    g_clear_error(&lerr);
+    free_access_event(ev);
   }
 
 out:
   g_clear_pointer(&s1, g_free);
   ax_event_free(event);
+  UA_TRACE_EXIT(axevent, G_STRFUNC, 0);
 }
 
 /* This is how the 'LiveStreamAccessed' event looks like
@@ -478,6 +433,8 @@ plugin_cleanup(void)
   }
 
   plugin->logger = NULL;
+  plugin->queue = NULL;
+  g_clear_pointer(&plugin->events, ua_utils_event_pool_free);
   g_clear_pointer(&plugin->name, g_free);
 
   /* free up allocated rollback data, if any */
@@ -490,13 +447,17 @@ plugin_cleanup(void)
 gboolean
 opc_ua_create(UA_Server *server,
               UA_Logger *logger,
-              G_GNUC_UNUSED gpointer *params,
+              gpointer *params,
               GError **err)
 {
+  ua_plugin_params_t *services = (ua_plugin_params_t *) params;
+  UA_NodeId ev_type = UA_NODEID_NUMERIC(0, UA_NS0ID_BASEEVENTTYPE);
   GError *lerr = NULL;
 
   g_return_val_if_fail(server != NULL, FALSE);
   g_return_val_if_fail(logger != NULL, FALSE);
+  g_return_val_if_fail(services != NULL, FALSE);
+  g_return_val_if_fail(services->queue != NULL, FALSE);
   g_return_val_if_fail(err == NULL || *err == NULL, FALSE);
 
   if (plugin != NULL) {
@@ -508,6 +469,11 @@ opc_ua_create(UA_Server *server,
   plugin->name = g_strdup(UA_PLUGIN_NAME);
   plugin->logger = logger;
   plugin->rbd = g_new0(rollback_data_t, 1);
+  plugin->queue = services->queue;
+  plugin->events = ua_utils_event_pool_new(&ev_type, EVENT_POOL_SIZE);
+  ua_utils_event_pool_keep_history(plugin->events, services->event_history);
+  plugin->event_latency =
+          ua_metrics_get(UA_METRIC_TIMING, "simple_event.event_latency");
 
   plugin->ns = UA_Server_addNamespace(server, UA_PLUGIN_NAMESPACE);
 
@@ -521,9 +487,7 @@ opc_ua_create(UA_Server *server,
     goto err_out;
   }
 
-  /* the information model was successfully populated so now we can free up our
-   * rollback data since we no longer need it */
-  ua_utils_clear_rbd(&plugin->rbd);
+  /* the rollback data is kept, opc_ua_remove() deletes the nodes it lists */
 
   return TRUE;
 
@@ -540,6 +504,30 @@ err_out:
   return FALSE;
 }
 
+gboolean
+opc_ua_remove(UA_Server *server, GError **err)
+{
+  g_return_val_if_fail(server != NULL, FALSE);
+  g_return_val_if_fail(err == NULL || *err == NULL, FALSE);
+
+  if (plugin == NULL || plugin->rbd == NULL) {
+    return TRUE;
+  }
+
+  /* the event nodes are created as the events are triggered */
+  if (plugin->events != NULL) {
+    ua_utils_event_pool_remove(plugin->events, server);
+  }
+
+  if (!ua_utils_do_rollback(server, plugin->rbd, err)) {
+    g_prefix_error(err, "ua_utils_do_rollback() failed: ");
+    return FALSE;
+  }
+  ua_utils_clear_rbd(&plugin->rbd);
+
+  return TRUE;
+}
+
 void
 opc_ua_destroy(void)
 {
@@ -23,7 +23,7 @@
  * SOFTWARE.
  */
 
-#include <curl/curl.h>
+#include <axsdk/axevent.h>
 #include <gio/gio.h>
 #include <glib.h>
 #include <jansson.h>
@@ -34,6 +34,9 @@
 #include "plugin.h"
 #include "thermal_plugin.h"
 #include "thermal_vapix.h"
+#include "ua_metrics.h"
+#include "ua_pubsub.h"
+#include "ua_trace.h"
 #include "ua_utils.h"
 #include "vapix_utils.h"
 
@@ -45,8 +48,20 @@
 #define ERR_NOT_INITIALIZED "The " UA_PLUGIN_NAME " is not initialized"
 #define ERR_NO_NAME         "The " UA_PLUGIN_NAME " was not given a name"
 
-#define NBR_OF_RETRIES 10
+/* polling periods in milliseconds */
+#define THERMAL_DEFAULT_INTERVAL 1000
+#define THERMAL_MAX_INTERVAL     60000
+#define THERMAL_IDLE_TIMEOUT     5000
+/* polling stops when no sampled node was read for this many periods */
+#define THERMAL_IDLE_PERIODS 3
 
+#define THERMAL_AREA_FMT             "Thermal%u"
+#define THERMAL_AREA_NAME_MAX        32
+#define THERMAL_TRIGGER_EV_SEVERITY  500
+#define THERMAL_TRIGGER_EV_POOL_SIZE 4
+
+#define DEADBAND_ABSOLUTE_BNAME     "DeadbandAbsolute"
+#define DEADBAND_PERCENT_BNAME      "DeadbandPercent"
 #define DETECTION_TYPE_BNAME        "DetectionType"
 #define ENABLED_BNAME               "Enabled"
 #define ID_BNAME                    "Id"
@@ -61,6 +76,47 @@
 
 DEFINE_GQUARK("opc-thermal-plugin")
 
+/* properties of a thermal area served from its cache, the temperatures are
+ * sampled from 'getAreaStatus' while the deadbands are set by the clients */
+typedef enum {
+  THERMAL_SAMPLE_NONE = 0,
+  THERMAL_SAMPLE_MIN,
+  THERMAL_SAMPLE_AVG,
+  THERMAL_SAMPLE_MAX,
+  THERMAL_SAMPLE_TRIGGERED,
+  THERMAL_DEADBAND_ABSOLUTE,
+  THERMAL_DEADBAND_PERCENT,
+  THERMAL_NBR_OF_SAMPLES
+} thermal_sample_t;
+
+typedef struct area_cache area_cache_t;
+
+/* node context of a sampled property */
+typedef struct sample_node {
+  area_cache_t *area;
+  thermal_sample_t sample;
+  /* monotonic time of the previous read of the node */
+  gint64 last_read;
+} sample_node_t;
+
+/* published temperature values of a thermal area */
+struct area_cache {
+  UA_Int32 min;
+  UA_Int32 avg;
+  UA_Int32 max;
+  UA_Boolean triggered;
+  /* monotonic time of the last area alarm event, a poll requested before it
+   * doesn't override the state it reported */
+  gint64 alarm_time;
+  /* time of the last change, 0 until the first 'getAreaStatus' completes */
+  UA_DateTime updated;
+  /* a temperature is only published when it moved from the published value
+   * by more than the deadbands, 0 disables a deadband */
+  UA_Double deadband_abs;
+  UA_Double deadband_pct;
+  sample_node_t nodes[THERMAL_NBR_OF_SAMPLES];
+};
+
 typedef struct plugin {
   /* user-friendly name of the plugin */
   gchar *name;
@@ -72,70 +128,161 @@ typedef struct plugin {
   UA_Server *server;
   /* node id of the thermal object */
   UA_NodeId thermal_parent;
-  /* callback id for getAreaStatus callback */
-  guint cb_id;
-  /* count number of times polling temperature values fails */
-  gint counter;
-  gchar *vapix_credentials;
-  CURL *curl_h;
-  /* mutex for curl_h */
-  GMutex curl_mutex;
-  /* keep track of data that needs to be rolled back in case of failure */
+  /* TRUE while a 'getAreaStatus' request is in flight */
+  gboolean update_pending;
+  /* monotonic time when the 'getAreaStatus' request was issued */
+  gint64 update_requested;
+  /* current polling period in milliseconds */
+  guint interval;
+  /* shortest polling period allowed in milliseconds */
+  guint min_interval;
+  /* protects the members below, the sampled nodes are read from the OPC-UA
+   * server thread while the polling runs in the main loop */
+  GMutex lock;
+  /* area_cache_t of the thermal areas, keyed by area id */
+  GHashTable *areas;
+  /* TRUE while the temperature values are polled or about to be */
+  gboolean sampling;
+  /* the plugin in the scheduler of the application, set by the first tick */
+  ua_sched_client_t *sched;
+  /* shortest time between two reads of a sampled node since the last poll in
+   * microseconds, G_MAXINT64 if none */
+  gint64 demand_interval;
+  /* monotonic time of the last read of a sampled node */
+  gint64 last_demand;
+  /* VAPIX account of the plugin, served by the shared connection pool */
+  vapix_session_t *vapix_h;
+  /* keep track of data that needs to be rolled back in case of failure, or
+   * when the plugin is removed */
   rollback_data_t *rbd;
+  /* node ids of the thermal areas and their properties */
+  ua_node_cache_t *nodes;
+  /* serve the scale method from the method workers */
+  gboolean async_methods;
+  /* thermal_area_t of the areas fetched before the plugin is created */
+  GList *area_list;
+  /* timings of the data sources and count of the failed polls */
+  ua_metric_t *reads;
+  ua_metric_t *writes;
+  ua_metric_t *poll_retries;
+  /* Axis event handler and subscription of the area alarm events */
+  AXEventHandler *event_handler;
+  guint event_subscription;
+  /* runs our server mutations in the OPC-UA server thread */
+  ua_queue_t *queue;
+  /* the nodes of the emitted threshold events */
+  ua_event_pool_t *trigger_ev;
+  /* time from the detection of a threshold crossing until the OPC-UA event is
+   * emitted */
+  ua_metric_t *event_latency;
 } plugin_t;
 
+/* a threshold crossing of a thermal area waiting to be emitted as an OPC-UA
+ * event */
+typedef struct trigger_change {
+  guint32 id;
+  UA_Boolean triggered;
+  UA_DateTime time;
+  /* g_get_monotonic_time() when the crossing was detected */
+  gint64 detected;
+} trigger_change_t;
+
 static plugin_t *plugin;
 
+/* the initial values of the static properties of a thermal area */
+typedef struct area_values {
+  UA_UInt32 id;
+  UA_Int32 preset_nbr;
+  UA_Int32 threshold;
+  UA_Boolean enabled;
+  UA_String name;
+  UA_String detection;
+  UA_String measurement;
+} area_values_t;
+
 typedef struct property {
   gchar *name;
   gint32 value_type;
+  thermal_sample_t sample;
+  /* TRUE if the property is added with the area_values_t member at 'offset'
+   * as its value */
+  gboolean initial;
+  glong offset;
 } property_t;
 
 /* clang-format off */
 static property_t thermal_properties[] = {
   {
     .name = ID_BNAME,
-    .value_type = UA_TYPES_UINT32
+    .value_type = UA_TYPES_UINT32,
+    .initial = TRUE,
+    .offset = G_STRUCT_OFFSET(area_values_t, id)
   },
   {
     .name = PRESET_NBR_BNAME,
-    .value_type = UA_TYPES_INT32
+    .value_type = UA_TYPES_INT32,
+    .initial = TRUE,
+    .offset = G_STRUCT_OFFSET(area_values_t, preset_nbr)
   },
   {
     .name = TEMP_AVG_BNAME,
-    .value_type = UA_TYPES_INT32
+    .value_type = UA_TYPES_INT32,
+    .sample = THERMAL_SAMPLE_AVG
   },
   {
     .name = TEMP_MAX_BNAME,
-    .value_type = UA_TYPES_INT32
+    .value_type = UA_TYPES_INT32,
+    .sample = THERMAL_SAMPLE_MAX
   },
   {
     .name = TEMP_MIN_BNAME,
-    .value_type = UA_TYPES_INT32
+    .value_type = UA_TYPES_INT32,
+    .sample = THERMAL_SAMPLE_MIN
   },
   {
     .name = THRESHOLD_VALUE_BNAME,
-    .value_type = UA_TYPES_INT32
+    .value_type = UA_TYPES_INT32,
+    .initial = TRUE,
+    .offset = G_STRUCT_OFFSET(area_values_t, threshold)
   },
   {
     .name = TRIGGERED_BNAME,
-    .value_type = UA_TYPES_BOOLEAN
+    .value_type = UA_TYPES_BOOLEAN,
+    .sample = THERMAL_SAMPLE_TRIGGERED
   },
   {
     .name = ENABLED_BNAME,
-    .value_type = UA_TYPES_BOOLEAN
+    .value_type = UA_TYPES_BOOLEAN,
+    .initial = TRUE,
+    .offset = G_STRUCT_OFFSET(area_values_t, enabled)
   },
   {
     .name = NAME_BNAME,
-    .value_type = UA_TYPES_STRING
+    .value_type = UA_TYPES_STRING,
+    .initial = TRUE,
+    .offset = G_STRUCT_OFFSET(area_values_t, name)
   },
   {
     .name = DETECTION_TYPE_BNAME,
-    .value_type = UA_TYPES_STRING
+    .value_type = UA_TYPES_STRING,
+    .initial = TRUE,
+    .offset = G_STRUCT_OFFSET(area_values_t, detection)
   },
   {
     .name = THRESHOLD_MEASUREMENT_BNAME,
-    .value_type = UA_TYPES_STRING
+    .value_type = UA_TYPES_STRING,
+    .initial = TRUE,
+    .offset = G_STRUCT_OFFSET(area_values_t, measurement)
+  },
+  {
+    .name = DEADBAND_ABSOLUTE_BNAME,
+    .value_type = UA_TYPES_DOUBLE,
+    .sample = THERMAL_DEADBAND_ABSOLUTE
+  },
+  {
+    .name = DEADBAND_PERCENT_BNAME,
+    .value_type = UA_TYPES_DOUBLE,
+    .sample = THERMAL_DEADBAND_PERCENT
   },
   {
     .name = NULL,
@@ -144,195 +291,300 @@ static property_t thermal_properties[] = {
 };
 /* clang-format on */
 
+/* the number of properties of a thermal area */
+#define THERMAL_NBR_OF_PROPERTIES (G_N_ELEMENTS(thermal_properties) - 1)
+
 /* Local functions */
-static gboolean
-opc_write_property(UA_NodeId parent,
-                   UA_QualifiedName browseName,
-                   void *data,
-                   const UA_DataType *type,
-                   GError **err)
+/* called from the OPC-UA server thread when a sampled node is read, either by
+ * a client or by the sampling of a monitored item */
+static UA_StatusCode
+thermal_sample_read_cb(G_GNUC_UNUSED UA_Server *server,
+                       G_GNUC_UNUSED const UA_NodeId *sessionId,
+                       G_GNUC_UNUSED void *sessionContext,
+                       G_GNUC_UNUSED const UA_NodeId *nodeId,
+                       void *nodeContext,
+                       UA_Boolean includeSourceTimeStamp,
+                       const UA_NumericRange *range,
+                       UA_DataValue *value)
 {
-  UA_StatusCode retval;
+  sample_node_t *node = (sample_node_t *) nodeContext;
+  area_cache_t *area;
+  UA_DateTime updated;
+  UA_StatusCode status;
+  gint64 now;
 
-  g_assert(type != NULL);
-  g_assert(data != NULL);
   g_assert(plugin != NULL);
-  g_assert(plugin->server != NULL);
-  g_assert(err == NULL || *err == NULL);
+  g_assert(node != NULL);
+  g_assert(value != NULL);
 
-  retval = UA_Server_writeObjectProperty_scalar(plugin->server,
-                                                parent,
-                                                browseName,
-                                                data,
-                                                type);
+  if (range != NULL) {
+    value->hasStatus = true;
+    value->status = UA_STATUSCODE_BADINDEXRANGEINVALID;
+    return UA_STATUSCODE_GOOD;
+  }
 
-  if (retval != UA_STATUSCODE_GOOD) {
-    SET_ERROR(err,
-              -1,
-              "UA_Server_writeObjectProperty_scalar(%.*s) failed: %s",
-              (int) browseName.name.length,
-              browseName.name.data,
-              UA_StatusCode_name(retval));
-    return FALSE;
+  area = node->area;
+  now = g_get_monotonic_time();
+
+  g_mutex_lock(&plugin->lock);
+
+  /* how often a node is read tells how fast the clients sample it, the area
+   * alarm events only bring the 'Triggered' changes forward */
+  if (node->last_read != 0 &&
+      now - node->last_read < THERMAL_MAX_INTERVAL * G_TIME_SPAN_MILLISECOND) {
+    plugin->demand_interval =
+            MIN(plugin->demand_interval, now - node->last_read);
+  }
+  node->last_read = now;
+  plugin->last_demand = now;
+
+  if (!plugin->sampling) {
+    plugin->sampling = TRUE;
+    /* before the first tick the polling starts with it */
+    if (plugin->sched != NULL) {
+      ua_sched_wake(plugin->sched, 0);
+    }
   }
 
-  return TRUE;
+  updated = area->updated;
+  if (updated == 0) {
+    /* nothing was polled yet, the first poll was just started */
+    g_mutex_unlock(&plugin->lock);
+    value->hasStatus = true;
+    value->status = UA_STATUSCODE_BADWAITINGFORINITIALDATA;
+    return UA_STATUSCODE_GOOD;
+  }
+
+  switch (node->sample) {
+  case THERMAL_SAMPLE_MIN:
+    status = UA_Variant_setScalarCopy(&value->value,
+                                      &area->min,
+                                      &UA_TYPES[UA_TYPES_INT32]);
+    break;
+  case THERMAL_SAMPLE_AVG:
+    status = UA_Variant_setScalarCopy(&value->value,
+                                      &area->avg,
+                                      &UA_TYPES[UA_TYPES_INT32]);
+    break;
+  case THERMAL_SAMPLE_MAX:
+    status = UA_Variant_setScalarCopy(&value->value,
+                                      &area->max,
+                                      &UA_TYPES[UA_TYPES_INT32]);
+    break;
+  case THERMAL_SAMPLE_TRIGGERED:
+    status = UA_Variant_setScalarCopy(&value->value,
+                                      &area->triggered,
+                                      &UA_TYPES[UA_TYPES_BOOLEAN]);
+    break;
+  default:
+    status = UA_STATUSCODE_BADINTERNALERROR;
+    break;
+  }
+
+  g_mutex_unlock(&plugin->lock);
+
+  if (status != UA_STATUSCODE_GOOD) {
+    return status;
+  }
+  value->hasValue = true;
+
+  if (includeSourceTimeStamp) {
+    value->hasSourceTimestamp = true;
+    value->sourceTimestamp = updated;
+  }
+
+  return UA_STATUSCODE_GOOD;
 }
 
-static gboolean
-ua_server_add_themal_properties(UA_NodeId parent, GError **err)
+/* called from the OPC-UA server thread when a deadband of an area is read */
+static UA_StatusCode
+thermal_deadband_read_cb(G_GNUC_UNUSED UA_Server *server,
+                         G_GNUC_UNUSED const UA_NodeId *sessionId,
+                         G_GNUC_UNUSED void *sessionContext,
+                         G_GNUC_UNUSED const UA_NodeId *nodeId,
+                         void *nodeContext,
+                         G_GNUC_UNUSED UA_Boolean includeSourceTimeStamp,
+                         const UA_NumericRange *range,
+                         UA_DataValue *value)
 {
+  sample_node_t *node = (sample_node_t *) nodeContext;
+  UA_Double deadband;
   UA_StatusCode status;
-  UA_VariableAttributes attr = UA_VariableAttributes_default;
 
   g_assert(plugin != NULL);
-  g_assert(plugin->rbd != NULL);
-  g_assert(plugin->server != NULL);
-  g_assert(err == NULL || *err == NULL);
+  g_assert(node != NULL);
+  g_assert(value != NULL);
 
-  for (gint i = 0; thermal_properties[i].name != NULL; i++) {
-    attr.accessLevel = UA_ACCESSLEVELMASK_READ;
-    UA_Variant_setScalar(&attr.value,
-                         NULL,
-                         &UA_TYPES[thermal_properties[i].value_type]);
+  if (range != NULL) {
+    value->hasStatus = true;
+    value->status = UA_STATUSCODE_BADINDEXRANGEINVALID;
+    return UA_STATUSCODE_GOOD;
+  }
 
-    attr.displayName = UA_LOCALIZEDTEXT("en-US", thermal_properties[i].name);
-    attr.description = UA_LOCALIZEDTEXT("en-US", thermal_properties[i].name);
-
-    status = UA_Server_addVariableNode_rb(
-            plugin->server,
-            UA_NODEID_NUMERIC(plugin->ns, 0),
-            parent,
-            UA_NODEID_NUMERIC(0, UA_NS0ID_HASPROPERTY),
-            UA_QUALIFIEDNAME(plugin->ns, thermal_properties[i].name),
-            UA_NODEID_NUMERIC(0, UA_NS0ID_PROPERTYTYPE),
-            attr,
-            NULL,
-            plugin->rbd,
-            NULL);
-
-    if (status != UA_STATUSCODE_GOOD) {
-      SET_ERROR(err,
-                -1,
-                "Failed to add variable %s: %s",
-                thermal_properties[i].name,
-                UA_StatusCode_name(status));
-      return FALSE;
-    }
+  g_mutex_lock(&plugin->lock);
+  deadband = (node->sample == THERMAL_DEADBAND_ABSOLUTE) ?
+                     node->area->deadband_abs :
+                     node->area->deadband_pct;
+  g_mutex_unlock(&plugin->lock);
+
+  status = UA_Variant_setScalarCopy(&value->value,
+                                    &deadband,
+                                    &UA_TYPES[UA_TYPES_DOUBLE]);
+  if (status != UA_STATUSCODE_GOOD) {
+    return status;
   }
+  value->hasValue = true;
 
-  return TRUE;
+  return UA_STATUSCODE_GOOD;
 }
 
-static gboolean
-ua_server_add_thermal_area(UA_UInt32 id,
-                           gchar *name,
-                           UA_Boolean enabled,
-                           UA_Int32 preset_nbr,
-                           UA_Int32 threshold_val,
-                           gchar *threshold,
-                           gchar *detection,
-                           GError **err)
+/* called from the OPC-UA server thread when a client sets a deadband */
+static UA_StatusCode
+thermal_deadband_write_cb(G_GNUC_UNUSED UA_Server *server,
+                          G_GNUC_UNUSED const UA_NodeId *sessionId,
+                          G_GNUC_UNUSED void *sessionContext,
+                          G_GNUC_UNUSED const UA_NodeId *nodeId,
+                          void *nodeContext,
+                          const UA_NumericRange *range,
+                          const UA_DataValue *value)
 {
-  UA_ObjectAttributes oAttr = UA_ObjectAttributes_default;
-  gchar *title;
-  UA_StatusCode status;
-  gboolean ret = TRUE;
-  UA_NodeId areaId;
-  UA_String ua_name;
-  UA_String ua_detection;
-  UA_String ua_threshold;
+  sample_node_t *node = (sample_node_t *) nodeContext;
+  UA_Double deadband;
 
   g_assert(plugin != NULL);
-  g_assert(plugin->rbd != NULL);
-  g_assert(plugin->server != NULL);
-  g_assert(name != NULL);
-  g_assert(threshold != NULL);
-  g_assert(detection != NULL);
-  g_assert(err == NULL || *err == NULL);
-
-  title = g_strdup_printf("Thermal%u", id);
-  oAttr.displayName = UA_LOCALIZEDTEXT("en-US", name);
-  oAttr.description = UA_LOCALIZEDTEXT("en-US", THERMAL_DESCRIPTION);
+  g_assert(node != NULL);
+  g_assert(value != NULL);
 
-  areaId = UA_NODEID_STRING(plugin->ns, title);
+  if (range != NULL) {
+    return UA_STATUSCODE_BADINDEXRANGEINVALID;
+  }
 
-  status =
-          UA_Server_addObjectNode_rb(plugin->server,
-                                     areaId,
-                                     plugin->thermal_parent,
-                                     UA_NODEID_NUMERIC(0, UA_NS0ID_ORGANIZES),
-                                     UA_QUALIFIEDNAME(plugin->ns, title),
-                                     UA_NODEID_NUMERIC(0,
-                                                       UA_NS0ID_BASEOBJECTTYPE),
-                                     oAttr,
-                                     NULL,
-                                     plugin->rbd,
-                                     NULL);
-  if (status != UA_STATUSCODE_GOOD) {
-    SET_ERROR(err,
-              -1,
-              "UA_Server_addObjectNode_rb() failed: %s",
-              UA_StatusCode_name(status));
-    ret = FALSE;
-    goto err_out;
+  if (!value->hasValue ||
+      !UA_Variant_hasScalarType(&value->value, &UA_TYPES[UA_TYPES_DOUBLE])) {
+    return UA_STATUSCODE_BADTYPEMISMATCH;
   }
 
-  if (!ua_server_add_themal_properties(areaId, err)) {
-    g_prefix_error(err, "ua_server_add_thermal_properties() failed: ");
-    ret = FALSE;
-    goto err_out;
+  deadband = *(UA_Double *) value->value.data;
+  if (!(deadband >= 0.0) ||
+      (node->sample == THERMAL_DEADBAND_PERCENT && deadband > 100.0)) {
+    return UA_STATUSCODE_BADOUTOFRANGE;
   }
 
-  ua_name = UA_STRING(name);
-  ua_detection = UA_STRING(detection);
-  ua_threshold = UA_STRING(threshold);
-
-  if (!opc_write_property(areaId,
-                          UA_QUALIFIEDNAME(plugin->ns, NAME_BNAME),
-                          &ua_name,
-                          &UA_TYPES[UA_TYPES_STRING],
-                          err) ||
-      !opc_write_property(areaId,
-                          UA_QUALIFIEDNAME(plugin->ns, ENABLED_BNAME),
-                          &enabled,
-                          &UA_TYPES[UA_TYPES_BOOLEAN],
-                          err) ||
-      !opc_write_property(areaId,
-                          UA_QUALIFIEDNAME(plugin->ns, THRESHOLD_VALUE_BNAME),
-                          &threshold_val,
-                          &UA_TYPES[UA_TYPES_INT32],
-                          err) ||
-      !opc_write_property(areaId,
-                          UA_QUALIFIEDNAME(plugin->ns, PRESET_NBR_BNAME),
-                          &preset_nbr,
-                          &UA_TYPES[UA_TYPES_INT32],
-                          err) ||
-      !opc_write_property(areaId,
-                          UA_QUALIFIEDNAME(plugin->ns, ID_BNAME),
-                          &id,
-                          &UA_TYPES[UA_TYPES_UINT32],
-                          err) ||
-      !opc_write_property(areaId,
-                          UA_QUALIFIEDNAME(plugin->ns,
-                                           THRESHOLD_MEASUREMENT_BNAME),
-                          &ua_threshold,
-                          &UA_TYPES[UA_TYPES_STRING],
-                          err) ||
-      !opc_write_property(areaId,
-                          UA_QUALIFIEDNAME(plugin->ns, DETECTION_TYPE_BNAME),
-                          &ua_detection,
-                          &UA_TYPES[UA_TYPES_STRING],
-                          err)) {
-    g_prefix_error(err, "opc_write_property() failed: ");
-    ret = FALSE;
-    goto err_out;
+  g_mutex_lock(&plugin->lock);
+  if (node->sample == THERMAL_DEADBAND_ABSOLUTE) {
+    node->area->deadband_abs = deadband;
+  } else {
+    node->area->deadband_pct = deadband;
   }
+  g_mutex_unlock(&plugin->lock);
 
-err_out:
-  g_clear_pointer(&title, g_free);
+  return UA_STATUSCODE_GOOD;
+}
+
+UA_METRICS_TIMED_READ(timed_sample_read_cb,
+                      thermal_sample_read_cb,
+                      plugin->reads)
+UA_METRICS_TIMED_READ(timed_deadband_read_cb,
+                      thermal_deadband_read_cb,
+                      plugin->reads)
+UA_METRICS_TIMED_WRITE(timed_deadband_write_cb,
+                       thermal_deadband_write_cb,
+                       plugin->writes)
+
+static const UA_DataSource sample_source = { .read = timed_sample_read_cb,
+                                            .write = NULL };
+static const UA_DataSource deadband_source = {
+  .read = timed_deadband_read_cb,
+  .write = timed_deadband_write_cb
+};
+
+/* describes the object of a thermal area, titled 'title', followed by its
+ * properties in 'nodes', which has room for 1 + THERMAL_NBR_OF_PROPERTIES
+ * nodes. The static properties get their values from 'values', which is
+ * filled in from 'info', the sampled ones are served from 'area'. */
+static void
+describe_thermal_area(const thermal_area_t *info,
+                      gchar *title,
+                      area_values_t *values,
+                      area_cache_t *area,
+                      ua_node_desc_t *nodes)
+{
+  UA_NodeId areaId;
+  UA_VariableAttributes *attr;
+  thermal_sample_t sample;
+  gboolean is_deadband;
+
+  g_assert(plugin != NULL);
+  g_assert(info != NULL);
+  g_assert(info->name != NULL);
+  g_assert(info->measurement != NULL);
+  g_assert(info->detectionType != NULL);
+  g_assert(title != NULL);
+  g_assert(values != NULL);
+  g_assert(area != NULL);
+  g_assert(nodes != NULL);
+
+  values->id = info->id;
+  values->preset_nbr = info->presetNbr;
+  values->threshold = info->threshold;
+  values->enabled = (info->enabled != FALSE);
+  values->name = UA_STRING(info->name);
+  values->detection = UA_STRING(info->detectionType);
+  values->measurement = UA_STRING(info->measurement);
+
+  areaId = UA_NODEID_STRING(plugin->ns, title);
 
-  return ret;
+  nodes[0].node_class = UA_NODECLASS_OBJECT;
+  nodes[0].requested_id = areaId;
+  nodes[0].parent = plugin->thermal_parent;
+  nodes[0].reference_type = UA_NODEID_NUMERIC(0, UA_NS0ID_ORGANIZES);
+  nodes[0].browse_name = UA_QUALIFIEDNAME(plugin->ns, title);
+  nodes[0].type_definition = UA_NODEID_NUMERIC(0, UA_NS0ID_BASEOBJECTTYPE);
+  nodes[0].attr.object = UA_ObjectAttributes_default;
+  nodes[0].attr.object.displayName = UA_LOCALIZEDTEXT("en-US", info->name);
+  nodes[0].attr.object.description =
+          UA_LOCALIZEDTEXT("en-US", THERMAL_DESCRIPTION);
+
+  for (guint i = 0; i < THERMAL_NBR_OF_PROPERTIES; i++) {
+    ua_node_desc_t *node = &nodes[i + 1];
+
+    sample = thermal_properties[i].sample;
+    is_deadband = (sample == THERMAL_DEADBAND_ABSOLUTE ||
+                   sample == THERMAL_DEADBAND_PERCENT);
+
+    node->node_class = UA_NODECLASS_VARIABLE;
+    node->requested_id = UA_NODEID_NUMERIC(plugin->ns, 0);
+    node->parent = areaId;
+    node->reference_type = UA_NODEID_NUMERIC(0, UA_NS0ID_HASPROPERTY);
+    node->browse_name =
+            UA_QUALIFIEDNAME(plugin->ns, thermal_properties[i].name);
+    node->type_definition = UA_NODEID_NUMERIC(0, UA_NS0ID_PROPERTYTYPE);
+
+    attr = &node->attr.variable;
+    *attr = UA_VariableAttributes_default;
+    attr->accessLevel = UA_ACCESSLEVELMASK_READ;
+    if (is_deadband) {
+      attr->accessLevel |= UA_ACCESSLEVELMASK_WRITE;
+    }
+    attr->minimumSamplingInterval =
+            (sample != THERMAL_SAMPLE_NONE && !is_deadband) ?
+                    plugin->min_interval :
+                    0.0;
+    UA_Variant_setScalar(&attr->value,
+                         thermal_properties[i].initial ?
+                                 (guint8 *) values +
+                                         thermal_properties[i].offset :
+                                 NULL,
+                         &UA_TYPES[thermal_properties[i].value_type]);
+    attr->displayName = UA_LOCALIZEDTEXT("en-US", thermal_properties[i].name);
+    attr->description = UA_LOCALIZEDTEXT("en-US", thermal_properties[i].name);
+
+    if (sample != THERMAL_SAMPLE_NONE) {
+      /* sampled properties and deadbands are served from the area cache */
+      node->data_source = is_deadband ? &deadband_source : &sample_source;
+      node->context = &area->nodes[sample];
+    }
+  }
 }
 
 static void
@@ -350,112 +602,304 @@ free_thermal_area(gpointer data)
   g_clear_pointer(&values, g_free);
 }
 
+/* adds the objects of the thermal areas and their properties in one batch,
+ * either all of them or none */
 static gboolean
 add_thermal_areas(GError **err)
 {
-  gboolean retval = TRUE;
-  GList *lst = NULL;
+  gboolean retval;
+  GList *lst;
+  guint nr_areas;
+  gsize nr_nodes;
+  ua_node_desc_t *nodes;
+  area_values_t *values;
+  area_cache_t *area;
+  gchar **titles;
+  guint i = 0;
 
   g_assert(plugin != NULL);
-  g_assert(plugin->curl_h != NULL);
   g_assert(plugin->logger != NULL);
-  g_assert(plugin->vapix_credentials != NULL);
+  g_assert(plugin->server != NULL);
+  g_assert(plugin->rbd != NULL);
+  g_assert(plugin->areas != NULL);
   g_assert(err == NULL || *err == NULL);
 
-  if (!vapix_get_thermal_areas(plugin->vapix_credentials,
-                               plugin->curl_h,
-                               &lst,
-                               err)) {
-    g_prefix_error(err, "vapix_get_thermal_areas() failed: ");
-    retval = FALSE;
-    goto err_out;
-  }
+  /* fetched over VAPIX by plugin_prefetch() */
+  lst = g_steal_pointer(&plugin->area_list);
+
+  nr_areas = g_list_length(lst);
+  nr_nodes = nr_areas * (1 + THERMAL_NBR_OF_PROPERTIES);
+  nodes = g_new0(ua_node_desc_t, nr_nodes);
+  values = g_new0(area_values_t, nr_areas);
+  titles = g_new0(gchar *, nr_areas + 1);
 
-  for (GList *iter = lst; iter != NULL; iter = iter->next) {
-    thermal_area_t *values = (thermal_area_t *) iter->data;
-    if (!ua_server_add_thermal_area(values->id,
-                                    values->name,
-                                    values->enabled,
-                                    values->presetNbr,
-                                    values->threshold,
-                                    values->measurement,
-                                    values->detectionType,
-                                    err)) {
-      g_prefix_error(err, "ua_server_add_thermal_area() failed: ");
-      retval = FALSE;
-      goto err_out;
+  for (GList *iter = lst; iter != NULL; iter = iter->next, i++) {
+    const thermal_area_t *info = (thermal_area_t *) iter->data;
+
+    area = g_new0(area_cache_t, 1);
+    for (gint j = 0; j < THERMAL_NBR_OF_SAMPLES; j++) {
+      area->nodes[j].area = area;
+      area->nodes[j].sample = (thermal_sample_t) j;
     }
+    g_hash_table_replace(plugin->areas, GUINT_TO_POINTER(info->id), area);
+
+    titles[i] = g_strdup_printf(THERMAL_AREA_FMT, info->id);
+    describe_thermal_area(info,
+                          titles[i],
+                          &values[i],
+                          area,
+                          &nodes[i * (1 + THERMAL_NBR_OF_PROPERTIES)]);
   }
 
-err_out:
+  retval = ua_utils_add_nodes(plugin->server,
+                              nodes,
+                              nr_nodes,
+                              plugin->rbd,
+                              err);
+  if (!retval) {
+    g_prefix_error(err, "ua_utils_add_nodes() failed: ");
+  }
+
+  g_strfreev(titles);
+  g_free(values);
+  g_free(nodes);
   g_list_free_full(lst, free_thermal_area);
 
   return retval;
 }
 
+/* an #ua_queue_func_t emitting the OPC-UA event of a threshold crossing */
+static void
+thermal_emit_trigger(UA_Server *server, gpointer data)
+{
+  trigger_change_t *change = data;
+  gchar title[THERMAL_AREA_NAME_MAX];
+  UA_NodeId area_node;
+  ua_event_fields_t fields;
+  GError *lerr = NULL;
+
+  g_assert(server != NULL);
+  g_assert(change != NULL);
+  g_assert(plugin != NULL);
+  g_assert(plugin->logger != NULL);
+
+  g_snprintf(title, sizeof(title), THERMAL_AREA_FMT, change->id);
+  area_node = UA_NODEID_STRING(plugin->ns, title);
+
+  fields.time = change->time;
+  fields.severity = THERMAL_TRIGGER_EV_SEVERITY;
+  fields.message = UA_LOCALIZEDTEXT("en-US",
+                                    change->triggered ? "Threshold triggered" :
+                                                        "Threshold cleared");
+  fields.sourceName = UA_STRING(title);
+
+  /* the area object is the event origin node */
+  if (!ua_utils_event_pool_trigger(plugin->trigger_ev,
+                                   server,
+                                   &area_node,
+                                   &fields,
+                                   &lerr)) {
+    LOG_E(plugin->logger,
+          "ua_utils_event_pool_trigger() failed: %s",
+          GERROR_MSG(lerr));
+    g_clear_error(&lerr);
+    return;
+  }
+
+  ua_metric_observe_since(plugin->event_latency, change->detected);
+}
+
+/* hands a threshold crossing over to the server thread to be emitted */
+static void
+thermal_queue_trigger(guint32 id, UA_Boolean triggered, UA_DateTime time)
+{
+  trigger_change_t *change;
+  GError *lerr = NULL;
+
+  g_assert(plugin != NULL);
+  g_assert(plugin->logger != NULL);
+
+  change = g_new0(trigger_change_t, 1);
+  change->id = id;
+  change->triggered = triggered;
+  change->time = time;
+  change->detected = g_get_monotonic_time();
+
+  if (!ua_queue_push(plugin->queue,
+                     thermal_emit_trigger,
+                     change,
+                     g_free,
+                     &lerr)) {
+    LOG_E(plugin->logger,
+          "Dropped the threshold event of area: %u: %s",
+          id,
+          GERROR_MSG(lerr));
+    g_clear_error(&lerr);
+    g_free(change);
+  }
+}
+
+/* adds the sampled properties of the thermal areas to the DataSet published
+ * with PubSub, if any. Its samples keep the temperatures polled. */
 static gboolean
-ua_server_update_thermal(UA_UInt32 id,
-                         UA_Int32 min,
-                         UA_Int32 avg,
-                         UA_Int32 max,
-                         UA_Boolean triggered,
-                         GError **err)
+publish_thermal_areas(GError **err)
 {
-  gchar *title;
-  UA_NodeId areaId;
-  gboolean ret = TRUE;
+  GHashTableIter iter;
+  gpointer key;
+  gchar title[THERMAL_AREA_NAME_MAX];
+  gchar *alias;
+  UA_NodeId area_node;
+  UA_NodeId node_id;
+  gboolean published;
 
-  g_assert(NULL != plugin);
-  g_assert(NULL != plugin->server);
+  g_assert(plugin != NULL);
+  g_assert(plugin->server != NULL);
+  g_assert(plugin->areas != NULL);
   g_assert(err == NULL || *err == NULL);
 
-  title = g_strdup_printf("Thermal%u", id);
-
-  areaId = UA_NODEID_STRING(plugin->ns, title);
+  g_hash_table_iter_init(&iter, plugin->areas);
+  while (g_hash_table_iter_next(&iter, &key, NULL)) {
+    g_snprintf(title, sizeof(title), THERMAL_AREA_FMT, GPOINTER_TO_UINT(key));
+    area_node = UA_NODEID_STRING(plugin->ns, title);
+
+    for (gint i = 0; thermal_properties[i].name != NULL; i++) {
+      UA_QualifiedName bname =
+              UA_QUALIFIEDNAME(plugin->ns, thermal_properties[i].name);
+
+      /* the deadbands are settings rather than data */
+      if (thermal_properties[i].sample == THERMAL_SAMPLE_NONE ||
+          thermal_properties[i].sample > THERMAL_SAMPLE_TRIGGERED) {
+        continue;
+      }
+
+      if (!ua_utils_node_cache_resolve(plugin->nodes,
+                                       plugin->server,
+                                       &area_node,
+                                       UA_NS0ID_HASPROPERTY,
+                                       &bname,
+                                       &node_id,
+                                       err)) {
+        g_prefix_error(err, "ua_utils_node_cache_resolve() failed: ");
+        return FALSE;
+      }
+
+      alias = g_strdup_printf("%s.%s", title, thermal_properties[i].name);
+      published = ua_pubsub_publish(plugin->server, &node_id, alias, err);
+      g_free(alias);
+      UA_NodeId_clear(&node_id);
+
+      if (!published) {
+        g_prefix_error(err, "ua_pubsub_publish() failed: ");
+        return FALSE;
+      }
+    }
+  }
 
-  if (!opc_write_property(areaId,
-                          UA_QUALIFIEDNAME(plugin->ns, TEMP_MIN_BNAME),
-                          &min,
-                          &UA_TYPES[UA_TYPES_INT32],
-                          err) ||
-      !opc_write_property(areaId,
-                          UA_QUALIFIEDNAME(plugin->ns, TEMP_AVG_BNAME),
-                          &avg,
-                          &UA_TYPES[UA_TYPES_INT32],
-                          err) ||
-      !opc_write_property(areaId,
-                          UA_QUALIFIEDNAME(plugin->ns, TEMP_MAX_BNAME),
-                          &max,
-                          &UA_TYPES[UA_TYPES_INT32],
-                          err) ||
-      !opc_write_property(areaId,
-                          UA_QUALIFIEDNAME(plugin->ns, TRIGGERED_BNAME),
-                          &triggered,
-                          &UA_TYPES[UA_TYPES_BOOLEAN],
-                          err)) {
-    g_prefix_error(err, "opc_write_property() failed: ");
-    ret = G_SOURCE_REMOVE;
-  }
-
-  g_clear_pointer(&title, g_free);
-
-  return ret;
+  return TRUE;
 }
 
-/* Retry to poll for temperature values */
+/* TRUE if a polled temperature is to be published, called with the plugin
+ * lock held */
 static gboolean
-check_counter(void)
+exceeds_deadband(area_cache_t *area, UA_Int32 published, UA_Int32 polled)
 {
+  UA_Double delta;
+
+  g_assert(area != NULL);
+
+  if (published == polled) {
+    return FALSE;
+  }
+
+  delta = ABS((UA_Double) polled - (UA_Double) published);
+
+  if (area->deadband_abs > 0.0 && delta <= area->deadband_abs) {
+    return FALSE;
+  }
+
+  if (area->deadband_pct > 0.0 &&
+      delta <= ABS((UA_Double) published) * area->deadband_pct / 100.0) {
+    return FALSE;
+  }
+
+  return TRUE;
+}
+
+/* publishes the polled values of a thermal area which changed, 'requested' is
+ * the monotonic time the poll was issued. Called with the plugin lock held */
+static void
+update_area_cache(thermal_area_values_t *values,
+                  gint64 requested,
+                  UA_DateTime now)
+{
+  area_cache_t *area;
+  gboolean changed = FALSE;
+  UA_Int32 polled;
+
   g_assert(plugin != NULL);
+  g_assert(plugin->areas != NULL);
+  g_assert(values != NULL);
 
-  plugin->counter++;
+  area = g_hash_table_lookup(plugin->areas, GUINT_TO_POINTER(values->id));
 
-  if (plugin->counter < NBR_OF_RETRIES) {
-    return G_SOURCE_CONTINUE;
-  } else {
-    plugin->cb_id = 0;
-    return G_SOURCE_REMOVE;
+  /* areas added after the plugin was created are not exposed */
+  if (area == NULL) {
+    return;
+  }
+
+  /* the first poll publishes everything */
+  if (area->updated == 0) {
+    area->min = (gint) values->min;
+    area->avg = (gint) values->avg;
+    area->max = (gint) values->max;
+    if (area->alarm_time < requested) {
+      area->triggered = values->triggered;
+    }
+    area->updated = now;
+    return;
+  }
+
+  polled = (gint) values->min;
+  if (exceeds_deadband(area, area->min, polled)) {
+    area->min = polled;
+    changed = TRUE;
+  }
+
+  polled = (gint) values->avg;
+  if (exceeds_deadband(area, area->avg, polled)) {
+    area->avg = polled;
+    changed = TRUE;
+  }
+
+  polled = (gint) values->max;
+  if (exceeds_deadband(area, area->max, polled)) {
+    area->max = polled;
+    changed = TRUE;
+  }
+
+  /* the polled state is reconciled unless an area alarm event came in while
+   * the poll was in flight, a device without the events relies on it */
+  if (area->alarm_time < requested && area->triggered != values->triggered) {
+    area->triggered = values->triggered;
+    changed = TRUE;
+    thermal_queue_trigger(values->id, area->triggered, now);
   }
+
+  /* the source timestamp tells when the published values last changed */
+  if (changed) {
+    area->updated = now;
+  }
+}
+
+/* a failed poll is retried by the next ticks, after a backoff */
+static void
+poll_failed(void)
+{
+  g_assert(plugin != NULL);
+  g_assert(plugin->sched != NULL);
+
+  ua_metric_add(plugin->poll_retries, 1);
+  ua_sched_report(plugin->sched, FALSE);
 }
 
 static void
@@ -470,58 +914,244 @@ free_thermal_area_values(gpointer data)
   g_clear_pointer(&values, g_free);
 }
 
-static gboolean
-update_thermal_cb(G_GNUC_UNUSED gpointer userdata)
+/* polling period following the fastest sampling of the nodes since the last
+ * poll, called with the plugin lock held */
+static guint
+get_sampling_interval(void)
+{
+  guint interval;
+
+  g_assert(plugin != NULL);
+
+  interval = plugin->interval;
+
+  if (plugin->demand_interval != G_MAXINT64) {
+    interval = (guint) (plugin->demand_interval / G_TIME_SPAN_MILLISECOND);
+    /* ignore the jitter of the reads */
+    if (interval <= plugin->interval &&
+        interval >= plugin->interval - plugin->interval / 10) {
+      interval = plugin->interval;
+    }
+    plugin->demand_interval = G_MAXINT64;
+  }
+
+  return CLAMP(interval, plugin->min_interval, THERMAL_MAX_INTERVAL);
+}
+
+/* called from the main loop when a 'getAreaStatus' request is completed */
+static void
+update_thermal_done_cb(GList *areas,
+                       const GError *err,
+                       G_GNUC_UNUSED gpointer userdata)
+{
+  UA_DateTime now;
+
+  g_assert(plugin != NULL);
+  g_assert(plugin->logger != NULL);
+
+  plugin->update_pending = FALSE;
+
+  if (err != NULL) {
+    LOG_E(plugin->logger,
+          "vapix_get_thermal_area_status_async() failed: %s",
+          GERROR_MSG(err));
+    poll_failed();
+    goto out;
+  }
+
+  now = UA_DateTime_now();
+
+  g_mutex_lock(&plugin->lock);
+  for (GList *iter = areas; iter != NULL; iter = iter->next) {
+    update_area_cache((thermal_area_values_t *) iter->data,
+                      plugin->update_requested,
+                      now);
+  }
+  g_mutex_unlock(&plugin->lock);
+
+  ua_sched_report(plugin->sched, TRUE);
+
+out:
+  g_list_free_full(areas, free_thermal_area_values);
+}
+
+/* requests the temperature values unless a request is already in flight */
+static void
+request_thermal_status(void)
 {
   GError *lerr = NULL;
-  gboolean ret = G_SOURCE_CONTINUE;
-  GList *lst = NULL;
 
   g_assert(plugin != NULL);
   g_assert(plugin->logger != NULL);
-  g_assert(plugin->curl_h != NULL);
-  g_assert(plugin->vapix_credentials != NULL);
+  g_assert(plugin->vapix_h != NULL);
+  g_assert(plugin->sched != NULL);
+
+  /* a slow thermometry.cgi must not pile up requests */
+  if (plugin->update_pending) {
+    return;
+  }
 
-  g_mutex_lock(&plugin->curl_mutex);
+  /* the scheduler ticks us again once the budget allows it */
+  if (!ua_sched_acquire(plugin->sched)) {
+    return;
+  }
 
-  if (!vapix_get_thermal_area_status(plugin->vapix_credentials,
-                                     plugin->curl_h,
-                                     &lst,
-                                     &lerr)) {
+  if (!vapix_get_thermal_area_status_async(plugin->vapix_h,
+                                           update_thermal_done_cb,
+                                           NULL,
+                                           &lerr)) {
     LOG_E(plugin->logger,
-          "vapix_get_thermal_area_status() failed: %s",
+          "vapix_get_thermal_area_status_async() failed: %s",
           GERROR_MSG(lerr));
     g_clear_error(&lerr);
-    g_mutex_unlock(&plugin->curl_mutex);
-    ret = check_counter();
-    goto err_out;
+    poll_failed();
+    return;
   }
 
-  g_mutex_unlock(&plugin->curl_mutex);
+  plugin->update_pending = TRUE;
+  plugin->update_requested = g_get_monotonic_time();
+}
 
-  for (GList *iter = lst; iter != NULL; iter = iter->next) {
-    thermal_area_values_t *values = (thermal_area_values_t *) iter->data;
-    if (!ua_server_update_thermal(values->id,
-                                  (gint) values->min,
-                                  (gint) values->avg,
-                                  (gint) values->max,
-                                  values->triggered,
-                                  &lerr)) {
-      LOG_E(plugin->logger,
-            "ua_server_update_thermal() failed: %s",
-            GERROR_MSG(lerr));
-      g_clear_error(&lerr);
-      ret = G_SOURCE_REMOVE;
-      goto err_out;
+/* called from the main loop when the alarm of a thermal area changes state */
+static void
+thermal_event_cb(G_GNUC_UNUSED guint subscription,
+                 AXEvent *event,
+                 G_GNUC_UNUSED gpointer user_data)
+{
+  const AXEventKeyValueSet *key_value_set;
+  area_cache_t *area;
+  gint id;
+  gboolean active;
+  gboolean changed = FALSE;
+  UA_DateTime now;
+  GError *lerr = NULL;
+
+  g_assert(plugin != NULL);
+  g_assert(plugin->areas != NULL);
+  g_assert(event != NULL);
+
+  UA_TRACE_ENTRY(axevent, G_STRFUNC);
+
+  key_value_set = ax_event_get_key_value_set(event);
+  if (key_value_set == NULL) {
+    goto out;
+  }
+
+  if (!ax_event_key_value_set_get_integer(key_value_set,
+                                          "AreaID",
+                                          NULL,
+                                          &id,
+                                          &lerr)) {
+    LOG_E(plugin->logger,
+          "'AreaID' key missing from event: %s",
+          GERROR_MSG(lerr));
+    goto out;
+  }
+
+  if (!ax_event_key_value_set_get_boolean(key_value_set,
+                                          "TriggerState",
+                                          NULL,
+                                          &active,
+                                          &lerr)) {
+    LOG_E(plugin->logger,
+          "'TriggerState' key missing from event: %s",
+          GERROR_MSG(lerr));
+    goto out;
+  }
+
+  LOG_D(plugin->logger, "Thermal area %d: triggered=%d", id, active);
+
+  now = UA_DateTime_now();
+
+  g_mutex_lock(&plugin->lock);
+  area = g_hash_table_lookup(plugin->areas, GUINT_TO_POINTER((guint) id));
+  /* areas added after the plugin was created are not exposed */
+  if (area != NULL) {
+    area->alarm_time = g_get_monotonic_time();
+  }
+  if (area != NULL && area->triggered != (active != FALSE)) {
+    area->triggered = (active != FALSE);
+    /* the state reported when subscribing is no crossing, until the first
+     * poll it is only recorded */
+    if (area->updated != 0) {
+      area->updated = now;
+      changed = TRUE;
     }
   }
+  g_mutex_unlock(&plugin->lock);
 
-  plugin->counter = 0;
+  if (changed) {
+    thermal_queue_trigger((guint32) id, (active != FALSE), now);
+  }
 
-err_out:
-  g_list_free_full(lst, free_thermal_area_values);
+out:
+  g_clear_error(&lerr);
+  /* the callback must always free 'event', NULL-case handled by the API */
+  ax_event_free(event);
+  UA_TRACE_EXIT(axevent, G_STRFUNC, 0);
+}
+
+/* subscribes to the alarms of the thermal areas, which bring the polled
+ * 'Triggered' changes forward */
+static gboolean
+thermal_subscribe_events(GError **err)
+{
+  AXEventKeyValueSet *key_value_set;
+  guint subscription;
+
+  g_assert(plugin != NULL);
+  g_assert(plugin->event_handler != NULL);
+  g_assert(err == NULL || *err == NULL);
+
+  key_value_set = ax_event_key_value_set_new();
+  if (key_value_set == NULL) {
+    SET_ERROR(err, -1, "ax_event_key_value_set_new() failed!");
+    return FALSE;
+  }
 
-  return ret;
+  /* Initialize an AXEventKeyValueSet that matches the area alarms.
+   *
+   * tns1:topic0=VideoSource
+   * tnsaxis:topic1=Thermometry
+   * tnsaxis:topic2=TemperatureDetection
+   * AreaID=*        <-- Subscribe to all areas
+   * TriggerState=*  <-- Subscribe to all states
+   */
+  /* clang-format off */
+  if (!ax_event_key_value_set_add_key_values(key_value_set, err,
+      "topic0",       "tns1",    "VideoSource",          AX_VALUE_TYPE_STRING,
+      "topic1",       "tnsaxis", "Thermometry",          AX_VALUE_TYPE_STRING,
+      "topic2",       "tnsaxis", "TemperatureDetection", AX_VALUE_TYPE_STRING,
+      "AreaID",       NULL,      NULL,                   AX_VALUE_TYPE_INT,
+      "TriggerState", NULL,      NULL,                   AX_VALUE_TYPE_BOOL,
+      NULL)) {
+    g_prefix_error(err, "ax_event_key_value_set_add_key_values() failed: ");
+    ax_event_key_value_set_free(key_value_set);
+    return FALSE;
+  }
+  /* clang-format on */
+
+  if (!ax_event_handler_subscribe(plugin->event_handler,
+                                  key_value_set,
+                                  &subscription,
+                                  (AXSubscriptionCallback) thermal_event_cb,
+                                  plugin,
+                                  err)) {
+    g_prefix_error(err, "ax_event_handler_subscribe() failed: ");
+    ax_event_key_value_set_free(key_value_set);
+    return FALSE;
+  }
+
+  plugin->event_subscription = subscription;
+
+  /* The key/value set is no longer needed */
+  ax_event_key_value_set_free(key_value_set);
+
+  LOG_D(plugin->logger,
+        "VideoSource/Thermometry/TemperatureDetection subscr. id: %u",
+        plugin->event_subscription);
+
+  return TRUE;
 }
 
 /* callback executed when the 'Set Scale' method */
@@ -557,12 +1187,7 @@ thermal_change_scale_cb(G_GNUC_UNUSED UA_Server *server,
     goto err_out;
   }
 
-  g_mutex_lock(&plugin->curl_mutex);
-
-  if (!vapix_set_temperature_scale(plugin->vapix_credentials,
-                                   plugin->curl_h,
-                                   scale_lower,
-                                   &lerr)) {
+  if (!vapix_set_temperature_scale(plugin->vapix_h, scale_lower, &lerr)) {
     LOG_E(plugin->logger,
           "vapix_set_temperature_scale() failed: %s",
           GERROR_MSG(lerr));
@@ -570,8 +1195,6 @@ thermal_change_scale_cb(G_GNUC_UNUSED UA_Server *server,
     status = UA_STATUSCODE_BADCOMMUNICATIONERROR;
   }
 
-  g_mutex_unlock(&plugin->curl_mutex);
-
 err_out:
   g_clear_pointer(&scale_lower, g_free);
 
@@ -584,6 +1207,7 @@ thermal_add_scale_method(GError **err)
   UA_StatusCode status;
   UA_MethodAttributes mattr;
   UA_Argument in_arg;
+  UA_NodeId method;
 
   g_assert(plugin != NULL);
   g_assert(plugin->rbd != NULL);
@@ -619,14 +1243,23 @@ thermal_add_scale_method(GError **err)
                                       NULL,
                                       NULL,
                                       plugin->rbd,
-                                      NULL);
+                                      &method);
 
   if (status != UA_STATUSCODE_GOOD) {
     SET_ERROR(err,
               -1,
               "UA_Server_addMethodNode_rb() failed, error code: %s",
               UA_StatusCode_name(status));
+    return status;
+  }
+
+  /* the VAPIX request blocks, let a method worker wait for it if there are
+   * any. A failure only leaves the method synchronous. */
+  if (plugin->async_methods &&
+      ua_utils_set_method_async(plugin->server, method) != UA_STATUSCODE_GOOD) {
+    LOG_W(plugin->logger, "Failed to make the scale method asynchronous");
   }
+  UA_NodeId_clear(&method);
 
   return status;
 }
@@ -680,79 +1313,179 @@ add_thermal_object(GError **err)
 static void
 plugin_cleanup(void)
 {
+  GError *lerr = NULL;
+
   g_assert(plugin != NULL);
   g_assert(plugin->logger != NULL);
 
-  if (plugin->cb_id != 0 && !g_source_remove(plugin->cb_id)) {
-    LOG_E(plugin->logger,
-          "Failed to remove timed vapix retrieval function from main loop");
-  }
+  if (plugin->event_handler != NULL) {
+    if (plugin->event_subscription > 0 &&
+        !ax_event_handler_unsubscribe_and_notify(plugin->event_handler,
+                                                 plugin->event_subscription,
+                                                 NULL,
+                                                 NULL,
+                                                 &lerr)) {
+      LOG_E(plugin->logger,
+            "ax_event_handler_unsubscribe_and_notify() failed: %s",
+            GERROR_MSG(lerr));
+      g_clear_error(&lerr);
+    }
 
-  if (plugin->curl_h != NULL) {
-    curl_easy_cleanup(plugin->curl_h);
+    ax_event_handler_free(plugin->event_handler);
+    plugin->event_handler = NULL;
   }
 
+  g_clear_pointer(&plugin->vapix_h, vapix_session_free);
+  g_clear_pointer(&plugin->trigger_ev, ua_utils_event_pool_free);
+  plugin->queue = NULL;
+
   plugin->logger = NULL;
   plugin->server = NULL;
-  g_mutex_clear(&plugin->curl_mutex);
   g_clear_pointer(&plugin->name, g_free);
-  g_clear_pointer(&plugin->vapix_credentials, g_free);
 
   /* free up allocated rollback data, if any */
   ua_utils_clear_rbd(&plugin->rbd);
 
+  g_clear_pointer(&plugin->areas, g_hash_table_destroy);
+  g_list_free_full(g_steal_pointer(&plugin->area_list), free_thermal_area);
+  g_clear_pointer(&plugin->nodes, ua_utils_node_cache_free);
+  g_mutex_clear(&plugin->lock);
+
   g_clear_pointer(&plugin, g_free);
 }
 
+/* allocates the plugin and fetches the thermal areas over VAPIX, blocking but
+ * without accessing the server */
+static gboolean
+plugin_prefetch(UA_Logger *logger,
+                ua_plugin_params_t *services,
+                GError **err)
+{
+  g_assert(plugin == NULL);
+  g_assert(logger != NULL);
+  g_assert(services != NULL);
+  g_assert(err == NULL || *err == NULL);
+
+  plugin = g_new0(plugin_t, 1);
+
+  plugin->name = g_strdup(UA_PLUGIN_NAME);
+  plugin->logger = logger;
+  plugin->rbd = g_new0(rollback_data_t, 1);
+  plugin->nodes = ua_utils_node_cache_new();
+  plugin->rbd->node_cache = plugin->nodes;
+  plugin->interval = THERMAL_DEFAULT_INTERVAL;
+  plugin->min_interval = services->min_sampling_interval;
+  plugin->async_methods = (services->method_workers > 0);
+  plugin->demand_interval = G_MAXINT64;
+  plugin->areas = g_hash_table_new_full(NULL, NULL, NULL, g_free);
+  g_mutex_init(&plugin->lock);
+  plugin->reads = ua_metrics_get(UA_METRIC_TIMING, "thermal.reads");
+  plugin->writes = ua_metrics_get(UA_METRIC_TIMING, "thermal.writes");
+  plugin->poll_retries =
+          ua_metrics_get(UA_METRIC_COUNTER, "thermal.poll_retries");
+  plugin->event_latency =
+          ua_metrics_get(UA_METRIC_TIMING, "thermal.event_latency");
+  plugin->queue = services->queue;
+
+  /* the credentials of the VAPIX account are managed by the service */
+  plugin->vapix_h =
+          vapix_session_new(services->vapix, "vapix-thermometry-user", err);
+  if (plugin->vapix_h == NULL) {
+    g_prefix_error(err, "vapix_session_new() failed: ");
+    goto err_out;
+  }
+
+  /* If thermometry isn't supported don't return false */
+  if (!vapix_get_supported_versions(plugin->vapix_h, err)) {
+    g_prefix_error(err, "No supported versions available for 'thermometry': ");
+    goto err_out;
+  }
+
+  if (!vapix_get_thermal_areas(plugin->vapix_h, &plugin->area_list, err)) {
+    g_prefix_error(err, "vapix_get_thermal_areas() failed: ");
+    goto err_out;
+  }
+
+  return TRUE;
+
+err_out:
+  plugin_cleanup();
+
+  return FALSE;
+}
+
 /* Exported functions */
+gboolean
+opc_ua_prepare(UA_Logger *logger, gpointer *params, GError **err)
+{
+  ua_plugin_params_t *services = (ua_plugin_params_t *) params;
+
+  g_return_val_if_fail(logger != NULL, FALSE);
+  g_return_val_if_fail(services != NULL, FALSE);
+  g_return_val_if_fail(services->vapix != NULL, FALSE);
+  g_return_val_if_fail(err == NULL || *err == NULL, FALSE);
+
+  if (plugin != NULL) {
+    return TRUE;
+  }
+
+  if (!plugin_prefetch(logger, services, err)) {
+    g_prefix_error(err, "plugin_prefetch() failed: ");
+    return FALSE;
+  }
+
+  return TRUE;
+}
+
 gboolean
 opc_ua_create(UA_Server *server,
               UA_Logger *logger,
-              G_GNUC_UNUSED gpointer *params,
+              gpointer *params,
               GError **err)
 {
+  ua_plugin_params_t *services = (ua_plugin_params_t *) params;
+  UA_NodeId ev_type;
   GError *lerr = NULL;
 
   g_return_val_if_fail(server != NULL, FALSE);
   g_return_val_if_fail(logger != NULL, FALSE);
+  g_return_val_if_fail(services != NULL, FALSE);
+  g_return_val_if_fail(services->vapix != NULL, FALSE);
   g_return_val_if_fail(err == NULL || *err == NULL, FALSE);
 
-  if (plugin != NULL) {
+  if (plugin != NULL && plugin->server != NULL) {
     return TRUE;
   }
 
-  plugin = g_new0(plugin_t, 1);
+  /* unless already done by opc_ua_prepare() */
+  if (plugin == NULL && !plugin_prefetch(logger, services, err)) {
+    g_prefix_error(err, "plugin_prefetch() failed: ");
+    return FALSE;
+  }
 
-  plugin->name = g_strdup(UA_PLUGIN_NAME);
-  plugin->logger = logger;
-  plugin->rbd = g_new0(rollback_data_t, 1);
   plugin->server = server;
-  g_mutex_init(&plugin->curl_mutex);
+  plugin->ns = UA_Server_addNamespace(server, THERMAL_NAMESPACE_URI);
 
-  plugin->curl_h = curl_easy_init();
-  if (plugin->curl_h == NULL) {
-    SET_ERROR(err, -1, "curl_easy_init() failed");
-    goto err_out;
-  }
+  ev_type = UA_NODEID_NUMERIC(0, UA_NS0ID_BASEEVENTTYPE);
+  plugin->trigger_ev =
+          ua_utils_event_pool_new(&ev_type, THERMAL_TRIGGER_EV_POOL_SIZE);
+  ua_utils_event_pool_keep_history(plugin->trigger_ev, services->event_history);
 
-  /* obtain credentials to make VAPIX calls */
-  plugin->vapix_credentials =
-          vapix_get_credentials("vapix-thermometry-user", err);
-  if (plugin->vapix_credentials == NULL) {
-    g_prefix_error(err, "Failed to get the VAPIX credentials: ");
+  /* the threshold crossings are pushed by the device, without the events they
+   * are only seen by the polling. Subscribe before the sampled nodes exist. */
+  plugin->event_handler = ax_event_handler_new();
+  if (plugin->event_handler == NULL) {
+    SET_ERROR(err, -1, "Could not allocate AXEventHandler!");
     goto err_out;
   }
 
-  /* If thermometry isn't supported don't return false */
-  if (!vapix_get_supported_versions(plugin->vapix_credentials,
-                                    plugin->curl_h,
-                                    err)) {
-    g_prefix_error(err, "No supported versions available for 'thermometry': ");
-    goto err_out;
+  if (!thermal_subscribe_events(&lerr)) {
+    LOG_W(plugin->logger,
+          "Polling the triggered states, thermal_subscribe_events() failed: %s",
+          GERROR_MSG(lerr));
+    g_clear_error(&lerr);
   }
 
-  plugin->ns = UA_Server_addNamespace(server, THERMAL_NAMESPACE_URI);
-
   /* Add thermal-object and scale variable */
   if (!add_thermal_object(err)) {
     g_prefix_error(err, "add_thermal_object() failed: ");
@@ -764,11 +1497,17 @@ opc_ua_create(UA_Server *server,
     goto err_out;
   }
 
-  plugin->cb_id = g_timeout_add_seconds(1, update_thermal_cb, NULL);
+  /* the clients of the server don't depend on the publishing */
+  if (!publish_thermal_areas(&lerr)) {
+    LOG_W(plugin->logger,
+          "publish_thermal_areas() failed: %s",
+          GERROR_MSG(lerr));
+    g_clear_error(&lerr);
+  }
+
+  /* the temperature values are polled once the sampled nodes are read */
 
-  /* the information model was successfully populated so now we can free up our
-   * rollback data since we no longer need it */
-  ua_utils_clear_rbd(&plugin->rbd);
+  /* the rollback data is kept, opc_ua_remove() deletes the nodes it lists */
 
   return TRUE;
 
@@ -784,6 +1523,79 @@ err_out:
   return FALSE;
 }
 
+guint
+opc_ua_tick(ua_sched_client_t *client, gint64 now)
+{
+  gint64 idle_timeout;
+  guint interval;
+
+  g_return_val_if_fail(client != NULL, 0);
+  g_return_val_if_fail(plugin != NULL, 0);
+
+  g_mutex_lock(&plugin->lock);
+
+  plugin->sched = client;
+
+  /* woken by the next read of a sampled node */
+  if (!plugin->sampling) {
+    g_mutex_unlock(&plugin->lock);
+    return 0;
+  }
+
+  idle_timeout = MAX(THERMAL_IDLE_PERIODS * plugin->interval,
+                     THERMAL_IDLE_TIMEOUT);
+  if (now - plugin->last_demand > idle_timeout * G_TIME_SPAN_MILLISECOND) {
+    /* nobody is watching the temperature values anymore */
+    plugin->sampling = FALSE;
+    g_mutex_unlock(&plugin->lock);
+    LOG_D(plugin->logger, "Thermal areas are idle, polling stopped");
+    return 0;
+  }
+
+  interval = get_sampling_interval();
+
+  g_mutex_unlock(&plugin->lock);
+
+  if (interval != plugin->interval) {
+    LOG_D(plugin->logger, "Polling thermal areas every %u ms", interval);
+    plugin->interval = interval;
+  }
+
+  request_thermal_status();
+
+  return plugin->interval;
+}
+
+gboolean
+opc_ua_remove(UA_Server *server, GError **err)
+{
+  g_return_val_if_fail(server != NULL, FALSE);
+  g_return_val_if_fail(err == NULL || *err == NULL, FALSE);
+
+  if (plugin == NULL || plugin->rbd == NULL) {
+    return TRUE;
+  }
+
+  /* the published fields refer to the variables of the plugin */
+  if (!ua_pubsub_unpublish(server, plugin->ns, err)) {
+    g_prefix_error(err, "ua_pubsub_unpublish() failed: ");
+    return FALSE;
+  }
+
+  /* the event nodes are created as the events are triggered */
+  if (plugin->trigger_ev != NULL) {
+    ua_utils_event_pool_remove(plugin->trigger_ev, server);
+  }
+
+  if (!ua_utils_do_rollback(server, plugin->rbd, err)) {
+    g_prefix_error(err, "ua_utils_do_rollback() failed: ");
+    return FALSE;
+  }
+  ua_utils_clear_rbd(&plugin->rbd);
+
+  return TRUE;
+}
+
 void
 opc_ua_destroy(void)
 {
@@ -23,13 +23,13 @@
  * SOFTWARE.
  */
 
-#include <curl/curl.h>
 #include <glib.h>
 #include <jansson.h>
 
 #include "error.h"
 #include "log.h"
 #include "thermal_vapix.h"
+#include "ua_metrics.h"
 #include "vapix_utils.h"
 
 #define THERMOMETRY_API_VERSION  "1.2"
@@ -59,8 +59,130 @@
 
 DEFINE_GQUARK("opc-thermal-vapix-plugin");
 
+/* pending 'getAreaStatus' request */
+typedef struct area_status_req {
+  thermal_status_cb_t callback;
+  gpointer user_data;
+} area_status_req_t;
+
+/* parses a 'getAreaStatus' response into a list of thermal_area_values_t */
+static gboolean
+parse_thermal_area_status(const gchar *response, GList **areas, GError **err)
+{
+  json_t *area;
+  json_t *area_list;
+  gsize index;
+  json_error_t json_error;
+  json_t *json_response;
+  gboolean ret = TRUE;
+  static ua_metric_t *parse_time;
+  gint64 start = g_get_monotonic_time();
+
+  const gchar *area_fmt = "{s:i, s:f, s:f, s:f, s:b}";
+  const gchar *fmt_string = "{s:{s:o}}";
+
+  g_assert(response != NULL);
+  g_assert(areas != NULL && *areas == NULL);
+  g_assert(err == NULL || *err == NULL);
+
+  json_response = json_loads(response, 0, &json_error);
+
+  if (json_response == NULL) {
+    SET_ERROR(err,
+              -1,
+              "Invalid json response: %d/%d/%d - %s",
+              json_error.line,
+              json_error.column,
+              json_error.position,
+              json_error.text);
+    ret = FALSE;
+    goto err_out;
+  }
+
+  /* clang-format off */
+  if (json_unpack_ex(json_response,
+                     &json_error,
+                     0,
+                     fmt_string,
+                     "data",
+                     "arealist", &area_list) != 0) {
+    SET_ERROR(err, -1, "json_unpack_ex() failed: %d/%d/%d - %s",
+              json_error.line,
+              json_error.column,
+              json_error.position,
+              json_error.text);
+    ret = FALSE;
+    goto err_out;
+  }
+  /* clang-format on */
+
+  json_array_foreach(area_list, index, area)
+  {
+    thermal_area_values_t *values = g_new(thermal_area_values_t, 1);
+
+    /* clang-format off */
+    if (json_unpack_ex(area,
+                       &json_error,
+                       0,
+                       area_fmt,
+                       "id", &values->id,
+                       "avg", &values->avg,
+                       "min", &values->min,
+                       "max", &values->max,
+                       "triggered", &values->triggered) != 0) {
+      SET_ERROR(err, -1, "json_unpack_ex() failed: %d/%d/%d - %s",
+              json_error.line,
+              json_error.column,
+              json_error.position,
+              json_error.text);
+      g_free(values);
+      ret = FALSE;
+      goto err_out;
+    }
+    /* clang-format on */
+    *areas = g_list_prepend(*areas, values);
+  }
+
+  ua_metric_observe_since(ua_metrics_get_cached(&parse_time,
+                                                UA_METRIC_TIMING,
+                                                "thermal.parse"),
+                          start);
+
+err_out:
+  g_clear_pointer(&json_response, json_decref);
+
+  return ret;
+}
+
+static void
+area_status_done_cb(const gchar *response,
+                    const GError *err,
+                    gpointer user_data)
+{
+  area_status_req_t *req = user_data;
+  GError *lerr = NULL;
+  GList *areas = NULL;
+
+  g_assert(req != NULL);
+
+  if (response == NULL) {
+    SET_ERROR(&lerr,
+              -1,
+              "vapix call: 'getAreaStatus' failed: %s",
+              GERROR_MSG(err));
+  } else if (!parse_thermal_area_status(response, &areas, &lerr)) {
+    g_list_free_full(areas, g_free);
+    areas = NULL;
+  }
+
+  req->callback(areas, lerr, req->user_data);
+
+  g_clear_error(&lerr);
+  g_free(req);
+}
+
 gboolean
-vapix_get_supported_versions(gchar *credentials, CURL *curl_h, GError **err)
+vapix_get_supported_versions(vapix_session_t *vapix_h, GError **err)
 {
   gchar *response;
   json_t *json_response;
@@ -71,12 +193,10 @@ vapix_get_supported_versions(gchar *credentials, CURL *curl_h, GError **err)
   json_t *version;
   gsize index;
 
-  g_return_val_if_fail(curl_h != NULL, FALSE);
-  g_return_val_if_fail(credentials != NULL, FALSE);
+  g_return_val_if_fail(vapix_h != NULL, FALSE);
   g_return_val_if_fail(err == NULL || *err == NULL, FALSE);
 
-  response = vapix_request(curl_h,
-                           credentials,
+  response = vapix_request(vapix_h,
                            THERMOMETRY_CGI_ENDPOINT,
                            HTTP_POST,
                            JSON_data,
@@ -171,10 +291,7 @@ out:
 }
 
 gboolean
-vapix_get_thermal_areas(gchar *credentials,
-                        CURL *curl_h,
-                        GList **areas,
-                        GError **err)
+vapix_get_thermal_areas(vapix_session_t *vapix_h, GList **areas, GError **err)
 {
   json_t *area;
   json_t *area_list;
@@ -187,14 +304,12 @@ vapix_get_thermal_areas(gchar *credentials,
   const gchar *area_fmt = "{s:i, s:b, s:s, s:s, s:s, s:i, s:i}";
   const gchar *fmt_string = "{s:{s:o}}";
 
-  g_return_val_if_fail(curl_h != NULL, FALSE);
-  g_return_val_if_fail(credentials != NULL, FALSE);
+  g_return_val_if_fail(vapix_h != NULL, FALSE);
   g_return_val_if_fail(areas != NULL, FALSE);
   g_return_val_if_fail(*areas == NULL, FALSE);
   g_return_val_if_fail(err == NULL || *err == NULL, FALSE);
 
-  response = vapix_request(curl_h,
-                           credentials,
+  response = vapix_request(vapix_h,
                            THERMOMETRY_CGI_ENDPOINT,
                            HTTP_POST,
                            JSON_data,
@@ -286,109 +401,39 @@ out:
 }
 
 gboolean
-vapix_get_thermal_area_status(gchar *credentials,
-                              CURL *curl_h,
-                              GList **areas,
-                              GError **err)
+vapix_get_thermal_area_status_async(vapix_session_t *vapix_h,
+                                    thermal_status_cb_t callback,
+                                    gpointer user_data,
+                                    GError **err)
 {
-  json_t *area;
-  json_t *area_list;
-  gsize index;
-  json_error_t json_error;
-  json_t *json_response;
-  gchar *response;
-  gboolean ret = TRUE;
+  area_status_req_t *req;
 
-  const gchar *area_fmt = "{s:i, s:f, s:f, s:f, s:b}";
-  const gchar *fmt_string = "{s:{s:o}}";
-
-  g_return_val_if_fail(curl_h != NULL, FALSE);
-  g_return_val_if_fail(credentials != NULL, FALSE);
-  g_return_val_if_fail(areas != NULL, FALSE);
-  g_return_val_if_fail(*areas == NULL, FALSE);
+  g_return_val_if_fail(vapix_h != NULL, FALSE);
+  g_return_val_if_fail(callback != NULL, FALSE);
   g_return_val_if_fail(err == NULL || *err == NULL, FALSE);
 
-  response = vapix_request(curl_h,
-                           credentials,
+  req = g_new0(area_status_req_t, 1);
+  req->callback = callback;
+  req->user_data = user_data;
+
+  if (!vapix_request_async(vapix_h,
                            THERMOMETRY_CGI_ENDPOINT,
                            HTTP_POST,
                            JSON_data,
                            GET_AREA_STATUS_REQUEST,
-                           err);
-
-  if (response == NULL) {
+                           area_status_done_cb,
+                           req,
+                           err)) {
     g_prefix_error(err, "vapix call: 'getAreaStatus' failed: ");
-    ret = FALSE;
-    goto err_out;
-  }
-
-  json_response = json_loads(response, 0, &json_error);
-
-  if (json_response == NULL) {
-    SET_ERROR(err,
-              -1,
-              "Invalid json response: %d/%d/%d - %s",
-              json_error.line,
-              json_error.column,
-              json_error.position,
-              json_error.text);
-    ret = FALSE;
-    goto err_out;
-  }
-
-  /* clang-format off */
-  if (json_unpack_ex(json_response,
-                     &json_error,
-                     0,
-                     fmt_string,
-                     "data",
-                     "arealist", &area_list) != 0) {
-    SET_ERROR(err, -1, "json_unpack_ex() failed: %d/%d/%d - %s",
-              json_error.line,
-              json_error.column,
-              json_error.position,
-              json_error.text);
-    ret = FALSE;
-    goto err_out;
-  }
-  /* clang-format on */
-
-  json_array_foreach(area_list, index, area)
-  {
-    thermal_area_values_t *values = g_new(thermal_area_values_t, 1);
-
-    /* clang-format off */
-    if (json_unpack_ex(area,
-                       &json_error,
-                       0,
-                       area_fmt,
-                       "id", &values->id,
-                       "avg", &values->avg,
-                       "min", &values->min,
-                       "max", &values->max,
-                       "triggered", &values->triggered) != 0) {
-      SET_ERROR(err, -1, "json_unpack_ex() failed: %d/%d/%d - %s",
-              json_error.line,
-              json_error.column,
-              json_error.position,
-              json_error.text);
-      ret = FALSE;
-      goto err_out;
-    }
-    /* clang-format on */
-    *areas = g_list_prepend(*areas, values);
+    g_free(req);
+    return FALSE;
   }
 
-err_out:
-  g_clear_pointer(&json_response, json_decref);
-  g_clear_pointer(&response, g_free);
-
-  return ret;
+  return TRUE;
 }
 
 gboolean
-vapix_set_temperature_scale(gchar *credentials,
-                            CURL *curl_h,
+vapix_set_temperature_scale(vapix_session_t *vapix_h,
                             gchar *scale,
                             GError **err)
 {
@@ -396,15 +441,13 @@ vapix_set_temperature_scale(gchar *credentials,
   gchar *response;
   gboolean retval = TRUE;
 
-  g_return_val_if_fail(credentials != NULL, FALSE);
-  g_return_val_if_fail(curl_h != NULL, FALSE);
+  g_return_val_if_fail(vapix_h != NULL, FALSE);
   g_return_val_if_fail(scale != NULL, FALSE);
   g_return_val_if_fail(err == NULL || *err == NULL, FALSE);
 
   request = g_strdup_printf(SET_SCALE_REQUEST, scale);
 
-  response = vapix_request(curl_h,
-                           credentials,
+  response = vapix_request(vapix_h,
                            THERMOMETRY_CGI_ENDPOINT,
                            HTTP_POST,
                            JSON_data,
@@ -26,9 +26,10 @@
 #ifndef __THERMAL_VAPIX_H__
 #define __THERMAL_VAPIX_H__
 
-#include <curl/curl.h>
 #include <glib.h>
 
+#include "vapix_utils.h"
+
 typedef struct thermal_area {
   gchar *detectionType;
   gboolean enabled;
@@ -47,24 +48,28 @@ typedef struct thermal_area_values {
   gboolean triggered;
 } thermal_area_values_t;
 
+typedef void (*thermal_status_cb_t)(GList *areas,
+                                    const GError *err,
+                                    gpointer user_data);
+
 gboolean
-vapix_get_supported_versions(gchar *credentials, CURL *curl_h, GError **err);
+vapix_get_supported_versions(vapix_session_t *vapix_h, GError **err);
 
 gboolean
-vapix_get_thermal_areas(gchar *credentials,
-                        CURL *curl_h,
-                        GList **areas,
-                        GError **err);
+vapix_get_thermal_areas(vapix_session_t *vapix_h, GList **areas, GError **err);
 
+/* Requests the current status of all the thermal areas without blocking.
+ * 'callback' is called from the main loop with a list of thermal_area_values_t
+ * (ownership is transferred to the callback) or with 'err' set if the request
+ * failed. */
 gboolean
-vapix_get_thermal_area_status(gchar *credentials,
-                              CURL *curl_h,
-                              GList **areas,
-                              GError **err);
+vapix_get_thermal_area_status_async(vapix_session_t *vapix_h,
+                                    thermal_status_cb_t callback,
+                                    gpointer user_data,
+                                    GError **err);
 
 gboolean
-vapix_set_temperature_scale(gchar *credentials,
-                            CURL *curl_h,
+vapix_set_temperature_scale(vapix_session_t *vapix_h,
                             gchar *scale,
                             GError **err);
 
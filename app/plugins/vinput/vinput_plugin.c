@@ -24,13 +24,17 @@
  */
 
 #include <axsdk/axevent.h>
-#include <curl/curl.h>
 #include <gio/gio.h>
 #include <glib.h>
 #include <open62541/server.h>
 
 #include "error.h"
 #include "log.h"
+#include "plugin.h"
+#include "ua_cache.h"
+#include "ua_metrics.h"
+#include "ua_pubsub.h"
+#include "ua_trace.h"
 #include "ua_utils.h"
 #include "vapix_utils.h"
 #include "vinput_plugin.h"
@@ -41,13 +45,33 @@
 #define UA_VINP_OBJ_DISPLAY_NAME "VirtualInputs"
 #define UA_VINP_OBJ_DESCRIPTION  "VirtualInputs"
 
+/* name and entry of the on-disk copy of the schema version */
+#define VIN_CACHE_NAME           "vinput"
+#define VIN_CACHE_SCHEMA_VERSION "SchemaVersion"
+
 #define UA_VINPUTID_VIRTUALINPUTS_STARTID 6100
 #define VIN_BROWSE_NAME                   "VirtualInput-"
 #define VIN_BROWSE_NAME_FMT               VIN_BROWSE_NAME "%d"
+/* the states of all the ports, following the port nodes */
+#define UA_VINPUTID_STATES \
+  (UA_VINPUTID_VIRTUALINPUTS_STARTID + VINPUT_MAX_PORTS + 1)
+#define UA_VINPUTID_STATES_MASK \
+  (UA_VINPUTID_VIRTUALINPUTS_STARTID + VINPUT_MAX_PORTS + 2)
+#define VIN_STATES_BROWSE_NAME      "States"
+#define VIN_STATES_MASK_BROWSE_NAME "StatesMask"
+/* names of the aggregates in the published DataSet */
+#define VIN_STATES_ALIAS \
+  UA_VINP_OBJ_DISPLAY_NAME "." VIN_STATES_BROWSE_NAME
+#define VIN_STATES_MASK_ALIAS \
+  UA_VINP_OBJ_DISPLAY_NAME "." VIN_STATES_MASK_BROWSE_NAME
 
 /* the max possible as of today, the actual nr. could be less on older f/w */
 #define VINPUT_MAX_PORTS 64
 
+/* requests of a SetMultiple call performed at the same time, more would only
+ * wait for a connection of the VAPIX service */
+#define VIN_SET_MULTIPLE_CONCURRENCY 4
+
 #define ERR_NOT_INITIALIZED "The " UA_PLUGIN_NAME " is not initialized"
 #define ERR_NO_NAME         "The " UA_PLUGIN_NAME " was not given a name"
 
@@ -65,16 +89,40 @@ typedef struct plugin {
 
   AXEventHandler *event_handler;
   guint event_subscription;
+  /* accessed with g_atomic_int_get()/g_atomic_int_set(), the methods may be
+   * called from the method worker threads */
   gboolean *vin_states;
+  /* accessed with g_atomic_pointer_get(), see vin_schema_version(). It is
+   * replaced at most once, by the revalidation of a cached schema version,
+   * the replaced string is kept in 'stale_schema_version' since a method
+   * worker may still be using it */
   gchar *schema_version;
-  gchar *vapix_credentials;
-  CURL *curl_h;
+  gchar *stale_schema_version;
+  /* the schema version was loaded from the cache and is revalidated over
+   * VAPIX once the plugin is created */
+  gboolean cached;
+  /* serve the Activate/Deactivate methods from the method workers */
+  gboolean async_methods;
+  /* VAPIX account of the plugin, served by the shared connection pool */
+  vapix_session_t *vapix_h;
+  /* timings of the data sources */
+  ua_metric_t *reads;
+  ua_metric_t *writes;
 } plugin_t;
 
 static plugin_t *plugin;
 
 /* Local functions */
 
+/* the schema version of the Virtual Input VAPIX, see plugin_t */
+static const gchar *
+vin_schema_version(void)
+{
+  g_assert(plugin != NULL);
+
+  return g_atomic_pointer_get(&plugin->schema_version);
+}
+
 /* Performs a rollback on the nodes added to the information model by deleting
  * them from the server. This must always be called before the server thread
  * is started. */
@@ -121,9 +169,8 @@ vin_ua_activate_cb(G_GNUC_UNUSED UA_Server *server,
     return UA_STATUSCODE_BADOUTOFRANGE;
   }
 
-  ua_status = vin_set_port_state(plugin->curl_h,
-                                 plugin->vapix_credentials,
-                                 plugin->schema_version,
+  ua_status = vin_set_port_state(plugin->vapix_h,
+                                 vin_schema_version(),
                                  port_nr,
                                  TRUE,
                                  duration,
@@ -175,9 +222,8 @@ vin_ua_deactivate_cb(G_GNUC_UNUSED UA_Server *server,
     return UA_STATUSCODE_BADOUTOFRANGE;
   }
 
-  ua_status = vin_set_port_state(plugin->curl_h,
-                                 plugin->vapix_credentials,
-                                 plugin->schema_version,
+  ua_status = vin_set_port_state(plugin->vapix_h,
+                                 vin_schema_version(),
                                  port_nr,
                                  FALSE,
                                  0,
@@ -200,6 +246,119 @@ vin_ua_deactivate_cb(G_GNUC_UNUSED UA_Server *server,
   return ua_status;
 }
 
+/* applies the state changes of several ports at once, the input arguments are
+ * arrays of the same length holding the port numbers, the states and the
+ * durations */
+static UA_StatusCode
+vin_ua_set_multiple_cb(G_GNUC_UNUSED UA_Server *server,
+                       G_GNUC_UNUSED const UA_NodeId *sessionId,
+                       G_GNUC_UNUSED void *sessionHandle,
+                       G_GNUC_UNUSED const UA_NodeId *methodId,
+                       G_GNUC_UNUSED void *methodContext,
+                       G_GNUC_UNUSED const UA_NodeId *objectId,
+                       G_GNUC_UNUSED void *objectContext,
+                       G_GNUC_UNUSED size_t inputSize,
+                       const UA_Variant *input,
+                       G_GNUC_UNUSED size_t outputSize,
+                       UA_Variant *output)
+{
+  vin_port_change_t changes[VINPUT_MAX_PORTS];
+  UA_Boolean state_changed[VINPUT_MAX_PORTS];
+  UA_StatusCode results[VINPUT_MAX_PORTS];
+  UA_UInt32 *ports;
+  UA_Boolean *states;
+  UA_Int32 *durations;
+  guint64 seen = 0;
+  gsize nr_ports;
+  UA_StatusCode ua_status;
+
+  g_assert(plugin != NULL);
+  g_assert(input != NULL);
+  g_assert(output != NULL);
+
+  nr_ports = input[0].arrayLength;
+  if (input[1].arrayLength != nr_ports || input[2].arrayLength != nr_ports) {
+    return UA_STATUSCODE_BADINVALIDARGUMENT;
+  }
+  if (nr_ports > VINPUT_MAX_PORTS) {
+    return UA_STATUSCODE_BADTOOMANYOPERATIONS;
+  }
+
+  ports = input[0].data;
+  states = input[1].data;
+  durations = input[2].data;
+
+  LOG_D(plugin->logger, "nr_ports: %" G_GSIZE_FORMAT, nr_ports);
+
+  for (gsize i = 0; i < nr_ports; i++) {
+    if ((ports[i] < 1) || (ports[i] > VINPUT_MAX_PORTS)) {
+      return UA_STATUSCODE_BADOUTOFRANGE;
+    }
+    /* the requests are concurrent, their order on one port is undefined */
+    if (seen & (G_GUINT64_CONSTANT(1) << (ports[i] - 1))) {
+      return UA_STATUSCODE_BADINVALIDARGUMENT;
+    }
+    seen |= G_GUINT64_CONSTANT(1) << (ports[i] - 1);
+
+    changes[i].portnr = ports[i];
+    changes[i].state = states[i];
+    changes[i].duration = states[i] ? durations[i] : 0;
+  }
+
+  vin_set_port_states(plugin->vapix_h,
+                      vin_schema_version(),
+                      changes,
+                      nr_ports,
+                      VIN_SET_MULTIPLE_CONCURRENCY,
+                      plugin->vin_states);
+
+  for (gsize i = 0; i < nr_ports; i++) {
+    if (changes[i].status != UA_STATUSCODE_GOOD) {
+      LOG_E(plugin->logger,
+            "vin_set_port_state() failed for port_nr: %u: %s",
+            changes[i].portnr,
+            GERROR_MSG(changes[i].err));
+      g_clear_error(&changes[i].err);
+    }
+    state_changed[i] = changes[i].state_changed;
+    results[i] = changes[i].status;
+  }
+
+  ua_status = UA_Variant_setArrayCopy(&output[0],
+                                      state_changed,
+                                      nr_ports,
+                                      &UA_TYPES[UA_TYPES_BOOLEAN]);
+  if (ua_status != UA_STATUSCODE_GOOD) {
+    return ua_status;
+  }
+
+  return UA_Variant_setArrayCopy(&output[1],
+                                 results,
+                                 nr_ports,
+                                 &UA_TYPES[UA_TYPES_STATUSCODE]);
+}
+
+/* hands the calls of a method over to the method workers of the server, a
+ * failure only leaves them synchronous */
+static void
+vin_ua_offload_method(UA_NodeId *method)
+{
+  UA_StatusCode status;
+
+  g_assert(plugin != NULL);
+  g_assert(method != NULL);
+
+  if (plugin->async_methods) {
+    status = ua_utils_set_method_async(plugin->server, *method);
+    if (status != UA_STATUSCODE_GOOD) {
+      LOG_W(plugin->logger,
+            "ua_utils_set_method_async() failed: %s",
+            UA_StatusCode_name(status));
+    }
+  }
+  UA_NodeId_clear(method);
+}
+
 static gboolean
 vin_ua_add_methods(const UA_NodeId parent, GError **err)
 {
@@ -208,6 +367,10 @@ vin_ua_add_methods(const UA_NodeId parent, GError **err)
   /* input/output argument definitions for the UA Activate/Deactivate methods */
   UA_Argument in_args[2];
   UA_Argument out_arg;
+  /* and for the UA SetMultiple method */
+  UA_Argument multi_in_args[3];
+  UA_Argument multi_out_args[2];
+  UA_NodeId method;
 
   g_assert(plugin != NULL);
   g_assert(plugin->server != NULL);
@@ -255,7 +418,7 @@ vin_ua_add_methods(const UA_NodeId parent, GError **err)
                                       &out_arg,
                                       NULL,
                                       plugin->rbd,
-                                      NULL);
+                                      &method);
   if (status != UA_STATUSCODE_GOOD) {
     SET_ERROR(err,
               -1,
@@ -263,6 +426,7 @@ vin_ua_add_methods(const UA_NodeId parent, GError **err)
               UA_StatusCode_name(status));
     return FALSE;
   }
+  vin_ua_offload_method(&method);
 
   /* prepare a node for the Deactivate method */
   /* Note: has the same I/O arguments as the "Activate" method except it is
@@ -287,7 +451,75 @@ vin_ua_add_methods(const UA_NodeId parent, GError **err)
                                       &out_arg,
                                       NULL,
                                       plugin->rbd,
-                                      NULL);
+                                      &method);
+  if (status != UA_STATUSCODE_GOOD) {
+    SET_ERROR(err,
+              -1,
+              "UA_Server_addMethodNode_rb() failed, error code: %s",
+              UA_StatusCode_name(status));
+    return FALSE;
+  }
+  vin_ua_offload_method(&method);
+
+  /* prepare a node for the SetMultiple method, taking the arguments of the
+   * "Activate" method, plus the state, as arrays */
+  UA_Argument_init(&multi_in_args[0]);
+  multi_in_args[0].description =
+          UA_LOCALIZEDTEXT("en-US", "Virtual Input port numbers (1..64)");
+  multi_in_args[0].name = UA_STRING("Virtual Inputs");
+  multi_in_args[0].dataType = UA_TYPES[UA_TYPES_UINT32].typeId;
+  multi_in_args[0].valueRank = UA_VALUERANK_ONE_DIMENSION;
+
+  UA_Argument_init(&multi_in_args[1]);
+  multi_in_args[1].description =
+          UA_LOCALIZEDTEXT("en-US", "States to set (true to activate)");
+  multi_in_args[1].name = UA_STRING("States");
+  multi_in_args[1].dataType = UA_TYPES[UA_TYPES_BOOLEAN].typeId;
+  multi_in_args[1].valueRank = UA_VALUERANK_ONE_DIMENSION;
+
+  UA_Argument_init(&multi_in_args[2]);
+  multi_in_args[2].description = UA_LOCALIZEDTEXT(
+          "en-US",
+          "Activation durations in seconds (-1 to ignore)");
+  multi_in_args[2].name = UA_STRING("Durations");
+  multi_in_args[2].dataType = UA_TYPES[UA_TYPES_INT32].typeId;
+  multi_in_args[2].valueRank = UA_VALUERANK_ONE_DIMENSION;
+
+  UA_Argument_init(&multi_out_args[0]);
+  multi_out_args[0].description = UA_LOCALIZEDTEXT("en-US", "State Changed");
+  multi_out_args[0].name = UA_STRING("State Changed");
+  multi_out_args[0].dataType = UA_TYPES[UA_TYPES_BOOLEAN].typeId;
+  multi_out_args[0].valueRank = UA_VALUERANK_ONE_DIMENSION;
+
+  UA_Argument_init(&multi_out_args[1]);
+  multi_out_args[1].description =
+          UA_LOCALIZEDTEXT("en-US", "Outcome of each state change");
+  multi_out_args[1].name = UA_STRING("Results");
+  multi_out_args[1].dataType = UA_TYPES[UA_TYPES_STATUSCODE].typeId;
+  multi_out_args[1].valueRank = UA_VALUERANK_ONE_DIMENSION;
+
+  mattr = UA_MethodAttributes_default;
+  mattr.description =
+          UA_LOCALIZEDTEXT("en-US", "Set the state of several Virtual Inputs");
+  mattr.displayName = UA_LOCALIZEDTEXT("en-US", "SetMultiple");
+  mattr.executable = TRUE;
+  mattr.userExecutable = TRUE;
+
+  status = UA_Server_addMethodNode_rb(plugin->server,
+                                      UA_NODEID_NUMERIC(plugin->ns, 0),
+                                      parent,
+                                      UA_NODEID_NUMERIC(0,
+                                                        UA_NS0ID_HASCOMPONENT),
+                                      UA_QUALIFIEDNAME(1, "SetMultiple Method"),
+                                      mattr,
+                                      &vin_ua_set_multiple_cb,
+                                      3,
+                                      multi_in_args,
+                                      2,
+                                      multi_out_args,
+                                      NULL,
+                                      plugin->rbd,
+                                      &method);
   if (status != UA_STATUSCODE_GOOD) {
     SET_ERROR(err,
               -1,
@@ -295,6 +527,7 @@ vin_ua_add_methods(const UA_NodeId parent, GError **err)
               UA_StatusCode_name(status));
     return FALSE;
   }
+  vin_ua_offload_method(&method);
 
   return TRUE;
 }
@@ -328,9 +561,9 @@ vin_ua_read_cb(UA_Server *server,
   LOG_D(plugin->logger,
         "cached VirtualInput-%d state: %d",
         portnr + 1,
-        plugin->vin_states[portnr]);
+        g_atomic_int_get(&plugin->vin_states[portnr]));
 
-  if (plugin->vin_states[portnr]) {
+  if (g_atomic_int_get(&plugin->vin_states[portnr])) {
     ua_vin_state = TRUE;
   } else {
     ua_vin_state = FALSE;
@@ -353,6 +586,69 @@ err_out:
   return ua_status;
 }
 
+/* serves 'States', the cached states of all the ports as a Boolean array
+ * indexed by port number - 1 */
+static UA_StatusCode
+vin_ua_read_states_cb(G_GNUC_UNUSED UA_Server *server,
+                      G_GNUC_UNUSED const UA_NodeId *sessionId,
+                      G_GNUC_UNUSED void *sessionContext,
+                      G_GNUC_UNUSED const UA_NodeId *nodeId,
+                      G_GNUC_UNUSED void *nodeContext,
+                      G_GNUC_UNUSED UA_Boolean includeSourceTimeStamp,
+                      G_GNUC_UNUSED const UA_NumericRange *range,
+                      UA_DataValue *dataValue)
+{
+  UA_Boolean states[VINPUT_MAX_PORTS];
+  UA_StatusCode ua_status;
+
+  g_assert(plugin != NULL);
+  g_assert(dataValue != NULL);
+
+  for (guint i = 0; i < VINPUT_MAX_PORTS; i++) {
+    states[i] = g_atomic_int_get(&plugin->vin_states[i]) ? TRUE : FALSE;
+  }
+
+  ua_status = UA_Variant_setArrayCopy(&dataValue->value,
+                                      states,
+                                      VINPUT_MAX_PORTS,
+                                      &UA_TYPES[UA_TYPES_BOOLEAN]);
+  dataValue->hasValue = (ua_status == UA_STATUSCODE_GOOD);
+
+  return ua_status;
+}
+
+/* serves 'StatesMask', the cached states of all the ports as a bitmask where
+ * bit 0 is port 1 */
+static UA_StatusCode
+vin_ua_read_states_mask_cb(G_GNUC_UNUSED UA_Server *server,
+                           G_GNUC_UNUSED const UA_NodeId *sessionId,
+                           G_GNUC_UNUSED void *sessionContext,
+                           G_GNUC_UNUSED const UA_NodeId *nodeId,
+                           G_GNUC_UNUSED void *nodeContext,
+                           G_GNUC_UNUSED UA_Boolean includeSourceTimeStamp,
+                           G_GNUC_UNUSED const UA_NumericRange *range,
+                           UA_DataValue *dataValue)
+{
+  UA_UInt64 mask = 0;
+  UA_StatusCode ua_status;
+
+  g_assert(plugin != NULL);
+  g_assert(dataValue != NULL);
+
+  for (guint i = 0; i < VINPUT_MAX_PORTS; i++) {
+    if (g_atomic_int_get(&plugin->vin_states[i])) {
+      mask |= G_GUINT64_CONSTANT(1) << i;
+    }
+  }
+
+  ua_status = UA_Variant_setScalarCopy(&dataValue->value,
+                                       &mask,
+                                       &UA_TYPES[UA_TYPES_UINT64]);
+  dataValue->hasValue = (ua_status == UA_STATUSCODE_GOOD);
+
+  return ua_status;
+}
+
 static UA_StatusCode
 vin_ua_write_cb(UA_Server *server,
                 G_GNUC_UNUSED const UA_NodeId *sessionId,
@@ -379,9 +675,9 @@ vin_ua_write_cb(UA_Server *server,
   new_state = *(UA_Boolean *) dataValue->value.data;
   LOG_D(plugin->logger, "vinput: %d OPC-UA new state: %d", portnr, new_state);
 
-  ua_status = vin_set_port_state(plugin->curl_h,
-                                 plugin->vapix_credentials,
-                                 plugin->schema_version,
+  /* the status of the write is the one of the VAPIX request */
+  ua_status = vin_set_port_state(plugin->vapix_h,
+                                 vin_schema_version(),
                                  portnr,
                                  new_state,
                                  -1,
@@ -438,66 +734,171 @@ vin_ua_add_object(UA_NodeId *outId, GError **err)
   return TRUE;
 }
 
+UA_METRICS_TIMED_READ(timed_read_cb, vin_ua_read_cb, plugin->reads)
+UA_METRICS_TIMED_WRITE(timed_write_cb, vin_ua_write_cb, plugin->writes)
+UA_METRICS_TIMED_READ(timed_read_states_cb,
+                      vin_ua_read_states_cb,
+                      plugin->reads)
+UA_METRICS_TIMED_READ(timed_read_states_mask_cb,
+                      vin_ua_read_states_mask_cb,
+                      plugin->reads)
+
+/* adds the variables of all the VirtualInput ports in one batch, either all
+ * of them or none */
 static gboolean
 vin_ua_add_instances(UA_NodeId parent, GError **err)
 {
-  UA_StatusCode retVal = UA_STATUSCODE_GOOD;
+  gboolean ret;
   /* clang-format off */
   UA_DataSource ua_vinp_cb = {
-    .read = vin_ua_read_cb,
-    .write = vin_ua_write_cb
+    .read = timed_read_cb,
+    .write = timed_write_cb
   };
   /* clang-format on */
-  UA_VariableAttributes vattr = UA_VariableAttributes_default;
-  gint i = 0;
-  gchar *port_name = NULL;
+  ua_node_desc_t *nodes;
+  gchar **port_names;
 
   g_assert(plugin != NULL);
   g_assert(plugin->server != NULL);
   g_assert(plugin->rbd != NULL);
   g_assert(err == NULL || *err == NULL);
 
-  vattr.accessLevel = UA_ACCESSLEVELMASK_READ | UA_ACCESSLEVELMASK_WRITE;
-  vattr.dataType = UA_TYPES[UA_TYPES_BOOLEAN].typeId;
+  nodes = g_new0(ua_node_desc_t, VINPUT_MAX_PORTS);
+  port_names = g_new0(gchar *, VINPUT_MAX_PORTS + 1);
+
+  for (gint i = 0; i < VINPUT_MAX_PORTS; i++) {
+    /* NOTE: the numbering of the Virtual Inputs starts from 1 */
+    port_names[i] = g_strdup_printf(VIN_BROWSE_NAME_FMT, i + 1);
+
+    nodes[i].node_class = UA_NODECLASS_VARIABLE;
+    nodes[i].requested_id =
+            UA_NODEID_NUMERIC(plugin->ns,
+                              UA_VINPUTID_VIRTUALINPUTS_STARTID + i + 1);
+    nodes[i].parent = parent;
+    nodes[i].reference_type = UA_NODEID_NUMERIC(0, UA_NS0ID_HASCOMPONENT);
+    nodes[i].browse_name = UA_QUALIFIEDNAME(plugin->ns, port_names[i]);
+    nodes[i].type_definition =
+            UA_NODEID_NUMERIC(0, UA_NS0ID_BASEDATAVARIABLETYPE);
+    nodes[i].attr.variable = UA_VariableAttributes_default;
+    nodes[i].attr.variable.accessLevel =
+            UA_ACCESSLEVELMASK_READ | UA_ACCESSLEVELMASK_WRITE;
+    nodes[i].attr.variable.dataType = UA_TYPES[UA_TYPES_BOOLEAN].typeId;
+    nodes[i].attr.variable.displayName =
+            UA_LOCALIZEDTEXT("", port_names[i]);
+    nodes[i].data_source = &ua_vinp_cb;
+  }
+
+  LOG_D(plugin->logger, "Adding %d virtual inputs", VINPUT_MAX_PORTS);
+
+  ret = ua_utils_add_nodes(plugin->server,
+                           nodes,
+                           VINPUT_MAX_PORTS,
+                           plugin->rbd,
+                           err);
+  if (!ret) {
+    g_prefix_error(err,
+                   "Unable to add 'VirtualInput' ports to 'VirtualInputs' "
+                   "object: ");
+  }
+
+  g_strfreev(port_names);
+  g_free(nodes);
+
+  return ret;
+}
+
+/* adds the read-only variables holding the states of all the ports, one
+ * monitored item on them covers all the ports */
+static gboolean
+vin_ua_add_aggregates(UA_NodeId parent, GError **err)
+{
+  /* clang-format off */
+  const struct {
+    UA_UInt32 id;
+    const gchar *name;
+    const gchar *description;
+    UA_UInt32 type;
+    UA_Int32 value_rank;
+    UA_DataSource source;
+  } aggregates[] = {
+    { UA_VINPUTID_STATES, VIN_STATES_BROWSE_NAME,
+      "States of all the Virtual Inputs by 0-based index, element 0 is "
+      "port number 1", UA_TYPES_BOOLEAN,
+      UA_VALUERANK_ONE_DIMENSION, { .read = timed_read_states_cb } },
+    { UA_VINPUTID_STATES_MASK, VIN_STATES_MASK_BROWSE_NAME,
+      "States of all the Virtual Inputs as a bitmask, bit 0 is port "
+      "number 1", UA_TYPES_UINT64,
+      UA_VALUERANK_SCALAR, { .read = timed_read_states_mask_cb } },
+  };
+  /* clang-format on */
+  UA_VariableAttributes vattr;
+  UA_StatusCode status;
 
-  for (i = 1; i <= VINPUT_MAX_PORTS; i++) {
-    port_name = g_strdup_printf(VIN_BROWSE_NAME_FMT, i);
+  g_assert(plugin != NULL);
+  g_assert(plugin->server != NULL);
+  g_assert(plugin->rbd != NULL);
+  g_assert(err == NULL || *err == NULL);
 
-    LOG_D(plugin->logger, "Adding virtual input: %s", port_name);
+  for (guint i = 0; i < G_N_ELEMENTS(aggregates); i++) {
+    vattr = UA_VariableAttributes_default;
+    vattr.accessLevel = UA_ACCESSLEVELMASK_READ;
+    vattr.dataType = UA_TYPES[aggregates[i].type].typeId;
+    vattr.valueRank = aggregates[i].value_rank;
+    vattr.displayName = UA_LOCALIZEDTEXT("", (gchar *) aggregates[i].name);
+    vattr.description =
+            UA_LOCALIZEDTEXT("", (gchar *) aggregates[i].description);
 
-    /* add variable nodes for all existing VirtualInput ports */
-    vattr.displayName = UA_LOCALIZEDTEXT("", port_name);
-    retVal |= UA_Server_addVariableNode_rb(
+    status = UA_Server_addVariableNode_rb(
             plugin->server,
-            UA_NODEID_NUMERIC(plugin->ns,
-                              UA_VINPUTID_VIRTUALINPUTS_STARTID + i),
+            UA_NODEID_NUMERIC(plugin->ns, aggregates[i].id),
             parent,
             UA_NODEID_NUMERIC(0, UA_NS0ID_HASCOMPONENT),
-            UA_QUALIFIEDNAME(plugin->ns, port_name),
+            UA_QUALIFIEDNAME(plugin->ns, (gchar *) aggregates[i].name),
             UA_NODEID_NUMERIC(0, UA_NS0ID_BASEDATAVARIABLETYPE),
             vattr,
             NULL,
             plugin->rbd,
             NULL);
+    if (status == UA_STATUSCODE_GOOD) {
+      status = UA_Server_setVariableNode_dataSource(
+              plugin->server,
+              UA_NODEID_NUMERIC(plugin->ns, aggregates[i].id),
+              aggregates[i].source);
+    }
+    if (status != UA_STATUSCODE_GOOD) {
+      SET_ERROR(err,
+                -1,
+                "Failed to add variable node %s: %s",
+                aggregates[i].name,
+                UA_StatusCode_name(status));
+      return FALSE;
+    }
+  }
 
-    retVal |= UA_Server_setVariableNode_dataSource(
-            plugin->server,
-            UA_NODEID_NUMERIC(plugin->ns,
-                              UA_VINPUTID_VIRTUALINPUTS_STARTID + i),
-            ua_vinp_cb);
+  return TRUE;
+}
 
-    g_clear_pointer(&port_name, g_free);
-  }
+/* adds the aggregates to the DataSet published with PubSub, if any */
+static gboolean
+vin_ua_publish_aggregates(GError **err)
+{
+  UA_NodeId states;
+  UA_NodeId mask;
 
-  if (retVal != UA_STATUSCODE_GOOD) {
-    SET_ERROR(err,
-              -1,
-              "Unable to add 'VirtualInput' ports to 'VirtualInputs' object!");
-    goto bail_out;
+  g_assert(plugin != NULL);
+  g_assert(plugin->server != NULL);
+  g_assert(err == NULL || *err == NULL);
+
+  states = UA_NODEID_NUMERIC(plugin->ns, UA_VINPUTID_STATES);
+  mask = UA_NODEID_NUMERIC(plugin->ns, UA_VINPUTID_STATES_MASK);
+
+  if (!ua_pubsub_publish(plugin->server, &states, VIN_STATES_ALIAS, err) ||
+      !ua_pubsub_publish(plugin->server, &mask, VIN_STATES_MASK_ALIAS, err)) {
+    g_prefix_error(err, "ua_pubsub_publish() failed: ");
+    return FALSE;
   }
 
-bail_out:
-  return (retVal == UA_STATUSCODE_GOOD);
+  return TRUE;
 }
 
 static void
@@ -514,6 +915,8 @@ vin_event_cb(G_GNUC_UNUSED guint subscription,
   g_assert(plugin->vin_states != NULL);
   g_assert(event != NULL);
 
+  UA_TRACE_ENTRY(axevent, G_STRFUNC);
+
   /* Extract the AXEventKeyValueSet from the event. */
   key_value_set = ax_event_get_key_value_set(event);
 
@@ -546,7 +949,7 @@ vin_event_cb(G_GNUC_UNUSED guint subscription,
   }
 
   /* !NOTE!: the D-Bus numbering of the Virtual Inputs starts from 1 not 0! */
-  plugin->vin_states[port - 1] = active;
+  g_atomic_int_set(&plugin->vin_states[port - 1], active);
 
   LOG_D(plugin->logger, "VirtualInput-%d: %d", port, active);
 
@@ -554,6 +957,7 @@ err_out:
   g_clear_error(&lerr);
   /* the callback must always free 'event', NULL-case handled by the API */
   ax_event_free(event);
+  UA_TRACE_EXIT(axevent, G_STRFUNC, 0);
 
   return;
 }
@@ -624,9 +1028,7 @@ plugin_cleanup(void)
 
   g_assert(plugin != NULL);
 
-  if (plugin->curl_h != NULL) {
-    curl_easy_cleanup(plugin->curl_h);
-  }
+  g_clear_pointer(&plugin->vapix_h, vapix_session_free);
 
   if (plugin->event_handler != NULL) {
     if (plugin->event_subscription > 0) {
@@ -647,8 +1049,8 @@ plugin_cleanup(void)
 
   g_clear_pointer(&plugin->name, g_free);
   g_clear_pointer(&plugin->vin_states, g_free);
-  g_clear_pointer(&plugin->vapix_credentials, g_free);
   g_clear_pointer(&plugin->schema_version, g_free);
+  g_clear_pointer(&plugin->stale_schema_version, g_free);
 
   /* free up allocated rollback data, if any */
   ua_utils_clear_rbd(&plugin->rbd);
@@ -658,41 +1060,177 @@ plugin_cleanup(void)
   return;
 }
 
+/* stores the schema version for the next start of the plugin */
+static void
+vin_cache_schema_version(const gchar *schema_version)
+{
+  GHashTable *cache;
+  GError *lerr = NULL;
+
+  g_assert(plugin != NULL);
+  g_assert(schema_version != NULL);
+
+  cache = g_hash_table_new(g_str_hash, g_str_equal);
+  g_hash_table_insert(cache,
+                      (gpointer) VIN_CACHE_SCHEMA_VERSION,
+                      (gpointer) schema_version);
+  if (!ua_cache_store(VIN_CACHE_NAME, cache, &lerr)) {
+    LOG_W(plugin->logger, "ua_cache_store() failed: %s", GERROR_MSG(lerr));
+    g_clear_error(&lerr);
+  }
+  g_hash_table_unref(cache);
+}
+
+/* called from the main loop with the current schema version */
+static void
+vin_revalidate_done_cb(const gchar *schema_version,
+                       const GError *err,
+                       G_GNUC_UNUSED gpointer user_data)
+{
+  g_assert(plugin != NULL);
+
+  if (schema_version == NULL) {
+    LOG_W(plugin->logger,
+          "Failed to revalidate the VAPIX schema version: %s",
+          GERROR_MSG(err));
+    return;
+  }
+
+  if (g_strcmp0(schema_version, vin_schema_version()) == 0) {
+    return;
+  }
+
+  LOG_I(plugin->logger,
+        "VAPIX schema version changed: %s -> %s",
+        vin_schema_version(),
+        schema_version);
+
+  /* the main loop is the only writer */
+  g_free(plugin->stale_schema_version);
+  plugin->stale_schema_version = plugin->schema_version;
+  g_atomic_pointer_set(&plugin->schema_version, g_strdup(schema_version));
+  vin_cache_schema_version(schema_version);
+}
+
+/* allocates the plugin and loads the virtual input API schema version from
+ * the cache or else fetches it over VAPIX, blocking but without accessing the
+ * server */
+static gboolean
+plugin_prefetch(UA_Logger *logger,
+                ua_plugin_params_t *services,
+                GError **err)
+{
+  GHashTable *cache;
+  GError *lerr = NULL;
+
+  g_assert(plugin == NULL);
+  g_assert(logger != NULL);
+  g_assert(services != NULL);
+  g_assert(err == NULL || *err == NULL);
+
+  plugin = g_new0(plugin_t, 1);
+
+  plugin->name = g_strdup(UA_PLUGIN_NAME);
+  plugin->logger = logger;
+  plugin->rbd = g_new0(rollback_data_t, 1);
+  plugin->async_methods = (services->method_workers > 0);
+  plugin->reads = ua_metrics_get(UA_METRIC_TIMING, "vinput.reads");
+  plugin->writes = ua_metrics_get(UA_METRIC_TIMING, "vinput.writes");
+
+  /* allocate an array of booleans to keep track of the vinput states */
+  plugin->vin_states = g_new0(gboolean, VINPUT_MAX_PORTS);
+
+  /* the credentials of the VAPIX account are managed by the service */
+  plugin->vapix_h =
+          vapix_session_new(services->vapix, "vapix-virtualinput-user", err);
+  if (plugin->vapix_h == NULL) {
+    g_prefix_error(err, "vapix_session_new() failed: ");
+    goto err_out;
+  }
+
+  /* the schema version only changes with the firmware, a cached copy is used
+   * right away and revalidated once the plugin is created */
+  cache = ua_cache_load(VIN_CACHE_NAME, &lerr);
+  if (cache != NULL) {
+    plugin->schema_version =
+            g_strdup(g_hash_table_lookup(cache, VIN_CACHE_SCHEMA_VERSION));
+    g_hash_table_unref(cache);
+  } else {
+    LOG_D(plugin->logger, "ua_cache_load() failed: %s", GERROR_MSG(lerr));
+    g_clear_error(&lerr);
+  }
+
+  if (plugin->schema_version != NULL) {
+    plugin->cached = TRUE;
+  } else {
+    plugin->schema_version = vin_get_schema_version(plugin->vapix_h, err);
+    if (plugin->schema_version == NULL) {
+      g_prefix_error(err, "Failed to get VAPIX schema version: ");
+      goto err_out;
+    }
+    vin_cache_schema_version(plugin->schema_version);
+  }
+  LOG_D(plugin->logger, "plugin->schema_version: %s", plugin->schema_version);
+
+  return TRUE;
+
+err_out:
+  plugin_cleanup();
+
+  return FALSE;
+}
+
 /* Exported functions */
+gboolean
+opc_ua_prepare(UA_Logger *logger, gpointer *params, GError **err)
+{
+  ua_plugin_params_t *services = (ua_plugin_params_t *) params;
+
+  g_return_val_if_fail(logger != NULL, FALSE);
+  g_return_val_if_fail(services != NULL, FALSE);
+  g_return_val_if_fail(services->vapix != NULL, FALSE);
+  g_return_val_if_fail(err == NULL || *err == NULL, FALSE);
+
+  if (plugin != NULL) {
+    return TRUE;
+  }
+
+  if (!plugin_prefetch(logger, services, err)) {
+    g_prefix_error(err, "plugin_prefetch() failed: ");
+    return FALSE;
+  }
+
+  return TRUE;
+}
+
 gboolean
 opc_ua_create(UA_Server *server,
               UA_Logger *logger,
-              G_GNUC_UNUSED gpointer *params,
+              gpointer *params,
               GError **err)
 {
+  ua_plugin_params_t *services = (ua_plugin_params_t *) params;
   UA_NodeId vinp_obj_node;
   GError *lerr = NULL;
 
   g_return_val_if_fail(server != NULL, FALSE);
   g_return_val_if_fail(logger != NULL, FALSE);
+  g_return_val_if_fail(services != NULL, FALSE);
+  g_return_val_if_fail(services->vapix != NULL, FALSE);
   g_return_val_if_fail(err == NULL || *err == NULL, FALSE);
 
-  if (plugin != NULL) {
+  if (plugin != NULL && plugin->server != NULL) {
     return TRUE;
   }
 
-  plugin = g_new0(plugin_t, 1);
+  /* unless already done by opc_ua_prepare() */
+  if (plugin == NULL && !plugin_prefetch(logger, services, err)) {
+    g_prefix_error(err, "plugin_prefetch() failed: ");
+    return FALSE;
+  }
 
-  plugin->name = g_strdup(UA_PLUGIN_NAME);
-  plugin->logger = logger;
   plugin->server = server;
   plugin->ns = UA_Server_addNamespace(server, UA_PLUGIN_NAMESPACE);
-  plugin->rbd = g_new0(rollback_data_t, 1);
-
-  /* allocate an array of booleans to keep track of the vinput states */
-  plugin->vin_states = g_new0(gboolean, VINPUT_MAX_PORTS);
-
-  /* allocate a curl handle that we are going to use throughout our requests */
-  plugin->curl_h = curl_easy_init();
-  if (plugin->curl_h == NULL) {
-    SET_ERROR(err, -1, "curl_easy_init() failed");
-    goto err_out;
-  }
 
   /* subscribe to "VirtualInput" events */
   plugin->event_handler = ax_event_handler_new();
@@ -706,23 +1244,6 @@ opc_ua_create(UA_Server *server,
     goto err_out;
   }
 
-  /* obtain credentials to make VAPIX calls */
-  plugin->vapix_credentials =
-          vapix_get_credentials("vapix-virtualinput-user", err);
-  if (plugin->vapix_credentials == NULL) {
-    g_prefix_error(err, "Failed to get the VAPIX credentials: ");
-    goto err_out;
-  }
-
-  plugin->schema_version = vin_get_schema_version(plugin->curl_h,
-                                                  plugin->vapix_credentials,
-                                                  err);
-  if (plugin->schema_version == NULL) {
-    g_prefix_error(err, "Failed to get VAPIX schema version: ");
-    goto err_out;
-  }
-  LOG_D(plugin->logger, "plugin->schema_version: %s", plugin->schema_version);
-
   /* add the VirtualInputs object to the opc-ua server */
   if (!vin_ua_add_object(&vinp_obj_node, err)) {
     g_prefix_error(err, "vin_ua_add_object() failed: ");
@@ -735,15 +1256,39 @@ opc_ua_create(UA_Server *server,
     goto err_out;
   }
 
-  /* add methods (Activate/Deactivate) to the object node */
+  /* and the variables aggregating them */
+  if (!vin_ua_add_aggregates(vinp_obj_node, err)) {
+    g_prefix_error(err, "vin_ua_add_aggregates() failed: ");
+    goto err_out;
+  }
+
+  /* add methods (Activate/Deactivate/SetMultiple) to the object node */
   if (!vin_ua_add_methods(vinp_obj_node, err)) {
     g_prefix_error(err, "vin_ua_add_methods() failed: ");
     goto err_out;
   }
 
-  /* the information model was successfully populated so now we can free up our
-   * rollback data since we no longer need it */
-  ua_utils_clear_rbd(&plugin->rbd);
+  /* the clients of the server don't depend on the publishing */
+  if (!vin_ua_publish_aggregates(&lerr)) {
+    LOG_W(plugin->logger,
+          "vin_ua_publish_aggregates() failed: %s",
+          GERROR_MSG(lerr));
+    g_clear_error(&lerr);
+  }
+
+  /* refresh a cached schema version without delaying the start up */
+  if (plugin->cached &&
+      !vin_get_schema_version_async(plugin->vapix_h,
+                                    vin_revalidate_done_cb,
+                                    NULL,
+                                    &lerr)) {
+    LOG_W(plugin->logger,
+          "vin_get_schema_version_async() failed: %s",
+          GERROR_MSG(lerr));
+    g_clear_error(&lerr);
+  }
+
+  /* the rollback data is kept, opc_ua_remove() deletes the nodes it lists */
 
   return TRUE;
 
@@ -762,6 +1307,31 @@ err_out:
   return FALSE;
 }
 
+gboolean
+opc_ua_remove(UA_Server *server, GError **err)
+{
+  g_return_val_if_fail(server != NULL, FALSE);
+  g_return_val_if_fail(err == NULL || *err == NULL, FALSE);
+
+  if (plugin == NULL || plugin->rbd == NULL) {
+    return TRUE;
+  }
+
+  /* the published fields refer to the variables of the plugin */
+  if (!ua_pubsub_unpublish(server, plugin->ns, err)) {
+    g_prefix_error(err, "ua_pubsub_unpublish() failed: ");
+    return FALSE;
+  }
+
+  if (!ua_utils_do_rollback(server, plugin->rbd, err)) {
+    g_prefix_error(err, "ua_utils_do_rollback() failed: ");
+    return FALSE;
+  }
+  ua_utils_clear_rbd(&plugin->rbd);
+
+  return TRUE;
+}
+
 void
 opc_ua_destroy(void)
 {
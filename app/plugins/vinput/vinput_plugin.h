@@ -26,12 +26,27 @@
 #ifndef __VINPUT_PLUGIN_H__
 #define __VINPUT_PLUGIN_H__
 
+/**
+ * opc_ua_prepare:
+ * @logger: an open62541 logger instance
+ * @params: a #ua_plugin_params_t holding the services provided by the server
+ *   application
+ * @err: return location for a #GError
+ *
+ * Fetches the schema version of the virtual input API over VAPIX ahead of
+ * opc_ua_create(), called from a worker thread.
+ *
+ * Returns: TRUE if successful, FALSE otherwise.
+ */
+gboolean
+opc_ua_prepare(UA_Logger *logger, gpointer *params, GError **err);
+
 /**
  * opc_ua_create:
  * @server: OPC-UA Server object
  * @logger: an open62541 logger instance
- * @params: pointer to user data (can be used to pass in additional parameters
- *   for the initialization of the plugin)
+ * @params: a #ua_plugin_params_t holding the services provided by the server
+ *   application
  * @err: return location for a #GError
  *
  * Sets up and initializes the plugin.
@@ -41,9 +56,22 @@
 gboolean
 opc_ua_create(UA_Server *server,
               UA_Logger *logger,
-              G_GNUC_UNUSED gpointer *params,
+              gpointer *params,
               GError **err);
 
+/**
+ * opc_ua_remove:
+ * @server: OPC-UA Server object
+ * @err: return location for a #GError
+ *
+ * Deletes the nodes added by the plugin while the server keeps running, ahead
+ * of opc_ua_destroy(), called with an exclusive access to the server.
+ *
+ * Returns: TRUE if the nodes were deleted, FALSE otherwise.
+ */
+gboolean
+opc_ua_remove(UA_Server *server, GError **err);
+
 /**
  * opc_ua_destroy:
  *
@@ -27,6 +27,7 @@
 #include <open62541/server.h>
 
 #include "error.h"
+#include "ua_metrics.h"
 #include "vapix_utils.h"
 #include "vinput_vapix.h"
 
@@ -53,6 +54,19 @@
 
 DEFINE_GQUARK("vinput-vapix")
 
+/* context of a pending asynchronous schema version request */
+typedef struct schema_version_req {
+  vin_schema_version_cb_t callback;
+  gpointer user_data;
+} schema_version_req_t;
+
+/* what the workers of vin_set_port_states() share */
+typedef struct port_states_req {
+  vapix_session_t *vapix_h;
+  const gchar *schema_version;
+  gboolean *vin_states;
+} port_states_req_t;
+
 static void
 vin_xml_start_element(G_GNUC_UNUSED GMarkupParseContext *context,
                       const gchar *element_name,
@@ -219,6 +233,8 @@ vin_xml_parse(const gchar *xml_txt, parser_status_t *result, GError **err)
   };
   /* clang-format on */
   gboolean res = FALSE;
+  static ua_metric_t *parse_time;
+  gint64 start = g_get_monotonic_time();
 
   g_return_val_if_fail(xml_txt != NULL, FALSE);
   g_return_val_if_fail(result != NULL, FALSE);
@@ -242,6 +258,11 @@ vin_xml_parse(const gchar *xml_txt, parser_status_t *result, GError **err)
     goto err_out;
   }
 
+  ua_metric_observe_since(ua_metrics_get_cached(&parse_time,
+                                                UA_METRIC_TIMING,
+                                                "vinput.parse"),
+                          start);
+
 err_out:
   g_markup_parse_context_free(parse_ctx);
 
@@ -258,35 +279,18 @@ vin_xml_parse_clear(parser_status_t *parser_status)
   g_clear_pointer(&parser_status->error_descr, g_free);
 }
 
-/* NOTE: "duration" (in seconds) is an optional parameter of the "activate.cgi"
- * request. OPC UA methods cannot take optional parameters. We use the
- * convention that a negative "duration" value will be ignored.
- * See:
- * https://developer.axis.com/vapix/network-video/input-and-outputs/#activate-a-virtual-input:
- * */
-UA_StatusCode
-vin_set_port_state(CURL *curl_h,
-                   const gchar *credentials,
-                   const gchar *schema_version,
+/* returns the "activate.cgi" or "deactivate.cgi" request (with parameters)
+ * that sets 'portnr' to 'state', a negative 'duration' is ignored */
+static gchar *
+vin_port_state_req(const gchar *schema_version,
                    UA_UInt32 portnr,
                    UA_Boolean state,
-                   UA_Int32 duration,
-                   gboolean *vin_states,
-                   gboolean *state_changed,
-                   GError **err)
+                   UA_Int32 duration)
 {
-  UA_StatusCode ua_status = UA_STATUSCODE_BAD;
-  gchar *vapix_req = NULL;
-  gchar *vapix_params = NULL;
-  gchar *response = NULL;
-  parser_status_t parse_res = { 0 };
+  gchar *vapix_req;
+  gchar *vapix_params;
 
-  g_return_val_if_fail(curl_h != NULL, UA_STATUSCODE_BAD);
-  g_return_val_if_fail(credentials != NULL, UA_STATUSCODE_BAD);
-  g_return_val_if_fail(schema_version != NULL, UA_STATUSCODE_BAD);
-  g_return_val_if_fail(vin_states != NULL, UA_STATUSCODE_BAD);
-  g_return_val_if_fail(state_changed != NULL, UA_STATUSCODE_BAD);
-  g_return_val_if_fail(err == NULL || *err == NULL, UA_STATUSCODE_BAD);
+  g_assert(schema_version != NULL);
 
   if (state && (duration >= 0)) {
     /* NOTE: only "activate.cgi" (i.e. "state == true") has an
@@ -312,96 +316,290 @@ vin_set_port_state(CURL *curl_h,
                                 vapix_params);
   }
 
-  response = vapix_request(curl_h,
-                           credentials,
+  g_clear_pointer(&vapix_params, g_free);
+
+  return vapix_req;
+}
+
+/* interprets the response of a 'vapix_req' activate/deactivate request */
+static gboolean
+vin_port_state_parse(const gchar *vapix_req,
+                     const gchar *response,
+                     gboolean *state_changed,
+                     GError **err)
+{
+  gboolean res = FALSE;
+  parser_status_t parse_res = { 0 };
+
+  g_assert(vapix_req != NULL);
+  g_assert(response != NULL);
+  g_assert(state_changed != NULL);
+  g_assert(err == NULL || *err == NULL);
+
+  if (vin_xml_parse(response, &parse_res, err)) {
+    if (parse_res.vapix_mask & VAPIX_ERR) {
+      /* VAPIX response: error */
+      SET_ERROR(err,
+                -1,
+                "%s: error response: %s",
+                vapix_req,
+                (parse_res.error_descr != NULL) ? parse_res.error_descr :
+                                                  "unknown error");
+    } else {
+      /* VAPIX response: success */
+      *state_changed = parse_res.state_changed;
+      res = TRUE;
+    }
+  } else {
+    g_prefix_error(err, "vin_xml_parse() failed: ");
+  } /* vin_xml_parse(): FALSE */
+
+  vin_xml_parse_clear(&parse_res);
+
+  return res;
+}
+
+/* request successfull with a state change, update our 'vin_states' cache */
+static void
+vin_update_states(gboolean *vin_states,
+                  UA_UInt32 portnr,
+                  UA_Boolean state,
+                  gboolean state_changed)
+{
+  g_assert(vin_states != NULL);
+
+  if (state_changed) {
+    /* the cache is shared with the other threads of the plugin */
+    g_atomic_int_set(&vin_states[portnr - 1], state ? TRUE : FALSE);
+  }
+}
+
+/* NOTE: "duration" (in seconds) is an optional parameter of the "activate.cgi"
+ * request. OPC UA methods cannot take optional parameters. We use the
+ * convention that a negative "duration" value will be ignored.
+ * See:
+ * https://developer.axis.com/vapix/network-video/input-and-outputs/#activate-a-virtual-input:
+ * */
+UA_StatusCode
+vin_set_port_state(vapix_session_t *vapix_h,
+                   const gchar *schema_version,
+                   UA_UInt32 portnr,
+                   UA_Boolean state,
+                   UA_Int32 duration,
+                   gboolean *vin_states,
+                   gboolean *state_changed,
+                   GError **err)
+{
+  UA_StatusCode ua_status = UA_STATUSCODE_BAD;
+  gchar *vapix_req = NULL;
+  gchar *response = NULL;
+
+  g_return_val_if_fail(vapix_h != NULL, UA_STATUSCODE_BAD);
+  g_return_val_if_fail(schema_version != NULL, UA_STATUSCODE_BAD);
+  g_return_val_if_fail(vin_states != NULL, UA_STATUSCODE_BAD);
+  g_return_val_if_fail(state_changed != NULL, UA_STATUSCODE_BAD);
+  g_return_val_if_fail(err == NULL || *err == NULL, UA_STATUSCODE_BAD);
+
+  vapix_req = vin_port_state_req(schema_version, portnr, state, duration);
+
+  response = vapix_request(vapix_h,
                            vapix_req,
                            HTTP_GET,
                            NONE_data,
                            NULL,
                            err);
   if (response != NULL) {
-    if (vin_xml_parse(response, &parse_res, err)) {
-      if (parse_res.vapix_mask & VAPIX_ERR) {
-        /* VAPIX response: error */
-        if (parse_res.error_descr) {
-          SET_ERROR(err,
-                    -1,
-                    "%s: error response: %s",
-                    vapix_req,
-                    parse_res.error_descr);
-        }
-      } else {
-        /* VAPIX response: success */
-        ua_status = UA_STATUSCODE_GOOD;
-        *state_changed = parse_res.state_changed;
-
-        if (parse_res.state_changed) {
-          /* request successfull with a state change, update our
-           * 'vin_states' cache */
-          if (state) {
-            vin_states[portnr - 1] = TRUE;
-          } else {
-            vin_states[portnr - 1] = FALSE;
-          }
-        }
-      }
-    } else {
-      g_prefix_error(err, "vin_xml_parse() failed: ");
-    } /* vin_xml_parse(): FALSE */
-
-    vin_xml_parse_clear(&parse_res);
+    if (vin_port_state_parse(vapix_req, response, state_changed, err)) {
+      ua_status = UA_STATUSCODE_GOOD;
+      vin_update_states(vin_states, portnr, state, *state_changed);
+    }
     g_clear_pointer(&response, g_free);
-
   } else {
     /* failed request, response == NULL */
     g_prefix_error(err, "vapix_request() failed: ");
   }
 
-  g_clear_pointer(&vapix_params, g_free);
   g_clear_pointer(&vapix_req, g_free);
 
   return ua_status;
 }
 
-gchar *
-vin_get_schema_version(CURL *curl_h, const gchar *credentials, GError **err)
+/* a GFunc performing one state change of vin_set_port_states() */
+static void
+vin_port_change_worker(gpointer data, gpointer user_data)
+{
+  vin_port_change_t *change = data;
+  port_states_req_t *req = user_data;
+
+  g_assert(change != NULL);
+  g_assert(req != NULL);
+
+  change->status = vin_set_port_state(req->vapix_h,
+                                      req->schema_version,
+                                      change->portnr,
+                                      change->state,
+                                      change->duration,
+                                      req->vin_states,
+                                      &change->state_changed,
+                                      &change->err);
+}
+
+void
+vin_set_port_states(vapix_session_t *vapix_h,
+                    const gchar *schema_version,
+                    vin_port_change_t *changes,
+                    guint nr_changes,
+                    guint max_concurrent,
+                    gboolean *vin_states)
+{
+  port_states_req_t req;
+  GThreadPool *pool = NULL;
+  GError *lerr = NULL;
+
+  g_return_if_fail(vapix_h != NULL);
+  g_return_if_fail(schema_version != NULL);
+  g_return_if_fail(changes != NULL || nr_changes == 0);
+  g_return_if_fail(max_concurrent > 0);
+  g_return_if_fail(vin_states != NULL);
+
+  req.vapix_h = vapix_h;
+  req.schema_version = schema_version;
+  req.vin_states = vin_states;
+
+  /* the threads of a shared pool are kept by GLib between the calls, each
+   * request takes a kept-alive connection of the VAPIX service */
+  if (nr_changes > 1 && max_concurrent > 1) {
+    pool = g_thread_pool_new(vin_port_change_worker,
+                             &req,
+                             (gint) MIN(nr_changes, max_concurrent),
+                             FALSE,
+                             &lerr);
+    /* without a pool the requests are performed one at a time */
+    g_clear_error(&lerr);
+  }
+
+  for (guint i = 0; i < nr_changes; i++) {
+    changes[i].status = UA_STATUSCODE_BAD;
+    changes[i].state_changed = FALSE;
+    changes[i].err = NULL;
+
+    if (pool == NULL || !g_thread_pool_push(pool, &changes[i], &lerr)) {
+      g_clear_error(&lerr);
+      vin_port_change_worker(&changes[i], &req);
+    }
+  }
+
+  if (pool != NULL) {
+    /* wait for all the requests to be done */
+    g_thread_pool_free(pool, FALSE, TRUE);
+  }
+}
+
+/* interprets a getschemaversions.cgi response */
+static gchar *
+vin_schema_version_parse(const gchar *response, GError **err)
 {
   parser_status_t parse_res = { 0 };
   gchar *schema_version = NULL;
+
+  g_assert(response != NULL);
+  g_assert(err == NULL || *err == NULL);
+
+  if (vin_xml_parse(response, &parse_res, err)) {
+    /* <Success> response: save the <MajorVersion> of <SchemaVersion> as we
+     * need it for subsequent activate/deactivate VAPIX calls */
+    schema_version = g_strdup(parse_res.schema_version);
+  } else {
+    /* <Error> response */
+    g_prefix_error(err, "vin_xml_parse() failed: ");
+  }
+  vin_xml_parse_clear(&parse_res);
+
+  return schema_version;
+}
+
+gchar *
+vin_get_schema_version(vapix_session_t *vapix_h, GError **err)
+{
+  gchar *schema_version = NULL;
   gchar *response = NULL;
 
-  g_return_val_if_fail(curl_h != NULL, NULL);
-  g_return_val_if_fail(credentials != NULL, NULL);
+  g_return_val_if_fail(vapix_h != NULL, NULL);
   g_return_val_if_fail(err == NULL || *err == NULL, NULL);
 
   /* fetch the schema version of the Virtual Input VAPIX */
-  response = vapix_request(curl_h,
-                           credentials,
+  response = vapix_request(vapix_h,
                            VINPUT_SCHEMA_CGI_ENDPOINT,
                            HTTP_GET,
                            NONE_data,
                            NULL,
                            err);
   if (response != NULL) {
-    if (vin_xml_parse(response, &parse_res, err)) {
-      /* <Success> response: save the <MajorVersion> of <SchemaVersion> as we
-       * need it for subsequent activate/deactivate VAPIX calls */
-      schema_version = g_strdup(parse_res.schema_version);
-    } else {
-      /* <Error> response */
-      g_prefix_error(err, "vin_xml_parse() failed: ");
-
-      vin_xml_parse_clear(&parse_res);
-      g_clear_pointer(&response, g_free);
-      goto err_out;
-    }
-    vin_xml_parse_clear(&parse_res);
+    schema_version = vin_schema_version_parse(response, err);
     g_clear_pointer(&response, g_free);
   } else {
     g_prefix_error(err, "vapix_request() failed: ");
   } /* response == NULL*/
 
-err_out:
-
   return schema_version;
 }
+
+/* completion callback of an asynchronous schema version request, runs in the
+ * main loop */
+static void
+vin_schema_version_done_cb(const gchar *response,
+                           const GError *err,
+                           gpointer user_data)
+{
+  schema_version_req_t *req = user_data;
+  gchar *schema_version = NULL;
+  GError *lerr = NULL;
+
+  g_assert(req != NULL);
+  g_assert(req->callback != NULL);
+
+  if (err != NULL) {
+    lerr = g_error_copy(err);
+    g_prefix_error(&lerr, "vapix_request_async() failed: ");
+  } else {
+    schema_version = vin_schema_version_parse(response, &lerr);
+  }
+
+  req->callback(schema_version, lerr, req->user_data);
+
+  g_clear_error(&lerr);
+  g_free(schema_version);
+  g_free(req);
+}
+
+gboolean
+vin_get_schema_version_async(vapix_session_t *vapix_h,
+                             vin_schema_version_cb_t callback,
+                             gpointer user_data,
+                             GError **err)
+{
+  schema_version_req_t *req;
+
+  g_return_val_if_fail(vapix_h != NULL, FALSE);
+  g_return_val_if_fail(callback != NULL, FALSE);
+  g_return_val_if_fail(err == NULL || *err == NULL, FALSE);
+
+  req = g_new0(schema_version_req_t, 1);
+  req->callback = callback;
+  req->user_data = user_data;
+
+  if (!vapix_request_async(vapix_h,
+                           VINPUT_SCHEMA_CGI_ENDPOINT,
+                           HTTP_GET,
+                           NONE_data,
+                           NULL,
+                           vin_schema_version_done_cb,
+                           req,
+                           err)) {
+    g_prefix_error(err, "vapix_request_async() failed: ");
+    g_free(req);
+    return FALSE;
+  }
+
+  return TRUE;
+}
@@ -26,6 +26,8 @@
 #ifndef __VINPUT_VAPIX_H__
 #define __VINPUT_VAPIX_H__
 
+#include "vapix_utils.h"
+
 #define VINPUT_ACTIVATE_CGI_ENDPOINT   "virtualinput/activate.cgi"
 #define VINPUT_DEACTIVATE_CGI_ENDPOINT "virtualinput/deactivate.cgi"
 #define VINPUT_SCHEMA_CGI_ENDPOINT     "virtualinput/getschemaversions.cgi"
@@ -49,7 +51,22 @@ typedef struct parser_status {
 } parser_status_t;
 
 gchar *
-vin_get_schema_version(CURL *curl_h, const gchar *credentials, GError **err);
+vin_get_schema_version(vapix_session_t *vapix_h, GError **err);
+
+/* called from the main loop when a schema version request is completed,
+ * 'schema_version' is NULL if 'err' is set, both are only valid until
+ * returning */
+typedef void (*vin_schema_version_cb_t)(const gchar *schema_version,
+                                        const GError *err,
+                                        gpointer user_data);
+
+/* Same as vin_get_schema_version() but doesn't wait for the response, the
+ * result is reported through 'callback'. */
+gboolean
+vin_get_schema_version_async(vapix_session_t *vapix_h,
+                             vin_schema_version_cb_t callback,
+                             gpointer user_data,
+                             GError **err);
 
 /* NOTE: "duration" (in seconds) is an optional parameter of the "activate.cgi"
  * request. OPC UA methods cannot take optional parameters. We use the
@@ -58,8 +75,7 @@ vin_get_schema_version(CURL *curl_h, const gchar *credentials, GError **err);
  * https://developer.axis.com/vapix/network-video/input-and-outputs/#activate-a-virtual-input:
  * */
 UA_StatusCode
-vin_set_port_state(CURL *curl_h,
-                   const gchar *credentials,
+vin_set_port_state(vapix_session_t *vapix_h,
                    const gchar *schema_version,
                    UA_UInt32 portnr,
                    UA_Boolean state,
@@ -68,4 +84,27 @@ vin_set_port_state(CURL *curl_h,
                    gboolean *state_changed,
                    GError **err);
 
+/* a port state change of vin_set_port_states() */
+typedef struct vin_port_change {
+  UA_UInt32 portnr;
+  UA_Boolean state;
+  UA_Int32 duration;
+  /* the outcome, set by vin_set_port_states(). 'err' is set if 'status' is
+   * not good and must be freed by the caller */
+  UA_StatusCode status;
+  gboolean state_changed;
+  GError *err;
+} vin_port_change_t;
+
+/* Applies 'nr_changes' port state changes as vin_set_port_state() does, with
+ * at most 'max_concurrent' requests performed at the same time. Returns once
+ * all of them are done, the outcome of each one is stored in 'changes'. */
+void
+vin_set_port_states(vapix_session_t *vapix_h,
+                    const gchar *schema_version,
+                    vin_port_change_t *changes,
+                    guint nr_changes,
+                    guint max_concurrent,
+                    gboolean *vin_states);
+
 #endif /* __VINPUT_VAPIX_H__ */
@@ -0,0 +1,169 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2025 Axis Communications AB
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <glib.h>
+#include <stdarg.h>
+#include <string.h>
+
+#include "ua_arena.h"
+
+/* alignment of every allocation, enough for any scalar type */
+#define ARENA_ALIGN (2 * sizeof(gpointer))
+
+/* bump allocation out of a single block, requests that don't fit go to the
+ * heap until the next reset which enlarges the block to the high-water mark */
+struct ua_arena {
+  gchar *block;
+  gsize size;
+  gsize used;
+  /* heap allocations made since the last reset and their total size */
+  GSList *overflow;
+  gsize overflow_size;
+};
+
+static gsize
+align_size(gsize size)
+{
+  return (size + ARENA_ALIGN - 1) & ~(ARENA_ALIGN - 1);
+}
+
+ua_arena_t *
+ua_arena_new(gsize size)
+{
+  ua_arena_t *arena;
+
+  g_return_val_if_fail(size > 0, NULL);
+
+  arena = g_new0(ua_arena_t, 1);
+  arena->size = align_size(size);
+  arena->block = g_malloc(arena->size);
+
+  return arena;
+}
+
+void
+ua_arena_free(ua_arena_t *arena)
+{
+  if (arena == NULL) {
+    return;
+  }
+
+  g_slist_free_full(arena->overflow, g_free);
+  g_free(arena->block);
+  g_free(arena);
+}
+
+void
+ua_arena_reset(ua_arena_t *arena)
+{
+  g_return_if_fail(arena != NULL);
+
+  if (arena->overflow != NULL) {
+    gsize size = arena->used + arena->overflow_size;
+
+    g_slist_free_full(arena->overflow, g_free);
+    arena->overflow = NULL;
+    arena->overflow_size = 0;
+
+    /* the previous content is released, no need to copy it */
+    g_free(arena->block);
+    arena->size = MAX(arena->size * 2, size);
+    arena->block = g_malloc(arena->size);
+  }
+  arena->used = 0;
+}
+
+gpointer
+ua_arena_alloc(ua_arena_t *arena, gsize size)
+{
+  gpointer mem;
+
+  g_return_val_if_fail(arena != NULL, NULL);
+
+  size = align_size(MAX(size, 1));
+  if (size <= arena->size - arena->used) {
+    mem = arena->block + arena->used;
+    arena->used += size;
+    return mem;
+  }
+
+  mem = g_malloc(size);
+  arena->overflow = g_slist_prepend(arena->overflow, mem);
+  arena->overflow_size += size;
+
+  return mem;
+}
+
+gchar *
+ua_arena_strndup(ua_arena_t *arena, const gchar *str, gsize n)
+{
+  gchar *copy;
+
+  g_return_val_if_fail(arena != NULL, NULL);
+
+  if (str == NULL) {
+    return NULL;
+  }
+
+  n = strnlen(str, n);
+  copy = ua_arena_alloc(arena, n + 1);
+  memcpy(copy, str, n);
+  copy[n] = '\0';
+
+  return copy;
+}
+
+gchar *
+ua_arena_printf(ua_arena_t *arena, const gchar *format, ...)
+{
+  va_list args;
+  gchar *str;
+  gsize avail;
+  gint len;
+
+  g_return_val_if_fail(arena != NULL, NULL);
+  g_return_val_if_fail(format != NULL, NULL);
+
+  /* format straight into the free space of the block and only claim what was
+   * used, formatting a second time if it was too small */
+  avail = arena->size - arena->used;
+  str = arena->block + arena->used;
+  va_start(args, format);
+  len = g_vsnprintf(str, avail, format, args);
+  va_end(args);
+  g_assert(len >= 0);
+
+  if ((gsize) len < avail) {
+    arena->used += align_size((gsize) len + 1);
+    return str;
+  }
+
+  str = ua_arena_alloc(arena, (gsize) len + 1);
+  va_start(args, format);
+  g_vsnprintf(str, (gsize) len + 1, format, args);
+  va_end(args);
+
+  return str;
+}
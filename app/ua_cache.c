@@ -0,0 +1,248 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2025 Axis Communications AB
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <errno.h>
+#include <glib.h>
+#include <string.h>
+
+#include "error.h"
+#include "ua_cache.h"
+
+/* can be set at build time, e.g. for a host build of the application */
+#ifndef UA_CACHE_DIR
+#define UA_CACHE_DIR "/usr/local/packages/" APPNAME "/localdata"
+#endif
+
+#define UA_CACHE_SUFFIX ".cache"
+
+/* bumped whenever the layout of the cache files changes */
+#define UA_CACHE_FORMAT 1
+
+#define UA_CACHE_GROUP        "cache"
+#define UA_CACHE_KEY_FORMAT   "format"
+#define UA_CACHE_KEY_FIRMWARE "firmware"
+#define UA_CACHE_ENTRIES      "entries"
+
+/* identifies the running firmware without any VAPIX request */
+#define OS_RELEASE_FILE       "/etc/os-release"
+#define OS_RELEASE_VERSION_ID "VERSION_ID="
+
+DEFINE_GQUARK("ua-cache")
+
+static gchar *
+get_firmware_version(GError **err)
+{
+  gchar *contents = NULL;
+  gchar **lines = NULL;
+  gchar *version = NULL;
+
+  g_assert(err == NULL || *err == NULL);
+
+  if (!g_file_get_contents(OS_RELEASE_FILE, &contents, NULL, err)) {
+    return NULL;
+  }
+
+  lines = g_strsplit(contents, "\n", -1);
+  g_free(contents);
+  for (guint i = 0; lines[i] != NULL; i++) {
+    if (g_str_has_prefix(lines[i], OS_RELEASE_VERSION_ID)) {
+      /* the value may be quoted as in a shell assignment */
+      version = g_shell_unquote(lines[i] + strlen(OS_RELEASE_VERSION_ID), err);
+      g_strfreev(lines);
+      return version;
+    }
+  }
+  g_strfreev(lines);
+
+  SET_ERROR(err, -1, "No %s in %s", OS_RELEASE_VERSION_ID, OS_RELEASE_FILE);
+
+  return NULL;
+}
+
+static gchar *
+get_cache_path(const gchar *name)
+{
+  gchar *filename;
+  gchar *path;
+
+  g_assert(name != NULL);
+
+  filename = g_strconcat(name, UA_CACHE_SUFFIX, NULL);
+  path = g_build_filename(UA_CACHE_DIR, filename, NULL);
+  g_free(filename);
+
+  return path;
+}
+
+GHashTable *
+ua_cache_load(const gchar *name, GError **err)
+{
+  gchar *path = NULL;
+  gchar *firmware = NULL;
+  gchar *cached_firmware = NULL;
+  gchar **keys = NULL;
+  GKeyFile *key_file = NULL;
+  GHashTable *entries = NULL;
+  gint format;
+
+  g_return_val_if_fail(name != NULL, NULL);
+  g_return_val_if_fail(err == NULL || *err == NULL, NULL);
+
+  firmware = get_firmware_version(err);
+  if (firmware == NULL) {
+    g_prefix_error(err, "get_firmware_version() failed: ");
+    return NULL;
+  }
+
+  path = get_cache_path(name);
+  key_file = g_key_file_new();
+  if (!g_key_file_load_from_file(key_file, path, G_KEY_FILE_NONE, err)) {
+    g_prefix_error(err, "Failed to load %s: ", path);
+    goto out;
+  }
+
+  format = g_key_file_get_integer(key_file,
+                                  UA_CACHE_GROUP,
+                                  UA_CACHE_KEY_FORMAT,
+                                  NULL);
+  if (format != UA_CACHE_FORMAT) {
+    SET_ERROR(err, -1, "%s: unsupported format %d", path, format);
+    goto out;
+  }
+
+  cached_firmware = g_key_file_get_string(key_file,
+                                          UA_CACHE_GROUP,
+                                          UA_CACHE_KEY_FIRMWARE,
+                                          NULL);
+  if (g_strcmp0(cached_firmware, firmware) != 0) {
+    SET_ERROR(err,
+              -1,
+              "%s: written by firmware %s, running %s",
+              path,
+              cached_firmware != NULL ? cached_firmware : "(none)",
+              firmware);
+    goto out;
+  }
+
+  keys = g_key_file_get_keys(key_file, UA_CACHE_ENTRIES, NULL, err);
+  if (keys == NULL) {
+    g_prefix_error(err, "%s: ", path);
+    goto out;
+  }
+
+  entries = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, g_free);
+  for (guint i = 0; keys[i] != NULL; i++) {
+    gchar *value;
+
+    value = g_key_file_get_string(key_file, UA_CACHE_ENTRIES, keys[i], err);
+    if (value == NULL) {
+      g_prefix_error(err, "%s: ", path);
+      g_clear_pointer(&entries, g_hash_table_unref);
+      goto out;
+    }
+    g_hash_table_insert(entries, g_strdup(keys[i]), value);
+  }
+
+out:
+  g_strfreev(keys);
+  g_key_file_free(key_file);
+  g_free(cached_firmware);
+  g_free(firmware);
+  g_free(path);
+
+  return entries;
+}
+
+gboolean
+ua_cache_store(const gchar *name, GHashTable *entries, GError **err)
+{
+  gchar *path = NULL;
+  gchar *firmware = NULL;
+  gchar *data = NULL;
+  GKeyFile *key_file = NULL;
+  GHashTableIter iter;
+  gpointer key;
+  gpointer value;
+  gsize len;
+  gboolean ret = FALSE;
+
+  g_return_val_if_fail(name != NULL, FALSE);
+  g_return_val_if_fail(entries != NULL, FALSE);
+  g_return_val_if_fail(err == NULL || *err == NULL, FALSE);
+
+  firmware = get_firmware_version(err);
+  if (firmware == NULL) {
+    g_prefix_error(err, "get_firmware_version() failed: ");
+    return FALSE;
+  }
+
+  key_file = g_key_file_new();
+  g_key_file_set_integer(key_file,
+                         UA_CACHE_GROUP,
+                         UA_CACHE_KEY_FORMAT,
+                         UA_CACHE_FORMAT);
+  g_key_file_set_string(key_file,
+                        UA_CACHE_GROUP,
+                        UA_CACHE_KEY_FIRMWARE,
+                        firmware);
+
+  g_hash_table_iter_init(&iter, entries);
+  while (g_hash_table_iter_next(&iter, &key, &value)) {
+    g_key_file_set_string(key_file,
+                          UA_CACHE_ENTRIES,
+                          (const gchar *) key,
+                          (const gchar *) value);
+  }
+
+  data = g_key_file_to_data(key_file, &len, err);
+  if (data == NULL) {
+    goto out;
+  }
+
+  if (g_mkdir_with_parents(UA_CACHE_DIR, 0755) != 0) {
+    SET_ERROR(err,
+              -1,
+              "Failed to create %s: %s",
+              UA_CACHE_DIR,
+              g_strerror(errno));
+    goto out;
+  }
+
+  /* written to a temporary file first and renamed over the old cache */
+  path = get_cache_path(name);
+  if (!g_file_set_contents(path, data, len, err)) {
+    goto out;
+  }
+
+  ret = TRUE;
+
+out:
+  g_key_file_free(key_file);
+  g_free(data);
+  g_free(firmware);
+  g_free(path);
+
+  return ret;
+}
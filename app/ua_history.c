@@ -0,0 +1,670 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2025 Axis Communications AB
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <glib.h>
+#include <open62541/server.h>
+#include <string.h>
+
+#ifdef UA_ENABLE_HISTORIZING
+#include <open62541/plugin/historydatabase.h>
+#endif
+
+#include "error.h"
+#include "ua_history.h"
+
+DEFINE_GQUARK("ua-history")
+
+/* sizes of the strings of an entry, longer ones are truncated */
+#define HISTORY_EVENT_ID_MAX    16 /* open62541 generates 16 byte EventIds */
+#define HISTORY_NODE_ID_MAX     64
+#define HISTORY_LOCALE_MAX      16
+#define HISTORY_TEXT_MAX        128
+#define HISTORY_SOURCE_NAME_MAX 64
+
+/* an event of the ring, its strings are NUL-terminated */
+typedef struct history_entry {
+  UA_DateTime time;
+  UA_DateTime receive_time;
+  UA_UInt16 severity;
+  /* the origin node, only numeric and string ids short enough are kept and
+   * the others are only read through the Server object */
+  gboolean has_origin;
+  UA_UInt16 origin_ns;
+  UA_NodeIdType origin_type;
+  UA_UInt32 origin_numeric;
+  gchar origin_string[HISTORY_NODE_ID_MAX];
+  UA_Byte event_id[HISTORY_EVENT_ID_MAX];
+  gsize event_id_len;
+  gchar locale[HISTORY_LOCALE_MAX];
+  gchar text[HISTORY_TEXT_MAX];
+  gchar source_name[HISTORY_SOURCE_NAME_MAX];
+} history_entry_t;
+
+struct ua_history {
+  UA_NodeId eventType;
+  history_entry_t *entries;
+  guint capacity;
+  /* index of the oldest entry and number of entries */
+  guint first;
+  guint count;
+  /* the events are recorded and read from different threads */
+  GMutex lock;
+};
+
+/* all the histories, served by the history database */
+static GMutex histories_lock;
+static GSList *histories;
+
+/* Local functions */
+
+/* copies 'src' to the NUL-terminated 'dst' of 'size' bytes, without cutting a
+ * UTF-8 character in half */
+static void
+copy_string(gchar *dst, gsize size, const UA_String *src)
+{
+  const gchar *end;
+  gsize len;
+
+  g_assert(dst != NULL);
+  g_assert(size > 0);
+  g_assert(src != NULL);
+
+  len = MIN(src->length, size - 1);
+  if (len > 0) {
+    memcpy(dst, src->data, len);
+  }
+  if (!g_utf8_validate(dst, len, &end)) {
+    len = end - dst;
+  }
+  dst[len] = '\0';
+}
+
+static void
+set_origin(history_entry_t *entry, const UA_NodeId *origin)
+{
+  g_assert(entry != NULL);
+  g_assert(origin != NULL);
+
+  entry->has_origin = FALSE;
+  entry->origin_ns = origin->namespaceIndex;
+  entry->origin_type = origin->identifierType;
+
+  if (origin->identifierType == UA_NODEIDTYPE_NUMERIC) {
+    entry->origin_numeric = origin->identifier.numeric;
+    entry->has_origin = TRUE;
+  } else if (origin->identifierType == UA_NODEIDTYPE_STRING &&
+             origin->identifier.string.length < HISTORY_NODE_ID_MAX) {
+    memcpy(entry->origin_string,
+           origin->identifier.string.data,
+           origin->identifier.string.length);
+    entry->origin_string[origin->identifier.string.length] = '\0';
+    entry->has_origin = TRUE;
+  }
+}
+
+#ifdef UA_ENABLE_HISTORIZING
+
+/* an event selected by a HistoryReadEvents request, with its fields */
+typedef struct selected_event {
+  UA_DateTime time;
+  UA_HistoryEventFieldList fields;
+} selected_event_t;
+
+static UA_NodeId
+get_origin(const history_entry_t *entry)
+{
+  g_assert(entry != NULL);
+  g_assert(entry->has_origin);
+
+  if (entry->origin_type == UA_NODEIDTYPE_NUMERIC) {
+    return UA_NODEID_NUMERIC(entry->origin_ns, entry->origin_numeric);
+  }
+
+  return UA_NODEID_STRING(entry->origin_ns, (gchar *) entry->origin_string);
+}
+
+/* TRUE if the events of 'entry' are read through 'node' */
+static gboolean
+emitted_by(const history_entry_t *entry, const UA_NodeId *node)
+{
+  UA_NodeId server = UA_NODEID_NUMERIC(0, UA_NS0ID_SERVER);
+  UA_NodeId origin;
+
+  g_assert(entry != NULL);
+  g_assert(node != NULL);
+
+  /* the Server object is the notifier of all the events */
+  if (UA_NodeId_equal(node, &server)) {
+    return TRUE;
+  }
+
+  if (!entry->has_origin) {
+    return FALSE;
+  }
+
+  origin = get_origin(entry);
+
+  return UA_NodeId_equal(node, &origin);
+}
+
+static gboolean
+is_field(const UA_SimpleAttributeOperand *operand, const gchar *name)
+{
+  const UA_QualifiedName *qn;
+
+  g_assert(operand != NULL);
+  g_assert(name != NULL);
+
+  if (operand->browsePathSize != 1 ||
+      operand->attributeId != UA_ATTRIBUTEID_VALUE) {
+    return FALSE;
+  }
+
+  qn = &operand->browsePath[0];
+
+  return qn->namespaceIndex == 0 && qn->name.length == strlen(name) &&
+         memcmp(qn->name.data, name, qn->name.length) == 0;
+}
+
+/* the value of the field selected by 'operand', left empty for the fields
+ * which are not recorded */
+static UA_StatusCode
+get_field(const ua_history_t *history,
+          const history_entry_t *entry,
+          const UA_SimpleAttributeOperand *operand,
+          UA_Variant *value)
+{
+  UA_ByteString event_id;
+  UA_NodeId origin;
+  UA_String source_name;
+  UA_LocalizedText message;
+
+  g_assert(history != NULL);
+  g_assert(entry != NULL);
+  g_assert(operand != NULL);
+  g_assert(value != NULL);
+
+  UA_Variant_init(value);
+
+  if (is_field(operand, "EventId")) {
+    event_id.length = entry->event_id_len;
+    event_id.data = (UA_Byte *) entry->event_id;
+    return UA_Variant_setScalarCopy(value,
+                                    &event_id,
+                                    &UA_TYPES[UA_TYPES_BYTESTRING]);
+  } else if (is_field(operand, "EventType")) {
+    return UA_Variant_setScalarCopy(value,
+                                    &history->eventType,
+                                    &UA_TYPES[UA_TYPES_NODEID]);
+  } else if (is_field(operand, "SourceNode") && entry->has_origin) {
+    origin = get_origin(entry);
+    return UA_Variant_setScalarCopy(value,
+                                    &origin,
+                                    &UA_TYPES[UA_TYPES_NODEID]);
+  } else if (is_field(operand, "SourceName")) {
+    source_name = UA_STRING((gchar *) entry->source_name);
+    return UA_Variant_setScalarCopy(value,
+                                    &source_name,
+                                    &UA_TYPES[UA_TYPES_STRING]);
+  } else if (is_field(operand, "Time")) {
+    return UA_Variant_setScalarCopy(value,
+                                    &entry->time,
+                                    &UA_TYPES[UA_TYPES_DATETIME]);
+  } else if (is_field(operand, "ReceiveTime")) {
+    return UA_Variant_setScalarCopy(value,
+                                    &entry->receive_time,
+                                    &UA_TYPES[UA_TYPES_DATETIME]);
+  } else if (is_field(operand, "Message")) {
+    message.locale = UA_STRING((gchar *) entry->locale);
+    message.text = UA_STRING((gchar *) entry->text);
+    return UA_Variant_setScalarCopy(value,
+                                    &message,
+                                    &UA_TYPES[UA_TYPES_LOCALIZEDTEXT]);
+  } else if (is_field(operand, "Severity")) {
+    return UA_Variant_setScalarCopy(value,
+                                    &entry->severity,
+                                    &UA_TYPES[UA_TYPES_UINT16]);
+  }
+
+  return UA_STATUSCODE_GOOD;
+}
+
+static UA_StatusCode
+select_event(const ua_history_t *history,
+             const history_entry_t *entry,
+             const UA_EventFilter *filter,
+             GArray *selected)
+{
+  selected_event_t event;
+  UA_StatusCode status = UA_STATUSCODE_GOOD;
+
+  g_assert(history != NULL);
+  g_assert(entry != NULL);
+  g_assert(filter != NULL);
+  g_assert(selected != NULL);
+
+  event.time = entry->time;
+  UA_HistoryEventFieldList_init(&event.fields);
+  if (filter->selectClausesSize > 0) {
+    event.fields.eventFields =
+            (UA_Variant *) UA_Array_new(filter->selectClausesSize,
+                                        &UA_TYPES[UA_TYPES_VARIANT]);
+    if (event.fields.eventFields == NULL) {
+      return UA_STATUSCODE_BADOUTOFMEMORY;
+    }
+    event.fields.eventFieldsSize = filter->selectClausesSize;
+  }
+
+  for (gsize i = 0; i < filter->selectClausesSize; i++) {
+    status = get_field(history,
+                       entry,
+                       &filter->selectClauses[i],
+                       &event.fields.eventFields[i]);
+    if (status != UA_STATUSCODE_GOOD) {
+      UA_HistoryEventFieldList_clear(&event.fields);
+      return status;
+    }
+  }
+
+  g_array_append_val(selected, event);
+
+  return UA_STATUSCODE_GOOD;
+}
+
+static gint
+compare_events(gconstpointer a, gconstpointer b)
+{
+  const selected_event_t *ea = a;
+  const selected_event_t *eb = b;
+
+  return (ea->time > eb->time) - (ea->time < eb->time);
+}
+
+/* the continuation point of a read which returned up to the events at 'time',
+ * of which 'nr_at_time' were returned. It holds no state of the server and
+ * is only valid as long as no event at 'time' is overwritten in the ring. */
+typedef struct continuation {
+  UA_DateTime time;
+  guint32 nr_at_time;
+} continuation_t;
+
+/* the size of an encoded continuation_t, without its padding */
+#define CONTINUATION_SIZE (sizeof(UA_DateTime) + sizeof(guint32))
+
+static UA_StatusCode
+parse_continuation(const UA_ByteString *cp, continuation_t *cont)
+{
+  g_assert(cp != NULL);
+  g_assert(cont != NULL);
+
+  if (cp->length != CONTINUATION_SIZE) {
+    return UA_STATUSCODE_BADCONTINUATIONPOINTINVALID;
+  }
+  memcpy(&cont->time, cp->data, sizeof(cont->time));
+  memcpy(&cont->nr_at_time,
+         cp->data + sizeof(cont->time),
+         sizeof(cont->nr_at_time));
+  if (cont->nr_at_time == 0) {
+    return UA_STATUSCODE_BADCONTINUATIONPOINTINVALID;
+  }
+
+  return UA_STATUSCODE_GOOD;
+}
+
+static UA_StatusCode
+make_continuation(const continuation_t *cont, UA_ByteString *cp)
+{
+  UA_StatusCode status;
+
+  g_assert(cont != NULL);
+  g_assert(cp != NULL);
+
+  status = UA_ByteString_allocBuffer(cp, CONTINUATION_SIZE);
+  if (status == UA_STATUSCODE_GOOD) {
+    memcpy(cp->data, &cont->time, sizeof(cont->time));
+    memcpy(cp->data + sizeof(cont->time),
+           &cont->nr_at_time,
+           sizeof(cont->nr_at_time));
+  }
+
+  return status;
+}
+
+/* the events of all the histories read through 'node' within the time range
+ * of 'details', from 'cp_in' on when not empty. At most numValuesPerNode
+ * events are returned, when more are left 'cp_out' is set to resume the read
+ * after the last returned one. */
+static UA_StatusCode
+read_events(const UA_ReadEventDetails *details,
+            const UA_NodeId *node,
+            const UA_ByteString *cp_in,
+            UA_HistoryEvent *result,
+            UA_ByteString *cp_out)
+{
+  UA_DateTime start = details->startTime;
+  UA_DateTime end = details->endTime;
+  UA_DateTime lo;
+  UA_DateTime hi;
+  gboolean backward;
+  GArray *selected;
+  selected_event_t *event;
+  continuation_t cont = { 0 };
+  gboolean resumed;
+  guint first = 0;
+  guint nr;
+  UA_StatusCode status = UA_STATUSCODE_GOOD;
+
+  g_assert(details != NULL);
+  g_assert(node != NULL);
+  g_assert(cp_in != NULL);
+  g_assert(result != NULL);
+  g_assert(cp_out != NULL);
+
+  resumed = (cp_in->length > 0);
+
+  /* the events are only selected by the time range and the node */
+  if (details->filter.whereClause.elementsSize > 0) {
+    return UA_STATUSCODE_BADMONITOREDITEMFILTERUNSUPPORTED;
+  }
+
+  if (resumed) {
+    status = parse_continuation(cp_in, &cont);
+    if (status != UA_STATUSCODE_GOOD) {
+      return status;
+    }
+  }
+
+  /* an unspecified bound (0) leaves the range open on that side, the events
+   * are returned from the start time towards the end time */
+  if (start == 0 && end == 0) {
+    return UA_STATUSCODE_BADINVALIDTIMESTAMPARGUMENT;
+  } else if (start != 0 && end != 0) {
+    lo = MIN(start, end);
+    hi = MAX(start, end);
+    backward = (start > end);
+  } else {
+    lo = start;
+    hi = end;
+    backward = (start == 0);
+  }
+
+  selected = g_array_new(FALSE, FALSE, sizeof(selected_event_t));
+
+  g_mutex_lock(&histories_lock);
+  for (GSList *iter = histories; iter != NULL; iter = iter->next) {
+    ua_history_t *history = iter->data;
+
+    g_mutex_lock(&history->lock);
+    for (guint i = 0; i < history->count && status == UA_STATUSCODE_GOOD;
+         i++) {
+      const history_entry_t *entry =
+              &history->entries[(history->first + i) % history->capacity];
+
+      if ((lo != 0 && entry->time < lo) || (hi != 0 && entry->time > hi) ||
+          !emitted_by(entry, node)) {
+        continue;
+      }
+      status = select_event(history, entry, &details->filter, selected);
+    }
+    g_mutex_unlock(&history->lock);
+  }
+  g_mutex_unlock(&histories_lock);
+
+  /* the histories are merged by time, each one is already in order and the
+   * sort keeps the order of the events of the same time */
+  g_array_sort(selected, compare_events);
+
+  /* read backwards the result starts with the latest event */
+  if (backward) {
+    for (guint i = 0; i < selected->len / 2; i++) {
+      selected_event_t tmp = g_array_index(selected, selected_event_t, i);
+
+      g_array_index(selected, selected_event_t, i) =
+              g_array_index(selected, selected_event_t, selected->len - 1 - i);
+      g_array_index(selected, selected_event_t, selected->len - 1 - i) = tmp;
+    }
+  }
+
+  /* skip the events returned by the previous reads */
+  if (resumed) {
+    guint at_time = 0;
+
+    while (first < selected->len) {
+      event = &g_array_index(selected, selected_event_t, first);
+      if (event->time == cont.time) {
+        if (at_time++ == cont.nr_at_time) {
+          break;
+        }
+      } else if (backward ? event->time < cont.time :
+                            event->time > cont.time) {
+        break;
+      }
+      first++;
+    }
+  }
+
+  nr = selected->len - first;
+  if (details->numValuesPerNode > 0 && nr > details->numValuesPerNode) {
+    nr = details->numValuesPerNode;
+
+    /* the position of the last returned event */
+    event = &g_array_index(selected, selected_event_t, first + nr - 1);
+    cont.time = event->time;
+    cont.nr_at_time = 0;
+    for (guint i = 0; i < first + nr; i++) {
+      if (g_array_index(selected, selected_event_t, i).time == cont.time) {
+        cont.nr_at_time++;
+      }
+    }
+    if (status == UA_STATUSCODE_GOOD) {
+      status = make_continuation(&cont, cp_out);
+    }
+  }
+
+  if (status == UA_STATUSCODE_GOOD && nr > 0) {
+    result->events = (UA_HistoryEventFieldList *)
+            UA_Array_new(nr, &UA_TYPES[UA_TYPES_HISTORYEVENTFIELDLIST]);
+    if (result->events == NULL) {
+      status = UA_STATUSCODE_BADOUTOFMEMORY;
+    }
+  }
+
+  for (guint i = 0; i < selected->len; i++) {
+    event = &g_array_index(selected, selected_event_t, i);
+    if (status == UA_STATUSCODE_GOOD && i >= first && i < first + nr) {
+      /* moved to the result */
+      result->events[i - first] = event->fields;
+    } else {
+      UA_HistoryEventFieldList_clear(&event->fields);
+    }
+  }
+  if (status == UA_STATUSCODE_GOOD) {
+    result->eventsSize = nr;
+  } else {
+    UA_ByteString_clear(cp_out);
+  }
+  g_array_free(selected, TRUE);
+
+  return status;
+}
+
+/* the readEvent callback of the history database */
+static void
+read_event_cb(G_GNUC_UNUSED UA_Server *server,
+              G_GNUC_UNUSED void *hdbContext,
+              G_GNUC_UNUSED const UA_NodeId *sessionId,
+              G_GNUC_UNUSED void *sessionContext,
+              G_GNUC_UNUSED const UA_RequestHeader *requestHeader,
+              const UA_ReadEventDetails *historyReadDetails,
+              G_GNUC_UNUSED UA_TimestampsToReturn timestampsToReturn,
+              UA_Boolean releaseContinuationPoints,
+              size_t nodesToReadSize,
+              const UA_HistoryReadValueId *nodesToRead,
+              UA_HistoryReadResponse *response,
+              UA_HistoryEvent *const *const historyData)
+{
+  g_assert(historyReadDetails != NULL);
+  g_assert(response != NULL);
+  g_assert(nodesToReadSize == 0 || response->resultsSize == nodesToReadSize);
+
+  for (gsize i = 0; i < nodesToReadSize; i++) {
+    /* the continuation points hold no state of the server, there is
+     * nothing to release */
+    if (releaseContinuationPoints) {
+      response->results[i].statusCode = UA_STATUSCODE_GOOD;
+    } else {
+      response->results[i].statusCode =
+              read_events(historyReadDetails,
+                          &nodesToRead[i].nodeId,
+                          &nodesToRead[i].continuationPoint,
+                          historyData[i],
+                          &response->results[i].continuationPoint);
+    }
+  }
+}
+
+#endif /* UA_ENABLE_HISTORIZING */
+
+/* Exported functions */
+
+ua_history_t *
+ua_history_new(const UA_NodeId *eventType, guint capacity)
+{
+  ua_history_t *history;
+
+  g_return_val_if_fail(eventType != NULL, NULL);
+  g_return_val_if_fail(capacity > 0, NULL);
+
+  history = g_new0(ua_history_t, 1);
+  if (UA_NodeId_copy(eventType, &history->eventType) != UA_STATUSCODE_GOOD) {
+    g_free(history);
+    return NULL;
+  }
+  history->entries = g_new0(history_entry_t, capacity);
+  history->capacity = capacity;
+  g_mutex_init(&history->lock);
+
+  g_mutex_lock(&histories_lock);
+  histories = g_slist_prepend(histories, history);
+  g_mutex_unlock(&histories_lock);
+
+  return history;
+}
+
+void
+ua_history_free(ua_history_t *history)
+{
+  if (history == NULL) {
+    return;
+  }
+
+  g_mutex_lock(&histories_lock);
+  histories = g_slist_remove(histories, history);
+  g_mutex_unlock(&histories_lock);
+
+  g_free(history->entries);
+  UA_NodeId_clear(&history->eventType);
+  g_mutex_clear(&history->lock);
+  g_free(history);
+}
+
+void
+ua_history_record(ua_history_t *history,
+                  const UA_NodeId *origin,
+                  const UA_ByteString *eventId,
+                  const ua_event_fields_t *fields)
+{
+  history_entry_t *entry;
+  UA_DateTime now = UA_DateTime_now();
+
+  g_return_if_fail(history != NULL);
+  g_return_if_fail(origin != NULL);
+  g_return_if_fail(fields != NULL);
+
+  g_mutex_lock(&history->lock);
+
+  if (history->count < history->capacity) {
+    entry = &history->entries[(history->first + history->count) %
+                              history->capacity];
+    history->count++;
+  } else {
+    /* the oldest event makes room for the new one */
+    entry = &history->entries[history->first];
+    history->first = (history->first + 1) % history->capacity;
+  }
+
+  entry->time = fields->time;
+  entry->receive_time = now;
+  entry->severity = fields->severity;
+  set_origin(entry, origin);
+
+  entry->event_id_len = 0;
+  if (eventId != NULL) {
+    entry->event_id_len = MIN(eventId->length, HISTORY_EVENT_ID_MAX);
+    memcpy(entry->event_id, eventId->data, entry->event_id_len);
+  }
+
+  copy_string(entry->locale, sizeof(entry->locale), &fields->message.locale);
+  copy_string(entry->text, sizeof(entry->text), &fields->message.text);
+  copy_string(entry->source_name,
+              sizeof(entry->source_name),
+              &fields->sourceName);
+
+  g_mutex_unlock(&history->lock);
+}
+
+gboolean
+ua_history_setup(UA_Server *server, GError **err)
+{
+  g_return_val_if_fail(server != NULL, FALSE);
+  g_return_val_if_fail(err == NULL || *err == NULL, FALSE);
+
+#ifdef UA_ENABLE_HISTORIZING
+  UA_ServerConfig *config = UA_Server_getConfig(server);
+  UA_StatusCode status;
+
+  config->historyDatabase.readEvent = read_event_cb;
+  config->accessHistoryEventsCapability = true;
+
+  /* the clients find the history through the notifier of all the events */
+  status = UA_Server_writeEventNotifier(server,
+                                        UA_NODEID_NUMERIC(0, UA_NS0ID_SERVER),
+                                        UA_EVENTNOTIFIER_SUBSCRIBE_TO_EVENT |
+                                                UA_EVENTNOTIFIER_HISTORY_READ);
+  if (status != UA_STATUSCODE_GOOD) {
+    SET_ERROR(err,
+              -1,
+              "UA_Server_writeEventNotifier() failed: %s",
+              UA_StatusCode_name(status));
+    return FALSE;
+  }
+
+  return TRUE;
+#else
+  SET_ERROR(err, -1, "open62541 is built without historizing");
+
+  return FALSE;
+#endif
+}
@@ -0,0 +1,240 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2025 Axis Communications AB
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <glib.h>
+#include <malloc.h>
+#include <open62541/types.h>
+#include <stdlib.h>
+
+#include "error.h"
+#include "ua_memory.h"
+#include "ua_metrics.h"
+
+#define SERVER_OWNER_NAME "server"
+
+DEFINE_GQUARK("ua-memory")
+
+static struct {
+  /* set once by ua_memory_setup() */
+  gboolean enabled;
+  /* protects the registration of the owners */
+  GMutex lock;
+  guint nr_owners;
+  gchar *names[UA_MEMORY_MAX_OWNERS];
+  /* the gauges of the owners, set before their id is handed out */
+  ua_metric_t *gauges[UA_MEMORY_MAX_OWNERS];
+  ua_metric_t *total;
+} memory;
+
+/* the owner of the calling thread, stored as GUINT_TO_POINTER() */
+static GPrivate current_owner;
+
+#ifdef UA_ENABLE_MALLOC_SINGLETON
+static void
+account(guint owner, gssize delta)
+{
+  g_assert(owner < UA_MEMORY_MAX_OWNERS);
+
+  ua_metric_adjust(g_atomic_pointer_get(&memory.gauges[owner]), (gint) delta);
+  ua_metric_adjust(g_atomic_pointer_get(&memory.total), (gint) delta);
+}
+
+/* The blocks carry no header, the singletons are swapped in per thread and
+ * a block may be freed by a thread other than the one which allocated it.
+ * The usable size of a block is added to the owner of the allocating thread
+ * and subtracted from the owner of the freeing one. */
+static void *
+account_malloc(size_t size)
+{
+  void *ptr = malloc(size);
+
+  if (ptr != NULL) {
+    account(ua_memory_get_owner(), (gssize) malloc_usable_size(ptr));
+  }
+
+  return ptr;
+}
+
+static void *
+account_calloc(size_t nelem, size_t elsize)
+{
+  void *ptr = calloc(nelem, elsize);
+
+  if (ptr != NULL) {
+    account(ua_memory_get_owner(), (gssize) malloc_usable_size(ptr));
+  }
+
+  return ptr;
+}
+
+static void
+account_free(void *ptr)
+{
+  if (ptr == NULL) {
+    return;
+  }
+
+  account(ua_memory_get_owner(), -(gssize) malloc_usable_size(ptr));
+  free(ptr);
+}
+
+static void *
+account_realloc(void *ptr, size_t size)
+{
+  gsize old_size;
+  void *new_ptr;
+
+  if (ptr == NULL) {
+    return account_malloc(size);
+  }
+
+  if (size == 0) {
+    account_free(ptr);
+    return NULL;
+  }
+
+  old_size = malloc_usable_size(ptr);
+  new_ptr = realloc(ptr, size);
+  if (new_ptr == NULL) {
+    return NULL;
+  }
+  account(ua_memory_get_owner(),
+          (gssize) malloc_usable_size(new_ptr) - (gssize) old_size);
+
+  return new_ptr;
+}
+
+#endif /* UA_ENABLE_MALLOC_SINGLETON */
+
+gboolean
+ua_memory_setup(GError **err)
+{
+  g_return_val_if_fail(err == NULL || *err == NULL, FALSE);
+
+  if (memory.enabled) {
+    SET_ERROR(err, -1, "The accounting is already started");
+    return FALSE;
+  }
+
+#ifdef UA_ENABLE_MALLOC_SINGLETON
+  memory.total = ua_metrics_get(UA_METRIC_GAUGE, "memory.total");
+  memory.enabled = TRUE;
+  /* registered first, as UA_MEMORY_SERVER */
+  (void) ua_memory_get_owner_id(SERVER_OWNER_NAME);
+  ua_memory_attach_thread();
+
+  return TRUE;
+#else
+  SET_ERROR(err,
+            -1,
+            "open62541 is built without UA_ENABLE_MALLOC_SINGLETON");
+
+  return FALSE;
+#endif
+}
+
+void
+ua_memory_clear(void)
+{
+  g_mutex_lock(&memory.lock);
+  for (guint i = 0; i < memory.nr_owners; i++) {
+    g_atomic_pointer_set(&memory.gauges[i], NULL);
+  }
+  g_atomic_pointer_set(&memory.total, NULL);
+  g_mutex_unlock(&memory.lock);
+}
+
+void
+ua_memory_attach_thread(void)
+{
+  if (!memory.enabled) {
+    return;
+  }
+
+#ifdef UA_ENABLE_MALLOC_SINGLETON
+  UA_mallocSingleton = account_malloc;
+  UA_freeSingleton = account_free;
+  UA_callocSingleton = account_calloc;
+  UA_reallocSingleton = account_realloc;
+#endif
+}
+
+guint
+ua_memory_get_owner_id(const gchar *name)
+{
+  gchar *metric;
+  guint id = UA_MEMORY_SERVER;
+
+  g_return_val_if_fail(name != NULL, UA_MEMORY_SERVER);
+
+  if (!memory.enabled) {
+    return UA_MEMORY_SERVER;
+  }
+
+  g_mutex_lock(&memory.lock);
+  for (guint i = 0; i < memory.nr_owners; i++) {
+    if (g_strcmp0(memory.names[i], name) == 0) {
+      id = i;
+      goto out;
+    }
+  }
+
+  if (memory.nr_owners == UA_MEMORY_MAX_OWNERS) {
+    goto out;
+  }
+
+  id = memory.nr_owners++;
+  memory.names[id] = g_strdup(name);
+  metric = g_strdup_printf("memory.%s", name);
+  g_atomic_pointer_set(&memory.gauges[id],
+                       ua_metrics_get(UA_METRIC_GAUGE, metric));
+  g_free(metric);
+
+out:
+  g_mutex_unlock(&memory.lock);
+
+  return id;
+}
+
+guint
+ua_memory_get_owner(void)
+{
+  gpointer owner = g_private_get(&current_owner);
+
+  return GPOINTER_TO_UINT(owner);
+}
+
+guint
+ua_memory_set_owner(guint owner)
+{
+  guint previous;
+
+  g_return_val_if_fail(owner < UA_MEMORY_MAX_OWNERS, UA_MEMORY_SERVER);
+
+  previous = ua_memory_get_owner();
+  g_private_set(&current_owner, GUINT_TO_POINTER(owner));
+
+  return previous;
+}
@@ -0,0 +1,350 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2025 Axis Communications AB
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <glib.h>
+#include <string.h>
+
+#include "ua_metrics.h"
+
+/* the accumulators of a metric in one thread */
+typedef struct metric_cell {
+  guint64 count;
+  guint64 sum;
+  guint64 max;
+  guint64 buckets[UA_METRICS_NR_BUCKETS];
+} metric_cell_t;
+
+/* the accumulators of all the metrics updated by one thread. Only that thread
+ * writes them, 'seq' is odd while it does so that the readers can retry rather
+ * than sum up a torn update. */
+typedef struct metric_shard {
+  gint seq;
+  metric_cell_t cells[UA_METRICS_MAX];
+} metric_shard_t;
+
+struct ua_metric {
+  gchar *name;
+  ua_metric_type_t type;
+  /* the index of the cells in the shards */
+  guint index;
+  /* the value of a gauge */
+  gint value;
+};
+
+static const guint64 bucket_bounds[UA_METRICS_NR_BUCKETS] = {
+  100, 1000, 5000, 10000, 50000, 100000, 500000, G_MAXUINT64
+};
+
+static void
+release_shard(gpointer data);
+
+static GPrivate current_shard = G_PRIVATE_INIT(release_shard);
+
+static struct {
+  GMutex lock;
+  ua_metric_t metrics[UA_METRICS_MAX];
+  /* only grows until ua_metrics_clear(), can be read without the lock */
+  gint size;
+  /* name -> ua_metric_t */
+  GHashTable *names;
+  /* all the shards, the ones of the exited threads are also in 'idle' */
+  GSList *shards;
+  GSList *idle;
+} registry;
+
+/* called when a thread exits, its counts still add up to the totals so the
+ * shard is handed over to the next thread rather than freed */
+static void
+release_shard(gpointer data)
+{
+  g_mutex_lock(&registry.lock);
+  /* the shard is gone if the registry was cleared meanwhile */
+  if (g_slist_find(registry.shards, data) != NULL) {
+    registry.idle = g_slist_prepend(registry.idle, data);
+  }
+  g_mutex_unlock(&registry.lock);
+}
+
+static metric_shard_t *
+get_shard(void)
+{
+  metric_shard_t *shard = g_private_get(&current_shard);
+
+  if (G_LIKELY(shard != NULL)) {
+    return shard;
+  }
+
+  g_mutex_lock(&registry.lock);
+  if (registry.idle != NULL) {
+    shard = registry.idle->data;
+    registry.idle = g_slist_delete_link(registry.idle, registry.idle);
+  } else {
+    shard = g_new0(metric_shard_t, 1);
+    registry.shards = g_slist_prepend(registry.shards, shard);
+  }
+  g_mutex_unlock(&registry.lock);
+
+  g_private_set(&current_shard, shard);
+
+  return shard;
+}
+
+/* takes a consistent copy of the cell 'index' of a shard */
+static void
+read_cell(metric_shard_t *shard, guint index, metric_cell_t *cell)
+{
+  gint seq;
+
+  g_assert(shard != NULL);
+  g_assert(index < UA_METRICS_MAX);
+  g_assert(cell != NULL);
+
+  for (;;) {
+    seq = g_atomic_int_get(&shard->seq);
+    if ((seq & 1) == 0) {
+      *cell = shard->cells[index];
+      /* a full barrier as well, fails if the owner has started an update
+       * since 'seq' was read */
+      if (g_atomic_int_compare_and_exchange(&shard->seq, seq, seq)) {
+        return;
+      }
+    }
+    g_thread_yield();
+  }
+}
+
+ua_metric_t *
+ua_metrics_get(ua_metric_type_t type, const gchar *name)
+{
+  ua_metric_t *metric;
+
+  g_return_val_if_fail(name != NULL, NULL);
+
+  g_mutex_lock(&registry.lock);
+
+  if (registry.names == NULL) {
+    registry.names = g_hash_table_new(g_str_hash, g_str_equal);
+  }
+
+  metric = g_hash_table_lookup(registry.names, name);
+  if (metric != NULL) {
+    if (metric->type != type) {
+      metric = NULL;
+    }
+  } else if (registry.size < UA_METRICS_MAX) {
+    metric = &registry.metrics[registry.size];
+    metric->name = g_strdup(name);
+    metric->type = type;
+    metric->index = (guint) registry.size;
+    g_hash_table_insert(registry.names, metric->name, metric);
+    /* publish the metric to the lock-free readers */
+    g_atomic_int_set(&registry.size, registry.size + 1);
+  }
+
+  g_mutex_unlock(&registry.lock);
+
+  return metric;
+}
+
+ua_metric_t *
+ua_metrics_get_cached(ua_metric_t **cache,
+                      ua_metric_type_t type,
+                      const gchar *name)
+{
+  ua_metric_t *metric;
+
+  g_return_val_if_fail(cache != NULL, NULL);
+
+  metric = g_atomic_pointer_get(cache);
+  if (G_LIKELY(metric != NULL)) {
+    return metric;
+  }
+
+  /* racing threads get the same metric */
+  metric = ua_metrics_get(type, name);
+  g_atomic_pointer_set(cache, metric);
+
+  return metric;
+}
+
+guint
+ua_metrics_get_size(void)
+{
+  return (guint) g_atomic_int_get(&registry.size);
+}
+
+ua_metric_t *
+ua_metrics_get_nth(guint n)
+{
+  g_return_val_if_fail(n < ua_metrics_get_size(), NULL);
+
+  return &registry.metrics[n];
+}
+
+const gchar *
+ua_metric_get_name(const ua_metric_t *metric)
+{
+  g_return_val_if_fail(metric != NULL, NULL);
+
+  return metric->name;
+}
+
+ua_metric_type_t
+ua_metric_get_type(const ua_metric_t *metric)
+{
+  g_return_val_if_fail(metric != NULL, UA_METRIC_COUNTER);
+
+  return metric->type;
+}
+
+void
+ua_metric_add(ua_metric_t *metric, guint64 n)
+{
+  metric_shard_t *shard;
+
+  if (metric == NULL) {
+    return;
+  }
+  g_return_if_fail(metric->type == UA_METRIC_COUNTER);
+
+  shard = get_shard();
+  g_atomic_int_inc(&shard->seq);
+  shard->cells[metric->index].count += n;
+  g_atomic_int_inc(&shard->seq);
+}
+
+void
+ua_metric_observe(ua_metric_t *metric, guint64 usec)
+{
+  metric_shard_t *shard;
+  metric_cell_t *cell;
+  guint bucket = 0;
+
+  if (metric == NULL) {
+    return;
+  }
+  g_return_if_fail(metric->type == UA_METRIC_TIMING);
+
+  while (usec > bucket_bounds[bucket]) {
+    bucket++;
+  }
+
+  shard = get_shard();
+  cell = &shard->cells[metric->index];
+  g_atomic_int_inc(&shard->seq);
+  cell->count++;
+  cell->sum += usec;
+  cell->max = MAX(cell->max, usec);
+  cell->buckets[bucket]++;
+  g_atomic_int_inc(&shard->seq);
+}
+
+void
+ua_metric_observe_since(ua_metric_t *metric, gint64 start)
+{
+  gint64 elapsed;
+
+  if (metric == NULL) {
+    return;
+  }
+
+  elapsed = g_get_monotonic_time() - start;
+  ua_metric_observe(metric, (guint64) MAX(elapsed, 0));
+}
+
+void
+ua_metric_set(ua_metric_t *metric, gint value)
+{
+  if (metric == NULL) {
+    return;
+  }
+  g_return_if_fail(metric->type == UA_METRIC_GAUGE);
+
+  g_atomic_int_set(&metric->value, value);
+}
+
+void
+ua_metric_adjust(ua_metric_t *metric, gint delta)
+{
+  if (metric == NULL) {
+    return;
+  }
+  g_return_if_fail(metric->type == UA_METRIC_GAUGE);
+
+  (void) g_atomic_int_add(&metric->value, delta);
+}
+
+void
+ua_metric_read(const ua_metric_t *metric, ua_metric_value_t *value)
+{
+  metric_cell_t cell;
+
+  g_return_if_fail(metric != NULL);
+  g_return_if_fail(value != NULL);
+
+  memset(value, 0, sizeof(*value));
+
+  if (metric->type == UA_METRIC_GAUGE) {
+    value->value = g_atomic_int_get(&metric->value);
+    return;
+  }
+
+  g_mutex_lock(&registry.lock);
+  for (GSList *l = registry.shards; l != NULL; l = l->next) {
+    read_cell(l->data, metric->index, &cell);
+    value->count += cell.count;
+    value->sum += cell.sum;
+    value->max = MAX(value->max, cell.max);
+    for (guint i = 0; i < UA_METRICS_NR_BUCKETS; i++) {
+      value->buckets[i] += cell.buckets[i];
+    }
+  }
+  g_mutex_unlock(&registry.lock);
+}
+
+const guint64 *
+ua_metrics_get_bucket_bounds(void)
+{
+  return bucket_bounds;
+}
+
+void
+ua_metrics_clear(void)
+{
+  g_mutex_lock(&registry.lock);
+  for (gint i = 0; i < registry.size; i++) {
+    g_free(registry.metrics[i].name);
+  }
+  memset(registry.metrics, 0, sizeof(registry.metrics));
+  registry.size = 0;
+  g_clear_pointer(&registry.names, g_hash_table_destroy);
+  g_slist_free_full(registry.shards, g_free);
+  registry.shards = NULL;
+  g_clear_pointer(&registry.idle, g_slist_free);
+  g_mutex_unlock(&registry.lock);
+
+  /* the calling thread may register new metrics afterwards */
+  g_private_set(&current_shard, NULL);
+}
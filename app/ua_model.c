@@ -0,0 +1,316 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2025 Axis Communications AB
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <glib.h>
+#include <open62541/server.h>
+
+#include "error.h"
+#include "ua_model.h"
+#include "ua_utils.h"
+
+DEFINE_GQUARK("ua-model")
+
+static UA_NodeId
+model_node_id(const ua_model_id_t *id, UA_UInt16 ns)
+{
+  g_assert(id != NULL);
+
+  return UA_NODEID_NUMERIC(id->local ? ns : 0, id->id);
+}
+
+static UA_QualifiedName
+model_browse_name(const ua_model_node_t *node, UA_UInt16 ns)
+{
+  g_assert(node != NULL);
+
+  return UA_QUALIFIEDNAME(node->browse_ns0 ? 0 : ns,
+                          (char *) node->browse_name);
+}
+
+static UA_StatusCode
+add_object(UA_Server *server, const ua_model_node_t *node, UA_UInt16 ns)
+{
+  UA_ObjectAttributes attr = UA_ObjectAttributes_default;
+
+  g_assert(server != NULL);
+  g_assert(node != NULL);
+
+  attr.displayName = UA_LOCALIZEDTEXT("", (char *) node->display_name);
+  if (node->description != NULL) {
+    attr.description = UA_LOCALIZEDTEXT("", (char *) node->description);
+  }
+  attr.eventNotifier = node->event_notifier;
+
+  return UA_Server_addObjectNode(
+          server,
+          model_node_id(&node->id, ns),
+          model_node_id(&node->parent, ns),
+          model_node_id(&node->reference_type, ns),
+          model_browse_name(node, ns),
+          model_node_id(&node->type_definition, ns),
+          attr,
+          NULL,
+          NULL);
+}
+
+static UA_StatusCode
+add_variable(UA_Server *server, const ua_model_node_t *node, UA_UInt16 ns)
+{
+  UA_VariableAttributes attr = UA_VariableAttributes_default;
+  UA_LocalizedText texts[UA_MODEL_MAX_ENUM_STRINGS];
+  UA_UInt32 array_dimensions[1];
+
+  g_assert(server != NULL);
+  g_assert(node != NULL);
+  g_assert(node->nr_enum_strings <= UA_MODEL_MAX_ENUM_STRINGS);
+
+  attr.displayName = UA_LOCALIZEDTEXT("", (char *) node->display_name);
+  if (node->description != NULL) {
+    attr.description = UA_LOCALIZEDTEXT("", (char *) node->description);
+  }
+  attr.dataType = model_node_id(&node->data_type, ns);
+  attr.accessLevel = node->access_level;
+  if (node->user_access_level != 0) {
+    attr.userAccessLevel = node->user_access_level;
+  }
+  attr.valueRank = node->value_rank;
+  if (node->array_length > 0) {
+    array_dimensions[0] = node->array_length;
+    attr.arrayDimensionsSize = 1;
+    attr.arrayDimensions = array_dimensions;
+  }
+
+  /* the server copies the value, it is built on the stack */
+  if (node->enum_strings != NULL) {
+    for (guint i = 0; i < node->nr_enum_strings; i++) {
+      texts[i] = UA_LOCALIZEDTEXT("", (char *) node->enum_strings[i]);
+    }
+    UA_Variant_setArray(&attr.value,
+                        texts,
+                        node->nr_enum_strings,
+                        &UA_TYPES[UA_TYPES_LOCALIZEDTEXT]);
+  }
+
+  return UA_Server_addVariableNode(
+          server,
+          model_node_id(&node->id, ns),
+          model_node_id(&node->parent, ns),
+          model_node_id(&node->reference_type, ns),
+          model_browse_name(node, ns),
+          model_node_id(&node->type_definition, ns),
+          attr,
+          NULL,
+          NULL);
+}
+
+static UA_StatusCode
+add_object_type(UA_Server *server, const ua_model_node_t *node, UA_UInt16 ns)
+{
+  UA_ObjectTypeAttributes attr = UA_ObjectTypeAttributes_default;
+
+  g_assert(server != NULL);
+  g_assert(node != NULL);
+
+  attr.displayName = UA_LOCALIZEDTEXT("", (char *) node->display_name);
+  if (node->description != NULL) {
+    attr.description = UA_LOCALIZEDTEXT("", (char *) node->description);
+  }
+  attr.isAbstract = node->is_abstract;
+
+  return UA_Server_addObjectTypeNode(
+          server,
+          model_node_id(&node->id, ns),
+          model_node_id(&node->parent, ns),
+          model_node_id(&node->reference_type, ns),
+          model_browse_name(node, ns),
+          attr,
+          NULL,
+          NULL);
+}
+
+static UA_StatusCode
+add_data_type(UA_Server *server, const ua_model_node_t *node, UA_UInt16 ns)
+{
+  UA_DataTypeAttributes attr = UA_DataTypeAttributes_default;
+
+  g_assert(server != NULL);
+  g_assert(node != NULL);
+
+  attr.displayName = UA_LOCALIZEDTEXT("", (char *) node->display_name);
+  if (node->description != NULL) {
+    attr.description = UA_LOCALIZEDTEXT("", (char *) node->description);
+  }
+  attr.isAbstract = node->is_abstract;
+
+  return UA_Server_addDataTypeNode(
+          server,
+          model_node_id(&node->id, ns),
+          model_node_id(&node->parent, ns),
+          model_node_id(&node->reference_type, ns),
+          model_browse_name(node, ns),
+          attr,
+          NULL,
+          NULL);
+}
+
+static UA_StatusCode
+add_model_node(UA_Server *server, const ua_model_node_t *node, UA_UInt16 ns)
+{
+  g_assert(server != NULL);
+  g_assert(node != NULL);
+
+  switch (node->node_class) {
+  case UA_NODECLASS_OBJECT:
+    return add_object(server, node, ns);
+  case UA_NODECLASS_VARIABLE:
+    return add_variable(server, node, ns);
+  case UA_NODECLASS_OBJECTTYPE:
+    return add_object_type(server, node, ns);
+  case UA_NODECLASS_DATATYPE:
+    return add_data_type(server, node, ns);
+  default:
+    return UA_STATUSCODE_BADNODECLASSINVALID;
+  }
+}
+
+/* registers the custom data types of the model with the server, the previous
+ * ones are restored by the rollback */
+static void
+register_types(UA_Server *server,
+               const ua_model_t *model,
+               UA_UInt16 ns,
+               rollback_data_t *rbd)
+{
+  UA_ServerConfig *config;
+
+  g_assert(server != NULL);
+  g_assert(model != NULL);
+  g_assert(rbd != NULL);
+
+  for (guint i = 0; i < model->nr_types; i++) {
+    model->types[i].typeId.namespaceIndex = ns;
+    model->types[i].binaryEncodingId.namespaceIndex = ns;
+  }
+
+  config = UA_Server_getConfig(server);
+  model->type_array->next = config->customDataTypes;
+  rbd->saved_cdt = config->customDataTypes;
+  config->customDataTypes = model->type_array;
+}
+
+gboolean
+ua_model_load(UA_Server *server,
+              const ua_model_t *model,
+              rollback_data_t *rbd,
+              GError **err)
+{
+  UA_StatusCode status;
+  UA_UInt16 ns;
+
+  g_return_val_if_fail(server != NULL, FALSE);
+  g_return_val_if_fail(model != NULL, FALSE);
+  g_return_val_if_fail(model->namespace_uri != NULL, FALSE);
+  g_return_val_if_fail(rbd != NULL, FALSE);
+  g_return_val_if_fail(rbd->model == NULL, FALSE);
+  g_return_val_if_fail(err == NULL || *err == NULL, FALSE);
+
+  ns = UA_Server_addNamespace(server, model->namespace_uri);
+
+  if (model->nr_types > 0) {
+    register_types(server, model, ns, rbd);
+  }
+
+  /* from now on the rollback deletes whatever nodes of the model got added */
+  rbd->model = model;
+  rbd->model_ns = ns;
+
+  for (guint i = 0; i < model->nr_nodes; i++) {
+    status = add_model_node(server, &model->nodes[i], ns);
+    if (status != UA_STATUSCODE_GOOD) {
+      SET_ERROR(err,
+                -1,
+                "Failed to add node %s (ns=%u;i=%u): %s",
+                model->nodes[i].browse_name,
+                ns,
+                model->nodes[i].id.id,
+                UA_StatusCode_name(status));
+      return FALSE;
+    }
+  }
+
+  for (guint i = 0; i < model->nr_references; i++) {
+    const ua_model_reference_t *ref = &model->references[i];
+
+    status = UA_Server_addReference(
+            server,
+            model_node_id(&ref->source, ns),
+            model_node_id(&ref->reference_type, ns),
+            UA_EXPANDEDNODEID_NUMERIC(ref->target.local ? ns : 0,
+                                      ref->target.id),
+            ref->is_forward);
+    if (status != UA_STATUSCODE_GOOD) {
+      SET_ERROR(err,
+                -1,
+                "Failed to add reference from node i=%u to node i=%u: %s",
+                ref->source.id,
+                ref->target.id,
+                UA_StatusCode_name(status));
+      return FALSE;
+    }
+  }
+
+  return TRUE;
+}
+
+gboolean
+ua_model_remove(UA_Server *server,
+                const ua_model_t *model,
+                UA_UInt16 ns,
+                GError **err)
+{
+  UA_StatusCode status;
+
+  g_return_val_if_fail(server != NULL, FALSE);
+  g_return_val_if_fail(model != NULL, FALSE);
+  g_return_val_if_fail(err == NULL || *err == NULL, FALSE);
+
+  /* the children go first, a deleted parent may already have taken them */
+  for (guint i = model->nr_nodes; i > 0; i--) {
+    const ua_model_node_t *node = &model->nodes[i - 1];
+
+    status = UA_Server_deleteNode(server, model_node_id(&node->id, ns), TRUE);
+    if (status != UA_STATUSCODE_GOOD &&
+        status != UA_STATUSCODE_BADNODEIDUNKNOWN) {
+      SET_ERROR(err,
+                -1,
+                "Failed to delete node %s: %s",
+                node->browse_name,
+                UA_StatusCode_name(status));
+      return FALSE;
+    }
+  }
+
+  return TRUE;
+}
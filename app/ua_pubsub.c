@@ -0,0 +1,434 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2025 Axis Communications AB
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <glib.h>
+#include <open62541/server.h>
+#include <string.h>
+
+#ifdef UA_ENABLE_PUBSUB
+#include <open62541/server_pubsub.h>
+#endif
+
+#include "error.h"
+#include "ua_pubsub.h"
+
+DEFINE_GQUARK("ua-pubsub")
+
+#ifdef UA_ENABLE_PUBSUB
+
+#define PUBSUB_TRANSPORT_UDP_UADP                                              \
+  "http://opcfoundation.org/UA-Profile/Transport/pubsub-udp-uadp"
+#define PUBSUB_WRITER_GROUP_ID   1
+#define PUBSUB_DATASET_WRITER_ID 1
+/* a key frame carrying all the fields every this many messages */
+#define PUBSUB_KEY_FRAME_COUNT 10
+
+/* a field of the DataSet and the variable it publishes */
+typedef struct published_field {
+  UA_NodeId variable;
+  UA_NodeId field;
+} published_field_t;
+
+/* the PubSub components of the server, only accessed from the server thread
+ * or with an exclusive access to the server */
+static struct {
+  gboolean started;
+  UA_NodeId connection;
+  UA_NodeId dataset;
+  UA_NodeId writer_group;
+  UA_NodeId writer;
+  /* published_field_t of the DataSet */
+  GArray *fields;
+} pubsub;
+
+static void
+clear_published_field(gpointer data)
+{
+  published_field_t *field = data;
+
+  g_assert(field != NULL);
+
+  UA_NodeId_clear(&field->variable);
+  UA_NodeId_clear(&field->field);
+}
+
+/* removes the components added so far, the writer group and its writer are
+ * removed along with the connection */
+static void
+remove_pubsub(UA_Server *server)
+{
+  g_assert(server != NULL);
+
+  if (!UA_NodeId_isNull(&pubsub.connection)) {
+    (void) UA_Server_removePubSubConnection(server, pubsub.connection);
+  }
+  if (!UA_NodeId_isNull(&pubsub.dataset)) {
+    (void) UA_Server_removePublishedDataSet(server, pubsub.dataset);
+  }
+
+  UA_NodeId_clear(&pubsub.connection);
+  UA_NodeId_clear(&pubsub.dataset);
+  UA_NodeId_clear(&pubsub.writer_group);
+  UA_NodeId_clear(&pubsub.writer);
+  g_clear_pointer(&pubsub.fields, g_array_unref);
+  pubsub.started = FALSE;
+}
+
+static gboolean
+add_connection(UA_Server *server,
+               const gchar *address,
+               UA_UInt16 publisher_id,
+               GError **err)
+{
+  UA_PubSubConnectionConfig config;
+  UA_NetworkAddressUrlDataType url;
+  UA_StatusCode status;
+
+  g_assert(server != NULL);
+  g_assert(address != NULL);
+  g_assert(err == NULL || *err == NULL);
+
+  /* the default network interface joins the multicast group */
+  memset(&url, 0, sizeof(url));
+  url.url = UA_STRING((gchar *) address);
+
+  memset(&config, 0, sizeof(config));
+  config.name = UA_STRING("Axis OPC-UA Publisher");
+  config.transportProfileUri = UA_STRING(PUBSUB_TRANSPORT_UDP_UADP);
+  UA_Variant_setScalar(&config.address,
+                       &url,
+                       &UA_TYPES[UA_TYPES_NETWORKADDRESSURLDATATYPE]);
+  config.publisherId.idType = UA_PUBLISHERIDTYPE_UINT16;
+  config.publisherId.id.uint16 = publisher_id;
+
+  status = UA_Server_addPubSubConnection(server, &config, &pubsub.connection);
+  if (status != UA_STATUSCODE_GOOD) {
+    SET_ERROR(err,
+              -1,
+              "UA_Server_addPubSubConnection(%s) failed: %s",
+              address,
+              UA_StatusCode_name(status));
+    return FALSE;
+  }
+
+  return TRUE;
+}
+
+static gboolean
+add_dataset(UA_Server *server, GError **err)
+{
+  UA_PublishedDataSetConfig config;
+  UA_AddPublishedDataSetResult result;
+
+  g_assert(server != NULL);
+  g_assert(err == NULL || *err == NULL);
+
+  memset(&config, 0, sizeof(config));
+  config.publishedDataSetType = UA_PUBSUB_DATASET_PUBLISHEDITEMS;
+  config.name = UA_STRING("Axis Device");
+
+  result = UA_Server_addPublishedDataSet(server, &config, &pubsub.dataset);
+  if (result.addResult != UA_STATUSCODE_GOOD) {
+    SET_ERROR(err,
+              -1,
+              "UA_Server_addPublishedDataSet() failed: %s",
+              UA_StatusCode_name(result.addResult));
+    return FALSE;
+  }
+
+  return TRUE;
+}
+
+static gboolean
+add_writer(UA_Server *server, guint interval, GError **err)
+{
+  UA_WriterGroupConfig group;
+  UA_UadpWriterGroupMessageDataType message;
+  UA_UInt32 mask;
+  UA_DataSetWriterConfig writer;
+  UA_StatusCode status;
+
+  g_assert(server != NULL);
+  g_assert(err == NULL || *err == NULL);
+
+  /* the subscribers pick the messages by PublisherId and WriterGroupId */
+  UA_UadpWriterGroupMessageDataType_init(&message);
+  mask = UA_UADPNETWORKMESSAGECONTENTMASK_PUBLISHERID |
+         UA_UADPNETWORKMESSAGECONTENTMASK_GROUPHEADER |
+         UA_UADPNETWORKMESSAGECONTENTMASK_WRITERGROUPID |
+         UA_UADPNETWORKMESSAGECONTENTMASK_PAYLOADHEADER;
+  message.networkMessageContentMask = (UA_UadpNetworkMessageContentMask) mask;
+
+  memset(&group, 0, sizeof(group));
+  group.name = UA_STRING("Axis Writer Group");
+  group.publishingInterval = interval;
+  group.writerGroupId = PUBSUB_WRITER_GROUP_ID;
+  group.encodingMimeType = UA_PUBSUB_ENCODING_UADP;
+  UA_ExtensionObject_setValueNoDelete(
+          &group.messageSettings,
+          &message,
+          &UA_TYPES[UA_TYPES_UADPWRITERGROUPMESSAGEDATATYPE]);
+
+  status = UA_Server_addWriterGroup(server,
+                                    pubsub.connection,
+                                    &group,
+                                    &pubsub.writer_group);
+  if (status != UA_STATUSCODE_GOOD) {
+    SET_ERROR(err,
+              -1,
+              "UA_Server_addWriterGroup() failed: %s",
+              UA_StatusCode_name(status));
+    return FALSE;
+  }
+
+  memset(&writer, 0, sizeof(writer));
+  writer.name = UA_STRING("Axis DataSet Writer");
+  writer.dataSetWriterId = PUBSUB_DATASET_WRITER_ID;
+  writer.keyFrameCount = PUBSUB_KEY_FRAME_COUNT;
+
+  status = UA_Server_addDataSetWriter(server,
+                                      pubsub.writer_group,
+                                      pubsub.dataset,
+                                      &writer,
+                                      &pubsub.writer);
+  if (status != UA_STATUSCODE_GOOD) {
+    SET_ERROR(err,
+              -1,
+              "UA_Server_addDataSetWriter() failed: %s",
+              UA_StatusCode_name(status));
+    return FALSE;
+  }
+
+  return TRUE;
+}
+
+gboolean
+ua_pubsub_start(UA_Server *server,
+                const gchar *address,
+                UA_UInt16 publisher_id,
+                guint interval,
+                GError **err)
+{
+  UA_StatusCode status;
+
+  g_return_val_if_fail(server != NULL, FALSE);
+  g_return_val_if_fail(address != NULL, FALSE);
+  g_return_val_if_fail(interval > 0, FALSE);
+  g_return_val_if_fail(!pubsub.started, FALSE);
+  g_return_val_if_fail(err == NULL || *err == NULL, FALSE);
+
+  if (!add_connection(server, address, publisher_id, err)) {
+    g_prefix_error(err, "add_connection() failed: ");
+    goto err_out;
+  }
+
+  if (!add_dataset(server, err)) {
+    g_prefix_error(err, "add_dataset() failed: ");
+    goto err_out;
+  }
+
+  if (!add_writer(server, interval, err)) {
+    g_prefix_error(err, "add_writer() failed: ");
+    goto err_out;
+  }
+
+  status = UA_Server_enableWriterGroup(server, pubsub.writer_group);
+  if (status != UA_STATUSCODE_GOOD) {
+    SET_ERROR(err,
+              -1,
+              "UA_Server_enableWriterGroup() failed: %s",
+              UA_StatusCode_name(status));
+    goto err_out;
+  }
+
+  pubsub.fields = g_array_new(FALSE, FALSE, sizeof(published_field_t));
+  g_array_set_clear_func(pubsub.fields, clear_published_field);
+  pubsub.started = TRUE;
+
+  return TRUE;
+
+err_out:
+  remove_pubsub(server);
+
+  return FALSE;
+}
+
+gboolean
+ua_pubsub_publish(UA_Server *server,
+                  const UA_NodeId *variable,
+                  const gchar *alias,
+                  GError **err)
+{
+  UA_DataSetFieldConfig field;
+  UA_DataSetFieldResult result;
+  published_field_t published;
+  UA_StatusCode status;
+
+  g_return_val_if_fail(server != NULL, FALSE);
+  g_return_val_if_fail(variable != NULL, FALSE);
+  g_return_val_if_fail(alias != NULL, FALSE);
+  g_return_val_if_fail(err == NULL || *err == NULL, FALSE);
+
+  if (!pubsub.started) {
+    return TRUE;
+  }
+
+  UA_NodeId_init(&published.field);
+
+  memset(&field, 0, sizeof(field));
+  field.dataSetFieldType = UA_PUBSUB_DATASETFIELD_VARIABLE;
+  field.field.variable.fieldNameAlias = UA_STRING((gchar *) alias);
+  field.field.variable.publishParameters.publishedVariable = *variable;
+  field.field.variable.publishParameters.attributeId = UA_ATTRIBUTEID_VALUE;
+
+  /* the DataSetMetaData sent by the writer is only updated while its group
+   * isn't operational */
+  (void) UA_Server_disableWriterGroup(server, pubsub.writer_group);
+  result = UA_Server_addDataSetField(server,
+                                     pubsub.dataset,
+                                     &field,
+                                     &published.field);
+  status = UA_Server_enableWriterGroup(server, pubsub.writer_group);
+
+  if (result.result != UA_STATUSCODE_GOOD) {
+    SET_ERROR(err,
+              -1,
+              "UA_Server_addDataSetField(%s) failed: %s",
+              alias,
+              UA_StatusCode_name(result.result));
+    return FALSE;
+  }
+
+  /* kept to stop publishing it with ua_pubsub_unpublish() */
+  (void) UA_NodeId_copy(variable, &published.variable);
+  g_array_append_val(pubsub.fields, published);
+
+  if (status != UA_STATUSCODE_GOOD) {
+    SET_ERROR(err,
+              -1,
+              "UA_Server_enableWriterGroup() failed: %s",
+              UA_StatusCode_name(status));
+    return FALSE;
+  }
+
+  return TRUE;
+}
+
+gboolean
+ua_pubsub_unpublish(UA_Server *server, UA_UInt16 ns, GError **err)
+{
+  UA_DataSetFieldResult result;
+  UA_StatusCode status;
+  gboolean ret = TRUE;
+
+  g_return_val_if_fail(server != NULL, FALSE);
+  g_return_val_if_fail(err == NULL || *err == NULL, FALSE);
+
+  if (!pubsub.started) {
+    return TRUE;
+  }
+
+  (void) UA_Server_disableWriterGroup(server, pubsub.writer_group);
+  for (guint i = pubsub.fields->len; i > 0; i--) {
+    published_field_t *published =
+            &g_array_index(pubsub.fields, published_field_t, i - 1);
+
+    if (published->variable.namespaceIndex != ns) {
+      continue;
+    }
+
+    result = UA_Server_removeDataSetField(server, published->field);
+    if (result.result != UA_STATUSCODE_GOOD) {
+      /* the other fields are still removed, only the first error is kept */
+      if (ret) {
+        SET_ERROR(err,
+                  -1,
+                  "UA_Server_removeDataSetField() failed: %s",
+                  UA_StatusCode_name(result.result));
+        ret = FALSE;
+      }
+      continue;
+    }
+    g_array_remove_index(pubsub.fields, i - 1);
+  }
+  status = UA_Server_enableWriterGroup(server, pubsub.writer_group);
+
+  if (ret && status != UA_STATUSCODE_GOOD) {
+    SET_ERROR(err,
+              -1,
+              "UA_Server_enableWriterGroup() failed: %s",
+              UA_StatusCode_name(status));
+    ret = FALSE;
+  }
+
+  return ret;
+}
+
+#else /* UA_ENABLE_PUBSUB */
+
+gboolean
+ua_pubsub_start(UA_Server *server,
+                const gchar *address,
+                G_GNUC_UNUSED UA_UInt16 publisher_id,
+                guint interval,
+                GError **err)
+{
+  g_return_val_if_fail(server != NULL, FALSE);
+  g_return_val_if_fail(address != NULL, FALSE);
+  g_return_val_if_fail(interval > 0, FALSE);
+  g_return_val_if_fail(err == NULL || *err == NULL, FALSE);
+
+  SET_ERROR(err, -1, "open62541 is built without PubSub");
+
+  return FALSE;
+}
+
+gboolean
+ua_pubsub_publish(UA_Server *server,
+                  const UA_NodeId *variable,
+                  const gchar *alias,
+                  GError **err)
+{
+  g_return_val_if_fail(server != NULL, FALSE);
+  g_return_val_if_fail(variable != NULL, FALSE);
+  g_return_val_if_fail(alias != NULL, FALSE);
+  g_return_val_if_fail(err == NULL || *err == NULL, FALSE);
+
+  /* nothing is published */
+  return TRUE;
+}
+
+gboolean
+ua_pubsub_unpublish(UA_Server *server,
+                    G_GNUC_UNUSED UA_UInt16 ns,
+                    GError **err)
+{
+  g_return_val_if_fail(server != NULL, FALSE);
+  g_return_val_if_fail(err == NULL || *err == NULL, FALSE);
+
+  return TRUE;
+}
+
+#endif /* UA_ENABLE_PUBSUB */
@@ -0,0 +1,266 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2025 Axis Communications AB
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <glib.h>
+
+#include "error.h"
+#include "ua_memory.h"
+#include "ua_queue.h"
+
+DEFINE_GQUARK("ua-queue")
+
+/* a slot of the ring, 'sequence' tells whether it is free for the producer at
+ * position 'sequence' or holds the command of position 'sequence - 1' */
+typedef struct ua_cell {
+  gint sequence;
+  ua_queue_func_t func;
+  gpointer data;
+  GDestroyNotify destroy;
+  /* the memory owner of the producer, see ua_memory_set_owner() */
+  guint owner;
+} ua_cell_t;
+
+/* bounded multi-producer single-consumer ring, producers claim a position with
+ * a compare-and-exchange and publish the cell through its sequence number. The
+ * positions are free running and wrap around. */
+struct ua_queue {
+  ua_cell_t *cells;
+  guint mask;
+  /* next position claimed by a producer */
+  gint enqueue_pos;
+  /* next position run by the consumer, only accessed by the consumer */
+  guint dequeue_pos;
+  /* set once by ua_queue_close() */
+  gint closed;
+  /* set by the producer making the ring non-empty, cleared by the consumer */
+  gint signalled;
+  GMutex notify_lock;
+  ua_queue_notify_t notify;
+  gpointer notify_data;
+};
+
+/* takes the command at the head of the ring, FALSE if there is none */
+static gboolean
+pop_cell(ua_queue_t *queue, ua_cell_t *out)
+{
+  ua_cell_t *cell;
+  guint pos;
+  gint dif;
+
+  g_assert(queue != NULL);
+  g_assert(out != NULL);
+
+  pos = queue->dequeue_pos;
+  cell = &queue->cells[pos & queue->mask];
+  dif = (gint) ((guint) g_atomic_int_get(&cell->sequence) - (pos + 1));
+  if (dif < 0) {
+    return FALSE;
+  }
+
+  *out = *cell;
+  /* hand the cell over to the producer one lap ahead */
+  g_atomic_int_set(&cell->sequence, (gint) (pos + queue->mask + 1));
+  queue->dequeue_pos = pos + 1;
+
+  return TRUE;
+}
+
+/* wakes the consumer up, unless another producer did since it last began to
+ * drain the ring */
+static void
+signal_consumer(ua_queue_t *queue)
+{
+  g_assert(queue != NULL);
+
+  if (!g_atomic_int_compare_and_exchange(&queue->signalled, FALSE, TRUE)) {
+    return;
+  }
+
+  g_mutex_lock(&queue->notify_lock);
+  if (queue->notify != NULL && !queue->notify(queue->notify_data)) {
+    g_atomic_int_set(&queue->signalled, FALSE);
+  }
+  g_mutex_unlock(&queue->notify_lock);
+}
+
+ua_queue_t *
+ua_queue_new(guint capacity)
+{
+  ua_queue_t *queue;
+  guint size = 1;
+
+  g_return_val_if_fail(capacity > 0 && capacity <= G_MAXINT / 2, NULL);
+
+  while (size < capacity) {
+    size <<= 1;
+  }
+
+  queue = g_new0(ua_queue_t, 1);
+  queue->cells = g_new0(ua_cell_t, size);
+  queue->mask = size - 1;
+  g_mutex_init(&queue->notify_lock);
+  for (guint i = 0; i < size; i++) {
+    queue->cells[i].sequence = (gint) i;
+  }
+
+  return queue;
+}
+
+void
+ua_queue_set_notify(ua_queue_t *queue,
+                    ua_queue_notify_t notify,
+                    gpointer user_data)
+{
+  g_return_if_fail(queue != NULL);
+
+  g_mutex_lock(&queue->notify_lock);
+  queue->notify = notify;
+  queue->notify_data = user_data;
+  /* the commands pushed so far have signalled nobody */
+  g_atomic_int_set(&queue->signalled, notify != NULL && notify(user_data));
+  g_mutex_unlock(&queue->notify_lock);
+}
+
+void
+ua_queue_close(ua_queue_t *queue)
+{
+  ua_cell_t cell;
+
+  g_return_if_fail(queue != NULL);
+
+  g_atomic_int_set(&queue->closed, TRUE);
+
+  /* the server thread is gone, the caller is the consumer from now on */
+  while (pop_cell(queue, &cell)) {
+    if (cell.destroy != NULL) {
+      cell.destroy(cell.data);
+    }
+  }
+}
+
+void
+ua_queue_free(ua_queue_t *queue)
+{
+  if (queue == NULL) {
+    return;
+  }
+
+  ua_queue_close(queue);
+  g_mutex_clear(&queue->notify_lock);
+  g_free(queue->cells);
+  g_free(queue);
+}
+
+gboolean
+ua_queue_push(ua_queue_t *queue,
+              ua_queue_func_t func,
+              gpointer data,
+              GDestroyNotify destroy,
+              GError **err)
+{
+  ua_cell_t *cell;
+  guint pos;
+  gint dif;
+
+  g_return_val_if_fail(queue != NULL, FALSE);
+  g_return_val_if_fail(func != NULL, FALSE);
+  g_return_val_if_fail(err == NULL || *err == NULL, FALSE);
+
+  if (g_atomic_int_get(&queue->closed)) {
+    SET_ERROR(err, -1, "The queue is closed");
+    return FALSE;
+  }
+
+  pos = (guint) g_atomic_int_get(&queue->enqueue_pos);
+  for (;;) {
+    cell = &queue->cells[pos & queue->mask];
+    dif = (gint) ((guint) g_atomic_int_get(&cell->sequence) - pos);
+
+    if (dif == 0) {
+      /* the cell is free, try to claim its position */
+      if (g_atomic_int_compare_and_exchange(&queue->enqueue_pos,
+                                            (gint) pos,
+                                            (gint) (pos + 1))) {
+        break;
+      }
+    } else if (dif < 0) {
+      /* the consumer hasn't taken the command of the previous lap yet */
+      SET_ERROR(err, -1, "The queue is full (%u commands)", queue->mask + 1);
+      return FALSE;
+    }
+
+    /* another producer claimed the position, retry with the latest one */
+    pos = (guint) g_atomic_int_get(&queue->enqueue_pos);
+  }
+
+  cell->func = func;
+  cell->data = data;
+  cell->destroy = destroy;
+  cell->owner = ua_memory_get_owner();
+  /* publish the command to the consumer */
+  g_atomic_int_set(&cell->sequence, (gint) (pos + 1));
+  signal_consumer(queue);
+
+  return TRUE;
+}
+
+guint
+ua_queue_drain(ua_queue_t *queue, UA_Server *server)
+{
+  ua_cell_t cell;
+  guint count = 0;
+  guint owner;
+
+  g_return_val_if_fail(queue != NULL, 0);
+
+  /* a command pushed from now on needs another drain */
+  g_atomic_int_set(&queue->signalled, FALSE);
+
+  while (count <= queue->mask && pop_cell(queue, &cell)) {
+    /* what the command allocates is accounted to its producer */
+    owner = ua_memory_set_owner(cell.owner);
+    cell.func(server, cell.data);
+    if (cell.destroy != NULL) {
+      cell.destroy(cell.data);
+    }
+    (void) ua_memory_set_owner(owner);
+    count++;
+  }
+
+  if (count > queue->mask) {
+    /* leave the rest to the next drain */
+    signal_consumer(queue);
+  }
+
+  return count;
+}
+
+guint
+ua_queue_length(ua_queue_t *queue)
+{
+  g_return_val_if_fail(queue != NULL, 0);
+
+  return (guint) g_atomic_int_get(&queue->enqueue_pos) - queue->dequeue_pos;
+}
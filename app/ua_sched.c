@@ -0,0 +1,409 @@
+/**
+ * MIT License
+ *
+ * Copyright (c) 2025 Axis Communications AB
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <glib.h>
+
+#include "ua_memory.h"
+#include "ua_metrics.h"
+#include "ua_sched.h"
+
+/* milliseconds, the grid of the ticks of the short periods */
+#define SCHED_GRANULARITY 100
+/* milliseconds, the periods from which the ticks fall on whole seconds */
+#define SCHED_SLOW_PERIOD 1000
+/* milliseconds, the backoff after the first failure and its upper bound */
+#define SCHED_BACKOFF_MIN 1000
+#define SCHED_BACKOFF_MAX 60000
+/* failures after which the backoff stops growing */
+#define SCHED_MAX_FAILURES 16
+
+/* one VAPIX request in the token bucket, which is counted in millionths of a
+ * request so that it is refilled with integers */
+#define SCHED_TOKEN G_USEC_PER_SEC
+
+struct ua_sched_client {
+  ua_sched_t *sched;
+  ua_sched_tick_t tick;
+  /* monotonic time of the next tick, G_MAXINT64 while idle */
+  gint64 due;
+  /* the last period returned by the tick, in milliseconds */
+  guint period;
+  /* consecutive failures and the monotonic time before which the client is
+   * not ticked */
+  guint failures;
+  gint64 not_before;
+  /* durations of the ticks and count of the backoffs */
+  ua_metric_t *ticks;
+  ua_metric_t *backoffs;
+  /* the memory owner of the ticks */
+  guint owner;
+};
+
+struct ua_sched {
+  GList *clients;
+  /* protects the members below, the clients may be woken from any thread */
+  GMutex lock;
+  /* the armed timer and the monotonic time it fires at */
+  guint timer_id;
+  gint64 wakeup;
+  /* idle source arming the timer again after ua_sched_wake() */
+  guint arm_id;
+  /* token bucket of the VAPIX requests per second, 0 for no limit */
+  guint budget;
+  gint64 tokens;
+  gint64 refilled;
+  ua_metric_t *wakeups;
+  ua_metric_t *denied;
+};
+
+/* Local functions */
+
+/* rounds 'time' up to the grid of 'period' (in milliseconds), so that the
+ * clients which are due close to each other are ticked by the same wakeup */
+static gint64
+align(gint64 time, guint period)
+{
+  gint64 grid;
+
+  grid = (period >= SCHED_SLOW_PERIOD) ? SCHED_SLOW_PERIOD : SCHED_GRANULARITY;
+  grid *= G_TIME_SPAN_MILLISECOND;
+
+  return ((time + grid - 1) / grid) * grid;
+}
+
+/* the tick of 'client' at 'due' at the earliest and after its backoff, called
+ * with the scheduler lock held */
+static void
+bring_forward(ua_sched_client_t *client, gint64 due, guint period)
+{
+  g_assert(client != NULL);
+
+  due = align(MAX(due, client->not_before), period);
+  client->due = MIN(client->due, due);
+}
+
+static gboolean
+run_ticks_cb(gpointer data);
+
+/* arms the timer for the earliest due client, called from the main loop with
+ * the scheduler lock held */
+static void
+arm_timer(ua_sched_t *sched)
+{
+  gint64 next = G_MAXINT64;
+  gint64 now;
+
+  g_assert(sched != NULL);
+
+  for (GList *iter = sched->clients; iter != NULL; iter = iter->next) {
+    ua_sched_client_t *client = iter->data;
+
+    next = MIN(next, client->due);
+  }
+
+  if (sched->timer_id != 0 && sched->wakeup == next) {
+    return;
+  }
+
+  if (sched->timer_id != 0) {
+    g_source_remove(sched->timer_id);
+    sched->timer_id = 0;
+  }
+
+  sched->wakeup = next;
+  if (next == G_MAXINT64) {
+    /* all the clients are idle */
+    return;
+  }
+
+  now = g_get_monotonic_time();
+  sched->timer_id =
+          g_timeout_add((guint) ((MAX(next - now, 0) + 999) / 1000),
+                        run_ticks_cb,
+                        sched);
+}
+
+static gboolean
+arm_timer_cb(gpointer data)
+{
+  ua_sched_t *sched = data;
+
+  g_assert(sched != NULL);
+
+  g_mutex_lock(&sched->lock);
+  sched->arm_id = 0;
+  arm_timer(sched);
+  g_mutex_unlock(&sched->lock);
+
+  return G_SOURCE_REMOVE;
+}
+
+/* ticks the due clients, called from the main loop */
+static gboolean
+run_ticks_cb(gpointer data)
+{
+  ua_sched_t *sched = data;
+  GList *due = NULL;
+  gint64 wakeup;
+  gint64 now;
+
+  g_assert(sched != NULL);
+
+  now = g_get_monotonic_time();
+  ua_metric_add(sched->wakeups, 1);
+
+  g_mutex_lock(&sched->lock);
+  sched->timer_id = 0;
+  wakeup = sched->wakeup;
+  for (GList *iter = sched->clients; iter != NULL; iter = iter->next) {
+    ua_sched_client_t *client = iter->data;
+
+    if (client->due <= now) {
+      /* idle unless the tick or a wakeup asks for more */
+      client->due = G_MAXINT64;
+      due = g_list_prepend(due, client);
+    }
+  }
+  g_mutex_unlock(&sched->lock);
+
+  /* the ticks may wake and back off clients, they run without the lock */
+  for (GList *iter = due; iter != NULL; iter = iter->next) {
+    ua_sched_client_t *client = iter->data;
+    gint64 start = g_get_monotonic_time();
+    guint period;
+    guint owner;
+
+    owner = ua_memory_set_owner(client->owner);
+    period = client->tick(client, now);
+    (void) ua_memory_set_owner(owner);
+    ua_metric_observe_since(client->ticks, start);
+
+    if (period > 0) {
+      g_mutex_lock(&sched->lock);
+      client->period = period;
+      /* the periods are counted from the grid, not from the late timer */
+      bring_forward(client,
+                    MAX(wakeup + period * G_TIME_SPAN_MILLISECOND, now),
+                    period);
+      g_mutex_unlock(&sched->lock);
+    }
+  }
+  g_list_free(due);
+
+  g_mutex_lock(&sched->lock);
+  arm_timer(sched);
+  g_mutex_unlock(&sched->lock);
+
+  return G_SOURCE_REMOVE;
+}
+
+/* adds the requests earned since the last refill, called with the scheduler
+ * lock held */
+static void
+refill(ua_sched_t *sched, gint64 now)
+{
+  g_assert(sched != NULL);
+
+  /* at most one second of requests is saved up */
+  sched->tokens = MIN(sched->tokens + (now - sched->refilled) * sched->budget,
+                      (gint64) sched->budget * SCHED_TOKEN);
+  sched->refilled = now;
+}
+
+/* Exported functions */
+
+ua_sched_t *
+ua_sched_new(guint budget)
+{
+  ua_sched_t *sched = g_new0(ua_sched_t, 1);
+
+  g_mutex_init(&sched->lock);
+  sched->wakeup = G_MAXINT64;
+  sched->budget = budget;
+  sched->tokens = (gint64) budget * SCHED_TOKEN;
+  sched->refilled = g_get_monotonic_time();
+  sched->wakeups = ua_metrics_get(UA_METRIC_COUNTER, "sched.wakeups");
+  sched->denied = ua_metrics_get(UA_METRIC_COUNTER, "sched.vapix_denied");
+
+  return sched;
+}
+
+void
+ua_sched_free(ua_sched_t *sched)
+{
+  if (sched == NULL) {
+    return;
+  }
+
+  g_warn_if_fail(sched->clients == NULL);
+
+  if (sched->timer_id != 0) {
+    g_source_remove(sched->timer_id);
+  }
+  if (sched->arm_id != 0) {
+    g_source_remove(sched->arm_id);
+  }
+  g_list_free_full(sched->clients, g_free);
+  g_mutex_clear(&sched->lock);
+  g_free(sched);
+}
+
+ua_sched_client_t *
+ua_sched_add(ua_sched_t *sched, const gchar *name, ua_sched_tick_t tick)
+{
+  ua_sched_client_t *client;
+  gchar *metric;
+
+  g_return_val_if_fail(sched != NULL, NULL);
+  g_return_val_if_fail(name != NULL, NULL);
+  g_return_val_if_fail(tick != NULL, NULL);
+
+  client = g_new0(ua_sched_client_t, 1);
+  client->sched = sched;
+  client->tick = tick;
+  client->period = SCHED_GRANULARITY;
+  client->due = align(g_get_monotonic_time(), SCHED_GRANULARITY);
+
+  metric = g_strdup_printf("sched.%s.ticks", name);
+  client->ticks = ua_metrics_get(UA_METRIC_TIMING, metric);
+  g_free(metric);
+  metric = g_strdup_printf("sched.%s.backoffs", name);
+  client->backoffs = ua_metrics_get(UA_METRIC_COUNTER, metric);
+  g_free(metric);
+  client->owner = ua_memory_get_owner_id(name);
+
+  g_mutex_lock(&sched->lock);
+  sched->clients = g_list_append(sched->clients, client);
+  arm_timer(sched);
+  g_mutex_unlock(&sched->lock);
+
+  return client;
+}
+
+void
+ua_sched_remove(ua_sched_client_t *client)
+{
+  ua_sched_t *sched;
+
+  if (client == NULL) {
+    return;
+  }
+
+  sched = client->sched;
+
+  g_mutex_lock(&sched->lock);
+  sched->clients = g_list_remove(sched->clients, client);
+  g_mutex_unlock(&sched->lock);
+
+  g_free(client);
+}
+
+void
+ua_sched_wake(ua_sched_client_t *client, guint delay)
+{
+  ua_sched_t *sched;
+  gint64 due;
+
+  g_return_if_fail(client != NULL);
+
+  sched = client->sched;
+  due = g_get_monotonic_time() + delay * G_TIME_SPAN_MILLISECOND;
+
+  g_mutex_lock(&sched->lock);
+  bring_forward(client, due, delay);
+  /* the timer belongs to the main loop */
+  if (client->due < sched->wakeup && sched->arm_id == 0) {
+    sched->arm_id = g_idle_add(arm_timer_cb, sched);
+  }
+  g_mutex_unlock(&sched->lock);
+}
+
+gboolean
+ua_sched_acquire(ua_sched_client_t *client)
+{
+  ua_sched_t *sched;
+  gint64 wait;
+
+  g_return_val_if_fail(client != NULL, FALSE);
+
+  sched = client->sched;
+
+  if (sched->budget == 0) {
+    return TRUE;
+  }
+
+  g_mutex_lock(&sched->lock);
+  refill(sched, g_get_monotonic_time());
+  if (sched->tokens >= SCHED_TOKEN) {
+    sched->tokens -= SCHED_TOKEN;
+    g_mutex_unlock(&sched->lock);
+    return TRUE;
+  }
+  /* microseconds until the bucket holds one request */
+  wait = (SCHED_TOKEN - sched->tokens + sched->budget - 1) / sched->budget;
+  g_mutex_unlock(&sched->lock);
+
+  ua_metric_add(sched->denied, 1);
+  ua_sched_wake(client, (guint) ((wait + 999) / 1000));
+
+  return FALSE;
+}
+
+void
+ua_sched_report(ua_sched_client_t *client, gboolean success)
+{
+  ua_sched_t *sched;
+  guint backoff;
+
+  g_return_if_fail(client != NULL);
+
+  sched = client->sched;
+
+  g_mutex_lock(&sched->lock);
+
+  if (success) {
+    client->failures = 0;
+    client->not_before = 0;
+    g_mutex_unlock(&sched->lock);
+    return;
+  }
+
+  client->failures = MIN(client->failures + 1, SCHED_MAX_FAILURES);
+  backoff = MIN(SCHED_BACKOFF_MIN << (client->failures - 1), SCHED_BACKOFF_MAX);
+  /* half of the backoff is random, the clients which failed together are
+   * spread over the other half */
+  backoff = backoff / 2 + g_random_int_range(0, backoff / 2 + 1);
+  client->not_before =
+          g_get_monotonic_time() + backoff * G_TIME_SPAN_MILLISECOND;
+
+  /* an early tick is pushed back, the timer just finds nothing to do */
+  if (client->due != G_MAXINT64 && client->due < client->not_before) {
+    client->due = align(client->not_before, client->period);
+  }
+
+  g_mutex_unlock(&sched->lock);
+
+  ua_metric_add(client->backoffs, 1);
+}
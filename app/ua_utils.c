@@ -27,42 +27,733 @@
 #include <open62541/server.h>
 
 #include "error.h"
+#include "ua_history.h"
+#include "ua_model.h"
+#include "ua_trace.h"
 #include "ua_utils.h"
 
 DEFINE_GQUARK("ua-utils")
 
+/* key of an entry of the node cache */
+typedef struct node_key {
+  UA_NodeId parent;
+  UA_QualifiedName browseName;
+} node_key_t;
+
+struct ua_node_cache {
+  /* node_key_t -> UA_NodeId */
+  GHashTable *nodes;
+  GRWLock lock;
+};
+
+/* the BaseEventType fields written by ua_utils_event_pool_trigger() */
+typedef enum {
+  EVENT_FIELD_TIME = 0,
+  EVENT_FIELD_SEVERITY,
+  EVENT_FIELD_MESSAGE,
+  EVENT_FIELD_SOURCENAME,
+  EVENT_NBR_OF_FIELDS
+} event_field_t;
+
+static const gchar *const event_field_names[EVENT_NBR_OF_FIELDS] = {
+  "Time",
+  "Severity",
+  "Message",
+  "SourceName",
+};
+
+/* an event node kept alive between triggers and the ids of its fields */
+typedef struct event_instance {
+  UA_NodeId event;
+  UA_NodeId fields[EVENT_NBR_OF_FIELDS];
+  /* the node exists in the information model */
+  gboolean created;
+  /* being filled in and triggered */
+  gboolean busy;
+} event_instance_t;
+
+struct ua_event_pool {
+  UA_NodeId eventType;
+  event_instance_t *instances;
+  guint size;
+  /* protects the 'created' and 'busy' flags of the instances */
+  GMutex lock;
+  /* the triggered events, NULL unless kept */
+  ua_history_t *history;
+};
+
 /* Local functions */
 
+static guint
+node_key_hash(gconstpointer data)
+{
+  const node_key_t *key = (const node_key_t *) data;
+  guint hash;
+
+  g_assert(key != NULL);
+
+  hash = UA_NodeId_hash(&key->parent) ^ key->browseName.namespaceIndex;
+  for (size_t i = 0; i < key->browseName.name.length; i++) {
+    hash = (hash << 5) + hash + key->browseName.name.data[i];
+  }
+
+  return hash;
+}
+
+static gboolean
+node_key_equal(gconstpointer a, gconstpointer b)
+{
+  const node_key_t *key_a = (const node_key_t *) a;
+  const node_key_t *key_b = (const node_key_t *) b;
+
+  g_assert(key_a != NULL);
+  g_assert(key_b != NULL);
+
+  return UA_NodeId_equal(&key_a->parent, &key_b->parent) &&
+         UA_QualifiedName_equal(&key_a->browseName, &key_b->browseName);
+}
+
+static void
+node_key_free(gpointer data)
+{
+  node_key_t *key = (node_key_t *) data;
+
+  if (key == NULL) {
+    return;
+  }
+
+  UA_NodeId_clear(&key->parent);
+  UA_QualifiedName_clear(&key->browseName);
+  g_free(key);
+}
+
+/* called with the write lock of the cache held */
+static void
+invalidate_node(ua_node_cache_t *cache, const UA_NodeId *nodeId)
+{
+  GHashTableIter iter;
+  gpointer key;
+  gpointer value;
+  GList *children = NULL;
+
+  g_assert(cache != NULL);
+  g_assert(nodeId != NULL);
+
+  g_hash_table_iter_init(&iter, cache->nodes);
+  while (g_hash_table_iter_next(&iter, &key, &value)) {
+    if (UA_NodeId_equal(&((node_key_t *) key)->parent, nodeId)) {
+      /* the descendants of the child are dropped below as well */
+      g_hash_table_iter_steal(&iter);
+      node_key_free(key);
+      children = g_list_prepend(children, value);
+    } else if (UA_NodeId_equal((UA_NodeId *) value, nodeId)) {
+      g_hash_table_iter_remove(&iter);
+    }
+  }
+
+  for (GList *l = children; l != NULL; l = l->next) {
+    invalidate_node(cache, (UA_NodeId *) l->data);
+  }
+  g_list_free_full(children, (GDestroyNotify) UA_NodeId_delete);
+}
+
+/* the journal of 'rbd', zero-filled when it is grown */
+static GArray *
+get_journal(rollback_data_t *rbd)
+{
+  g_assert(rbd != NULL);
+
+  if (rbd->node_ids == NULL) {
+    rbd->node_ids = g_array_new(FALSE, TRUE, sizeof(UA_NodeId));
+    g_array_set_clear_func(rbd->node_ids, (GDestroyNotify) UA_NodeId_clear);
+  }
+
+  return rbd->node_ids;
+}
+
 static UA_StatusCode
 add_nodeid_to_rbd(const UA_NodeId *node_id, rollback_data_t *rbd)
 {
   UA_StatusCode ua_status;
-  UA_NodeId *rb_nodeid;
+  UA_NodeId rb_nodeid;
 
   g_assert(node_id != NULL);
   g_assert(rbd != NULL);
 
-  /* allocate a UA_NodeId struct and add it to our rollback data
-   * (rbd->node_ids) */
-  rb_nodeid = UA_NodeId_new();
-  if (rb_nodeid == NULL) {
-    return UA_STATUSCODE_BADOUTOFMEMORY;
+  /* append a copy of the NodeId to our rollback data (rbd->node_ids) */
+  ua_status = UA_NodeId_copy(node_id, &rb_nodeid);
+  if (ua_status != UA_STATUSCODE_GOOD) {
+    return ua_status;
+  }
+  g_array_append_val(get_journal(rbd), rb_nodeid);
+
+  return UA_STATUSCODE_GOOD;
+}
+
+/* adds the node described by 'node', see ua_utils_add_nodes() */
+static UA_StatusCode
+add_described_node(UA_Server *server,
+                   const ua_node_desc_t *node,
+                   UA_NodeId *node_id)
+{
+  g_assert(server != NULL);
+  g_assert(node != NULL);
+  g_assert(node_id != NULL);
+
+  switch (node->node_class) {
+  case UA_NODECLASS_OBJECT:
+    return UA_Server_addObjectNode(server,
+                                   node->requested_id,
+                                   node->parent,
+                                   node->reference_type,
+                                   node->browse_name,
+                                   node->type_definition,
+                                   node->attr.object,
+                                   node->context,
+                                   node_id);
+  case UA_NODECLASS_VARIABLE:
+    if (node->data_source != NULL) {
+      return UA_Server_addDataSourceVariableNode(server,
+                                                 node->requested_id,
+                                                 node->parent,
+                                                 node->reference_type,
+                                                 node->browse_name,
+                                                 node->type_definition,
+                                                 node->attr.variable,
+                                                 *node->data_source,
+                                                 node->context,
+                                                 node_id);
+    }
+    return UA_Server_addVariableNode(server,
+                                     node->requested_id,
+                                     node->parent,
+                                     node->reference_type,
+                                     node->browse_name,
+                                     node->type_definition,
+                                     node->attr.variable,
+                                     node->context,
+                                     node_id);
+  default:
+    return UA_STATUSCODE_BADNODECLASSINVALID;
   }
+}
+
+/* records a node added by one of the *_rb() wrappers */
+static UA_StatusCode
+add_node_to_rbd(const UA_NodeId *parent,
+                const UA_QualifiedName *browseName,
+                const UA_NodeId *node_id,
+                rollback_data_t *rbd)
+{
+  UA_StatusCode ua_status;
+
+  g_assert(parent != NULL);
+  g_assert(browseName != NULL);
+  g_assert(node_id != NULL);
+  g_assert(rbd != NULL);
 
-  ua_status = UA_NodeId_copy(node_id, rb_nodeid);
+  ua_status = add_nodeid_to_rbd(node_id, rbd);
   if (ua_status != UA_STATUSCODE_GOOD) {
-    UA_NodeId_delete(rb_nodeid);
     return ua_status;
   }
 
-  /* add the allocated NodeId to our list */
-  rbd->node_ids = g_list_prepend(rbd->node_ids, rb_nodeid);
+  if (rbd->node_cache != NULL &&
+      !ua_utils_node_cache_add(rbd->node_cache, parent, browseName, node_id)) {
+    return UA_STATUSCODE_BADOUTOFMEMORY;
+  }
 
   return UA_STATUSCODE_GOOD;
 }
 
+/* looks up the child of 'parent' with the given browse name through a
+ * 'referenceTypeId' reference in the information model */
+static gboolean
+find_child_node(UA_Server *server,
+                const UA_NodeId *parent,
+                UA_UInt32 referenceTypeId,
+                const UA_QualifiedName *browseName,
+                UA_NodeId *outNodeId,
+                GError **err)
+{
+  UA_RelativePathElement rpe;
+  UA_BrowsePath bp;
+  UA_BrowsePathResult bpr;
+  UA_StatusCode status;
+  gboolean ret = FALSE;
+
+  g_assert(server != NULL);
+  g_assert(parent != NULL);
+  g_assert(browseName != NULL);
+  g_assert(outNodeId != NULL);
+  g_assert(err == NULL || *err == NULL);
+
+  UA_RelativePathElement_init(&rpe);
+  rpe.referenceTypeId = UA_NODEID_NUMERIC(0, referenceTypeId);
+  rpe.isInverse = FALSE;
+  rpe.includeSubtypes = FALSE;
+  rpe.targetName = *browseName;
+
+  UA_BrowsePath_init(&bp);
+  bp.startingNode = *parent;
+  bp.relativePath.elementsSize = 1;
+  bp.relativePath.elements = &rpe;
+
+  bpr = UA_Server_translateBrowsePathToNodeIds(server, &bp);
+  if (bpr.statusCode != UA_STATUSCODE_GOOD || bpr.targetsSize < 1) {
+    SET_ERROR(err,
+              -1,
+              "Unable to find nodeId of '%.*s', err: %s",
+              (int) browseName->name.length,
+              browseName->name.data,
+              UA_StatusCode_name(bpr.statusCode));
+    goto err_out;
+  }
+
+  status = UA_NodeId_copy(&bpr.targets[0].targetId.nodeId, outNodeId);
+  if (status != UA_STATUSCODE_GOOD) {
+    SET_ERROR(err,
+              -1,
+              "UA_NodeId_copy() failed: %s",
+              UA_StatusCode_name(status));
+    goto err_out;
+  }
+
+  ret = TRUE;
+
+err_out:
+  UA_BrowsePathResult_clear(&bpr);
+
+  return ret;
+}
+
+
+static void
+clear_event_instance(event_instance_t *inst)
+{
+  g_assert(inst != NULL);
+
+  UA_NodeId_clear(&inst->event);
+  for (guint i = 0; i < EVENT_NBR_OF_FIELDS; i++) {
+    UA_NodeId_clear(&inst->fields[i]);
+  }
+  inst->created = FALSE;
+}
+
+/* creates an event node of 'eventType' and looks up the ids of its fields */
+static gboolean
+create_event_instance(UA_Server *server,
+                      const UA_NodeId *eventType,
+                      event_instance_t *inst,
+                      GError **err)
+{
+  UA_StatusCode status;
+
+  g_assert(server != NULL);
+  g_assert(eventType != NULL);
+  g_assert(inst != NULL);
+  g_assert(err == NULL || *err == NULL);
+
+  status = UA_Server_createEvent(server, *eventType, &inst->event);
+  if (status != UA_STATUSCODE_GOOD) {
+    SET_ERROR(err,
+              -1,
+              "UA_Server_createEvent() failed: %s",
+              UA_StatusCode_name(status));
+    return FALSE;
+  }
+
+  for (guint i = 0; i < EVENT_NBR_OF_FIELDS; i++) {
+    UA_QualifiedName name =
+            UA_QUALIFIEDNAME(0, (gchar *) event_field_names[i]);
+
+    if (!find_child_node(server,
+                         &inst->event,
+                         UA_NS0ID_HASPROPERTY,
+                         &name,
+                         &inst->fields[i],
+                         err)) {
+      g_prefix_error(err, "find_child_node() failed: ");
+      (void) UA_Server_deleteNode(server, inst->event, TRUE);
+      clear_event_instance(inst);
+      return FALSE;
+    }
+  }
+
+  inst->created = TRUE;
+
+  return TRUE;
+}
+
+/* fills in the fields of the event node of 'inst' and triggers it */
+static gboolean
+fire_event_instance(UA_Server *server,
+                    const event_instance_t *inst,
+                    const UA_NodeId *origin,
+                    const ua_event_fields_t *fields,
+                    UA_Boolean deleteEventNode,
+                    ua_history_t *history,
+                    GError **err)
+{
+  UA_Variant values[EVENT_NBR_OF_FIELDS];
+  UA_ByteString eventId = UA_BYTESTRING_NULL;
+  UA_StatusCode status;
+  const gchar *tag;
+
+  g_assert(server != NULL);
+  g_assert(inst != NULL);
+  g_assert(origin != NULL);
+  g_assert(fields != NULL);
+  g_assert(err == NULL || *err == NULL);
+
+  /* the variants only borrow the fields of the caller */
+  UA_Variant_setScalar(&values[EVENT_FIELD_TIME],
+                       (gpointer) &fields->time,
+                       &UA_TYPES[UA_TYPES_DATETIME]);
+  UA_Variant_setScalar(&values[EVENT_FIELD_SEVERITY],
+                       (gpointer) &fields->severity,
+                       &UA_TYPES[UA_TYPES_UINT16]);
+  UA_Variant_setScalar(&values[EVENT_FIELD_MESSAGE],
+                       (gpointer) &fields->message,
+                       &UA_TYPES[UA_TYPES_LOCALIZEDTEXT]);
+  UA_Variant_setScalar(&values[EVENT_FIELD_SOURCENAME],
+                       (gpointer) &fields->sourceName,
+                       &UA_TYPES[UA_TYPES_STRING]);
+
+  for (guint i = 0; i < EVENT_NBR_OF_FIELDS; i++) {
+    status = UA_Server_writeValue(server, inst->fields[i], values[i]);
+    if (status != UA_STATUSCODE_GOOD) {
+      SET_ERROR(err,
+                -1,
+                "UA_Server_writeValue('%s') failed: %s",
+                event_field_names[i],
+                UA_StatusCode_name(status));
+      return FALSE;
+    }
+  }
+
+  /* tagged by the kind of node, a one-shot one is deleted when triggered */
+  tag = deleteEventNode ? "transient" : "pooled";
+  UA_TRACE_ENTRY(trigger_event, tag);
+  status = UA_Server_triggerEvent(server,
+                                  inst->event,
+                                  *origin,
+                                  history != NULL ? &eventId : NULL,
+                                  deleteEventNode);
+  UA_TRACE_EXIT(trigger_event, tag, status);
+  if (status != UA_STATUSCODE_GOOD) {
+    SET_ERROR(err,
+              -1,
+              "UA_Server_triggerEvent() failed: %s",
+              UA_StatusCode_name(status));
+    return FALSE;
+  }
+
+  if (history != NULL) {
+    ua_history_record(history, origin, &eventId, fields);
+    UA_ByteString_clear(&eventId);
+  }
+
+  return TRUE;
+}
+
 /* Exported functions */
 
+ua_node_cache_t *
+ua_utils_node_cache_new(void)
+{
+  ua_node_cache_t *cache = g_new0(ua_node_cache_t, 1);
+
+  cache->nodes = g_hash_table_new_full(node_key_hash,
+                                       node_key_equal,
+                                       node_key_free,
+                                       (GDestroyNotify) UA_NodeId_delete);
+  g_rw_lock_init(&cache->lock);
+
+  return cache;
+}
+
+void
+ua_utils_node_cache_free(ua_node_cache_t *cache)
+{
+  if (cache == NULL) {
+    return;
+  }
+
+  g_clear_pointer(&cache->nodes, g_hash_table_destroy);
+  g_rw_lock_clear(&cache->lock);
+  g_free(cache);
+}
+
+gboolean
+ua_utils_node_cache_add(ua_node_cache_t *cache,
+                        const UA_NodeId *parent,
+                        const UA_QualifiedName *browseName,
+                        const UA_NodeId *nodeId)
+{
+  node_key_t *key;
+  UA_NodeId *value;
+
+  g_return_val_if_fail(cache != NULL, FALSE);
+  g_return_val_if_fail(parent != NULL, FALSE);
+  g_return_val_if_fail(browseName != NULL, FALSE);
+  g_return_val_if_fail(nodeId != NULL, FALSE);
+
+  key = g_new0(node_key_t, 1);
+  value = UA_NodeId_new();
+  if (value == NULL ||
+      UA_NodeId_copy(parent, &key->parent) != UA_STATUSCODE_GOOD ||
+      UA_QualifiedName_copy(browseName, &key->browseName) !=
+              UA_STATUSCODE_GOOD ||
+      UA_NodeId_copy(nodeId, value) != UA_STATUSCODE_GOOD) {
+    node_key_free(key);
+    UA_NodeId_delete(value);
+    return FALSE;
+  }
+
+  g_rw_lock_writer_lock(&cache->lock);
+  g_hash_table_replace(cache->nodes, key, value);
+  g_rw_lock_writer_unlock(&cache->lock);
+
+  return TRUE;
+}
+
+gboolean
+ua_utils_node_cache_lookup(ua_node_cache_t *cache,
+                           const UA_NodeId *parent,
+                           const UA_QualifiedName *browseName,
+                           UA_NodeId *outNodeId)
+{
+  node_key_t key;
+  UA_NodeId *value;
+  gboolean found = FALSE;
+
+  g_return_val_if_fail(cache != NULL, FALSE);
+  g_return_val_if_fail(parent != NULL, FALSE);
+  g_return_val_if_fail(browseName != NULL, FALSE);
+  g_return_val_if_fail(outNodeId != NULL, FALSE);
+
+  /* the key only borrows the caller's data for the lookup */
+  key.parent = *parent;
+  key.browseName = *browseName;
+
+  g_rw_lock_reader_lock(&cache->lock);
+  value = g_hash_table_lookup(cache->nodes, &key);
+  if (value != NULL) {
+    found = (UA_NodeId_copy(value, outNodeId) == UA_STATUSCODE_GOOD);
+  }
+  g_rw_lock_reader_unlock(&cache->lock);
+
+  return found;
+}
+
+gboolean
+ua_utils_node_cache_resolve(ua_node_cache_t *cache,
+                            UA_Server *server,
+                            const UA_NodeId *parent,
+                            UA_UInt32 referenceTypeId,
+                            const UA_QualifiedName *browseName,
+                            UA_NodeId *outNodeId,
+                            GError **err)
+{
+  g_return_val_if_fail(cache != NULL, FALSE);
+  g_return_val_if_fail(server != NULL, FALSE);
+  g_return_val_if_fail(parent != NULL, FALSE);
+  g_return_val_if_fail(browseName != NULL, FALSE);
+  g_return_val_if_fail(outNodeId != NULL, FALSE);
+  g_return_val_if_fail(err == NULL || *err == NULL, FALSE);
+
+  if (ua_utils_node_cache_lookup(cache, parent, browseName, outNodeId)) {
+    return TRUE;
+  }
+
+  if (!find_child_node(server,
+                       parent,
+                       referenceTypeId,
+                       browseName,
+                       outNodeId,
+                       err)) {
+    return FALSE;
+  }
+
+  /* a failure to cache the node only costs another lookup next time */
+  (void) ua_utils_node_cache_add(cache, parent, browseName, outNodeId);
+
+  return TRUE;
+}
+
+void
+ua_utils_node_cache_invalidate(ua_node_cache_t *cache, const UA_NodeId *nodeId)
+{
+  g_return_if_fail(cache != NULL);
+  g_return_if_fail(nodeId != NULL);
+
+  g_rw_lock_writer_lock(&cache->lock);
+  invalidate_node(cache, nodeId);
+  g_rw_lock_writer_unlock(&cache->lock);
+}
+
+ua_event_pool_t *
+ua_utils_event_pool_new(const UA_NodeId *eventType, guint size)
+{
+  ua_event_pool_t *pool;
+
+  g_return_val_if_fail(eventType != NULL, NULL);
+  g_return_val_if_fail(size > 0, NULL);
+
+  pool = g_new0(ua_event_pool_t, 1);
+  if (UA_NodeId_copy(eventType, &pool->eventType) != UA_STATUSCODE_GOOD) {
+    g_free(pool);
+    return NULL;
+  }
+  pool->instances = g_new0(event_instance_t, size);
+  pool->size = size;
+  g_mutex_init(&pool->lock);
+
+  return pool;
+}
+
+void
+ua_utils_event_pool_free(ua_event_pool_t *pool)
+{
+  if (pool == NULL) {
+    return;
+  }
+
+  /* the event nodes themselves are owned by the server */
+  for (guint i = 0; i < pool->size; i++) {
+    clear_event_instance(&pool->instances[i]);
+  }
+  g_clear_pointer(&pool->instances, g_free);
+  g_clear_pointer(&pool->history, ua_history_free);
+  UA_NodeId_clear(&pool->eventType);
+  g_mutex_clear(&pool->lock);
+  g_free(pool);
+}
+
+void
+ua_utils_event_pool_remove(ua_event_pool_t *pool, UA_Server *server)
+{
+  g_return_if_fail(pool != NULL);
+  g_return_if_fail(server != NULL);
+
+  g_mutex_lock(&pool->lock);
+  for (guint i = 0; i < pool->size; i++) {
+    event_instance_t *inst = &pool->instances[i];
+
+    /* a busy node is being triggered, it is left to the server */
+    if (inst->created && !inst->busy) {
+      (void) UA_Server_deleteNode(server, inst->event, TRUE);
+      clear_event_instance(inst);
+    }
+  }
+  g_mutex_unlock(&pool->lock);
+}
+
+void
+ua_utils_event_pool_keep_history(ua_event_pool_t *pool, guint capacity)
+{
+  g_return_if_fail(pool != NULL);
+
+  g_clear_pointer(&pool->history, ua_history_free);
+  if (capacity > 0) {
+    pool->history = ua_history_new(&pool->eventType, capacity);
+  }
+}
+
+gboolean
+ua_utils_event_pool_trigger(ua_event_pool_t *pool,
+                            UA_Server *server,
+                            const UA_NodeId *origin,
+                            const ua_event_fields_t *fields,
+                            GError **err)
+{
+  event_instance_t *inst = NULL;
+  event_instance_t transient = { 0 };
+  gboolean create = FALSE;
+  gboolean ret;
+
+  g_return_val_if_fail(pool != NULL, FALSE);
+  g_return_val_if_fail(server != NULL, FALSE);
+  g_return_val_if_fail(origin != NULL, FALSE);
+  g_return_val_if_fail(fields != NULL, FALSE);
+  g_return_val_if_fail(err == NULL || *err == NULL, FALSE);
+
+  /* prefer an existing node, claim an empty slot otherwise */
+  g_mutex_lock(&pool->lock);
+  for (guint i = 0; i < pool->size; i++) {
+    event_instance_t *slot = &pool->instances[i];
+
+    if (slot->busy) {
+      continue;
+    }
+    if (slot->created) {
+      inst = slot;
+      create = FALSE;
+      break;
+    }
+    if (inst == NULL) {
+      inst = slot;
+      create = TRUE;
+    }
+  }
+  if (inst != NULL) {
+    inst->busy = TRUE;
+  }
+  g_mutex_unlock(&pool->lock);
+
+  if (inst == NULL) {
+    /* all the nodes are being triggered, fall back to a one-shot node */
+    if (!create_event_instance(server, &pool->eventType, &transient, err)) {
+      g_prefix_error(err, "create_event_instance() failed: ");
+      return FALSE;
+    }
+
+    ret = fire_event_instance(server,
+                              &transient,
+                              origin,
+                              fields,
+                              TRUE,
+                              pool->history,
+                              err);
+    clear_event_instance(&transient);
+
+    return ret;
+  }
+
+  if (create && !create_event_instance(server, &pool->eventType, inst, err)) {
+    g_prefix_error(err, "create_event_instance() failed: ");
+    ret = FALSE;
+  } else {
+    ret = fire_event_instance(server,
+                              inst,
+                              origin,
+                              fields,
+                              FALSE,
+                              pool->history,
+                              err);
+  }
+
+  g_mutex_lock(&pool->lock);
+  inst->busy = FALSE;
+  g_mutex_unlock(&pool->lock);
+
+  return ret;
+}
+
+UA_StatusCode
+ua_utils_set_method_async(UA_Server *server, const UA_NodeId methodId)
+{
+  g_return_val_if_fail(server != NULL, UA_STATUSCODE_BADINTERNALERROR);
+
+#if UA_MULTITHREADING >= 100
+  return UA_Server_setMethodNodeAsync(server, methodId, UA_TRUE);
+#else
+  (void) methodId;
+
+  return UA_STATUSCODE_BADNOTSUPPORTED;
+#endif
+}
+
 void
 ua_utils_clear_rbd(rollback_data_t **rbd)
 {
@@ -72,10 +763,8 @@ ua_utils_clear_rbd(rollback_data_t **rbd)
     return;
   }
 
-  if ((*rbd)->node_ids != NULL) {
-    /* free up the allocated UA_NodeId structures from the 'node_ids' list */
-    g_clear_list(&((*rbd)->node_ids), (GDestroyNotify) UA_NodeId_delete);
-  }
+  /* the journal clears the UA_NodeId structures it holds */
+  g_clear_pointer(&(*rbd)->node_ids, g_array_unref);
 
   /* free up the rollback_data_t structure itself */
   g_clear_pointer(rbd, g_free);
@@ -87,7 +776,7 @@ gboolean
 ua_utils_do_rollback(UA_Server *server, rollback_data_t *rbd, GError **err)
 {
   gboolean ret = FALSE;
-  GList *l;
+  UA_NodeId *node_id;
   UA_StatusCode ua_status;
   UA_ServerConfig *config;
 
@@ -108,19 +797,30 @@ ua_utils_do_rollback(UA_Server *server, rollback_data_t *rbd, GError **err)
     config->customDataTypes = rbd->saved_cdt;
   }
 
-  l = g_list_first(rbd->node_ids);
-  while (l != NULL) {
-    if (l->data) {
-      ua_status = UA_Server_deleteNode(server, *(UA_NodeId *) l->data, TRUE);
-      if (ua_status != UA_STATUSCODE_GOOD) {
-        SET_ERROR(err,
-                  -1,
-                  "UA_Server_deleteNode() failed: %s",
-                  UA_StatusCode_name(ua_status));
-        goto err_out;
-      }
+  for (guint i = rbd->node_ids != NULL ? rbd->node_ids->len : 0; i > 0; i--) {
+    node_id = &g_array_index(rbd->node_ids, UA_NodeId, i - 1);
+
+    ua_status = UA_Server_deleteNode(server, *node_id, TRUE);
+    /* the node may be gone already, deleted along with its parent or by the
+     * plugin itself */
+    if (ua_status != UA_STATUSCODE_GOOD &&
+        ua_status != UA_STATUSCODE_BADNODEIDUNKNOWN) {
+      SET_ERROR(err,
+                -1,
+                "UA_Server_deleteNode() failed: %s",
+                UA_StatusCode_name(ua_status));
+      goto err_out;
+    }
+
+    if (rbd->node_cache != NULL) {
+      ua_utils_node_cache_invalidate(rbd->node_cache, node_id);
     }
-    l = g_list_next(l);
+  }
+
+  if (rbd->model != NULL &&
+      !ua_model_remove(server, rbd->model, rbd->model_ns, err)) {
+    g_prefix_error(err, "ua_model_remove() failed: ");
+    goto err_out;
   }
 
   ret = TRUE;
@@ -130,6 +830,78 @@ err_out:
   return ret;
 }
 
+gboolean
+ua_utils_add_nodes(UA_Server *server,
+                   const ua_node_desc_t *nodes,
+                   gsize nr_nodes,
+                   rollback_data_t *rbd,
+                   GError **err)
+{
+  UA_StatusCode ua_status = UA_STATUSCODE_GOOD;
+  const ua_node_desc_t *node = NULL;
+  GArray *journal;
+  UA_NodeId *node_id;
+  guint mark;
+  guint added;
+
+  g_return_val_if_fail(server != NULL, FALSE);
+  g_return_val_if_fail(nodes != NULL || nr_nodes == 0, FALSE);
+  g_return_val_if_fail(rbd != NULL, FALSE);
+  g_return_val_if_fail(err == NULL || *err == NULL, FALSE);
+
+  journal = get_journal(rbd);
+  g_return_val_if_fail(nr_nodes <= G_MAXUINT - journal->len, FALSE);
+
+  /* the journal is grown once, the new node ids are written in place */
+  mark = journal->len;
+  g_array_set_size(journal, mark + (guint) nr_nodes);
+
+  for (added = 0; added < nr_nodes; added++) {
+    node = &nodes[added];
+    node_id = &g_array_index(journal, UA_NodeId, mark + added);
+
+    ua_status = add_described_node(server, node, node_id);
+    if (ua_status != UA_STATUSCODE_GOOD) {
+      break;
+    }
+
+    if (rbd->node_cache != NULL &&
+        !ua_utils_node_cache_add(rbd->node_cache,
+                                 &node->parent,
+                                 &node->browse_name,
+                                 node_id)) {
+      /* the node itself is deleted along with the others */
+      ua_status = UA_STATUSCODE_BADOUTOFMEMORY;
+      added++;
+      break;
+    }
+  }
+
+  if (ua_status == UA_STATUSCODE_GOOD) {
+    return TRUE;
+  }
+
+  SET_ERROR(err,
+            -1,
+            "Failed to add node %.*s: %s",
+            (int) node->browse_name.name.length,
+            node->browse_name.name.data,
+            UA_StatusCode_name(ua_status));
+
+  /* take the whole batch back, the last added node first */
+  while (added > 0) {
+    added--;
+    node_id = &g_array_index(journal, UA_NodeId, mark + added);
+    (void) UA_Server_deleteNode(server, *node_id, TRUE);
+    if (rbd->node_cache != NULL) {
+      ua_utils_node_cache_invalidate(rbd->node_cache, node_id);
+    }
+  }
+  g_array_set_size(journal, mark);
+
+  return FALSE;
+}
+
 UA_StatusCode
 UA_Server_addObjectNode_rb(UA_Server *server,
                            const UA_NodeId requestedNewNodeId,
@@ -158,12 +930,14 @@ UA_Server_addObjectNode_rb(UA_Server *server,
                                       nodeContext,
                                       &out_nodeid);
   if (ua_status == UA_STATUSCODE_GOOD) {
+    ua_status |= add_node_to_rbd(&parentNodeId, &browseName, &out_nodeid, rbd);
+
     if (outNewNodeId) {
       /* caller wants to know the NodeId of the new node */
       *outNewNodeId = out_nodeid;
+    } else {
+      UA_NodeId_clear(&out_nodeid);
     }
-
-    ua_status |= add_nodeid_to_rbd(&out_nodeid, rbd);
   }
 
   return ua_status;
@@ -195,12 +969,14 @@ UA_Server_addDataTypeNode_rb(UA_Server *server,
                                         nodeContext,
                                         &out_nodeid);
   if (ua_status == UA_STATUSCODE_GOOD) {
+    ua_status |= add_node_to_rbd(&parentNodeId, &browseName, &out_nodeid, rbd);
+
     if (outNewNodeId) {
       /* caller wants to know the NodeId of the new node */
       *outNewNodeId = out_nodeid;
+    } else {
+      UA_NodeId_clear(&out_nodeid);
     }
-
-    ua_status |= add_nodeid_to_rbd(&out_nodeid, rbd);
   }
 
   return ua_status;
@@ -234,12 +1010,14 @@ UA_Server_addVariableNode_rb(UA_Server *server,
                                         nodeContext,
                                         &out_nodeid);
   if (ua_status == UA_STATUSCODE_GOOD) {
+    ua_status |= add_node_to_rbd(&parentNodeId, &browseName, &out_nodeid, rbd);
+
     if (outNewNodeId) {
       /* caller wants to know the NodeId of the new node */
       *outNewNodeId = out_nodeid;
+    } else {
+      UA_NodeId_clear(&out_nodeid);
     }
-
-    ua_status |= add_nodeid_to_rbd(&out_nodeid, rbd);
   }
 
   return ua_status;
@@ -271,12 +1049,14 @@ UA_Server_addObjectTypeNode_rb(UA_Server *server,
                                           nodeContext,
                                           &out_nodeid);
   if (ua_status == UA_STATUSCODE_GOOD) {
+    ua_status |= add_node_to_rbd(&parentNodeId, &browseName, &out_nodeid, rbd);
+
     if (outNewNodeId) {
       /* caller wants to know the NodeId of the new node */
       *outNewNodeId = out_nodeid;
+    } else {
+      UA_NodeId_clear(&out_nodeid);
     }
-
-    ua_status |= add_nodeid_to_rbd(&out_nodeid, rbd);
   }
 
   return ua_status;
@@ -319,12 +1099,14 @@ UA_Server_addMethodNode_rb(UA_Server *server,
                                       &out_nodeid);
 
   if (ua_status == UA_STATUSCODE_GOOD) {
+    ua_status |= add_node_to_rbd(&parentNodeId, &browseName, &out_nodeid, rbd);
+
     if (outNewNodeId) {
       /* caller wants to know the NodeId of the new node */
       *outNewNodeId = out_nodeid;
+    } else {
+      UA_NodeId_clear(&out_nodeid);
     }
-
-    ua_status |= add_nodeid_to_rbd(&out_nodeid, rbd);
   }
 
   return ua_status;
@@ -23,15 +23,27 @@
  * SOFTWARE.
  */
 
+#include <curl/curl.h>
 #include <gio/gio.h>
 #include <glib.h>
+#include <string.h>
 
 #include "error.h"
+#include "ua_metrics.h"
+#include "ua_trace.h"
 #include "vapix_utils.h"
 
 DEFINE_GQUARK("vapix-utils")
 
+/* can be set at build time, e.g. to point the plugins at a mock VAPIX server
+ * replaying recorded responses when measuring the performance */
+#ifndef VAPIX_URL
 #define VAPIX_URL "http://127.0.0.12/axis-cgi/%s"
+#endif
+
+/* VAPIX_CREDENTIALS, the "<user>:<password>" of all the sessions, can be set
+ * at build time too, on a host without the D-Bus service of the VAPIX service
+ * accounts */
 
 #define CONF1_DBUS_SERVICE     "com.axis.HTTPConf1"
 #define CONF1_DBUS_OBJECT_PATH "/com/axis/HTTPConf1/VAPIXServiceAccounts1"
@@ -42,6 +54,110 @@ DEFINE_GQUARK("vapix-utils")
 #define MIME_XML         "application/xml"
 #define MIME_JSON        "application/json"
 
+/* initial size of the response buffer, it grows as needed */
+#define VAPIX_RESPONSE_SIZE 4096
+/* TCP keep-alive probing of the idle VAPIX connection, in seconds */
+#define VAPIX_KEEPIDLE  60L
+#define VAPIX_KEEPINTVL 30L
+/* size of the names of the request metrics, longer ones are truncated */
+#define VAPIX_METRIC_NAME_MAX 64
+
+/* a cURL handle and the per-request options currently set in it */
+typedef struct vapix_conn {
+  CURL *handle;
+  /* options currently set in the handle */
+  gchar *credentials;
+  gchar *endpoint;
+  struct curl_slist *headers;
+  /* reused between requests */
+  GString *response;
+} vapix_conn_t;
+
+/* a GSource driving a cURL multi handle from a GMainContext */
+typedef struct vapix_source {
+  GSource source;
+  CURLM *multi;
+  /* curl_socket_t -> tag from g_source_add_unix_fd() */
+  GHashTable *fds;
+  /* requests added to the multi handle */
+  GList *requests;
+  /* connections for asynchronous requests waiting to be reused */
+  GSList *idle;
+} vapix_source_t;
+
+struct vapix_service {
+  /* HTTP headers indexed by HTTP_media_t, read-only once set up */
+  struct curl_slist *headers[JSON_data + 1];
+  /* connection pool for synchronous requests */
+  GMutex lock;
+  GCond released;
+  GSList *idle;
+  guint nr_conns;
+  guint max_conns;
+  /* asynchronous requests, NULL after vapix_service_shutdown() */
+  vapix_source_t *async;
+  /* protects the queued requests of the sessions */
+  GMutex queued_lock;
+  /* system bus connection used to fetch the credentials */
+  GDBusConnection *dbus;
+  /* user name -> credentials of all the sessions */
+  GMutex creds_lock;
+  GHashTable *creds;
+};
+
+struct vapix_session {
+  vapix_service_t *service;
+  /* the key of the session credentials in the service cache */
+  gchar *username;
+  /* "vapix.<cgi>" -> vapix_metrics_t of the endpoints used so far, so that
+   * the registry of the metrics is only looked up once per endpoint */
+  GRWLock metrics_lock;
+  GHashTable *metrics;
+  /* asynchronous requests whose idle source is attached to the context but
+   * not dispatched yet */
+  GSList *queued;
+};
+
+/* the metrics of an endpoint, the counters are registered on first use */
+typedef struct vapix_metrics {
+  ua_metric_t *duration;
+  ua_metric_t *errors;
+  ua_metric_t *retries;
+} vapix_metrics_t;
+
+/* an asynchronous request, owned by the multi handle until it completes */
+typedef struct vapix_async_req {
+  vapix_service_t *service;
+  vapix_session_t *session;
+  vapix_conn_t *conn;
+  gchar *endpoint;
+  HTTP_req_method_t req_type;
+  HTTP_media_t media_type;
+  gchar *post_req;
+  vapix_response_cb_t callback;
+  gpointer user_data;
+  /* TRUE once the request was retried with re-fetched credentials */
+  gboolean retried;
+  /* g_get_monotonic_time() when the request was made */
+  gint64 start;
+  /* the idle source starting the request, NULL once dispatched */
+  GSource *idle;
+} vapix_async_req_t;
+
+/* a socket which is ready for cURL to act on */
+typedef struct vapix_fd_action {
+  curl_socket_t sock;
+  gint action;
+} vapix_fd_action_t;
+
+/* clang-format off */
+static const gchar *media_mime[] = {
+  [NONE_data] = NULL,
+  [XML_data]  = MIME_XML,
+  [JSON_data] = MIME_JSON,
+};
+/* clang-format on */
+
 /* Local functions */
 static size_t
 write_cb(gchar *ptr, size_t size, size_t nmemb, void *userdata)
@@ -70,6 +186,44 @@ set_curl_setopt_error(CURLcode res, GError **err)
             curl_easy_strerror(res));
 }
 
+static gboolean
+add_media_headers(struct curl_slist **headers, const gchar *mime, GError **err)
+{
+  gchar *content_hdr;
+  gchar *accept_hdr;
+  struct curl_slist *tmp;
+  gboolean ret = FALSE;
+
+  g_assert(headers != NULL && *headers == NULL);
+  g_assert(mime != NULL);
+  g_assert(err == NULL || *err == NULL);
+
+  content_hdr = g_strdup_printf("%s: %s", HTTP_HDR_CONTENT, mime);
+  accept_hdr = g_strdup_printf("%s: %s", HTTP_HDR_ACCEPT, mime);
+
+  tmp = curl_slist_append(NULL, content_hdr);
+  if (tmp == NULL) {
+    SET_ERROR(err, -1, "curl_slist_append(): failed adding 'Content-Type:'");
+    goto out;
+  }
+  *headers = tmp;
+
+  tmp = curl_slist_append(*headers, accept_hdr);
+  if (tmp == NULL) {
+    SET_ERROR(err, -1, "curl_slist_append(): failed adding 'Accept:'");
+    goto out;
+  }
+
+  ret = TRUE;
+
+out:
+  g_free(content_hdr);
+  g_free(accept_hdr);
+
+  return ret;
+}
+
+#ifndef VAPIX_CREDENTIALS
 static gchar *
 parse_credentials(GVariant *result, GError **err)
 {
@@ -109,127 +263,400 @@ out:
   return credentials;
 }
 
-/* Exported functions */
-gchar *
-vapix_request(CURL *handle,
-              const gchar *credentials,
-              const gchar *endpoint,
-              HTTP_req_method_t req_type,
-              HTTP_media_t media_type,
-              const gchar *post_req,
-              GError **err)
+/* performs the 'GetCredentials' D-Bus call for 'username' */
+static gchar *
+fetch_credentials(GDBusConnection *con, const gchar *username, GError **err)
 {
-  glong code;
-  GString *response;
-  gchar *vapix_resp = NULL;
-  gchar *url = NULL;
-  gchar *content_hdr = NULL;
-  gchar *accept_hdr = NULL;
-  CURLcode res;
-  struct curl_slist *headers = NULL;
+  GVariant *result;
+  gchar *credentials;
 
-  g_return_val_if_fail(handle != NULL, NULL);
-  g_return_val_if_fail(credentials != NULL, NULL);
-  g_return_val_if_fail(endpoint != NULL, NULL);
-  g_return_val_if_fail(err == NULL || *err == NULL, NULL);
-  g_return_val_if_fail(((req_type == HTTP_GET) && (post_req == NULL)) ||
-                               ((req_type == HTTP_POST) && (post_req != NULL)),
-                       NULL);
+  g_assert(con != NULL);
+  g_assert(username != NULL);
+  g_assert(err == NULL || *err == NULL);
+
+  result = g_dbus_connection_call_sync(con,
+                                       CONF1_DBUS_SERVICE,
+                                       CONF1_DBUS_OBJECT_PATH,
+                                       CONF1_DBUS_INTERFACE,
+                                       "GetCredentials",
+                                       g_variant_new("(s)", username),
+                                       NULL,
+                                       G_DBUS_CALL_FLAGS_NONE,
+                                       -1,
+                                       NULL,
+                                       err);
+  if (result == NULL) {
+    g_prefix_error(err, "Failed to get credentials: ");
+    return NULL;
+  }
+
+  credentials = parse_credentials(result, err);
+
+  if (credentials == NULL) {
+    g_prefix_error(err, "parse_credentials() failed: ");
+  }
+
+  g_variant_unref(result);
+
+  return credentials;
+}
+#else
+/* the credentials set at build time, 'con' is NULL */
+static gchar *
+fetch_credentials(G_GNUC_UNUSED GDBusConnection *con,
+                  const gchar *username,
+                  GError **err)
+{
+  g_assert(username != NULL);
+  g_assert(err == NULL || *err == NULL);
+
+  return g_strdup(VAPIX_CREDENTIALS);
+}
+#endif
+
+/* makes sure the credentials of 'username' are in the cache of 'service' */
+static gboolean
+cache_credentials(vapix_service_t *service,
+                  const gchar *username,
+                  GError **err)
+{
+  gboolean cached;
+  gchar *credentials;
+
+  g_assert(service != NULL);
+  g_assert(username != NULL);
+  g_assert(err == NULL || *err == NULL);
+
+  g_mutex_lock(&service->creds_lock);
+  cached = g_hash_table_contains(service->creds, username);
+  g_mutex_unlock(&service->creds_lock);
+
+  if (cached) {
+    return TRUE;
+  }
+
+  credentials = fetch_credentials(service->dbus, username, err);
+  if (credentials == NULL) {
+    return FALSE;
+  }
+
+  g_mutex_lock(&service->creds_lock);
+  g_hash_table_replace(service->creds, g_strdup(username), credentials);
+  g_mutex_unlock(&service->creds_lock);
+
+  return TRUE;
+}
+
+/* re-fetches the credentials of 'username' after 'stale' was rejected, unless
+ * another request already did */
+static gboolean
+refresh_credentials(vapix_service_t *service,
+                    const gchar *username,
+                    const gchar *stale,
+                    GError **err)
+{
+  gboolean refreshed;
+  const gchar *current;
+  gchar *credentials;
+
+  g_assert(service != NULL);
+  g_assert(username != NULL);
+  g_assert(err == NULL || *err == NULL);
+
+  g_mutex_lock(&service->creds_lock);
+  current = g_hash_table_lookup(service->creds, username);
+  refreshed = (g_strcmp0(current, stale) != 0);
+  g_mutex_unlock(&service->creds_lock);
+
+  if (refreshed) {
+    return TRUE;
+  }
+
+  credentials = fetch_credentials(service->dbus, username, err);
+  if (credentials == NULL) {
+    g_prefix_error(err, "Failed to refresh the credentials of %s: ", username);
+    return FALSE;
+  }
 
-  /* start clean */
-  curl_easy_reset(handle);
+  g_mutex_lock(&service->creds_lock);
+  g_hash_table_replace(service->creds, g_strdup(username), credentials);
+  g_mutex_unlock(&service->creds_lock);
+
+  return TRUE;
+}
+
+/* sets the options which are common to all the requests */
+static gboolean
+setup_handle(CURL *handle, GString *response, GError **err)
+{
+  CURLcode res;
 
-  url = g_strdup_printf(VAPIX_URL, endpoint);
-  response = g_string_new(NULL);
+  g_assert(handle != NULL);
+  g_assert(response != NULL);
+  g_assert(err == NULL || *err == NULL);
 
-  res = curl_easy_setopt(handle, CURLOPT_URL, url);
+  res = curl_easy_setopt(handle, CURLOPT_HTTPAUTH, CURLAUTH_BASIC);
 
   if (res != CURLE_OK) {
     set_curl_setopt_error(res, err);
-    goto err_out;
+    return FALSE;
   }
 
-  res = curl_easy_setopt(handle, CURLOPT_USERPWD, credentials);
+  res = curl_easy_setopt(handle, CURLOPT_TCP_KEEPALIVE, 1L);
 
   if (res != CURLE_OK) {
     set_curl_setopt_error(res, err);
-    goto err_out;
+    return FALSE;
   }
 
-  res = curl_easy_setopt(handle, CURLOPT_HTTPAUTH, CURLAUTH_BASIC);
+  res = curl_easy_setopt(handle, CURLOPT_TCP_KEEPIDLE, VAPIX_KEEPIDLE);
 
   if (res != CURLE_OK) {
     set_curl_setopt_error(res, err);
-    goto err_out;
+    return FALSE;
   }
 
-  if (req_type == HTTP_POST) {
-    /* prepare corresponding HTTP headers */
-    if (media_type == XML_data) {
-      content_hdr = g_strdup_printf("%s: %s", HTTP_HDR_CONTENT, MIME_XML);
-      accept_hdr = g_strdup_printf("%s: %s", HTTP_HDR_ACCEPT, MIME_XML);
-    } else if (media_type == JSON_data) {
-      content_hdr = g_strdup_printf("%s: %s", HTTP_HDR_CONTENT, MIME_JSON);
-      accept_hdr = g_strdup_printf("%s: %s", HTTP_HDR_ACCEPT, MIME_JSON);
-    }
+  res = curl_easy_setopt(handle, CURLOPT_TCP_KEEPINTVL, VAPIX_KEEPINTVL);
 
-    if (content_hdr && accept_hdr) {
-      headers = curl_slist_append(headers, content_hdr);
-      if (!headers) {
-        SET_ERROR(err,
-                  -1,
-                  "curl_slist_append(): failed adding 'Content-Type:'");
-        goto err_out;
-      }
-
-      headers = curl_slist_append(headers, accept_hdr);
-      if (!headers) {
-        SET_ERROR(err, -1, "curl_slist_append(): failed adding 'Accept:'");
-        goto err_out;
-      }
-
-      res = curl_easy_setopt(handle, CURLOPT_HTTPHEADER, headers);
-      if (res != CURLE_OK) {
-        set_curl_setopt_error(res, err);
-        goto err_out;
-      }
-    }
+  if (res != CURLE_OK) {
+    set_curl_setopt_error(res, err);
+    return FALSE;
+  }
 
-    res = curl_easy_setopt(handle, CURLOPT_POSTFIELDS, post_req);
+  /* all the requests go to the same host, one cached connection is enough */
+  res = curl_easy_setopt(handle, CURLOPT_MAXCONNECTS, 1L);
 
-    if (res != CURLE_OK) {
-      set_curl_setopt_error(res, err);
-      goto err_out;
-    }
+  if (res != CURLE_OK) {
+    set_curl_setopt_error(res, err);
+    return FALSE;
   }
 
   res = curl_easy_setopt(handle, CURLOPT_WRITEFUNCTION, write_cb);
 
   if (res != CURLE_OK) {
     set_curl_setopt_error(res, err);
-    goto err_out;
+    return FALSE;
   }
 
   res = curl_easy_setopt(handle, CURLOPT_WRITEDATA, response);
 
   if (res != CURLE_OK) {
     set_curl_setopt_error(res, err);
+    return FALSE;
+  }
+
+  return TRUE;
+}
+
+static void
+free_conn(gpointer data)
+{
+  vapix_conn_t *conn = data;
+
+  if (conn == NULL) {
+    return;
+  }
+
+  if (conn->handle != NULL) {
+    curl_easy_cleanup(conn->handle);
+  }
+
+  g_free(conn->credentials);
+  g_free(conn->endpoint);
+  g_string_free(conn->response, TRUE);
+  g_free(conn);
+}
+
+static vapix_conn_t *
+new_conn(GError **err)
+{
+  vapix_conn_t *conn;
+
+  g_assert(err == NULL || *err == NULL);
+
+  conn = g_new0(vapix_conn_t, 1);
+  conn->response = g_string_sized_new(VAPIX_RESPONSE_SIZE);
+
+  conn->handle = curl_easy_init();
+  if (conn->handle == NULL) {
+    SET_ERROR(err, -1, "curl_easy_init() failed");
+    goto err_out;
+  }
+
+  if (!setup_handle(conn->handle, conn->response, err)) {
     goto err_out;
   }
 
-  res = curl_easy_perform(handle);
+  return conn;
+
+err_out:
+  free_conn(conn);
+
+  return NULL;
+}
+
+/* sets the options of a single request, only the ones that differ from the
+ * previous request served by 'conn' are passed to cURL */
+static gboolean
+prepare_conn(vapix_conn_t *conn,
+             vapix_session_t *session,
+             const gchar *endpoint,
+             HTTP_req_method_t req_type,
+             HTTP_media_t media_type,
+             const gchar *post_req,
+             GError **err)
+{
+  CURLcode res;
+  const gchar *credentials;
+  struct curl_slist *headers = NULL;
+
+  g_assert(conn != NULL);
+  g_assert(session != NULL);
+  g_assert(endpoint != NULL);
+  g_assert(err == NULL || *err == NULL);
+
+  g_string_truncate(conn->response, 0);
+
+  /* the connections are shared by sessions using different accounts, and the
+   * credentials of an account may be refreshed at any time */
+  g_mutex_lock(&session->service->creds_lock);
+  credentials = g_hash_table_lookup(session->service->creds, session->username);
+  g_assert(credentials != NULL);
+
+  if (g_strcmp0(credentials, conn->credentials) != 0) {
+    res = curl_easy_setopt(conn->handle, CURLOPT_USERPWD, credentials);
+    if (res != CURLE_OK) {
+      g_mutex_unlock(&session->service->creds_lock);
+      set_curl_setopt_error(res, err);
+      g_clear_pointer(&conn->credentials, g_free);
+      return FALSE;
+    }
+
+    g_free(conn->credentials);
+    conn->credentials = g_strdup(credentials);
+  }
+  g_mutex_unlock(&session->service->creds_lock);
+
+  /* pollers tend to hit the same endpoint over and over again */
+  if (g_strcmp0(endpoint, conn->endpoint) != 0) {
+    gchar *url = g_strdup_printf(VAPIX_URL, endpoint);
+
+    /* cURL keeps its own copy of the URL */
+    res = curl_easy_setopt(conn->handle, CURLOPT_URL, url);
+    g_free(url);
+    if (res != CURLE_OK) {
+      set_curl_setopt_error(res, err);
+      g_clear_pointer(&conn->endpoint, g_free);
+      return FALSE;
+    }
+
+    g_free(conn->endpoint);
+    conn->endpoint = g_strdup(endpoint);
+  }
+
+  if (req_type == HTTP_POST) {
+    if (media_type < G_N_ELEMENTS(session->service->headers)) {
+      headers = session->service->headers[media_type];
+    }
+
+    res = curl_easy_setopt(conn->handle, CURLOPT_POSTFIELDS, post_req);
+  } else {
+    res = curl_easy_setopt(conn->handle, CURLOPT_HTTPGET, 1L);
+  }
 
   if (res != CURLE_OK) {
-    SET_ERROR(err,
-              -1,
-              "curl_easy_perform error %d: '%s'",
-              res,
-              curl_easy_strerror(res));
+    set_curl_setopt_error(res, err);
+    return FALSE;
+  }
 
-    goto err_out;
+  if (headers != conn->headers) {
+    res = curl_easy_setopt(conn->handle, CURLOPT_HTTPHEADER, headers);
+    if (res != CURLE_OK) {
+      set_curl_setopt_error(res, err);
+      return FALSE;
+    }
+    conn->headers = headers;
+  }
+
+  return TRUE;
+}
+
+/* takes a connection from the pool, waits for one to be released if all the
+ * 'max_conns' connections are busy */
+static vapix_conn_t *
+acquire_conn(vapix_service_t *service, GError **err)
+{
+  vapix_conn_t *conn = NULL;
+
+  g_assert(service != NULL);
+  g_assert(err == NULL || *err == NULL);
+
+  g_mutex_lock(&service->lock);
+
+  while (service->idle == NULL && service->nr_conns >= service->max_conns) {
+    g_cond_wait(&service->released, &service->lock);
+  }
+
+  if (service->idle != NULL) {
+    conn = service->idle->data;
+    service->idle = g_slist_delete_link(service->idle, service->idle);
+    g_mutex_unlock(&service->lock);
+    return conn;
   }
 
-  res = curl_easy_getinfo(handle, CURLINFO_RESPONSE_CODE, &code);
+  /* reserve a slot for the new connection */
+  service->nr_conns++;
+  g_mutex_unlock(&service->lock);
+
+  conn = new_conn(err);
+  if (conn == NULL) {
+    g_mutex_lock(&service->lock);
+    service->nr_conns--;
+    g_cond_signal(&service->released);
+    g_mutex_unlock(&service->lock);
+  }
+
+  return conn;
+}
+
+static void
+release_conn(vapix_service_t *service, vapix_conn_t *conn)
+{
+  g_assert(service != NULL);
+  g_assert(conn != NULL);
+
+  g_mutex_lock(&service->lock);
+  service->idle = g_slist_prepend(service->idle, conn);
+  g_cond_signal(&service->released);
+  g_mutex_unlock(&service->lock);
+}
+
+/* TRUE if the credentials used by a performed request were rejected */
+static gboolean
+is_unauthorized(vapix_conn_t *conn)
+{
+  glong code = 0;
+
+  g_assert(conn != NULL);
+
+  curl_easy_getinfo(conn->handle, CURLINFO_RESPONSE_CODE, &code);
+
+  return code == 401;
+}
+
+/* checks the outcome of a performed request, on success its response is in
+ * 'conn->response' until the connection serves another request */
+static gboolean
+check_response(vapix_conn_t *conn, const gchar *endpoint, GError **err)
+{
+  glong code;
+  CURLcode res;
+
+  g_assert(conn != NULL);
+  g_assert(endpoint != NULL);
+  g_assert(err == NULL || *err == NULL);
+
+  res = curl_easy_getinfo(conn->handle, CURLINFO_RESPONSE_CODE, &code);
 
   if (res != CURLE_OK) {
     SET_ERROR(err,
@@ -238,7 +665,7 @@ vapix_request(CURL *handle,
               res,
               curl_easy_strerror(res));
 
-    goto err_out;
+    return FALSE;
   }
 
   if (code != 200) {
@@ -247,66 +674,867 @@ vapix_request(CURL *handle,
               "Got response code %ld from request to %s with response '%s'",
               code,
               endpoint,
-              response->str);
-    g_string_free(response, TRUE);
-    goto err_out;
+              conn->response->str);
+    return FALSE;
   }
 
-  vapix_resp = g_string_free(response, FALSE);
-
-err_out:
-  g_clear_pointer(&url, g_free);
-  g_clear_pointer(&content_hdr, g_free);
-  g_clear_pointer(&accept_hdr, g_free);
-
-  /* handles NULL-case too */
-  curl_slist_free_all(headers);
-
-  return vapix_resp;
+  return TRUE;
 }
 
-gchar *
-vapix_get_credentials(const gchar *username, GError **err)
+static vapix_metrics_t *
+get_endpoint_metrics(vapix_session_t *session, const gchar *name)
 {
-  GDBusConnection *con = NULL;
-  GVariant *result = NULL;
-  gchar *credentials = NULL;
+  vapix_metrics_t *metrics;
 
-  g_return_val_if_fail(username != NULL, NULL);
-  g_return_val_if_fail(err == NULL || *err == NULL, NULL);
+  g_assert(session != NULL);
+  g_assert(name != NULL);
 
-  con = g_bus_get_sync(G_BUS_TYPE_SYSTEM, NULL, err);
-  if (con == NULL) {
-    g_prefix_error(err, "Error connecting to D-Bus: ");
-    return NULL;
+  g_rw_lock_reader_lock(&session->metrics_lock);
+  metrics = g_hash_table_lookup(session->metrics, name);
+  g_rw_lock_reader_unlock(&session->metrics_lock);
+  if (G_LIKELY(metrics != NULL)) {
+    return metrics;
   }
 
-  result = g_dbus_connection_call_sync(con,
-                                       CONF1_DBUS_SERVICE,
-                                       CONF1_DBUS_OBJECT_PATH,
-                                       CONF1_DBUS_INTERFACE,
-                                       "GetCredentials",
-                                       g_variant_new("(s)", username),
-                                       NULL,
-                                       G_DBUS_CALL_FLAGS_NONE,
-                                       -1,
-                                       NULL,
-                                       err);
-  if (result == NULL) {
-    g_prefix_error(err, "Failed to get credentials: ");
-    goto out;
+  g_rw_lock_writer_lock(&session->metrics_lock);
+  metrics = g_hash_table_lookup(session->metrics, name);
+  if (metrics == NULL) {
+    metrics = g_new0(vapix_metrics_t, 1);
+    metrics->duration = ua_metrics_get(UA_METRIC_TIMING, name);
+    g_hash_table_insert(session->metrics, g_strdup(name), metrics);
   }
+  g_rw_lock_writer_unlock(&session->metrics_lock);
 
-  credentials = parse_credentials(result, err);
+  return metrics;
+}
 
-  if (credentials == NULL) {
-    g_prefix_error(err, "parse_credentials() failed: ");
-  }
+/* records the duration and the outcome of a request in the metrics
+ * "vapix.<cgi>", "vapix.<cgi>.errors" and "vapix.<cgi>.retries" */
+static void
+record_request(vapix_session_t *session,
+               const gchar *endpoint,
+               gint64 start,
+               gboolean failed,
+               gboolean retried)
+{
+  /* called for every request from any thread, the names are formatted on the
+   * stack */
+  gchar name[VAPIX_METRIC_NAME_MAX];
+  vapix_metrics_t *metrics;
+  gint len;
 
-  g_variant_unref(result);
+  g_assert(session != NULL);
+  g_assert(endpoint != NULL);
 
-out:
-  g_object_unref(con);
+  /* the query of e.g. "activate.cgi?schemaversion=1..." is left out */
+  len = (gint) MIN(strcspn(endpoint, "?"), VAPIX_METRIC_NAME_MAX);
+  g_snprintf(name, sizeof(name), "vapix.%.*s", len, endpoint);
+  metrics = get_endpoint_metrics(session, name);
+  ua_metric_observe_since(metrics->duration, start);
+  if (failed) {
+    g_snprintf(name, sizeof(name), "vapix.%.*s.errors", len, endpoint);
+    ua_metric_add(ua_metrics_get_cached(&metrics->errors,
+                                        UA_METRIC_COUNTER,
+                                        name),
+                  1);
+  }
+  if (retried) {
+    g_snprintf(name, sizeof(name), "vapix.%.*s.retries", len, endpoint);
+    ua_metric_add(ua_metrics_get_cached(&metrics->retries,
+                                        UA_METRIC_COUNTER,
+                                        name),
+                  1);
+  }
+}
+
+static void
+free_async_req(vapix_async_req_t *req)
+{
+  g_assert(req != NULL);
+
+  free_conn(req->conn);
+  g_free(req->endpoint);
+  g_free(req->post_req);
+  g_free(req);
+}
+
+static gboolean
+start_async_req(vapix_source_t *vs, vapix_async_req_t *req, GError **err);
+
+/* hands over the result of a request to its owner */
+static void
+complete_async_req(vapix_source_t *vs, vapix_async_req_t *req, CURLcode result)
+{
+  GError *lerr = NULL;
+  const gchar *response = NULL;
+  gchar *stale = NULL;
+
+  g_assert(vs != NULL);
+  g_assert(req != NULL);
+  g_assert(req->callback != NULL);
+
+  if (result != CURLE_OK) {
+    SET_ERROR(&lerr,
+              -1,
+              "curl_multi error %d: '%s'",
+              result,
+              curl_easy_strerror(result));
+  } else if (!req->retried && is_unauthorized(req->conn)) {
+    stale = g_strdup(req->conn->credentials);
+  } else if (check_response(req->conn, req->endpoint, &lerr)) {
+    /* lent to the callback rather than copied */
+    response = req->conn->response->str;
+  }
+
+  if (stale != NULL) {
+    /* the handle keeps its options and can serve the retry */
+    vs->idle = g_slist_prepend(vs->idle, req->conn);
+    req->conn = NULL;
+
+    /* the credentials may have been rotated, re-fetch them and try once more,
+     * the short D-Bus call is made synchronously as this is a rare event */
+    req->retried = TRUE;
+    if (refresh_credentials(req->session->service,
+                            req->session->username,
+                            stale,
+                            &lerr) &&
+        start_async_req(vs, req, &lerr)) {
+      g_free(stale);
+      return;
+    }
+    g_free(stale);
+    /* a connection which failed to start the retry isn't reused */
+    g_clear_pointer(&req->conn, free_conn);
+  }
+
+  record_request(req->session,
+                 req->endpoint,
+                 req->start,
+                 response == NULL,
+                 req->retried);
+  req->callback(response, lerr, req->user_data);
+
+  /* the handle keeps its options and can serve the next request, one started
+   * by the callback got another connection */
+  if (req->conn != NULL) {
+    vs->idle = g_slist_prepend(vs->idle, req->conn);
+    req->conn = NULL;
+  }
+
+  g_clear_error(&lerr);
+  free_async_req(req);
+}
+
+static gboolean
+start_async_req(vapix_source_t *vs, vapix_async_req_t *req, GError **err)
+{
+  CURLcode res;
+  CURLMcode mres;
+
+  g_assert(vs != NULL);
+  g_assert(req != NULL);
+  g_assert(err == NULL || *err == NULL);
+
+  if (vs->idle != NULL) {
+    req->conn = vs->idle->data;
+    vs->idle = g_slist_delete_link(vs->idle, vs->idle);
+  } else {
+    req->conn = new_conn(err);
+    if (req->conn == NULL) {
+      return FALSE;
+    }
+  }
+
+  if (!prepare_conn(req->conn,
+                    req->session,
+                    req->endpoint,
+                    req->req_type,
+                    req->media_type,
+                    req->post_req,
+                    err)) {
+    return FALSE;
+  }
+
+  res = curl_easy_setopt(req->conn->handle, CURLOPT_PRIVATE, req);
+
+  if (res != CURLE_OK) {
+    set_curl_setopt_error(res, err);
+    return FALSE;
+  }
+
+  mres = curl_multi_add_handle(vs->multi, req->conn->handle);
+
+  if (mres != CURLM_OK) {
+    SET_ERROR(err,
+              -1,
+              "curl_multi_add_handle error %d: '%s'",
+              mres,
+              curl_multi_strerror(mres));
+    return FALSE;
+  }
+
+  vs->requests = g_list_prepend(vs->requests, req);
+
+  return TRUE;
+}
+
+/* runs in the context given to vapix_service_new() */
+static gboolean
+start_async_req_cb(gpointer user_data)
+{
+  vapix_async_req_t *req = user_data;
+  vapix_source_t *vs;
+  GError *lerr = NULL;
+
+  g_assert(req != NULL);
+  g_assert(req->session != NULL);
+
+  g_mutex_lock(&req->service->queued_lock);
+  req->session->queued = g_slist_remove(req->session->queued, req);
+  g_clear_pointer(&req->idle, g_source_unref);
+  g_mutex_unlock(&req->service->queued_lock);
+
+  vs = req->service->async;
+
+  if (vs == NULL) {
+    SET_ERROR(&lerr, -1, "The VAPIX service was shut down");
+  } else if (start_async_req(vs, req, &lerr)) {
+    return G_SOURCE_REMOVE;
+  }
+
+  req->callback(NULL, lerr, req->user_data);
+
+  g_clear_error(&lerr);
+  free_async_req(req);
+
+  return G_SOURCE_REMOVE;
+}
+
+/* removes the requests of 'session' (or all of them if NULL) from the multi
+ * handle, the owners are notified only if 'notify' is TRUE */
+static void
+cancel_async_reqs(vapix_source_t *vs, vapix_session_t *session, gboolean notify)
+{
+  GList *iter;
+  GList *next;
+
+  g_assert(vs != NULL);
+
+  for (iter = vs->requests; iter != NULL; iter = next) {
+    vapix_async_req_t *req = iter->data;
+    GError *lerr = NULL;
+
+    next = iter->next;
+
+    if (session != NULL && req->session != session) {
+      continue;
+    }
+
+    curl_multi_remove_handle(vs->multi, req->conn->handle);
+    vs->requests = g_list_delete_link(vs->requests, iter);
+
+    if (notify) {
+      SET_ERROR(&lerr, -1, "Request to %s was cancelled", req->endpoint);
+      req->callback(NULL, lerr, req->user_data);
+      g_clear_error(&lerr);
+    }
+
+    free_async_req(req);
+  }
+}
+
+static void
+check_multi_info(vapix_source_t *vs)
+{
+  CURLMsg *msg;
+  gint pending;
+
+  g_assert(vs != NULL);
+
+  while ((msg = curl_multi_info_read(vs->multi, &pending)) != NULL) {
+    CURL *handle = msg->easy_handle;
+    CURLcode result = msg->data.result;
+    gchar *priv = NULL;
+
+    if (msg->msg != CURLMSG_DONE) {
+      continue;
+    }
+
+    curl_easy_getinfo(handle, CURLINFO_PRIVATE, &priv);
+    curl_multi_remove_handle(vs->multi, handle);
+
+    if (priv != NULL) {
+      vapix_async_req_t *req = (vapix_async_req_t *) priv;
+
+      vs->requests = g_list_remove(vs->requests, req);
+      complete_async_req(vs, req, result);
+    }
+  }
+}
+
+/* CURLMOPT_SOCKETFUNCTION: keeps the polled fds of the source in sync */
+static int
+socket_cb(G_GNUC_UNUSED CURL *handle,
+          curl_socket_t sock,
+          int what,
+          void *userp,
+          void *socketp)
+{
+  vapix_source_t *vs = userp;
+  guint cond = G_IO_ERR | G_IO_HUP;
+
+  g_assert(vs != NULL);
+
+  if (what == CURL_POLL_REMOVE) {
+    if (socketp != NULL) {
+      g_source_remove_unix_fd(&vs->source, socketp);
+      g_hash_table_remove(vs->fds, GINT_TO_POINTER(sock));
+    }
+    return 0;
+  }
+
+  if (what & CURL_POLL_IN) {
+    cond |= G_IO_IN;
+  }
+
+  if (what & CURL_POLL_OUT) {
+    cond |= G_IO_OUT;
+  }
+
+  if (socketp == NULL) {
+    gpointer tag = g_source_add_unix_fd(&vs->source, sock, cond);
+
+    curl_multi_assign(vs->multi, sock, tag);
+    g_hash_table_insert(vs->fds, GINT_TO_POINTER(sock), tag);
+  } else {
+    g_source_modify_unix_fd(&vs->source, socketp, cond);
+  }
+
+  return 0;
+}
+
+/* CURLMOPT_TIMERFUNCTION: maps the cURL timeout to the source ready time */
+static int
+timer_cb(G_GNUC_UNUSED CURLM *multi, long timeout_ms, void *userp)
+{
+  vapix_source_t *vs = userp;
+
+  g_assert(vs != NULL);
+
+  if (timeout_ms < 0) {
+    g_source_set_ready_time(&vs->source, -1);
+  } else {
+    g_source_set_ready_time(&vs->source,
+                            g_get_monotonic_time() + timeout_ms * 1000);
+  }
+
+  return 0;
+}
+
+static gboolean
+vapix_source_dispatch(GSource *source,
+                      G_GNUC_UNUSED GSourceFunc callback,
+                      G_GNUC_UNUSED gpointer user_data)
+{
+  vapix_source_t *vs = (vapix_source_t *) source;
+  GHashTableIter iter;
+  gpointer key;
+  gpointer tag;
+  GArray *ready;
+  gint64 ready_time;
+  gint running;
+  guint i;
+
+  ready_time = g_source_get_ready_time(source);
+  if (ready_time >= 0 && g_source_get_time(source) >= ready_time) {
+    /* cURL re-arms the timer through timer_cb() if needed */
+    g_source_set_ready_time(source, -1);
+    curl_multi_socket_action(vs->multi, CURL_SOCKET_TIMEOUT, 0, &running);
+  }
+
+  /* the fds may come and go while cURL acts on them, collect them first */
+  ready = g_array_new(FALSE, FALSE, sizeof(vapix_fd_action_t));
+  g_hash_table_iter_init(&iter, vs->fds);
+  while (g_hash_table_iter_next(&iter, &key, &tag)) {
+    GIOCondition revents = g_source_query_unix_fd(source, tag);
+    vapix_fd_action_t fd_action = { GPOINTER_TO_INT(key), 0 };
+
+    if (revents & G_IO_IN) {
+      fd_action.action |= CURL_CSELECT_IN;
+    }
+
+    if (revents & G_IO_OUT) {
+      fd_action.action |= CURL_CSELECT_OUT;
+    }
+
+    if (revents & (G_IO_ERR | G_IO_HUP)) {
+      fd_action.action |= CURL_CSELECT_ERR;
+    }
+
+    if (fd_action.action != 0) {
+      g_array_append_val(ready, fd_action);
+    }
+  }
+
+  for (i = 0; i < ready->len; i++) {
+    vapix_fd_action_t *fd_action = &g_array_index(ready, vapix_fd_action_t, i);
+
+    curl_multi_socket_action(vs->multi,
+                             fd_action->sock,
+                             fd_action->action,
+                             &running);
+  }
+  g_array_free(ready, TRUE);
+
+  check_multi_info(vs);
+
+  return G_SOURCE_CONTINUE;
+}
+
+static void
+vapix_source_finalize(GSource *source)
+{
+  vapix_source_t *vs = (vapix_source_t *) source;
+
+  if (vs->multi != NULL) {
+    curl_multi_cleanup(vs->multi);
+  }
+
+  g_slist_free_full(vs->idle, free_conn);
+  g_clear_pointer(&vs->fds, g_hash_table_destroy);
+}
+
+/* clang-format off */
+static GSourceFuncs vapix_source_funcs = {
+  .prepare = NULL,
+  .check = NULL,
+  .dispatch = vapix_source_dispatch,
+  .finalize = vapix_source_finalize,
+};
+/* clang-format on */
+
+/* Exported functions */
+vapix_service_t *
+vapix_service_new(GMainContext *context, guint max_connections, GError **err)
+{
+  vapix_service_t *service;
+  vapix_source_t *vs;
+  guint i;
+
+  g_return_val_if_fail(max_connections > 0, NULL);
+  g_return_val_if_fail(err == NULL || *err == NULL, NULL);
+
+  service = g_new0(vapix_service_t, 1);
+  g_mutex_init(&service->lock);
+  g_cond_init(&service->released);
+  service->max_conns = max_connections;
+  g_mutex_init(&service->creds_lock);
+  g_mutex_init(&service->queued_lock);
+  service->creds =
+          g_hash_table_new_full(g_str_hash, g_str_equal, g_free, g_free);
+
+  /* one connection serves the credentials of all the sessions */
+#ifndef VAPIX_CREDENTIALS
+  service->dbus = g_bus_get_sync(G_BUS_TYPE_SYSTEM, NULL, err);
+  if (service->dbus == NULL) {
+    g_prefix_error(err, "Error connecting to D-Bus: ");
+    goto err_out;
+  }
+#endif
+
+  /* prepare the HTTP headers for each media type once */
+  for (i = 0; i < G_N_ELEMENTS(media_mime); i++) {
+    if (media_mime[i] == NULL) {
+      continue;
+    }
+
+    if (!add_media_headers(&service->headers[i], media_mime[i], err)) {
+      goto err_out;
+    }
+  }
+
+  vs = (vapix_source_t *) g_source_new(&vapix_source_funcs,
+                                       sizeof(vapix_source_t));
+  vs->fds = g_hash_table_new(g_direct_hash, g_direct_equal);
+  service->async = vs;
+
+  vs->multi = curl_multi_init();
+  if (vs->multi == NULL) {
+    SET_ERROR(err, -1, "curl_multi_init() failed");
+    goto err_out;
+  }
+
+  if (curl_multi_setopt(vs->multi, CURLMOPT_SOCKETFUNCTION, socket_cb) !=
+              CURLM_OK ||
+      curl_multi_setopt(vs->multi, CURLMOPT_SOCKETDATA, vs) != CURLM_OK ||
+      curl_multi_setopt(vs->multi, CURLMOPT_TIMERFUNCTION, timer_cb) !=
+              CURLM_OK ||
+      curl_multi_setopt(vs->multi, CURLMOPT_TIMERDATA, vs) != CURLM_OK ||
+      curl_multi_setopt(vs->multi,
+                        CURLMOPT_MAX_TOTAL_CONNECTIONS,
+                        (glong) max_connections) != CURLM_OK ||
+      curl_multi_setopt(vs->multi,
+                        CURLMOPT_MAXCONNECTS,
+                        (glong) max_connections) != CURLM_OK) {
+    SET_ERROR(err, -1, "curl_multi_setopt() failed");
+    goto err_out;
+  }
+
+  g_source_set_name(&vs->source, "vapix-async");
+  g_source_attach(&vs->source, context);
+
+  return service;
+
+err_out:
+  vapix_service_free(service);
+
+  return NULL;
+}
+
+void
+vapix_service_shutdown(vapix_service_t *service)
+{
+  vapix_source_t *vs;
+
+  g_return_if_fail(service != NULL);
+
+  vs = service->async;
+  if (vs == NULL) {
+    return;
+  }
+
+  /* new requests are refused from now on */
+  service->async = NULL;
+
+  cancel_async_reqs(vs, NULL, TRUE);
+
+  /* closing the connections calls socket_cb(), keep the source alive */
+  g_clear_pointer(&vs->multi, curl_multi_cleanup);
+
+  g_source_destroy(&vs->source);
+  g_source_unref(&vs->source);
+}
+
+void
+vapix_service_free(vapix_service_t *service)
+{
+  guint i;
+
+  if (service == NULL) {
+    return;
+  }
+
+  vapix_service_shutdown(service);
+
+  /* all the sessions must be gone, i.e. no connection is in use */
+  g_warn_if_fail(g_slist_length(service->idle) == service->nr_conns);
+  g_slist_free_full(service->idle, free_conn);
+
+  for (i = 0; i < G_N_ELEMENTS(service->headers); i++) {
+    /* handles NULL-case too */
+    curl_slist_free_all(service->headers[i]);
+  }
+
+  g_clear_object(&service->dbus);
+  g_clear_pointer(&service->creds, g_hash_table_destroy);
+  g_mutex_clear(&service->queued_lock);
+  g_mutex_clear(&service->creds_lock);
+  g_cond_clear(&service->released);
+  g_mutex_clear(&service->lock);
+  g_free(service);
+}
+
+vapix_session_t *
+vapix_session_new(vapix_service_t *service,
+                  const gchar *username,
+                  GError **err)
+{
+  vapix_session_t *session;
+
+  g_return_val_if_fail(service != NULL, NULL);
+  g_return_val_if_fail(username != NULL, NULL);
+  g_return_val_if_fail(err == NULL || *err == NULL, NULL);
+
+  if (!cache_credentials(service, username, err)) {
+    return NULL;
+  }
+
+  session = g_new0(vapix_session_t, 1);
+  session->service = service;
+  session->username = g_strdup(username);
+  g_rw_lock_init(&session->metrics_lock);
+  session->metrics =
+          g_hash_table_new_full(g_str_hash, g_str_equal, g_free, g_free);
+
+  return session;
+}
+
+void
+vapix_session_free(vapix_session_t *session)
+{
+  GSList *iter;
+
+  if (session == NULL) {
+    return;
+  }
+
+  /* the owner of the session is going away, drop its pending requests, the
+   * queued ones are never dispatched once their idle source is destroyed */
+  g_mutex_lock(&session->service->queued_lock);
+  for (iter = session->queued; iter != NULL; iter = iter->next) {
+    vapix_async_req_t *req = iter->data;
+
+    g_source_destroy(req->idle);
+    g_clear_pointer(&req->idle, g_source_unref);
+    free_async_req(req);
+  }
+  g_clear_pointer(&session->queued, g_slist_free);
+  g_mutex_unlock(&session->service->queued_lock);
+
+  if (session->service->async != NULL) {
+    cancel_async_reqs(session->service->async, session, FALSE);
+  }
+
+  g_hash_table_destroy(session->metrics);
+  g_rw_lock_clear(&session->metrics_lock);
+  g_free(session->username);
+  g_free(session);
+}
+
+/* performs a request with one of the pooled connections of the service, on
+ * success the connection holding the response is returned to be released by
+ * the caller */
+static vapix_conn_t *
+perform_request(vapix_session_t *session,
+                const gchar *endpoint,
+                HTTP_req_method_t req_type,
+                HTTP_media_t media_type,
+                const gchar *post_req,
+                gboolean *retried,
+                GError **err)
+{
+  CURLcode res;
+  vapix_conn_t *conn;
+
+  g_assert(session != NULL);
+  g_assert(endpoint != NULL);
+  g_assert(retried != NULL);
+  g_assert(err == NULL || *err == NULL);
+
+  conn = acquire_conn(session->service, err);
+  if (conn == NULL) {
+    return NULL;
+  }
+
+  while (TRUE) {
+    if (!prepare_conn(conn,
+                      session,
+                      endpoint,
+                      req_type,
+                      media_type,
+                      post_req,
+                      err)) {
+      goto err_out;
+    }
+
+    res = curl_easy_perform(conn->handle);
+
+    if (res != CURLE_OK) {
+      SET_ERROR(err,
+                -1,
+                "curl_easy_perform error %d: '%s'",
+                res,
+                curl_easy_strerror(res));
+      goto err_out;
+    }
+
+    if (*retried || !is_unauthorized(conn)) {
+      break;
+    }
+
+    /* the credentials may have been rotated, re-fetch them and try once more */
+    *retried = TRUE;
+    if (!refresh_credentials(session->service,
+                             session->username,
+                             conn->credentials,
+                             err)) {
+      goto err_out;
+    }
+  }
+
+  if (!check_response(conn, endpoint, err)) {
+    goto err_out;
+  }
+
+  return conn;
+
+err_out:
+  release_conn(session->service, conn);
+
+  return NULL;
+}
+
+gchar *
+vapix_request(vapix_session_t *session,
+              const gchar *endpoint,
+              HTTP_req_method_t req_type,
+              HTTP_media_t media_type,
+              const gchar *post_req,
+              GError **err)
+{
+  vapix_conn_t *conn;
+  gchar *response = NULL;
+  gboolean retried = FALSE;
+  gint64 start = g_get_monotonic_time();
+
+  g_return_val_if_fail(session != NULL, NULL);
+  g_return_val_if_fail(endpoint != NULL, NULL);
+  g_return_val_if_fail(err == NULL || *err == NULL, NULL);
+  g_return_val_if_fail(((req_type == HTTP_GET) && (post_req == NULL)) ||
+                               ((req_type == HTTP_POST) && (post_req != NULL)),
+                       NULL);
+
+  UA_TRACE_ENTRY(vapix_request, endpoint);
+  conn = perform_request(session,
+                         endpoint,
+                         req_type,
+                         media_type,
+                         post_req,
+                         &retried,
+                         err);
+  if (conn != NULL) {
+    response = g_strndup(conn->response->str, conn->response->len);
+    release_conn(session->service, conn);
+  }
+
+  record_request(session, endpoint, start, response == NULL, retried);
+  UA_TRACE_EXIT(vapix_request, endpoint, response == NULL);
+
+  return response;
+}
+
+gboolean
+vapix_request_parse(vapix_session_t *session,
+                    const gchar *endpoint,
+                    HTTP_req_method_t req_type,
+                    HTTP_media_t media_type,
+                    const gchar *post_req,
+                    vapix_parse_func_t parse,
+                    gpointer user_data,
+                    GError **err)
+{
+  vapix_conn_t *conn;
+  gboolean retried = FALSE;
+  gboolean ret;
+  gint64 start = g_get_monotonic_time();
+
+  g_return_val_if_fail(session != NULL, FALSE);
+  g_return_val_if_fail(endpoint != NULL, FALSE);
+  g_return_val_if_fail(parse != NULL, FALSE);
+  g_return_val_if_fail(err == NULL || *err == NULL, FALSE);
+  g_return_val_if_fail(((req_type == HTTP_GET) && (post_req == NULL)) ||
+                               ((req_type == HTTP_POST) && (post_req != NULL)),
+                       FALSE);
+
+  UA_TRACE_ENTRY(vapix_request, endpoint);
+  conn = perform_request(session,
+                         endpoint,
+                         req_type,
+                         media_type,
+                         post_req,
+                         &retried,
+                         err);
+
+  record_request(session, endpoint, start, conn == NULL, retried);
+
+  if (conn == NULL) {
+    UA_TRACE_EXIT(vapix_request, endpoint, TRUE);
+    return FALSE;
+  }
+
+  /* parsed in the buffer of the connection, which is reused afterwards */
+  ret = parse(conn->response->str, conn->response->len, user_data, err);
+  release_conn(session->service, conn);
+  UA_TRACE_EXIT(vapix_request, endpoint, !ret);
+
+  return ret;
+}
+
+gboolean
+vapix_request_async(vapix_session_t *session,
+                    const gchar *endpoint,
+                    HTTP_req_method_t req_type,
+                    HTTP_media_t media_type,
+                    const gchar *post_req,
+                    vapix_response_cb_t callback,
+                    gpointer user_data,
+                    GError **err)
+{
+  vapix_async_req_t *req;
+  vapix_source_t *vs;
+
+  g_return_val_if_fail(session != NULL, FALSE);
+  g_return_val_if_fail(endpoint != NULL, FALSE);
+  g_return_val_if_fail(callback != NULL, FALSE);
+  g_return_val_if_fail(err == NULL || *err == NULL, FALSE);
+  g_return_val_if_fail(((req_type == HTTP_GET) && (post_req == NULL)) ||
+                               ((req_type == HTTP_POST) && (post_req != NULL)),
+                       FALSE);
+
+  vs = session->service->async;
+  if (vs == NULL) {
+    SET_ERROR(err, -1, "The VAPIX service was shut down");
+    return FALSE;
+  }
+
+  req = g_new0(vapix_async_req_t, 1);
+  req->service = session->service;
+  req->session = session;
+  req->endpoint = g_strdup(endpoint);
+  req->req_type = req_type;
+  req->media_type = media_type;
+  req->post_req = g_strdup(post_req);
+  req->callback = callback;
+  req->user_data = user_data;
+  req->start = g_get_monotonic_time();
+
+  /* the multi handle may only be used from the thread running its context,
+   * the request is always started from an idle source, even when called from
+   * that thread, so that the caller returns before @callback runs */
+  req->idle = g_idle_source_new();
+  g_source_set_name(req->idle, "vapix-async-start");
+  g_source_set_callback(req->idle, start_async_req_cb, req, NULL);
+
+  g_mutex_lock(&session->service->queued_lock);
+  session->queued = g_slist_prepend(session->queued, req);
+  g_source_attach(req->idle, g_source_get_context(&vs->source));
+  g_mutex_unlock(&session->service->queued_lock);
+
+  return TRUE;
+}
+
+gchar *
+vapix_get_credentials(const gchar *username, GError **err)
+{
+  GDBusConnection *con = NULL;
+  gchar *credentials = NULL;
+
+  g_return_val_if_fail(username != NULL, NULL);
+  g_return_val_if_fail(err == NULL || *err == NULL, NULL);
+
+  /* NOTE: this is the shared system bus connection of the process, i.e. the
+   * one held by a vapix_service_t if there is any */
+#ifndef VAPIX_CREDENTIALS
+  con = g_bus_get_sync(G_BUS_TYPE_SYSTEM, NULL, err);
+  if (con == NULL) {
+    g_prefix_error(err, "Error connecting to D-Bus: ");
+    return NULL;
+  }
+#endif
+
+  credentials = fetch_credentials(con, username, err);
+
+  g_clear_object(&con);
 
   return credentials;
 }
@@ -0,0 +1,605 @@
+#!/usr/bin/env python3
+#
+# MIT License
+#
+# Copyright (c) 2025 Axis Communications AB
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice (including the next
+# paragraph) shall be included in all copies or substantial portions of the
+# Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+# AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+# SOFTWARE.
+
+"""Compiles the NodeSet2 XML information model of a plugin into static tables.
+
+The model is a single namespace (ns=1) built on top of namespace 0. From
+<prefix>.NodeSet2.xml it writes, in the output directory:
+
+  <prefix>_nodeids.h  the numeric node ids, UA_<SYMBOL>ID_<SYMBOLICNAME>
+  <prefix>_types.h/c  the enumerations of the model as open62541 data types,
+                      UA_TYPES_<SYMBOL>
+  <prefix>_model.h/c  the 'ua_model_t' loaded with ua_model_load() (see
+                      app/include/ua_model.h)
+
+Only objects, variables, object types and enumeration data types are
+supported, the only supported variable values are LocalizedText arrays (e.g.
+EnumStrings).
+"""
+
+import argparse
+import os
+import re
+import sys
+import xml.etree.ElementTree as ET
+
+UA_NS = "{http://opcfoundation.org/UA/2011/03/UANodeSet.xsd}"
+TYPES_NS = "{http://opcfoundation.org/UA/2008/02/Types.xsd}"
+
+# keep in sync with UA_MODEL_MAX_ENUM_STRINGS in ua_model.h
+MAX_ENUM_STRINGS = 32
+
+HAS_TYPE_DEFINITION = 40
+# the hierarchical references a child may hang from its parent with
+HIERARCHICAL = {
+    35,  # Organizes
+    36,  # HasEventSource
+    45,  # HasSubtype
+    46,  # HasProperty
+    47,  # HasComponent
+    48,  # HasNotifier
+    49,  # HasOrderedComponent
+}
+
+NODE_CLASSES = {
+    "UAObject": ("UA_NODECLASS_OBJECT", "Object"),
+    "UAVariable": ("UA_NODECLASS_VARIABLE", "Variable"),
+    "UAObjectType": ("UA_NODECLASS_OBJECTTYPE", "ObjectType"),
+    "UADataType": ("UA_NODECLASS_DATATYPE", "DataType"),
+}
+
+ACCESS_LEVELS = [
+    (0x01, "UA_ACCESSLEVELMASK_READ"),
+    (0x02, "UA_ACCESSLEVELMASK_WRITE"),
+    (0x04, "UA_ACCESSLEVELMASK_HISTORYREAD"),
+    (0x08, "UA_ACCESSLEVELMASK_HISTORYWRITE"),
+    (0x10, "UA_ACCESSLEVELMASK_SEMANTICCHANGE"),
+    (0x20, "UA_ACCESSLEVELMASK_STATUSWRITE"),
+    (0x40, "UA_ACCESSLEVELMASK_TIMESTAMPWRITE"),
+]
+
+EVENT_NOTIFIERS = [
+    (0x01, "UA_EVENTNOTIFIER_SUBSCRIBE_TO_EVENT"),
+    (0x04, "UA_EVENTNOTIFIER_HISTORY_READ"),
+    (0x08, "UA_EVENTNOTIFIER_HISTORY_WRITE"),
+]
+
+VALUE_RANKS = {
+    -3: "UA_VALUERANK_SCALAR_OR_ONE_DIMENSION",
+    -2: "UA_VALUERANK_ANY",
+    -1: "UA_VALUERANK_SCALAR",
+    0: "UA_VALUERANK_ONE_OR_MORE_DIMENSIONS",
+    1: "UA_VALUERANK_ONE_DIMENSION",
+    2: "UA_VALUERANK_TWO_DIMENSIONS",
+    3: "UA_VALUERANK_THREE_DIMENSIONS",
+}
+
+LICENSE = """/**
+ * MIT License
+ *
+ * Copyright (c) 2025 Axis Communications AB
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+"""
+
+
+class ModelError(Exception):
+    pass
+
+
+class NodeId:
+    """a numeric node id of namespace 0 or of the model (ns=1)"""
+
+    def __init__(self, local, ident, alias=None):
+        self.local = local
+        self.ident = ident
+        self.alias = alias
+
+    def key(self):
+        return (self.local, self.ident)
+
+
+class Node:
+    def __init__(self, elem, tag):
+        self.elem = elem
+        self.tag = tag
+        self.node_class, self.class_name = NODE_CLASSES[tag]
+        self.node_id = None
+        self.browse_ns0 = False
+        self.browse_name = None
+        self.symbol = None
+        self.display_name = None
+        self.description = None
+        self.parent = None
+        self.reference_type = None
+        self.type_definition = None
+        self.references = []  # (reference type, target, is forward)
+
+
+class Model:
+    def __init__(self, path):
+        self.path = path
+        self.aliases = {}
+        self.namespace_uri = None
+        self.nodes = []
+        self.by_id = {}
+
+    def parse_id(self, text):
+        text = text.strip()
+        if text in self.aliases:
+            nid = self.parse_id(self.aliases[text])
+            nid.alias = text
+            return nid
+        m = re.fullmatch(r"(?:ns=(\d+);)?i=(\d+)", text)
+        if m is None:
+            raise ModelError("unsupported node id '%s', only numeric ids are"
+                             % text)
+        ns = int(m.group(1) or 0)
+        if ns not in (0, 1):
+            raise ModelError("node id '%s' is neither in namespace 0 nor in "
+                             "the namespace of the model" % text)
+        return NodeId(ns == 1, int(m.group(2)))
+
+    def load(self):
+        root = ET.parse(self.path).getroot()
+
+        uris = root.findall(UA_NS + "NamespaceUris/" + UA_NS + "Uri")
+        if len(uris) != 1:
+            raise ModelError("the model must have exactly one namespace")
+        self.namespace_uri = uris[0].text.strip()
+
+        for alias in root.findall(UA_NS + "Aliases/" + UA_NS + "Alias"):
+            self.aliases[alias.get("Alias")] = alias.text.strip()
+
+        for elem in root:
+            tag = elem.tag[len(UA_NS):]
+            if tag in ("NamespaceUris", "Aliases", "Models", "Extensions"):
+                continue
+            if tag not in NODE_CLASSES:
+                raise ModelError("unsupported node class %s" % tag)
+            self.nodes.append(self.load_node(elem, tag))
+
+        for node in self.nodes:
+            self.by_id[node.node_id.key()] = node
+        for node in self.nodes:
+            self.resolve_parent(node)
+
+    def load_node(self, elem, tag):
+        node = Node(elem, tag)
+        node.node_id = self.parse_id(elem.get("NodeId"))
+        if not node.node_id.local:
+            raise ModelError("node %s is not in the namespace of the model"
+                             % elem.get("NodeId"))
+
+        name = elem.get("BrowseName")
+        m = re.fullmatch(r"(?:(\d+):)?(.+)", name)
+        node.browse_ns0 = m.group(1) is None
+        if not node.browse_ns0 and m.group(1) != "1":
+            raise ModelError("unsupported browse name '%s'" % name)
+        node.browse_name = m.group(2)
+        node.symbol = elem.get("SymbolicName") or node.browse_name
+        if not re.fullmatch(r"\w+", node.symbol):
+            raise ModelError("node %s needs a SymbolicName" % name)
+
+        display = elem.find(UA_NS + "DisplayName")
+        node.display_name = (display.text if display is not None
+                             else node.browse_name)
+        desc = elem.find(UA_NS + "Description")
+        node.description = desc.text if desc is not None else None
+
+        for ref in elem.findall(UA_NS + "References/" + UA_NS + "Reference"):
+            forward = ref.get("IsForward", "true").lower() != "false"
+            node.references.append((self.parse_id(ref.get("ReferenceType")),
+                                    self.parse_id(ref.text),
+                                    forward))
+        return node
+
+    def resolve_parent(self, node):
+        parent_text = node.elem.get("ParentNodeId")
+        parent = self.parse_id(parent_text) if parent_text else None
+
+        for ref_type, target, forward in node.references:
+            if forward and ref_type.ident == HAS_TYPE_DEFINITION:
+                node.type_definition = target
+
+        # the inverse hierarchical reference of the node to its parent
+        for ref_type, target, forward in node.references:
+            if (not forward and not ref_type.local and
+                    ref_type.ident in HIERARCHICAL and
+                    (parent is None or target.key() == parent.key())):
+                node.parent = target
+                node.reference_type = ref_type
+                break
+        else:
+            # or the forward one of the parent to the node
+            other = self.by_id.get(parent.key()) if parent else None
+            for ref_type, target, forward in (other.references if other
+                                              else []):
+                if forward and target.key() == node.node_id.key():
+                    node.parent = parent
+                    node.reference_type = ref_type
+                    break
+            else:
+                raise ModelError("node %s has no parent" % node.symbol)
+
+        if (node.tag in ("UAObject", "UAVariable") and
+                node.type_definition is None):
+            raise ModelError("node %s has no type definition" % node.symbol)
+
+    def order_check(self):
+        seen = set()
+        for node in self.nodes:
+            if node.parent.local and node.parent.key() not in seen:
+                raise ModelError("node %s comes before its parent"
+                                 % node.symbol)
+            seen.add(node.node_id.key())
+
+    def extra_references(self):
+        """the references which are neither parent links nor type
+        definitions, each one once"""
+        implied = set()
+        for node in self.nodes:
+            implied.add((node.parent.key(), node.reference_type.key(),
+                         node.node_id.key()))
+            if node.type_definition is not None:
+                implied.add((node.node_id.key(), (False, HAS_TYPE_DEFINITION),
+                             node.type_definition.key()))
+
+        refs = []
+        for node in self.nodes:
+            for ref_type, target, forward in node.references:
+                if forward:
+                    key = (node.node_id.key(), ref_type.key(), target.key())
+                else:
+                    key = (target.key(), ref_type.key(), node.node_id.key())
+                if key in implied:
+                    continue
+                implied.add(key)
+                refs.append((node, ref_type, target, forward))
+        return refs
+
+
+class Generator:
+    def __init__(self, model, prefix, symbol, xml_name):
+        self.model = model
+        self.prefix = prefix
+        self.symbol = symbol
+        self.xml_name = xml_name
+
+    def banner(self):
+        return (LICENSE + "\n/* Generated by tools/ua_model_gen.py from %s, "
+                "do not edit */\n" % self.xml_name)
+
+    def guard(self, suffix):
+        return "__%s_%s_H__" % (self.prefix.upper(), suffix)
+
+    def id_macro(self, node):
+        return "UA_%sID_%s" % (self.symbol, node.symbol.upper())
+
+    def model_id(self, nid):
+        if nid.local:
+            node = self.model.by_id.get(nid.key())
+            if node is not None:
+                return "UA_MODEL_LOCAL(%s)" % self.id_macro(node)
+            return "UA_MODEL_LOCAL(%u)" % nid.ident
+        return "UA_MODEL_NS0(%u)" % nid.ident
+
+    def id_field(self, name, nid):
+        """a node id member of a table entry, commented with its alias"""
+        line = "    .%s = %s," % (name, self.model_id(nid))
+        if not nid.local and nid.alias is not None:
+            line += " /* %s */" % nid.alias
+        return line
+
+    @staticmethod
+    def mask(value, names):
+        if value == 0:
+            return "0"
+        parts = [name for bit, name in names if value & bit]
+        if sum(bit for bit, _ in names if value & bit) != value:
+            return "0x%02x" % value
+        return " | ".join(parts)
+
+    @staticmethod
+    def c_string(text):
+        return '"%s"' % text.replace("\\", "\\\\").replace('"', '\\"')
+
+    def enums(self):
+        types = []
+        for node in sorted(self.model.nodes, key=lambda n: n.node_id.ident):
+            if node.tag != "UADataType":
+                continue
+            definition = node.elem.find(UA_NS + "Definition")
+            fields = (definition.findall(UA_NS + "Field")
+                      if definition is not None else [])
+            if not fields or any(f.get("Value") is None for f in fields):
+                raise ModelError("data type %s is not an enumeration, only "
+                                 "enumerations are supported" % node.symbol)
+            types.append((node, [(f.get("Name"), int(f.get("Value")))
+                                 for f in fields]))
+        return types
+
+    def nodeids_h(self):
+        out = [self.banner(), "#ifndef %s" % self.guard("NODEIDS"),
+               "#define %s" % self.guard("NODEIDS"), "",
+               "/* clang-format off */"]
+        for node in sorted(self.model.nodes, key=lambda n: n.node_id.ident):
+            out.append("#define %s %u /* %s */" % (self.id_macro(node),
+                                                   node.node_id.ident,
+                                                   node.class_name))
+        out += ["/* clang-format on */", "",
+                "#endif /* %s */" % self.guard("NODEIDS"), ""]
+        return "\n".join(out)
+
+    def types_h(self, enums):
+        types = "UA_TYPES_%s" % self.symbol
+        out = [self.banner(), "#ifndef %s" % self.guard("TYPES"),
+               "#define %s" % self.guard("TYPES"), "",
+               "#include <open62541/types.h>", "",
+               "/**",
+               " * Every type is assigned an index in an array containing the "
+               "type descriptions.",
+               " * These descriptions are used during type handling (copying,"
+               " deletion,",
+               " * binary encoding, ...). */",
+               "#define %s_COUNT %u" % (types, len(enums)),
+               "extern UA_EXPORT UA_DataType %s[%s_COUNT];" % (types, types)]
+        for index, (node, fields) in enumerate(enums):
+            name = node.browse_name
+            upper = name.upper()
+            out += ["", "/* %s */" % name, "typedef enum {"]
+            for field, value in fields:
+                out.append("  UA_%s_%s = %d," % (upper, field.upper(), value))
+            out += ["  __UA_%s_FORCE32BIT = 0x7fffffff" % upper,
+                    "} UA_%s;" % name, "",
+                    "UA_STATIC_ASSERT(sizeof(UA_%s) == sizeof(UA_Int32),"
+                    % name,
+                    "                 enum_must_be_32bit);", "",
+                    "#define %s_%s %u" % (types, upper, index)]
+        out += ["", "#endif /* %s */" % self.guard("TYPES"), ""]
+        return "\n".join(out)
+
+    def types_c(self, enums):
+        types = "UA_TYPES_%s" % self.symbol
+        out = [self.banner(), '#include "%s_nodeids.h"' % self.prefix,
+               '#include "%s_types.h"' % self.prefix, ""]
+        for node, _ in enums:
+            out += ["/* %s */" % node.browse_name,
+                    "#define %s_members NULL" % node.browse_name, ""]
+        out += ["/* clang-format off */",
+                "UA_DataType %s[%s_COUNT] = {" % (types, types)]
+        for node, _ in enums:
+            name = node.browse_name
+            out += [
+                "  /* %s */" % name,
+                "  {",
+                "   %-49s/* .typeName */"
+                % ('UA_TYPENAME("%s")' % name),
+                "          { 0, UA_NODEIDTYPE_NUMERIC, { %s } },"
+                % self.id_macro(node),
+                "                                                    "
+                "/* .typeId */",
+                "          { 0, UA_NODEIDTYPE_NUMERIC, { 0 } },      "
+                "/* .binaryEncodingId */",
+                "          %-42s/* .memSize */" % ("sizeof(UA_%s)," % name),
+                "          UA_DATATYPEKIND_ENUM,                     "
+                "/* .typeKind */",
+                "          true,                                     "
+                "/* .pointerFree */",
+                "          UA_BINARY_OVERLAYABLE_INTEGER,            "
+                "/* .overlayable */",
+                "          0,                                        "
+                "/* .membersSize */",
+                "          %-42s/* .members */" % ("%s_members" % name),
+                "  },"]
+        out += ["};", "/* clang-format on */", ""]
+        return "\n".join(out)
+
+    def model_h(self):
+        out = [self.banner(), "#ifndef %s" % self.guard("MODEL"),
+               "#define %s" % self.guard("MODEL"), "",
+               '#include "ua_model.h"', "",
+               "/* the information model of %s, see ua_model_load() */"
+               % self.xml_name,
+               "extern const ua_model_t %s_model;" % self.prefix, "",
+               "#endif /* %s */" % self.guard("MODEL"), ""]
+        return "\n".join(out)
+
+    def variable_fields(self, node, out):
+        elem = node.elem
+        data_type = self.model.parse_id(elem.get("DataType", "i=24"))
+        out.append(self.id_field("data_type", data_type))
+        out.append("    .access_level = %s,"
+                   % self.mask(int(elem.get("AccessLevel", "1")),
+                               ACCESS_LEVELS))
+        if elem.get("UserAccessLevel") is not None:
+            out.append("    .user_access_level = %s,"
+                       % self.mask(int(elem.get("UserAccessLevel")),
+                                   ACCESS_LEVELS))
+        rank = int(elem.get("ValueRank", "-1"))
+        out.append("    .value_rank = %s," % VALUE_RANKS.get(rank, str(rank)))
+        dims = elem.get("ArrayDimensions")
+        if dims:
+            if "," in dims:
+                raise ModelError("%s: only one array dimension is supported"
+                                 % node.symbol)
+            out.append("    .array_length = %u," % int(dims))
+
+        value = elem.find(UA_NS + "Value")
+        if value is None:
+            return None
+        texts = value.find(TYPES_NS + "ListOfLocalizedText")
+        if texts is None or len(value) != 1:
+            raise ModelError("%s: only LocalizedText array values are "
+                             "supported" % node.symbol)
+        strings = [t.findtext(TYPES_NS + "Text", "")
+                   for t in texts.findall(TYPES_NS + "LocalizedText")]
+        if len(strings) > MAX_ENUM_STRINGS:
+            raise ModelError("%s: more than %u strings" % (node.symbol,
+                                                           MAX_ENUM_STRINGS))
+        array = "strings_%u" % node.node_id.ident
+        out.append("    .enum_strings = %s," % array)
+        out.append("    .nr_enum_strings = G_N_ELEMENTS(%s)," % array)
+        return (array, strings)
+
+    def model_c(self, enums):
+        nodes = []
+        arrays = []
+        for node in self.model.nodes:
+            out = ["  { /* %s */" % node.symbol,
+                   "    .node_class = %s," % node.node_class,
+                   self.id_field("id", node.node_id),
+                   self.id_field("parent", node.parent),
+                   self.id_field("reference_type", node.reference_type)]
+            if node.type_definition is not None:
+                out.append(self.id_field("type_definition",
+                                         node.type_definition))
+            if node.browse_ns0:
+                out.append("    .browse_ns0 = UA_TRUE,")
+            out.append("    .browse_name = %s,"
+                       % self.c_string(node.browse_name))
+            out.append("    .display_name = %s,"
+                       % self.c_string(node.display_name))
+            if node.description is not None:
+                out.append("    .description = %s,"
+                           % self.c_string(node.description))
+            if node.elem.get("IsAbstract", "false").lower() == "true":
+                out.append("    .is_abstract = UA_TRUE,")
+            if node.tag == "UAObject":
+                notifier = int(node.elem.get("EventNotifier", "0"))
+                if notifier != 0:
+                    out.append("    .event_notifier = %s,"
+                               % self.mask(notifier, EVENT_NOTIFIERS))
+            if node.tag == "UAVariable":
+                array = self.variable_fields(node, out)
+                if array is not None:
+                    arrays.append(array)
+            out.append("  },")
+            nodes += out
+
+        refs = []
+        for node, ref_type, target, forward in self.model.extra_references():
+            refs += ["  {",
+                     self.id_field("source", node.node_id),
+                     self.id_field("reference_type", ref_type),
+                     self.id_field("target", target),
+                     "    .is_forward = %s," % ("UA_TRUE" if forward
+                                                else "UA_FALSE"),
+                     "  },"]
+
+        out = [self.banner(), "#include <glib.h>", "",
+               '#include "%s_model.h"' % self.prefix,
+               '#include "%s_nodeids.h"' % self.prefix,
+               '#include "%s_types.h"' % self.prefix, "",
+               "/* clang-format off */"]
+        for array, strings in arrays:
+            out.append("static const char *const %s[] = { %s };"
+                       % (array, ", ".join(self.c_string(s) for s in strings)))
+        if arrays:
+            out.append("")
+        if enums:
+            types = "UA_TYPES_%s" % self.symbol
+            out += ["static UA_DataTypeArray types = {",
+                    "  NULL,",
+                    "  %s_COUNT," % types,
+                    "  %s," % types,
+                    "  UA_FALSE",
+                    "};", ""]
+        out += ["static const ua_model_node_t nodes[] = {"] + nodes + ["};"]
+        if refs:
+            out += ["", "static const ua_model_reference_t references[] = {"]
+            out += refs + ["};"]
+        out += ["/* clang-format on */", "",
+                "const ua_model_t %s_model = {" % self.prefix,
+                "  .namespace_uri = %s," % self.c_string(
+                    self.model.namespace_uri),
+                "  .nodes = nodes,",
+                "  .nr_nodes = G_N_ELEMENTS(nodes),"]
+        if refs:
+            out += ["  .references = references,",
+                    "  .nr_references = G_N_ELEMENTS(references),"]
+        if enums:
+            out += ["  .types = UA_TYPES_%s," % self.symbol,
+                    "  .nr_types = UA_TYPES_%s_COUNT," % self.symbol,
+                    "  .type_array = &types,"]
+        out += ["};", ""]
+        return "\n".join(out)
+
+    def write(self, outdir):
+        enums = self.enums()
+        files = {
+            "%s_nodeids.h" % self.prefix: self.nodeids_h(),
+            "%s_types.h" % self.prefix: self.types_h(enums),
+            "%s_types.c" % self.prefix: self.types_c(enums),
+            "%s_model.h" % self.prefix: self.model_h(),
+            "%s_model.c" % self.prefix: self.model_c(enums),
+        }
+        for name, text in files.items():
+            with open(os.path.join(outdir, name), "w") as f:
+                f.write(text)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("--prefix", required=True,
+                        help="prefix of the generated files, e.g. ioports")
+    parser.add_argument("--symbol", required=True,
+                        help="prefix of the generated symbols, e.g. IOP")
+    parser.add_argument("--outdir", default=".",
+                        help="directory of the generated files")
+    parser.add_argument("nodeset", help="the NodeSet2 XML file")
+    args = parser.parse_args()
+
+    model = Model(args.nodeset)
+    try:
+        model.load()
+        model.order_check()
+        Generator(model, args.prefix, args.symbol,
+                  os.path.basename(args.nodeset)).write(args.outdir)
+    except (ModelError, ET.ParseError) as e:
+        sys.exit("%s: %s" % (args.nodeset, e))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,175 @@
+#!/usr/bin/env python3
+#
+# MIT License
+#
+# Copyright (c) 2025 Axis Communications AB
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice (including the next
+# paragraph) shall be included in all copies or substantial portions of the
+# Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+# AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+# SOFTWARE.
+
+"""Measures the read throughput of the server with and without security.
+
+For each security policy and mode the script opens a session, reads a variable
+--requests times from --concurrency concurrent tasks sharing the secure
+channel, and reports the time of the handshake (secure channel and session),
+the reads per second, the mean duration of a read and the factor by which the
+path is slower than the unencrypted one.
+
+The signed and encrypted endpoints need the server to run with the 'Security'
+parameter set, and a client certificate (DER) and private key (PEM) whose URI
+is passed with --application-uri. The certificate has to be in the
+localdata/pki/trusted directory of the application unless it is empty. The
+exit status is 1 when a secured path is more than --max-factor times slower
+than the unencrypted one. It requires asyncua (pip install asyncua).
+"""
+
+import argparse
+import asyncio
+import sys
+import time
+
+try:
+    from asyncua import Client, ua
+    from asyncua.crypto import security_policies
+except ImportError:
+    sys.exit("asyncua is missing, pip install asyncua")
+
+# the server's current time, a variable without a plugin behind it
+DEFAULT_NODE = "ns=0;i=2258"
+DEFAULT_PATHS = ("None:None,"
+                 "Basic256Sha256:Sign,Basic256Sha256:SignAndEncrypt,"
+                 "Aes128Sha256RsaOaep:SignAndEncrypt")
+
+
+def parse_paths(value):
+    """Turns "<policy>:<mode>,..." into a list of (policy, mode)."""
+    paths = []
+    for item in value.split(","):
+        policy, _, mode = item.strip().partition(":")
+        if policy != "None" and \
+                not hasattr(security_policies, "SecurityPolicy" + policy):
+            raise argparse.ArgumentTypeError("unknown policy %s" % policy)
+        if not hasattr(ua.MessageSecurityMode, mode or "None"):
+            raise argparse.ArgumentTypeError("unknown mode %s" % mode)
+        paths.append((policy, mode or "None"))
+    return paths
+
+
+async def measure(args, policy, mode):
+    """Returns the handshake time and the read durations, in seconds."""
+    client = Client(args.url, timeout=args.timeout)
+    client.application_uri = args.application_uri
+    if policy != "None":
+        await client.set_security(
+            getattr(security_policies, "SecurityPolicy" + policy),
+            certificate=args.cert,
+            private_key=args.key,
+            mode=getattr(ua.MessageSecurityMode, mode))
+
+    start = time.perf_counter()
+    await client.connect()
+    connect_time = time.perf_counter() - start
+    try:
+        node = client.get_node(args.node)
+        for _ in range(args.warmup):
+            await node.read_value()
+
+        durations = []
+        remaining = [args.requests]
+
+        async def reader():
+            while remaining[0] > 0:
+                remaining[0] -= 1
+                t = time.perf_counter()
+                await node.read_value()
+                durations.append(time.perf_counter() - t)
+
+        start = time.perf_counter()
+        await asyncio.gather(*(reader() for _ in range(args.concurrency)))
+        elapsed = time.perf_counter() - start
+    finally:
+        await client.disconnect()
+
+    return connect_time, durations, elapsed
+
+
+async def run(args):
+    rows = []
+    for policy, mode in args.paths:
+        if policy != "None" and (args.cert is None or args.key is None):
+            sys.exit("%s:%s needs --cert and --key" % (policy, mode))
+        try:
+            rows.append((policy, mode) + await measure(args, policy, mode))
+        except (OSError, asyncio.TimeoutError, ua.UaError) as e:
+            sys.exit("%s:%s: %s" % (policy, mode, e))
+    return rows
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("url", help="e.g. opc.tcp://192.168.0.90:4840")
+    parser.add_argument("--paths", type=parse_paths,
+                        default=parse_paths(DEFAULT_PATHS),
+                        help="<policy>:<mode>,... default %s" % DEFAULT_PATHS)
+    parser.add_argument("--node", default=DEFAULT_NODE,
+                        help="the variable to read, default %s" % DEFAULT_NODE)
+    parser.add_argument("--requests", type=int, default=5000,
+                        help="reads per path, default 5000")
+    parser.add_argument("--concurrency", type=int, default=4,
+                        help="reads in flight, default 4")
+    parser.add_argument("--warmup", type=int, default=100,
+                        help="reads before the measurement, default 100")
+    parser.add_argument("--timeout", type=float, default=10,
+                        help="seconds to wait for a response, default 10")
+    parser.add_argument("--cert", help="the client certificate (DER)")
+    parser.add_argument("--key", help="the private key of --cert (PEM)")
+    parser.add_argument("--application-uri", default="urn:ua_read_bench",
+                        help="the URI in --cert, default urn:ua_read_bench")
+    parser.add_argument("--max-factor", type=float, default=2.0,
+                        help="slowest secured path relative to None, "
+                             "default 2.0")
+    args = parser.parse_args()
+
+    rows = asyncio.run(run(args))
+
+    baseline = None
+    for policy, mode, _, durations, elapsed in rows:
+        if policy == "None":
+            baseline = len(durations) / elapsed
+
+    status = 0
+    print("%-20s %-15s %10s %9s %8s %7s" %
+          ("policy", "mode", "connect_ms", "reads/s", "mean_ms", "factor"))
+    for policy, mode, connect_time, durations, elapsed in rows:
+        rate = len(durations) / elapsed
+        factor = baseline / rate if baseline else float("nan")
+        print("%-20s %-15s %10.1f %9.1f %8.2f %7.2f" %
+              (policy, mode, connect_time * 1000, rate,
+               sum(durations) / len(durations) * 1000, factor))
+        if policy != "None" and factor > args.max_factor:
+            status = 1
+
+    if status:
+        sys.stderr.write("a secured path is more than %.2f times slower than "
+                         "None\n" % args.max_factor)
+    return status
+
+
+if __name__ == "__main__":
+    sys.exit(main())
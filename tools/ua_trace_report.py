@@ -0,0 +1,179 @@
+#!/usr/bin/env python3
+#
+# MIT License
+#
+# Copyright (c) 2025 Axis Communications AB
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice (including the next
+# paragraph) shall be included in all copies or substantial portions of the
+# Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+# AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+# SOFTWARE.
+
+"""Turns a trace of the server tracepoints into a latency breakdown per stage.
+
+The input is the output of tools/ua_trace.bt (see app/include/ua_trace.h):
+
+  <nsecs> <tid> <probe> <tag>            for an entry
+  <nsecs> <tid> <probe> <status> <tag>   for an exit
+
+The entry and the exit of a stage are paired per thread. A stage entered while
+another one runs on the same thread, e.g. a VAPIX request made by a data source
+read, is nested in it: the "self" time of a stage is its duration minus the
+durations of the stages nested in it. The report has one row per stage and tag
+with the count, the number of non-zero exit statuses and the durations, in
+microseconds, sorted by the total time.
+"""
+
+import argparse
+import sys
+
+
+class Stats:
+    """The durations of a stage and tag."""
+
+    def __init__(self):
+        self.durations = []
+        self.self_sum = 0
+        self.errors = 0
+
+    def add(self, duration, self_time, status):
+        self.durations.append(duration)
+        self.self_sum += self_time
+        if status != 0:
+            self.errors += 1
+
+    def percentile(self, p):
+        """Nearest-rank percentile of the sorted durations."""
+        index = max(0, -(-len(self.durations) * p // 100) - 1)
+        return self.durations[index]
+
+
+def probe_name(probe):
+    """'usdt:/path/opcpluginserver:opcua:vapix_request_entry' ->
+    ('vapix_request', 'entry')"""
+    name = probe.rsplit(":", 1)[-1]
+    stage, _, kind = name.rpartition("_")
+    return stage, kind
+
+
+def parse(lines, keep_query):
+    """Pairs the entries and exits, returns the Stats per (stage, tag) and the
+    number of entries left without an exit."""
+    stats = {}
+    # per thread, the stack of the running stages: [stage, tag, start, nested]
+    stacks = {}
+    unmatched = 0
+
+    for line in lines:
+        fields = line.split(None, 3)
+        if len(fields) < 3 or not fields[0].isdigit():
+            # e.g. the "Attaching N probes..." banner of bpftrace
+            continue
+        nsecs, tid = int(fields[0]), fields[1]
+        stage, kind = probe_name(fields[2])
+        rest = fields[3].rstrip("\n") if len(fields) > 3 else ""
+        stack = stacks.setdefault(tid, [])
+
+        if kind == "entry":
+            tag = rest
+            if not keep_query:
+                tag = tag.split("?", 1)[0]
+            stack.append([stage, tag, nsecs, 0])
+            continue
+        if kind != "exit":
+            continue
+
+        status, _, _ = rest.partition(" ")
+        try:
+            status = int(status)
+        except ValueError:
+            continue
+        # drop the stages whose exit was lost
+        while stack and stack[-1][0] != stage:
+            stack.pop()
+            unmatched += 1
+        if not stack:
+            continue
+
+        stage, tag, start, nested = stack.pop()
+        duration = (nsecs - start) // 1000
+        stats.setdefault((stage, tag), Stats()).add(duration,
+                                                    duration - nested,
+                                                    status)
+        if stack:
+            stack[-1][3] += duration
+
+    unmatched += sum(len(stack) for stack in stacks.values())
+    return stats, unmatched
+
+
+def report(stats, by_stage, out):
+    if by_stage:
+        merged = {}
+        for (stage, _), s in stats.items():
+            m = merged.setdefault((stage, "*"), Stats())
+            m.durations.extend(s.durations)
+            m.self_sum += s.self_sum
+            m.errors += s.errors
+        stats = merged
+
+    rows = []
+    for (stage, tag), s in stats.items():
+        s.durations.sort()
+        total = sum(s.durations)
+        rows.append((total, stage, tag, s))
+    rows.sort(key=lambda row: row[0], reverse=True)
+
+    header = ("stage", "count", "errors", "total", "mean", "self",
+              "p50", "p99", "max", "tag")
+    out.write("%-16s %8s %6s %10s %8s %8s %8s %8s %8s  %s\n" % header)
+    for total, stage, tag, s in rows:
+        count = len(s.durations)
+        out.write("%-16s %8d %6d %10d %8d %8d %8d %8d %8d  %s\n" %
+                  (stage, count, s.errors, total, total // count,
+                   s.self_sum // count, s.percentile(50), s.percentile(99),
+                   s.durations[-1], tag))
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("--by-stage", action="store_true",
+                        help="one row per stage instead of per stage and tag")
+    parser.add_argument("--keep-query", action="store_true",
+                        help="keep the query of the VAPIX endpoints in the tag")
+    parser.add_argument("trace", nargs="?", default="-",
+                        help="the output of ua_trace.bt, default stdin")
+    args = parser.parse_args()
+
+    try:
+        if args.trace == "-":
+            stats, unmatched = parse(sys.stdin, args.keep_query)
+        else:
+            with open(args.trace) as f:
+                stats, unmatched = parse(f, args.keep_query)
+    except OSError as e:
+        sys.exit("%s: %s" % (args.trace, e))
+
+    report(stats, args.by_stage, sys.stdout)
+    if unmatched:
+        sys.stderr.write("%d entries without an exit were ignored\n" %
+                         unmatched)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,297 @@
+#!/usr/bin/env python3
+#
+# MIT License
+#
+# Copyright (c) 2025 Axis Communications AB
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice (including the next
+# paragraph) shall be included in all copies or substantial portions of the
+# Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+# AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+# SOFTWARE.
+
+"""Serves the VAPIX APIs used by the plugins, for the host load benchmark.
+
+It answers the thermometry.cgi, io/portmanagement.cgi, basicdeviceinfo.cgi and
+virtualinput/*.cgi requests of the thermal, ioports, bdi and vinput plugins
+with generated responses of --areas areas and --ports ports, whose temperatures
+and input states change over time, after --latency-ms (plus up to
+--jitter-ms). A file of --responses named <cgi>.<method>.json (JSON APIs, e.g.
+thermometry.getAreaStatus.json) or <cgi>.xml (e.g. activate.xml) is served
+instead, e.g. a response recorded on a device. The credentials are not
+checked. On exit it prints the number of requests per API and method.
+
+The application is pointed at it by building with
+-DVAPIX_URL=\"http://127.0.0.1:<port>/axis-cgi/%s\", see app/bench/Makefile.
+"""
+
+import argparse
+import collections
+import http.server
+import json
+import os
+import random
+import signal
+import sys
+import threading
+import time
+import urllib.parse
+
+VINPUT_RESPONSE = """<?xml version="1.0" encoding="UTF-8"?>
+<VirtualInputResponse SchemaVersion="1.0">
+  <Success>
+    <%(tag)s>
+      <StateChanged>%(changed)s</StateChanged>
+    </%(tag)s>
+  </Success>
+</VirtualInputResponse>
+"""
+VINPUT_SCHEMA_RESPONSE = """<?xml version="1.0" encoding="UTF-8"?>
+<VirtualInputResponse SchemaVersion="1.0">
+  <Success>
+    <SchemaVersion>
+      <MajorVersion>1</MajorVersion>
+      <MinorVersion>0</MinorVersion>
+    </SchemaVersion>
+  </Success>
+</VirtualInputResponse>
+"""
+
+
+class Device:
+    """The state behind the responses, shared by the handler threads."""
+
+    def __init__(self, areas, ports):
+        self.lock = threading.Lock()
+        self.start = time.monotonic()
+        self.areas = areas
+        self.ports = [{
+            "port": str(i),
+            "configurable": True,
+            "readonly": False,
+            "usage": "",
+            "name": "Port %d" % (i + 1),
+            "direction": "output" if i % 2 else "input",
+            "state": "open",
+            "normalState": "open",
+        } for i in range(ports)]
+        self.vinputs = {}
+        self.requests = collections.Counter()
+
+    def thermometry(self, method, params):
+        if method == "getSupportedVersions":
+            return {"apiVersions": ["1.2"]}
+        if method == "listAreas":
+            return {"arealist": [{
+                "id": i + 1,
+                "enabled": True,
+                "name": "Area %d" % (i + 1),
+                "detectionType": "above",
+                "measurement": "max",
+                "threshold": 40,
+                "presetNbr": params.get("presetNbr", 0),
+            } for i in range(self.areas)]}
+        if method == "getAreaStatus":
+            # a slow drift, so that the monitored items see changes
+            t = time.monotonic() - self.start
+            return {"arealist": [{
+                "id": i + 1,
+                "avg": round(20.0 + (t + i) % 10, 2),
+                "min": round(15.0 + (t + i) % 5, 2),
+                "max": round(30.0 + (t + i) % 20, 2),
+                "triggered": (t + i) % 20 > 10,
+            } for i in range(self.areas)]}
+        if method == "setTemperatureScale":
+            return {}
+        return None
+
+    def portmanagement(self, method, params):
+        if method == "getSupportedVersions":
+            return {"apiVersions": ["1.0", "1.1"]}
+        if method == "getPorts":
+            # the inputs toggle every few seconds
+            tick = int(time.monotonic() - self.start) // 5
+            with self.lock:
+                for i, port in enumerate(self.ports):
+                    if port["direction"] == "input":
+                        port["state"] = "closed" if (tick + i) % 2 else "open"
+                items = [dict(port) for port in self.ports]
+            return {"numberOfPorts": len(items), "items": items}
+        if method == "setPorts":
+            with self.lock:
+                for change in params.get("ports", []):
+                    nr = int(change.get("port", -1))
+                    if 0 <= nr < len(self.ports):
+                        self.ports[nr].update(
+                            (k, v) for k, v in change.items() if k != "port")
+            return {}
+        return None
+
+    def basicdeviceinfo(self, method, params):
+        if method == "getAllProperties":
+            return {"propertyList": {
+                "Architecture": "x86_64",
+                "Brand": "AXIS",
+                "BuildDate": "Jan 01 2025 00:00",
+                "HardwareID": "000",
+                "ProdFullName": "AXIS Mock Device",
+                "ProdNbr": "Mock",
+                "ProdShortName": "AXIS Mock",
+                "ProdType": "Network Camera",
+                "ProdVariant": "",
+                "SerialNumber": "ACCC8E000000",
+                "Soc": "Host",
+                "SocSerialNumber": "00000000-00000000-00000000-00000000",
+                "Version": "12.0.0",
+                "WebURL": "http://www.axis.com",
+            }}
+        return None
+
+    def vinput(self, cgi, query):
+        if cgi == "getschemaversions.cgi":
+            return VINPUT_SCHEMA_RESPONSE
+        port = query.get("port", ["0"])[0]
+        state = cgi == "activate.cgi"
+        with self.lock:
+            changed = self.vinputs.get(port, False) != state
+            self.vinputs[port] = state
+        return VINPUT_RESPONSE % {
+            "tag": "ActivateSuccess" if state else "DeactivateSuccess",
+            "changed": "true" if changed else "false",
+        }
+
+
+class Handler(http.server.BaseHTTPRequestHandler):
+    protocol_version = "HTTP/1.1"
+    json_apis = {
+        "thermometry.cgi": "thermometry",
+        "io/portmanagement.cgi": "portmanagement",
+        "basicdeviceinfo.cgi": "basicdeviceinfo",
+    }
+
+    def log_message(self, format, *args):
+        pass
+
+    def delay(self):
+        args = self.server.args
+        seconds = (args.latency_ms + random.uniform(0, args.jitter_ms)) / 1000
+        if seconds > 0:
+            time.sleep(seconds)
+
+    def recorded(self, name):
+        if self.server.args.responses is None:
+            return None
+        path = os.path.join(self.server.args.responses, name)
+        try:
+            with open(path, "rb") as f:
+                return f.read()
+        except FileNotFoundError:
+            return None
+
+    def reply(self, status, body, content_type):
+        self.send_response(status)
+        self.send_header("Content-Type", content_type)
+        self.send_header("Content-Length", str(len(body)))
+        self.end_headers()
+        self.wfile.write(body)
+
+    def do_POST(self):
+        url = urllib.parse.urlsplit(self.path)
+        length = int(self.headers.get("Content-Length", 0))
+        try:
+            request = json.loads(self.rfile.read(length) or b"{}")
+            method = request["method"]
+        except (ValueError, KeyError):
+            self.reply(400, b"", "text/plain")
+            return
+
+        api = self.json_apis.get(url.path.removeprefix("/axis-cgi/"))
+        self.server.device.requests[(api, method)] += 1
+        self.delay()
+
+        body = self.recorded("%s.%s.json" % (api, method))
+        if body is None and api is not None:
+            data = getattr(self.server.device, api)(
+                method, request.get("params", {}))
+            if data is None:
+                response = {"error": {"code": 2002,
+                                      "message": "Method not supported"}}
+            else:
+                response = {"data": data}
+            response.update(apiVersion=request.get("apiVersion", "1.0"),
+                            method=method)
+            body = json.dumps(response).encode()
+        if body is None:
+            self.reply(404, b"", "text/plain")
+            return
+        self.reply(200, body, "application/json")
+
+    def do_GET(self):
+        url = urllib.parse.urlsplit(self.path)
+        path = url.path.removeprefix("/axis-cgi/")
+        if not path.startswith("virtualinput/"):
+            self.reply(404, b"", "text/plain")
+            return
+
+        cgi = path.removeprefix("virtualinput/")
+        self.server.device.requests[("virtualinput", cgi)] += 1
+        self.delay()
+
+        body = self.recorded(cgi.replace(".cgi", ".xml"))
+        if body is None:
+            body = self.server.device.vinput(
+                cgi, urllib.parse.parse_qs(url.query)).encode()
+        self.reply(200, body, "application/xml")
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("--address", default="127.0.0.1",
+                        help="the address to listen on, default 127.0.0.1")
+    parser.add_argument("--port", type=int, default=8080,
+                        help="the port to listen on, default 8080")
+    parser.add_argument("--latency-ms", type=float, default=0,
+                        help="delay of every response, default 0")
+    parser.add_argument("--jitter-ms", type=float, default=0,
+                        help="random extra delay, default 0")
+    parser.add_argument("--areas", type=int, default=4,
+                        help="thermometry areas, default 4")
+    parser.add_argument("--ports", type=int, default=8,
+                        help="I/O ports, default 8")
+    parser.add_argument("--responses",
+                        help="directory of recorded responses")
+    args = parser.parse_args()
+
+    server = http.server.ThreadingHTTPServer((args.address, args.port),
+                                             Handler)
+    server.daemon_threads = True
+    server.args = args
+    server.device = Device(args.areas, args.ports)
+
+    signal.signal(signal.SIGTERM, lambda *_: sys.exit(0))
+    try:
+        server.serve_forever()
+    except (KeyboardInterrupt, SystemExit):
+        pass
+    finally:
+        for (api, method), count in sorted(server.device.requests.items(),
+                                           key=lambda item: str(item[0])):
+            sys.stderr.write("%-16s %-24s %8d\n" % (api, method, count))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())